@@ -3,6 +3,9 @@
 #include "nob.h"
 
 #include <time.h>
+#ifndef _WIN32
+#include <signal.h>
+#endif
 
 Cmd cmd = {0};
 
@@ -129,77 +132,402 @@ void filter_out_paths_doesnt_contain(char* contain, File_Paths* in){
     in->count = intermediate.count;
 }
 
-bool build_third_party(){
-    //this can be dumb build like who would modify third party
-    bool result = true;
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BUILD_X86_SIMD
+#endif
+
+#ifdef BUILD_X86_SIMD
+// Every opus file gets to know which x86 kernels exist so the RTCD tables in
+// x86_celt_map.c/x86_silk_map.c can point at them, opus_select_arch picks
+// one at runtime from cpuid. x86_64 always has SSE/SSE2 so those are presumed.
+void append_x86_simd_defines(Cmd* cmd){
+    cmd_append(cmd,
+        "-DOPUS_HAVE_RTCD",
+        "-DCPU_INFO_BY_C",
+        "-DOPUS_X86_MAY_HAVE_SSE",
+        "-DOPUS_X86_MAY_HAVE_SSE2",
+        "-DOPUS_X86_MAY_HAVE_SSE4_1",
+        "-DOPUS_X86_MAY_HAVE_AVX2",
+        "-DOPUS_X86_MAY_HAVE_AVX512",
+        "-DOPUS_X86_MAY_HAVE_AVX512_VNNI"
+    );
+#if defined(__x86_64__) || defined(_M_X64)
+    cmd_append(cmd, "-DOPUS_X86_PRESUME_SSE", "-DOPUS_X86_PRESUME_SSE2");
+#endif
+}
+
+// Only the kernel files themselves may use the wider instruction sets,
+// the same split opus' own build does
+void append_x86_simd_flags(Cmd* cmd, const char* path){
+    if(strstr(path, "_sse4_1.c")){
+        cmd_append(cmd, "-msse4.1");
+    }else if(strstr(path, "_avx512vnni.c")){
+        cmd_append(cmd, "-mavx", "-mfma", "-mavx2", "-mavx512f", "-mavx512dq", "-mavx512bw", "-mavx512vl", "-mavx512vnni");
+    }else if(strstr(path, "_avx512.c")){
+        cmd_append(cmd, "-mavx", "-mfma", "-mavx2", "-mavx512f", "-mavx512dq", "-mavx512bw", "-mavx512vl");
+    }else if(strstr(path, "_avx2.c") || strstr(path, "_avx.c")){
+        cmd_append(cmd, "-mavx", "-mfma", "-mavx2");
+    }else if(strstr(path, "_sse2.c")){
+        cmd_append(cmd, "-msse2");
+    }else if(strstr(path, "_sse.c")){
+        cmd_append(cmd, "-msse");
+    }
+}
+#endif
+
+#define PGO_DIR "build/pgo-data"
+#define PGO_RAW_DIR PGO_DIR "/raw"
+#define PGO_PROFDATA PGO_DIR "/default.profdata"
+#define PGO_HISTORY PGO_DIR "/history.txt"
+#define PGO_RELAY_PORT "47800"
+#define VOIP48_HISTORY "build/voip48-history.txt"
+#define VOIP48_RUNS 5 // workload runs per build, medians are reported
+
+// Build profiles, picked on the command line. debug is the default and what
+// the tree always built: unoptimized client/server with symbols. release and
+// native optimize everything and link with LTO so the codec archive can be
+// inlined into the client's hot loops, ThinLTO when clang has lld next to it
+// (see probe_lto), lto=off turns it off. pgo is release trained on the
+// headless workload (see run_pgo).
+typedef struct {
+    const char* name;
+    bool optimize;
+    bool lto; // wanted, what the toolchain can do is in lto_mode
+    const char* march; // NULL leaves the compiler default
+    const char* profile_generate; // directory instrumented binaries write raw profiles to
+    const char* profile_use; // merged profile to optimize with
+    bool voip48; // codec specialized for the client's stream, see voip48_profile
+} Profile;
+
+// The client only ever encodes and decodes 48 kHz mono in 20 ms frames.
+// voip48 builds of any profile fix that at compile time (OPUS_FIXED_* in
+// celt/arch.h), so what depends on the rate and channel count folds to
+// constants, leave out what neither the client nor the relay calls
+// (multistream, projection, the encode pool, opusfile and ogg) and link with
+// section GC so the stereo and resampling paths that folding made unreachable
+// go too. They build under build/<profile>-voip48/.
+Profile voip48_profile(Profile generic){
+    Profile profile = generic;
+    profile.name = temp_sprintf("%s-voip48", generic.name);
+    profile.voip48 = true;
+    return profile;
+}
 
-    int opuslib_exists = file_exists(
+void append_voip48_defines(Cmd* cmd){
+    cmd_append(cmd,
+        "-DOPUS_FIXED_SAMPLE_RATE=48000",
+        "-DOPUS_FIXED_CHANNELS=1",
+        "-DOPUS_FIXED_FRAME_SIZE=960",
+    );
+}
+
+void append_profile_pgo_flags(Cmd* cmd, Profile profile){
+    if(profile.profile_generate) cmd_append(cmd, temp_sprintf("-fprofile-generate=%s", profile.profile_generate));
+    if(profile.profile_use){
+        cmd_append(cmd,
+            temp_sprintf("-fprofile-use=%s", profile.profile_use),
+            "-Wno-profile-instr-unprofiled",
+            "-Wno-profile-instr-out-of-date"
+        );
+    }
+}
+
+// How profiles that want LTO get it. ThinLTO needs clang with lld, full LTO
+// with the default linker needs one that takes clang's bitcode (the LLVM gold
+// plugin, or ld64 on macOS). probe_lto picks the first that links here.
+typedef enum {
+    LTO_NONE,
+    LTO_FULL,
+    LTO_THIN,
+} Lto_Mode;
+
+Lto_Mode lto_mode = LTO_NONE;
+
+// Links an empty program with the given LTO flags, quietly
+bool lto_links(const char* lto_flag, const char* linker_flag){
+    const char* source = "build/lto_probe.c";
+    const char* program = "int main(void){return 0;}\n";
+    if(!write_entire_file(source, program, strlen(program))) return false;
+#ifdef _WIN32
+    const char* null_path = "NUL";
+    const char* output = "build/lto_probe.exe";
+#else
+    const char* null_path = "/dev/null";
+    const char* output = "build/lto_probe";
+#endif
+    Fd fdout = fd_open_for_write(null_path);
+    if(fdout == INVALID_FD) return false;
+    Fd fderr = fd_open_for_write(null_path);
+    if(fderr == INVALID_FD){
+        fd_close(fdout);
+        return false;
+    }
+    cmd_append(&cmd, "clang", lto_flag);
+    if(linker_flag) cmd_append(&cmd, linker_flag);
+    cmd_append(&cmd, source, "-o", output);
+    return cmd_run_sync_redirect_and_reset(&cmd, (Cmd_Redirect){.fdout = &fdout, .fderr = &fderr});
+}
+
+Lto_Mode probe_lto(void){
+    if(lto_links("-flto=thin", "-fuse-ld=lld")) return LTO_THIN;
+    nob_log(WARNING, "clang can't link with lld, ThinLTO is off. Install lld (ld.lld on the PATH) for it");
+    if(lto_links("-flto", NULL)){
+        nob_log(WARNING, "Using full LTO with the default linker instead");
+        return LTO_FULL;
+    }
+    nob_log(WARNING, "The default linker can't take LTO objects either, building without LTO");
+    return LTO_NONE;
+}
+
+void append_profile_codec_flags(Cmd* cmd, Profile profile){
+    cmd_append(cmd, "-O3");
+    if(!profile.optimize) cmd_append(cmd, "-g");
+    if(profile.lto && lto_mode == LTO_THIN) cmd_append(cmd, "-flto=thin");
+    if(profile.lto && lto_mode == LTO_FULL) cmd_append(cmd, "-flto");
+    if(profile.march) cmd_append(cmd, temp_sprintf("-march=%s", profile.march));
+    append_profile_pgo_flags(cmd, profile);
+}
+
+void append_profile_app_flags(Cmd* cmd, Profile profile){
+    if(profile.optimize){
+        cmd_append(cmd, "-O2", "-DNDEBUG");
+    }else{
+        cmd_append(cmd, "-g", "-O0");
+    }
+    if(profile.lto && lto_mode == LTO_THIN) cmd_append(cmd, "-flto=thin", "-fuse-ld=lld");
+    if(profile.lto && lto_mode == LTO_FULL) cmd_append(cmd, "-flto");
+    if(profile.march) cmd_append(cmd, temp_sprintf("-march=%s", profile.march));
+    if(profile.voip48){
+#ifdef __APPLE__
+        cmd_append(cmd, "-Wl,-dead_strip");
+#elif !defined(_WIN32)
+        cmd_append(cmd, "-Wl,--gc-sections");
+#endif
+    }
+    append_profile_pgo_flags(cmd, profile);
+}
+
+const char* profile_archive_path(Profile profile){
+#ifdef WIN32
+    return temp_sprintf("build/%s/opusfile.lib", profile.name);
+#else
+    return temp_sprintf("build/%s/libopusfile.a", profile.name);
+#endif
+}
+
+const char* profile_dnn_archive_path(Profile profile){
 #ifdef WIN32
-        "./thirdparty/opusfile.lib"
+    return temp_sprintf("build/%s/opusdnn.lib", profile.name);
+#else
+    return temp_sprintf("build/%s/libopusdnn.a", profile.name);
+#endif
+}
+
+// True when the flags an output was last built with (kept in stamp_path) are exactly these
+bool stamp_matches(const char* stamp_path, Cmd flags){
+    String_Builder rendered = {0};
+    String_Builder stamp = {0};
+    cmd_render(flags, &rendered);
+    bool result = file_exists(stamp_path) == 1 &&
+                  read_entire_file(stamp_path, &stamp) &&
+                  sv_eq(sb_to_sv(rendered), sb_to_sv(stamp));
+    sb_free(rendered);
+    sb_free(stamp);
+    return result;
+}
+
+bool stamp_write(const char* stamp_path, Cmd flags){
+    String_Builder rendered = {0};
+    cmd_render(flags, &rendered);
+    bool result = write_entire_file(stamp_path, rendered.items, rendered.count);
+    sb_free(rendered);
+    return result;
+}
+
+// mkdir -p for the directory part of path
+bool mkdir_parents(const char* path){
+    String_Builder sb = {0};
+    bool result = true;
+    for(size_t i = 0; path[i] != '\0'; i++){
+        if((path[i] == '/' || path[i] == '\\') && i > 0){
+            sb.count = 0;
+            sb_append_buf(&sb, path, i);
+            sb_append_null(&sb);
+            if(file_exists(sb.items) == 1) continue;
+            if(!mkdir_if_not_exists(sb.items)) return_defer(false);
+        }
+    }
+defer:
+    sb_free(sb);
+    return result;
+}
+
+int processor_count(){
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
 #else
-        "./thirdparty/libopusfile.a"
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? count : 1;
 #endif
+}
+
+// 1 when the object is missing or older than its source or any header the
+// compiler listed in the -MMD dependency file next to it, 0 when up to date
+int object_needs_rebuild(const char* object_path, const char* dep_path){
+    int result = 1;
+    String_Builder sb = {0};
+    File_Paths deps = {0};
+    size_t checkpoint = temp_save();
+
+    if(file_exists(dep_path) != 1) return_defer(1);
+    if(!read_entire_file(dep_path, &sb)) return_defer(1);
+
+    // Make style "object.o: source.c header.h ..." with backslash line continuations,
+    // the target ends at the first ": " (windows paths have drive colons)
+    String_View sv = sb_to_sv(sb);
+    while(sv.count > 1 && !(sv.data[0] == ':' && isspace(sv.data[1]))){
+        sv.data++;
+        sv.count--;
+    }
+    if(sv.count <= 1) return_defer(1);
+    sv_chop_left(&sv, 1);
+
+    while(true){
+        sv = sv_trim_left(sv);
+        if(sv.count == 0) break;
+        size_t n = 0;
+        while(n < sv.count && !isspace(sv.data[n])) n++;
+        String_View dep = sv_chop_left(&sv, n);
+        if(dep.count == 1 && dep.data[0] == '\\') continue;
+
+        const char* dep_cstr = temp_sprintf(SV_Fmt, SV_Arg(dep));
+        // A header that went away means the object has to be rebuilt to find out
+        if(file_exists(dep_cstr) != 1) return_defer(1);
+        da_append(&deps, dep_cstr);
+    }
+
+    result = needs_rebuild(object_path, deps.items, deps.count);
+
+defer:
+    temp_rewind(checkpoint);
+    sb_free(sb);
+    da_free(deps);
+    return result;
+}
+
+// Waits for the oldest running compile once jobs are already in flight
+bool procs_wait_for_slot(Procs* procs, size_t jobs){
+    bool result = true;
+    while(procs->count >= jobs){
+        result = proc_wait(procs->items[0]) && result;
+        memmove(procs->items, procs->items + 1, (procs->count - 1) * sizeof(*procs->items));
+        procs->count--;
+    }
+    return result;
+}
+
+// Include paths and defines opus is compiled with, also what anything built
+// against its internal headers needs so it sees the same structs and
+// dispatch tables
+void append_opus_internal_flags(Cmd* cmd){
+    cmd_append(cmd,
+        "-I./thirdparty/opus/src",
+        "-I./thirdparty/opus/include",
+        "-I./thirdparty/opus/silk",
+        "-I./thirdparty/opus/",
+        "-I./thirdparty/opus/dnn",
+        "-I./thirdparty/opus/celt",
+        "-I./thirdparty/opus/silk/float",
+
+        // Codec temporaries go to an arena inside every encoder/decoder
+        // instead of the audio thread's stack, see celt/stack_alloc.h
+        "-DOPUS_SCRATCH_ARENA",
     );
-    if(opuslib_exists < 0) return false;
-    if(opuslib_exists == 1) return true;
-    
-    File_Paths children = {0};
+#ifdef BUILD_X86_SIMD
+    append_x86_simd_defines(cmd);
+#endif
+}
+
+// Compiles sources into objects under build/<profile>/ and archives them.
+// Objects are rebuilt only when their source or headers change (or the
+// flags, kept in flags_path, do), compiles run in parallel up to the core
+// count
+bool build_archive(Profile profile, File_Paths sources, Cmd flags, const char* archive_path, const char* flags_path){
+    bool result = true;
     File_Paths objects_children = {0};
-    if(!traverse_directory("./thirdparty", &children)) return_defer(false);
-    
-    char *allowed[] = {"c"};
-    filter_out_paths_ending(allowed, 1,&children);
-    filter_out_paths_doesnt_contain("test",&children);
-    filter_out_paths_doesnt_contain("arm",&children);
-    filter_out_paths_doesnt_contain("dnn",&children);
-    filter_out_paths_doesnt_contain("mips",&children);
-    filter_out_paths_doesnt_contain("x86",&children);
-    filter_out_paths_doesnt_contain("silk/fixed",&children);
+    Procs procs = {0};
+    size_t jobs = processor_count();
+    size_t compiled = 0;
+
+    // Objects built with different flags don't count as up to date
+    if(!mkdir_parents(flags_path)) return_defer(false);
+    bool flags_changed = !stamp_matches(flags_path, flags);
     
-    for(int i = 0; i < children.count; i++){
+    for(int i = 0; i < sources.count; i++){
         String_Builder sb = {0};
-        String_View sv = sv_from_cstr(children.items[i]);
-        String_View sv2 = sv_from_cstr(children.items[i]);
+        String_Builder dep_sb = {0};
+        String_View sv = sv_from_cstr(sources.items[i]);
+        String_View sv2 = sv_from_cstr(sources.items[i]);
         if(sv2.data[0] == '.') sv_chop_by_delim(&sv2, '.');
         sv_chop_by_delim(&sv2, '.');
         sv.count = sv2.data - sv.data;
+        if(sv_starts_with(sv, sv_from_cstr("./"))) sv_chop_left(&sv, 2);
 
+        sb_append_cstr(&sb, temp_sprintf("build/%s/", profile.name));
+        sb_append_cstr(&dep_sb, temp_sprintf("build/%s/", profile.name));
         sb_append_buf(&sb,sv.data,sv.count);
+        sb_append_buf(&dep_sb,sv.data,sv.count);
         sb_append_cstr(&sb,"o");
+        sb_append_cstr(&dep_sb,"d");
         sb_append_null(&sb);
+        sb_append_null(&dep_sb);
+        da_append(&objects_children, sb.items);
+
+        int rebuild = flags_changed ? 1 : object_needs_rebuild(sb.items, dep_sb.items);
+        // A retrained profile changes the code even with the same flags
+        if(rebuild == 0 && profile.profile_use) rebuild = needs_rebuild1(sb.items, profile.profile_use);
+        if(rebuild < 0) return_defer(false);
+        if(rebuild == 0){
+            sb_free(dep_sb);
+            continue;
+        }
+        if(!mkdir_parents(sb.items)) return_defer(false);
     
         cmd.count = 0;
+        cmd_append(&cmd, "clang");
+        cmd_extend(&cmd, &flags);
+#ifdef BUILD_X86_SIMD
+        append_x86_simd_flags(&cmd, sources.items[i]);
+#endif
         cmd_append(&cmd,
-            "clang",
-            "-ffunction-sections",
-            "-fdata-sections",
-            "-O3",
+            "-MMD",
+            "-MF",
+            dep_sb.items,
             "-c",
-                
-            "-I./thirdparty/opus/src",
-            "-I./thirdparty/opus/include",
-            "-I./thirdparty/opus/silk",
-            "-I./thirdparty/opus/",
-            "-I./thirdparty/opus/dnn",
-            "-I./thirdparty/opus/celt",
-            "-I./thirdparty/opus/silk/float",
-            "-I./thirdparty/opusfile/include",
-            "-I./thirdparty/ogg/include",
-    
-            children.items[i],
+            sources.items[i],
             "-o",
             sb.items
         );
 
-        da_append(&objects_children, sb.items);
-        if(!cmd_run_sync_and_reset(&cmd)) return_defer(false);
+        if(!procs_wait_for_slot(&procs, jobs)) result = false;
+        da_append(&procs, cmd_run_async_and_reset(&cmd));
+        compiled++;
     }
 
-#ifdef WIN32
-    cmd_append(&cmd,"llvm-ar", "rcs", "./thirdparty/opusfile.lib");
-#else
-    cmd_append(&cmd,"llvm-ar", "rcs", "./thirdparty/libopusfile.a");
-#endif
+    if(!procs_wait_and_reset(&procs)) result = false;
+    if(!result) return_defer(false);
+    if(!stamp_write(flags_path, flags)) return_defer(false);
+
+    int archive_rebuild = compiled > 0 ? 1 : needs_rebuild(archive_path, (const char**)objects_children.items, objects_children.count);
+    if(archive_rebuild < 0) return_defer(false);
+    if(archive_rebuild == 0) return_defer(true);
+
+    // Start from an empty archive so members of deleted sources don't linger
+    if(file_exists(archive_path) == 1 && !delete_file(archive_path)) return_defer(false);
+
+    cmd_append(&cmd,"llvm-ar", "rcs", archive_path);
 
     for(int i = 0; i < objects_children.count; i++){
         cmd_append(&cmd, objects_children.items[i]);
@@ -208,14 +536,479 @@ bool build_third_party(){
     if(!cmd_run_sync_and_reset(&cmd)) return_defer(false);
 
 defer:
-    da_free(children);
     da_free(objects_children);
+    da_free(procs);
+    return result;
+}
+
+bool build_third_party(Profile profile){
+    bool result = true;
+    File_Paths children = {0};
+    Cmd flags = {0};
+
+    if(!traverse_directory("./thirdparty", &children)) return_defer(false);
+    
+    char *allowed[] = {"c"};
+    filter_out_paths_ending(allowed, 1,&children);
+    filter_out_paths_doesnt_contain("test",&children);
+    filter_out_paths_doesnt_contain("arm",&children);
+    filter_out_paths_doesnt_contain("dnn",&children);
+    filter_out_paths_doesnt_contain("mips",&children);
+#ifndef BUILD_X86_SIMD
+    filter_out_paths_doesnt_contain("x86",&children);
+#endif
+    filter_out_paths_doesnt_contain("silk/fixed",&children);
+    // mapping_matrix stays, the x86 dispatch tables point at its kernels
+    if(profile.voip48){
+        filter_out_paths_doesnt_contain("opusfile",&children);
+        filter_out_paths_doesnt_contain("/ogg/",&children);
+        filter_out_paths_doesnt_contain("multistream",&children);
+        filter_out_paths_doesnt_contain("projection",&children);
+        filter_out_paths_doesnt_contain("encode_pool",&children);
+    }
+
+    cmd_append(&flags,
+        "-ffunction-sections",
+        "-fdata-sections",
+        "-I./thirdparty/opusfile/include",
+        "-I./thirdparty/ogg/include",
+    );
+    append_opus_internal_flags(&flags);
+    if(profile.voip48) append_voip48_defines(&flags);
+    append_profile_codec_flags(&flags, profile);
+
+    result = build_archive(profile, children, flags, profile_archive_path(profile), temp_sprintf("build/%s/.build_flags", profile.name));
+
+defer:
+    da_free(children);
+    da_free(flags);
+    return result;
+}
+
+// The neural models (DRED, FARGAN, LACE) aren't part of the client build, so
+// they get an archive of their own that only the dnn benchmark links. The
+// NoLACE weights aren't in the tree, hence DISABLE_NOLACE.
+void append_dnn_defines(Cmd* cmd){
+    cmd_append(cmd, "-DENABLE_OSCE", "-DDISABLE_NOLACE");
+}
+
+bool build_dnn_archive(Profile profile){
+    bool result = true;
+    File_Paths children = {0};
+    Cmd flags = {0};
+
+    if(!traverse_directory("./thirdparty/opus/dnn", &children)) return_defer(false);
+
+    char *allowed[] = {"c"};
+    filter_out_paths_ending(allowed, 1,&children);
+    filter_out_paths_doesnt_contain("arm",&children);
+#ifndef BUILD_X86_SIMD
+    filter_out_paths_doesnt_contain("x86",&children);
+#endif
+    // Standalone tools with their own main, lossgen.c also includes the
+    // weight parser
+    filter_out_paths_doesnt_contain("_demo.c",&children);
+    filter_out_paths_doesnt_contain("dump_data.c",&children);
+    filter_out_paths_doesnt_contain("write_lpcnet_weights.c",&children);
+    filter_out_paths_doesnt_contain("lossgen.c",&children);
+
+    append_opus_internal_flags(&flags);
+    append_dnn_defines(&flags);
+    append_profile_codec_flags(&flags, profile);
+
+    result = build_archive(profile, children, flags, profile_dnn_archive_path(profile), temp_sprintf("build/%s/.dnn_build_flags", profile.name));
+
+defer:
+    da_free(children);
+    da_free(flags);
     return result;
 }
 
 void usage(char* program){
-    printf("[USAGE]: %s (client) (server)\n", program);
+    printf("[USAGE]: %s (client) (server) (bench) (test) (debug|release|native|pgo) (march=<cpu>) (lto=off) (voip48)\n", program);
+    printf("    bench    build and run the codec and kernel benchmarks, results in build/<profile>/bench.json\n");
+    printf("             build/<profile>/kernel_bench.json and build/<profile>/dnn_bench.json\n");
+    printf("    test     build and run the client's receiver report checks\n");
+    printf("    debug    unoptimized client/server with symbols (default)\n");
+    printf("    release  -O2 client/server, -O3 codec, LTO across libopusfile. Builds with clang either way,\n");
+    printf("             ThinLTO needs lld too, without it full LTO with the default linker or none is used\n");
+    printf("    native   release tuned with -march=native\n");
+    printf("    pgo      release trained on src/workload.c, speedup logged to %s\n", PGO_HISTORY);
+    printf("    march=   target cpu for any profile, e.g. march=x86-64-v3\n");
+    printf("    lto=off  build release, native and pgo without LTO\n");
+    printf("    voip48   codec specialized for 48 kHz mono 20 ms VOIP, with bench it is compared to the generic\n");
+    printf("             build on binary size, cold start and per-frame cost, logged to %s\n", VOIP48_HISTORY);
+}
+
+// Rebuilds output when it is missing, older than any input (or the profile
+// it is optimized with) or was built with other flags
+bool build_app(Profile profile, const char* output, const char** inputs, size_t inputs_count, Cmd flags, const char* stamp_path){
+    int result = needs_rebuild(output, inputs, inputs_count);
+    if(result == 0 && profile.profile_use) result = needs_rebuild1(output, profile.profile_use);
+    if(result < 0) return false;
+    if(result == 0 && stamp_matches(stamp_path, flags)) return true;
+
+    cmd.count = 0;
+    cmd_extend(&cmd, &flags);
+    if(!cmd_run_sync_and_reset(&cmd)) return false;
+    return stamp_write(stamp_path, flags);
+}
+
+// Checks of the client pieces that stand on their own, no codec needed
+bool run_tests(Profile profile){
+#ifdef _WIN32
+    const char* output = "build/receiver_stats_test.exe";
+#else
+    const char* output = "build/receiver_stats_test";
+#endif
+    const char* inputs[] = {"src/receiver_stats_test.cpp", "src/receiver_stats.h"};
+    Cmd flags = {0};
+    cmd_append(&flags, "clang++");
+    append_profile_app_flags(&flags, profile);
+    cmd_append(&flags, "src/receiver_stats_test.cpp", "-o", output);
+    bool ok = build_app(profile, output, inputs, ARRAY_LEN(inputs), flags, "build/.receiver_stats_test_flags");
+    da_free(flags);
+    if(!ok) return false;
+
+    cmd_append(&cmd, output);
+    return cmd_run_sync_and_reset(&cmd);
+}
+
+// Per-function timings of the SIMD kernels against their C versions, built
+// against the internal headers since those functions aren't public
+bool run_kernel_bench(Profile profile){
+#ifdef _WIN32
+    const char* output = temp_sprintf("build/%s/kernel_bench.exe", profile.name);
+#else
+    const char* output = temp_sprintf("build/%s/kernel_bench", profile.name);
+#endif
+    const char* inputs[] = {"src/kernel_bench.c", "src/corpus.h", profile_archive_path(profile)};
+    Cmd flags = {0};
+    cmd_append(&flags, "clang");
+    append_profile_app_flags(&flags, profile);
+    append_opus_internal_flags(&flags);
+    cmd_append(&flags,
+        "src/kernel_bench.c",
+        "-o",
+        output,
+        "-L",
+        temp_sprintf("build/%s", profile.name),
+        "-lopusfile",
+    );
+#ifndef _WIN32
+    cmd_append(&flags, "-lm");
+#endif
+    bool ok = build_app(profile, output, inputs, ARRAY_LEN(inputs), flags, temp_sprintf("build/%s/.kernel_bench_flags", profile.name));
+    da_free(flags);
+    if(!ok) return false;
+
+    cmd_append(&cmd, output, temp_sprintf("build/%s/kernel_bench.json", profile.name));
+    return cmd_run_sync_and_reset(&cmd);
+}
+
+// Frames per second of the neural models at every dispatch level this cpu
+// has, linked against their own archive (see build_dnn_archive)
+bool run_dnn_bench(Profile profile){
+    if(!build_dnn_archive(profile)) return false;
+#ifdef _WIN32
+    const char* output = temp_sprintf("build/%s/dnn_bench.exe", profile.name);
+#else
+    const char* output = temp_sprintf("build/%s/dnn_bench", profile.name);
+#endif
+    const char* inputs[] = {"src/dnn_bench.c", "src/corpus.h", profile_archive_path(profile), profile_dnn_archive_path(profile)};
+    Cmd flags = {0};
+    cmd_append(&flags, "clang");
+    append_profile_app_flags(&flags, profile);
+    append_opus_internal_flags(&flags);
+    append_dnn_defines(&flags);
+    cmd_append(&flags,
+        "src/dnn_bench.c",
+        "-o",
+        output,
+        "-L",
+        temp_sprintf("build/%s", profile.name),
+        "-lopusdnn",
+        "-lopusfile",
+    );
+#ifndef _WIN32
+    cmd_append(&flags, "-lm");
+#endif
+    bool ok = build_app(profile, output, inputs, ARRAY_LEN(inputs), flags, temp_sprintf("build/%s/.dnn_bench_flags", profile.name));
+    da_free(flags);
+    if(!ok) return false;
+
+    cmd_append(&cmd, output, temp_sprintf("build/%s/dnn_bench.json", profile.name));
+    return cmd_run_sync_and_reset(&cmd);
+}
+
+// Builds the codec benchmark against the profile's archive and runs it, the
+// JSON lands next to the archive so results of two profiles can be diffed
+bool run_bench(Profile profile){
+#ifdef _WIN32
+    const char* output = temp_sprintf("build/%s/bench.exe", profile.name);
+#else
+    const char* output = temp_sprintf("build/%s/bench", profile.name);
+#endif
+    const char* inputs[] = {"src/bench.c", "src/corpus.h", profile_archive_path(profile)};
+    Cmd flags = {0};
+    cmd_append(&flags, "clang");
+    append_profile_app_flags(&flags, profile);
+    cmd_append(&flags,
+        "src/bench.c",
+        "-o",
+        output,
+        "-I",
+        "thirdparty/opus/include",
+        "-L",
+        temp_sprintf("build/%s", profile.name),
+        "-lopusfile",
+    );
+#ifndef _WIN32
+    cmd_append(&flags, "-lm", "-lpthread");
+#endif
+    bool ok = build_app(profile, output, inputs, ARRAY_LEN(inputs), flags, temp_sprintf("build/%s/.bench_flags", profile.name));
+    da_free(flags);
+    if(!ok) return false;
+
+    cmd_append(&cmd, output, temp_sprintf("build/%s/bench.json", profile.name));
+    if(!cmd_run_sync_and_reset(&cmd)) return false;
+    return run_kernel_bench(profile) && run_dnn_bench(profile);
+}
+
+#ifndef _WIN32
+bool build_workload(Profile profile){
+    const char* output = temp_sprintf("build/%s/workload", profile.name);
+    const char* inputs[] = {"src/workload.c", "src/corpus.h", profile_archive_path(profile)};
+    Cmd flags = {0};
+    cmd_append(&flags, "clang");
+    append_profile_app_flags(&flags, profile);
+    cmd_append(&flags,
+        "src/workload.c",
+        "-o",
+        output,
+        "-I",
+        "thirdparty/opus/include",
+        "-L",
+        temp_sprintf("build/%s", profile.name),
+        "-lopusfile",
+        "-lm",
+        "-lpthread",
+    );
+    bool ok = build_app(profile, output, inputs, ARRAY_LEN(inputs), flags, temp_sprintf("build/%s/.workload_flags", profile.name));
+    da_free(flags);
+    return ok;
+}
+
+// The relay the workload talks to, built with the same profile
+bool build_profile_server(Profile profile){
+    const char* output = temp_sprintf("build/%s/server", profile.name);
+    const char* inputs[] = {"src/server.c", profile_archive_path(profile)};
+    Cmd flags = {0};
+    cmd_append(&flags, "clang");
+    append_profile_app_flags(&flags, profile);
+    cmd_append(&flags,
+        "src/server.c",
+        "-o",
+        output,
+        "-I",
+        "thirdparty/opus/include",
+        "-L",
+        temp_sprintf("build/%s", profile.name),
+        "-lopusfile",
+        "-lm",
+    );
+    bool ok = build_app(profile, output, inputs, ARRAY_LEN(inputs), flags, temp_sprintf("build/%s/.server_flags", profile.name));
+    da_free(flags);
+    return ok;
+}
+
+bool build_workload_profile(Profile profile){
+    return build_third_party(profile) && build_workload(profile) && build_profile_server(profile);
+}
+
+// Runs the workload against a local relay of the same profile, the relay is
+// stopped with SIGTERM so it exits through main (instrumented builds write
+// their profile then)
+bool run_workload(Profile profile, const char* report_path){
+    cmd_append(&cmd, temp_sprintf("build/%s/server", profile.name), "127.0.0.1", PGO_RELAY_PORT);
+    Proc server = cmd_run_async_and_reset(&cmd);
+    if(server == NOB_INVALID_PROC) return false;
+
+    cmd_append(&cmd, temp_sprintf("build/%s/workload", profile.name), report_path, "relay", "127.0.0.1", PGO_RELAY_PORT);
+    bool result = cmd_run_sync_and_reset(&cmd);
+
+    kill(server, SIGTERM);
+    if(!proc_wait(server)) result = false;
+    return result;
+}
+
+typedef struct {
+    double encode_us;
+    double decode_us;
+    double relay_rate;
+    double cold_start_us;
+} Workload_Report;
+
+bool read_workload_report(const char* path, Workload_Report* report){
+    String_Builder sb = {0};
+    if(!read_entire_file(path, &sb)) return false;
+    sb_append_null(&sb);
+    bool result = sscanf(sb.items,
+        "encode_us_per_frame %lf decode_us_per_frame %lf relay_messages_per_sec %lf cold_start_us %lf",
+        &report->encode_us, &report->decode_us, &report->relay_rate, &report->cold_start_us) == 4;
+    if(!result) nob_log(ERROR, "Malformed workload report %s", path);
+    sb_free(sb);
+    return result;
+}
+
+bool merge_profiles(){
+    bool result = true;
+    File_Paths raw = {0};
+    if(!read_entire_dir(PGO_RAW_DIR, &raw)) return_defer(false);
+
+    cmd_append(&cmd, "llvm-profdata", "merge", "-o", PGO_PROFDATA);
+    size_t profiles = 0;
+    for(size_t i = 0; i < raw.count; i++){
+        if(!sv_end_with(sv_from_cstr(raw.items[i]), ".profraw")) continue;
+        cmd_append(&cmd, temp_sprintf("%s/%s", PGO_RAW_DIR, raw.items[i]));
+        profiles++;
+    }
+    if(profiles == 0){
+        nob_log(ERROR, "The training run left no profiles in %s", PGO_RAW_DIR);
+        cmd.count = 0;
+        return_defer(false);
+    }
+    if(!cmd_run_sync_and_reset(&cmd)) return_defer(false);
+
+defer:
+    da_free(raw);
+    return result;
+}
+
+bool clear_raw_profiles(){
+    bool result = true;
+    File_Paths raw = {0};
+    if(!mkdir_parents(PGO_RAW_DIR "/")) return_defer(false);
+    if(!read_entire_dir(PGO_RAW_DIR, &raw)) return_defer(false);
+    for(size_t i = 0; i < raw.count; i++){
+        if(!sv_end_with(sv_from_cstr(raw.items[i]), ".profraw")) continue;
+        if(!delete_file(temp_sprintf("%s/%s", PGO_RAW_DIR, raw.items[i]))) return_defer(false);
+    }
+defer:
+    da_free(raw);
+    return result;
+}
+
+bool append_pgo_history(Workload_Report baseline, Workload_Report pgo, const char* march){
+    String_Builder sb = {0};
+    if(file_exists(PGO_HISTORY) == 1 && !read_entire_file(PGO_HISTORY, &sb)) return false;
+
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    const char* line = temp_sprintf(
+        "%s march=%s encode %.1f -> %.1f us/frame (%.2fx) decode %.1f -> %.1f us/frame (%.2fx) relay %.0f -> %.0f msg/s (%.2fx)\n",
+        date, march ? march : "default",
+        baseline.encode_us, pgo.encode_us, baseline.encode_us / pgo.encode_us,
+        baseline.decode_us, pgo.decode_us, baseline.decode_us / pgo.decode_us,
+        baseline.relay_rate, pgo.relay_rate, pgo.relay_rate / baseline.relay_rate);
+    printf("%s", line);
+    sb_append_cstr(&sb, line);
+
+    bool result = write_entire_file(PGO_HISTORY, sb.items, sb.count);
+    sb_free(sb);
+    return result;
+}
+
+// Instrumented build -> training run of the workload and relay -> merged
+// profile -> release and pgo builds timed on the same workload, the speedup
+// of every run is appended to PGO_HISTORY
+bool run_pgo(const char* march){
+    Profile generate = {.name = "pgo-gen", .optimize = true, .march = march, .profile_generate = PGO_RAW_DIR};
+    Profile release = {.name = "release", .optimize = true, .lto = true, .march = march};
+    Profile pgo = {.name = "pgo", .optimize = true, .lto = true, .march = march, .profile_use = PGO_PROFDATA};
+    Workload_Report baseline_report, pgo_report;
+
+    if(!build_workload_profile(generate)) return false;
+    if(!clear_raw_profiles()) return false;
+    if(!run_workload(generate, "build/pgo-gen/workload.txt")) return false;
+    if(!merge_profiles()) return false;
+
+    if(!build_workload_profile(release)) return false;
+    if(!build_workload_profile(pgo)) return false;
+    if(!run_workload(release, "build/release/workload.txt")) return false;
+    if(!run_workload(pgo, "build/pgo/workload.txt")) return false;
+    if(!read_workload_report("build/release/workload.txt", &baseline_report)) return false;
+    if(!read_workload_report("build/pgo/workload.txt", &pgo_report)) return false;
+
+    return append_pgo_history(baseline_report, pgo_report, march);
+}
+
+int compare_double(const void* a, const void* b){
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+double median(double* values, size_t count){
+    qsort(values, count, sizeof(double), compare_double);
+    return values[count / 2];
+}
+
+// The workload's codec pass (no relay) built against the generic and the
+// voip48 archive of the same profile. Runs alternate between the two so the
+// machine's drift hits both alike. The binary sizes and the medians of cold
+// start and per-frame cost are appended to VOIP48_HISTORY.
+bool run_voip48_bench(Profile generic){
+    Profile profiles[2] = {generic, voip48_profile(generic)};
+    double encode_us[2][VOIP48_RUNS], decode_us[2][VOIP48_RUNS], cold_start_us[2][VOIP48_RUNS];
+    long long sizes[2];
+
+    for(int p = 0; p < 2; p++){
+        if(!build_third_party(profiles[p]) || !build_workload(profiles[p])) return false;
+        struct stat statbuf;
+        if(stat(temp_sprintf("build/%s/workload", profiles[p].name), &statbuf) < 0) return false;
+        sizes[p] = statbuf.st_size;
+    }
+    for(int run = 0; run < VOIP48_RUNS; run++){
+        for(int p = 0; p < 2; p++){
+            const char* report_path = temp_sprintf("build/%s/workload.txt", profiles[p].name);
+            Workload_Report report;
+            cmd_append(&cmd, temp_sprintf("build/%s/workload", profiles[p].name), report_path);
+            if(!cmd_run_sync_and_reset(&cmd)) return false;
+            if(!read_workload_report(report_path, &report)) return false;
+            encode_us[p][run] = report.encode_us;
+            decode_us[p][run] = report.decode_us;
+            cold_start_us[p][run] = report.cold_start_us;
+        }
+    }
+
+    String_Builder sb = {0};
+    if(file_exists(VOIP48_HISTORY) == 1 && !read_entire_file(VOIP48_HISTORY, &sb)) return false;
+    char date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    double encode[2], decode[2], cold_start[2];
+    for(int p = 0; p < 2; p++){
+        encode[p] = median(encode_us[p], VOIP48_RUNS);
+        decode[p] = median(decode_us[p], VOIP48_RUNS);
+        cold_start[p] = median(cold_start_us[p], VOIP48_RUNS);
+    }
+    const char* line = temp_sprintf(
+        "%s %s march=%s workload %lld -> %lld bytes (%.2fx) cold start %.0f -> %.0f us (%.2fx) "
+        "encode %.1f -> %.1f us/frame (%.2fx) decode %.1f -> %.1f us/frame (%.2fx)\n",
+        date, generic.name, generic.march ? generic.march : "default",
+        sizes[0], sizes[1], (double)sizes[0] / sizes[1],
+        cold_start[0], cold_start[1], cold_start[0] / cold_start[1],
+        encode[0], encode[1], encode[0] / encode[1],
+        decode[0], decode[1], decode[0] / decode[1]);
+    printf("%s", line);
+    sb_append_cstr(&sb, line);
+
+    bool result = write_entire_file(VOIP48_HISTORY, sb.items, sb.count);
+    sb_free(sb);
+    return result;
 }
+#endif
 
 int main(int argc, char** argv){
     NOB_GO_REBUILD_URSELF(argc,argv);
@@ -224,6 +1017,11 @@ int main(int argc, char** argv){
     
     bool build_client = true;
     bool build_server = true;
+    bool bench = false;
+    bool test = false;
+    bool voip48 = false;
+    bool lto_off = false;
+    Profile profile = {.name = "debug"};
 
     while (argc > 0){
         char* arg = shift_args(&argc,&argv);
@@ -235,32 +1033,82 @@ int main(int argc, char** argv){
             build_client = false;
         }
 
+        if(strcmp(arg,"bench") == 0){
+            bench = true;
+        }
+
+        if(strcmp(arg,"test") == 0){
+            test = true;
+        }
+
+        if(strcmp(arg,"debug") == 0){
+            profile = (Profile){.name = "debug"};
+        }
+
+        if(strcmp(arg,"release") == 0){
+            profile = (Profile){.name = "release", .optimize = true, .lto = true};
+        }
+
+        if(strcmp(arg,"native") == 0){
+            profile = (Profile){.name = "native", .optimize = true, .lto = true, .march = "native"};
+        }
+
+        if(strcmp(arg,"pgo") == 0){
+            profile = (Profile){.name = "pgo", .optimize = true, .lto = true, .profile_use = PGO_PROFDATA};
+        }
+
+        if(strncmp(arg,"march=",6) == 0){
+            profile.march = arg + 6;
+        }
+
+        if(strcmp(arg,"lto=off") == 0){
+            lto_off = true;
+        }
+
+        if(strcmp(arg,"voip48") == 0){
+            voip48 = true;
+        }
+
         if(strcmp(arg, "help") == 0){
             usage(program);
             return 0;
         }
     }
 
-    if(!build_third_party()) return 1;
-
     mkdir_if_not_exists("build");
+    if(profile.lto && !lto_off) lto_mode = probe_lto();
 
-    int result = needs_rebuild1(
-#ifdef _WIN32
-        "build/client.exe",
+    if(profile.profile_use){
+#ifndef _WIN32
+        if(!run_pgo(profile.march)) return 1;
 #else
-        "build/client",
+        printf("PGO builds need the relay, which doesn't build on windows\n");
+        return 1;
 #endif
-        "src/client.cpp"
-    );
+    }
 
-    if(result < 0) return 1;
+    if(voip48 && bench){
+#ifndef _WIN32
+        return run_voip48_bench(profile) ? 0 : 1;
+#else
+        printf("The voip48 comparison runs the workload, which doesn't build on windows\n");
+        return 1;
+#endif
+    }
+    if(voip48) profile = voip48_profile(profile);
 
-    if(build_client && result){
-        cmd.count = 0;
-        cmd_append(&cmd,
-           "clang++",
-           "-g",
+    if(test) return run_tests(profile) ? 0 : 1;
+
+    if(!build_third_party(profile)) return 1;
+
+    if(bench) return run_bench(profile) ? 0 : 1;
+
+    if(build_client){
+        const char* inputs[] = {"src/client.cpp", profile_archive_path(profile)};
+        Cmd flags = {0};
+        cmd_append(&flags, "clang++");
+        append_profile_app_flags(&flags, profile);
+        cmd_append(&flags,
            "src/client.cpp",
            "-o",
 #ifdef _WIN32
@@ -275,36 +1123,48 @@ int main(int argc, char** argv){
            "-I",
            "thirdparty/opus/include",
            "-L",
-           "thirdparty",
+           temp_sprintf("build/%s", profile.name),
            "-lopusfile",
         );
 
-        if(!cmd_run_sync_and_reset(&cmd)) return 1;
-    }
-
-
-    result = 
-#ifndef _WIN32
-    needs_rebuild1(
-        "build/server",
-        "src/server.c"
-    );
+        bool ok = build_app(profile,
+#ifdef _WIN32
+            "build/client.exe",
 #else
-    1;
+            "build/client",
 #endif
+            inputs, ARRAY_LEN(inputs), flags, "build/.client_flags");
+        da_free(flags);
+        if(!ok) return 1;
+    }
 
-    if(result < 0) return 1;
-
-    if(build_server && result){
+    if(build_server){
 #ifndef _WIN32
-        cmd.count = 0;
+        // The relay links opus for the repacketizer, it splits multi-frame
+        // packets for listeners that want one frame per message
+        const char* inputs[] = {"src/server.c", profile_archive_path(profile)};
+        Cmd flags = {0};
+        cmd_append(&flags, "clang");
+        append_profile_app_flags(&flags, profile);
+        cmd_append(&flags,
+           "src/server.c",
+           "-o",
+           "build/server",
+           "-I",
+           "thirdparty/opus/include",
+           "-L",
+           temp_sprintf("build/%s", profile.name),
+           "-lopusfile",
+           "-lm",
+        );
 
-        cmd_append(&cmd, "clang", "src/server.c", "-o", "build/server");
-        if(!cmd_run_sync_and_reset(&cmd)) return 1;
+        bool ok = build_app(profile, "build/server", inputs, ARRAY_LEN(inputs), flags, "build/.server_flags");
+        da_free(flags);
+        if(!ok) return 1;
 #else
         printf("Building server on windows is not supported (who would use windows for server anyways)\n");
 #endif
     }
 
     return 0;
-}
\ No newline at end of file
+}
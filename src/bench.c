@@ -0,0 +1,844 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <opus.h>
+#include <opus_projection.h>
+#include "corpus.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Codec microbenchmark. Starts from the configuration the client calls with
+// and sweeps one setting at a time (application, channels, complexity,
+// bitrate, frame size) over generated speech and music, timing every
+// opus_encode_float/opus_decode_float call. The "pipelined" entries run the
+// tonality analysis on a helper thread and must produce the same packets as
+// the inline encode, the "tiers" ones encode one input at several bitrates
+// with opus_encode_float_tiers and must match independent encoders, the
+// "projection" ones encode an ambisonic recording with and without an encode
+// pool and must match each other when every stream has its full budget, the
+// "aggregation" ones add the client's frame info extension and pack several
+// frames per packet with the repacketizer as the client does on slow links,
+// and must split back into the encoder's packets. Results go out as JSON so two builds can be diffed.
+
+#define SAMPLE_RATE 48000
+#define MAX_CHANNELS 2
+#define MAX_FRAME_SIZE 2880 // 60 ms
+#define MAX_PACKET_SIZE 1500
+#define DEFAULT_SECONDS 20
+#define TIERS 3
+#define AMBISONIC_CHANNELS 9 // second order
+#define POOL_THREADS 3
+#define COPY_REPS 1000
+#define MAX_AGGREGATE 6 // frames per packet, src/client.cpp stops there too
+#define DTX_MAX_PAYLOAD 2 // silence frames, sent on their own
+#define PACKET_OVERHEAD_BYTES (4 + 5 + 40) // length prefix, audio header, TCP/IPv4
+#define EXTENSION_FRAME_INFO 120 // sequence number, sender clock and a level per frame, as src/client.cpp adds it
+#define FRAME_INFO_HEADER_SIZE 2 // then the levels and a clock offset of 1 or 2 bytes
+#define FRAME_INFO_ROOM (1 + FRAME_INFO_HEADER_SIZE + MAX_AGGREGATE + 2 + 3)
+
+typedef struct {
+    int application;
+    int channels;
+    int complexity;
+    int bitrate;
+    int frame_size; // samples per channel at 48 kHz
+    int dtx;
+    int pipelined; // tonality analysis one frame ahead on a helper thread
+} Config;
+
+// What src/client.cpp starts a call with
+static const Config production = {OPUS_APPLICATION_VOIP, 1, 8, 16000, 960, 1, 0};
+
+static const int applications[] = {OPUS_APPLICATION_VOIP, OPUS_APPLICATION_AUDIO, OPUS_APPLICATION_RESTRICTED_LOWDELAY};
+static const int channel_counts[] = {1, 2};
+static const int complexities[] = {0, 2, 4, 6, 8, 10};
+static const int bitrates[] = {6000, 12000, 16000, 24000, 32000, 64000, 128000};
+static const int frame_sizes[] = {120, 240, 480, 960, 1920, 2880};
+// A relay serving one talker to listeners on different links, the
+// production rate first
+static const int tier_bitrates[TIERS] = {16000, 24000, 12000};
+
+typedef struct {
+    const char* name;
+    float* pcm[MAX_CHANNELS + 1]; // indexed by channel count
+    int samples; // per channel
+} Corpus;
+
+typedef struct {
+    double total_ns;
+    double p99_ns;
+    double rtf; // codec time over audio time, below 1 is faster than real time
+} Timing;
+
+typedef struct {
+    int frames;
+    double avg_bitrate;
+    Timing encode;
+    Timing decode;
+    opus_int32 encoder_scratch; // peak arena use, 0 when the library has no arena
+    opus_int32 decoder_scratch;
+    unsigned int bitstream_hash; // FNV-1a over every packet and its length
+} Result;
+
+static double now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+#endif
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static Timing summarize(double* frame_ns, int frames, int frame_size) {
+    Timing timing = {0};
+    for (int i = 0; i < frames; i++) timing.total_ns += frame_ns[i];
+    qsort(frame_ns, frames, sizeof(double), compare_double);
+    timing.p99_ns = frame_ns[(int)(frames * 0.99)];
+    timing.rtf = timing.total_ns / ((double)frames * frame_size * 1e9 / SAMPLE_RATE);
+    return timing;
+}
+
+#define FNV_OFFSET 2166136261u
+
+static unsigned int hash_packet(unsigned int hash, const unsigned char* packet, int size) {
+    hash = (hash ^ (unsigned int)size) * 16777619u;
+    for (int j = 0; j < size; j++) hash = (hash ^ packet[j]) * 16777619u;
+    return hash;
+}
+
+static unsigned int hash_packets(const unsigned char* packets, const int* sizes, int frames) {
+    unsigned int hash = FNV_OFFSET;
+    for (int i = 0; i < frames; i++) hash = hash_packet(hash, packets + (size_t)i * MAX_PACKET_SIZE, sizes[i]);
+    return hash;
+}
+
+// Feeds every frame to the lookahead analysis, the library keeps it one frame
+// ahead of the encode loop
+typedef struct {
+    OpusAnalysisAhead* ahead;
+    const float* pcm;
+    int frames;
+    int frame_size;
+    int channels;
+} Helper;
+
+#ifdef _WIN32
+static DWORD WINAPI helper_main(LPVOID arg) {
+#else
+static void* helper_main(void* arg) {
+#endif
+    Helper* helper = arg;
+    for (int i = 0; i < helper->frames; i++) {
+        opus_analysis_ahead_float(helper->ahead, helper->pcm + (size_t)i * helper->frame_size * helper->channels,
+                                  helper->frame_size);
+    }
+    return 0;
+}
+
+static const char* application_name(int application) {
+    switch (application) {
+    case OPUS_APPLICATION_VOIP: return "voip";
+    case OPUS_APPLICATION_AUDIO: return "audio";
+    case OPUS_APPLICATION_RESTRICTED_LOWDELAY: return "lowdelay";
+    default: return "unknown";
+    }
+}
+
+static OpusEncoder* create_encoder(Config config) {
+    int error;
+    OpusEncoder* encoder = opus_encoder_create(SAMPLE_RATE, config.channels, config.application, &error);
+    if (error != OPUS_OK) {
+        fprintf(stderr, "Failed to create Opus encoder: %s\n", opus_strerror(error));
+        return NULL;
+    }
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(config.bitrate));
+    opus_encoder_ctl(encoder, OPUS_SET_VBR(1));
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(config.complexity));
+    opus_encoder_ctl(encoder, OPUS_SET_DTX(config.dtx));
+    return encoder;
+}
+
+static bool run_config(const Corpus* corpus, Config config, Result* result) {
+    int error;
+    OpusEncoder* encoder = create_encoder(config);
+    if (!encoder) return false;
+
+    OpusDecoder* decoder = opus_decoder_create(SAMPLE_RATE, config.channels, &error);
+    if (error != OPUS_OK) {
+        fprintf(stderr, "Failed to create Opus decoder: %s\n", opus_strerror(error));
+        opus_encoder_destroy(encoder);
+        return false;
+    }
+
+    int frames = corpus->samples / config.frame_size;
+    const float* pcm = corpus->pcm[config.channels];
+    unsigned char* packets = malloc((size_t)frames * MAX_PACKET_SIZE);
+    int* sizes = malloc(frames * sizeof(int));
+    double* frame_ns = malloc(frames * sizeof(double));
+    float decoded[MAX_FRAME_SIZE * MAX_CHANNELS];
+    bool ok = true;
+    long bytes = 0;
+
+    OpusAnalysisAhead* ahead = NULL;
+    Helper helper = {0};
+#ifdef _WIN32
+    HANDLE thread = NULL;
+#else
+    pthread_t thread;
+#endif
+    if (config.pipelined) {
+        ahead = opus_analysis_ahead_create(encoder, &error);
+        if (error != OPUS_OK) {
+            fprintf(stderr, "Failed to create lookahead analysis: %s\n", opus_strerror(error));
+            ok = false;
+        } else {
+            helper = (Helper){ahead, pcm, frames, config.frame_size, config.channels};
+#ifdef _WIN32
+            thread = CreateThread(NULL, 0, helper_main, &helper, 0, NULL);
+#else
+            pthread_create(&thread, NULL, helper_main, &helper);
+#endif
+        }
+    }
+
+    for (int i = 0; i < frames && ok; i++) {
+        double start = now_ns();
+        sizes[i] = opus_encode_float(encoder, pcm + (size_t)i * config.frame_size * config.channels,
+                                     config.frame_size, packets + (size_t)i * MAX_PACKET_SIZE, MAX_PACKET_SIZE);
+        frame_ns[i] = now_ns() - start;
+        if (sizes[i] < 0) {
+            fprintf(stderr, "Opus encode error: %s\n", opus_strerror(sizes[i]));
+            ok = false;
+        }
+        bytes += sizes[i];
+    }
+    if (ahead) {
+        // After an encode error the helper waits for a frame that never comes,
+        // so it is left behind along with its object and the run fails
+        if (ok) {
+#ifdef _WIN32
+            WaitForSingleObject(thread, INFINITE);
+#else
+            pthread_join(thread, NULL);
+#endif
+            opus_analysis_ahead_destroy(ahead);
+        }
+#ifdef _WIN32
+        CloseHandle(thread);
+#else
+        if (!ok) pthread_detach(thread);
+#endif
+    }
+    if (ok) result->encode = summarize(frame_ns, frames, config.frame_size);
+
+    for (int i = 0; i < frames && ok; i++) {
+        double start = now_ns();
+        int decoded_samples = opus_decode_float(decoder, packets + (size_t)i * MAX_PACKET_SIZE, sizes[i],
+                                                decoded, config.frame_size, 0);
+        frame_ns[i] = now_ns() - start;
+        if (decoded_samples < 0) {
+            fprintf(stderr, "Opus decode error: %s\n", opus_strerror(decoded_samples));
+            ok = false;
+        }
+    }
+    if (ok) {
+        result->decode = summarize(frame_ns, frames, config.frame_size);
+        result->frames = frames;
+        result->avg_bitrate = bytes * 8.0 / ((double)frames * config.frame_size / SAMPLE_RATE);
+        result->bitstream_hash = hash_packets(packets, sizes, frames);
+        if (opus_encoder_ctl(encoder, OPUS_GET_SCRATCH_PEAK(&result->encoder_scratch)) != OPUS_OK) result->encoder_scratch = 0;
+        if (opus_decoder_ctl(decoder, OPUS_GET_SCRATCH_PEAK(&result->decoder_scratch)) != OPUS_OK) result->decoder_scratch = 0;
+    }
+
+    free(frame_ns);
+    free(sizes);
+    free(packets);
+    opus_encoder_destroy(encoder);
+    opus_decoder_destroy(decoder);
+    return ok;
+}
+
+static void write_timing(FILE* out, const char* name, Timing timing, int frames) {
+    fprintf(out, "\"%s\": {\"ns_per_frame\": %.0f, \"p99_ns\": %.0f, \"rtf\": %.6f}",
+            name, timing.total_ns / frames, timing.p99_ns, timing.rtf);
+}
+
+static void write_result(FILE* out, const Corpus* corpus, const char* sweep, Config config, Result result, bool* first) {
+    fprintf(stderr, "%-6s %-10s %-8s ch=%d c=%-2d %6d bps %4.1f ms: encode %8.0f ns/frame (p99 %8.0f, rtf %.4f) decode %7.0f ns/frame (p99 %7.0f, rtf %.4f)\n",
+                   corpus->name, sweep, application_name(config.application), config.channels, config.complexity,
+                   config.bitrate, config.frame_size * 1000.0 / SAMPLE_RATE,
+                   result.encode.total_ns / result.frames, result.encode.p99_ns, result.encode.rtf,
+                   result.decode.total_ns / result.frames, result.decode.p99_ns, result.decode.rtf);
+
+    fprintf(out, "%s\n    {\"corpus\": \"%s\", \"sweep\": \"%s\", \"application\": \"%s\", \"channels\": %d, "
+                 "\"complexity\": %d, \"bitrate\": %d, \"frame_ms\": %g, \"frames\": %d, \"avg_bitrate\": %.0f, "
+                 "\"encoder_scratch_peak\": %d, \"decoder_scratch_peak\": %d, \"bitstream_hash\": \"%08x\", ",
+            *first ? "" : ",", corpus->name, sweep, application_name(config.application), config.channels,
+            config.complexity, config.bitrate, config.frame_size * 1000.0 / SAMPLE_RATE, result.frames,
+            result.avg_bitrate, result.encoder_scratch, result.decoder_scratch, result.bitstream_hash);
+    write_timing(out, "encode", result.encode, result.frames);
+    fprintf(out, ", ");
+    write_timing(out, "decode", result.decode, result.frames);
+    fprintf(out, "}");
+    *first = false;
+}
+
+static bool run_sweep(FILE* out, const Corpus* corpus, const char* sweep, Config config, bool* first) {
+    Result result;
+    if (!run_config(corpus, config, &result)) return false;
+    write_result(out, corpus, sweep, config, result, first);
+    return true;
+}
+
+// Pipelining must not change a single bit, so it is checked against the same
+// config encoded inline before its timings are worth anything
+static bool run_pipelined(FILE* out, const Corpus* corpus, Config config, bool* first) {
+    Result inline_result, result;
+    if (!run_config(corpus, config, &inline_result)) return false;
+    config.pipelined = 1;
+    if (!run_config(corpus, config, &result)) return false;
+    if (result.bitstream_hash != inline_result.bitstream_hash) {
+        fprintf(stderr, "%s c=%d: pipelined bitstream differs from the inline one (%08x vs %08x)\n",
+                corpus->name, config.complexity, result.bitstream_hash, inline_result.bitstream_hash);
+        return false;
+    }
+    write_result(out, corpus, "pipelined", config, result, first);
+    return true;
+}
+
+// One input encoded at each of tier_bitrates, by opus_encode_float_tiers and
+// by a loop over independent encoders. The packets must match. The tier
+// encoders are copies of the first one with opus_encoder_copy, whose cost is
+// timed on its own. The extra tier cost is the frame time past the first
+// encode, per tier.
+static bool run_tiers(FILE* out, const Corpus* corpus, Config config, bool* first) {
+    OpusEncoder* loop[TIERS] = {0};
+    OpusEncoder* tiers[TIERS] = {0};
+    unsigned char packet_storage[TIERS][MAX_PACKET_SIZE];
+    unsigned char* packets[TIERS];
+    opus_int32 sizes[TIERS];
+    int frames = corpus->samples / config.frame_size;
+    double* loop_ns = malloc(frames * sizeof(double));
+    double* tiers_ns = malloc(frames * sizeof(double));
+    double first_ns = 0.0, copy_ns = 0.0;
+    unsigned int loop_hash = FNV_OFFSET, tiers_hash = FNV_OFFSET;
+    bool ok = true;
+
+    for (int t = 0; t < TIERS && ok; t++) {
+        config.bitrate = tier_bitrates[t];
+        loop[t] = create_encoder(config);
+        tiers[t] = create_encoder(config);
+        ok = loop[t] && tiers[t];
+        if (ok && t > 0) {
+            ok = opus_encoder_copy(tiers[t], tiers[0]) == OPUS_OK;
+            opus_encoder_ctl(tiers[t], OPUS_SET_BITRATE(tier_bitrates[t]));
+        }
+        packets[t] = packet_storage[t];
+    }
+    for (int i = 0; i < frames && ok; i++) {
+        const float* pcm = corpus->pcm[config.channels] + (size_t)i * config.frame_size * config.channels;
+        double start = now_ns();
+        sizes[0] = opus_encode_float(loop[0], pcm, config.frame_size, packets[0], MAX_PACKET_SIZE);
+        double middle = now_ns();
+        for (int t = 1; t < TIERS; t++) {
+            sizes[t] = opus_encode_float(loop[t], pcm, config.frame_size, packets[t], MAX_PACKET_SIZE);
+        }
+        loop_ns[i] = now_ns() - start;
+        first_ns += middle - start;
+        for (int t = 0; t < TIERS && ok; t++) {
+            if (sizes[t] < 0) {
+                fprintf(stderr, "Opus encode error: %s\n", opus_strerror(sizes[t]));
+                ok = false;
+            }
+            loop_hash = hash_packet(loop_hash, packets[t], sizes[t]);
+        }
+
+        start = now_ns();
+        int error = opus_encode_float_tiers(tiers, pcm, TIERS, config.frame_size, packets, MAX_PACKET_SIZE, sizes);
+        tiers_ns[i] = now_ns() - start;
+        if (error != OPUS_OK) {
+            fprintf(stderr, "Opus tiers encode error: %s\n", opus_strerror(error));
+            ok = false;
+        }
+        for (int t = 0; t < TIERS && ok; t++) {
+            if (sizes[t] < 0) {
+                fprintf(stderr, "Opus encode error: %s\n", opus_strerror(sizes[t]));
+                ok = false;
+            }
+            tiers_hash = hash_packet(tiers_hash, packets[t], sizes[t]);
+        }
+    }
+    if (ok && tiers_hash != loop_hash) {
+        fprintf(stderr, "%s c=%d: tiers bitstream differs from the loop one (%08x vs %08x)\n",
+                corpus->name, config.complexity, tiers_hash, loop_hash);
+        ok = false;
+    }
+    if (ok) {
+        double start = now_ns();
+        for (int r = 0; r < COPY_REPS; r++) opus_encoder_copy(loop[1 + r % (TIERS - 1)], loop[0]);
+        copy_ns = (now_ns() - start) / COPY_REPS;
+    }
+    if (ok) {
+        config.bitrate = tier_bitrates[0];
+        Timing loop_timing = summarize(loop_ns, frames, config.frame_size);
+        Timing tiers_timing = summarize(tiers_ns, frames, config.frame_size);
+        double loop_extra = (loop_timing.total_ns - first_ns) / frames / (TIERS - 1);
+        double tiers_extra = (tiers_timing.total_ns - first_ns) / frames / (TIERS - 1);
+        fprintf(stderr, "%-6s %-10s %-8s ch=%d c=%-2d %6d bps %4.1f ms: %d tiers, first %8.0f ns/frame, extra tier loop %8.0f ns, "
+                        "tiers %8.0f ns (%.2fx), copy %6.0f ns\n",
+                corpus->name, "tiers", application_name(config.application), config.channels, config.complexity,
+                config.bitrate, config.frame_size * 1000.0 / SAMPLE_RATE, TIERS, first_ns / frames, loop_extra,
+                tiers_extra, loop_extra / tiers_extra, copy_ns);
+        fprintf(out, "%s\n    {\"corpus\": \"%s\", \"sweep\": \"tiers\", \"application\": \"%s\", \"channels\": %d, "
+                     "\"complexity\": %d, \"bitrate\": %d, \"frame_ms\": %g, \"frames\": %d, \"tiers\": %d, "
+                     "\"bitstream_hash\": \"%08x\", \"first_ns_per_frame\": %.0f, "
+                     "\"extra_tier_ns\": {\"loop\": %.0f, \"tiers\": %.0f}, \"copy_ns\": %.0f, ",
+                *first ? "" : ",", corpus->name, application_name(config.application), config.channels,
+                config.complexity, config.bitrate, config.frame_size * 1000.0 / SAMPLE_RATE, frames, TIERS,
+                tiers_hash, first_ns / frames, loop_extra, tiers_extra, copy_ns);
+        write_timing(out, "loop", loop_timing, frames);
+        fprintf(out, ", ");
+        write_timing(out, "tiers", tiers_timing, frames);
+        fprintf(out, "}");
+        *first = false;
+    }
+
+    for (int t = 0; t < TIERS; t++) {
+        if (loop[t]) opus_encoder_destroy(loop[t]);
+        if (tiers[t]) opus_encoder_destroy(tiers[t]);
+    }
+    free(loop_ns);
+    free(tiers_ns);
+    return ok;
+}
+
+// A second order ambisonic recording of the corpus (every channel a delayed,
+// scaled copy) through the projection encoder, serially and with its streams
+// on an OpusEncodePool of POOL_THREADS threads plus the caller's. With a
+// buffer that leaves every stream its full budget the packets must match. With
+// a smaller one the pool splits the buffer between the streams up front, so
+// frames where a stream's share binds may differ; those are counted.
+static bool run_projection(FILE* out, const Corpus* corpus, int max_bytes, bool* first) {
+    int channels = AMBISONIC_CHANNELS;
+    int frame_size = production.frame_size;
+    int frames = corpus->samples / frame_size;
+    bool full_budget = max_bytes >= channels * MAX_PACKET_SIZE;
+    float* pcm = malloc((size_t)corpus->samples * channels * sizeof(float));
+    unsigned char* packet = malloc(max_bytes);
+    unsigned char* pool_packet = malloc(max_bytes);
+    double* serial_ns = malloc(frames * sizeof(double));
+    double* pool_ns = malloc(frames * sizeof(double));
+    OpusProjectionEncoder* serial = NULL;
+    OpusProjectionEncoder* pooled = NULL;
+    OpusEncodePool* pool = NULL;
+    unsigned int serial_hash = FNV_OFFSET, pool_hash = FNV_OFFSET;
+    int streams = 0, coupled = 0, error;
+    int matching = 0;
+    double serial_bytes = 0, pool_bytes = 0;
+    bool ok = true;
+
+    for (int i = 0; i < corpus->samples; i++) {
+        for (int c = 0; c < channels; c++) {
+            int j = i - 7 * c;
+            pcm[(size_t)i * channels + c] = j < 0 ? 0.0f : corpus->pcm[1][j] * (1.0f - 0.08f * c);
+        }
+    }
+    serial = opus_projection_ambisonics_encoder_create(SAMPLE_RATE, channels, 3, &streams, &coupled, OPUS_APPLICATION_AUDIO, &error);
+    if (error == OPUS_OK) pooled = opus_projection_ambisonics_encoder_create(SAMPLE_RATE, channels, 3, &streams, &coupled, OPUS_APPLICATION_AUDIO, &error);
+    if (error == OPUS_OK) pool = opus_encode_pool_create(POOL_THREADS, &error);
+    if (error != OPUS_OK) {
+        fprintf(stderr, "Failed to create the projection encoders: %s\n", opus_strerror(error));
+        ok = false;
+    } else {
+        opus_projection_encoder_ctl(serial, OPUS_SET_BITRATE(32000 * channels));
+        opus_projection_encoder_ctl(pooled, OPUS_SET_BITRATE(32000 * channels));
+        opus_projection_encoder_ctl(pooled, OPUS_MULTISTREAM_SET_ENCODE_POOL(pool));
+    }
+    for (int i = 0; i < frames && ok; i++) {
+        const float* frame = pcm + (size_t)i * frame_size * channels;
+        double start = now_ns();
+        int size = opus_projection_encode_float(serial, frame, frame_size, packet, max_bytes);
+        serial_ns[i] = now_ns() - start;
+        if (size < 0) {
+            fprintf(stderr, "Opus projection encode error: %s\n", opus_strerror(size));
+            ok = false;
+            break;
+        }
+        serial_hash = hash_packet(serial_hash, packet, size);
+        serial_bytes += size;
+        start = now_ns();
+        int pool_size = opus_projection_encode_float(pooled, frame, frame_size, pool_packet, max_bytes);
+        pool_ns[i] = now_ns() - start;
+        if (pool_size < 0) {
+            fprintf(stderr, "Opus projection encode error: %s\n", opus_strerror(pool_size));
+            ok = false;
+            break;
+        }
+        pool_hash = hash_packet(pool_hash, pool_packet, pool_size);
+        pool_bytes += pool_size;
+        if (pool_size == size && memcmp(pool_packet, packet, size) == 0) matching++;
+    }
+    if (ok && full_budget && pool_hash != serial_hash) {
+        fprintf(stderr, "%s: pooled projection bitstream differs from the serial one (%08x vs %08x)\n",
+                corpus->name, pool_hash, serial_hash);
+        ok = false;
+    }
+    if (ok) {
+        Timing serial_timing = summarize(serial_ns, frames, frame_size);
+        Timing pool_timing = summarize(pool_ns, frames, frame_size);
+        fprintf(stderr, "%-6s %-10s %-8s ch=%d %d streams %4.1f ms %5d B: serial %8.0f ns/frame, %d+1 threads %8.0f ns/frame (%.2fx), "
+                        "%d/%d frames match, %.1f vs %.1f B/frame\n",
+                corpus->name, "projection", application_name(OPUS_APPLICATION_AUDIO), channels, streams,
+                frame_size * 1000.0 / SAMPLE_RATE, max_bytes, serial_timing.total_ns / frames, POOL_THREADS,
+                pool_timing.total_ns / frames, serial_timing.total_ns / pool_timing.total_ns, matching, frames,
+                pool_bytes / frames, serial_bytes / frames);
+        fprintf(out, "%s\n    {\"corpus\": \"%s\", \"sweep\": \"projection\", \"application\": \"%s\", \"channels\": %d, "
+                     "\"streams\": %d, \"bitrate\": %d, \"frame_ms\": %g, \"frames\": %d, \"threads\": %d, "
+                     "\"max_bytes\": %d, \"matching_frames\": %d, \"serial_bytes\": %.1f, \"pool_bytes\": %.1f, "
+                     "\"bitstream_hash\": \"%08x\", ",
+                *first ? "" : ",", corpus->name, application_name(OPUS_APPLICATION_AUDIO), channels, streams,
+                32000 * channels, frame_size * 1000.0 / SAMPLE_RATE, frames, POOL_THREADS, max_bytes, matching,
+                serial_bytes / frames, pool_bytes / frames, pool_hash);
+        write_timing(out, "serial", serial_timing, frames);
+        fprintf(out, ", ");
+        write_timing(out, "pool", pool_timing, frames);
+        fprintf(out, "}");
+        *first = false;
+    }
+
+    if (serial) opus_projection_encoder_destroy(serial);
+    if (pooled) opus_projection_encoder_destroy(pooled);
+    if (pool) opus_encode_pool_destroy(pool);
+    free(pcm);
+    free(packet);
+    free(pool_packet);
+    free(serial_ns);
+    free(pool_ns);
+    return ok;
+}
+
+// Packets of one aggregation run on their way through the relay
+typedef struct {
+    OpusRepacketizer* aggregator;
+    OpusRepacketizer* splitter;
+    int pending; // frames in aggregator
+    int first_seq; // of the first of them
+    unsigned char levels[MAX_AGGREGATE];
+    long packets;
+    long payload_bytes;
+    unsigned char* sent; // every packet sent, MAX_PACKET_SIZE apart, to time the frame info lookups on
+    int* sent_sizes;
+    int next_seq; // the frame info the next frame out of the relay must carry
+    unsigned int split_hash; // over the single frames a splitting relay sends on, frame info stripped
+    unsigned char packet[MAX_PACKET_SIZE];
+    unsigned char frame[MAX_PACKET_SIZE];
+} Aggregation;
+
+// Adds the frame info to the frames of the packet in agg->packet and sends it
+// on. Every frame the relay splits off must be the next one the frame info
+// points at and decode as the encoder's packet.
+static bool send_aggregated(Aggregation* agg, int size, int seq, const unsigned char* levels, int frames) {
+    // A clock offset of 0, in its one byte form
+    unsigned char info[FRAME_INFO_HEADER_SIZE + MAX_AGGREGATE + 1] = {(unsigned char)(seq >> 8), (unsigned char)seq};
+    memcpy(info + FRAME_INFO_HEADER_SIZE, levels, frames);
+    OpusExtensionData extension = {EXTENSION_FRAME_INFO, 0, info, FRAME_INFO_HEADER_SIZE + frames + 1};
+    size = opus_packet_add_extensions(agg->packet, size, MAX_PACKET_SIZE, &extension, 1);
+    if (size < 0) return false;
+    memcpy(agg->sent + (size_t)agg->packets * MAX_PACKET_SIZE, agg->packet, size);
+    agg->sent_sizes[agg->packets++] = size;
+    agg->payload_bytes += size;
+
+    const unsigned char* padding;
+    const unsigned char* sent_info;
+    int padding_size = opus_packet_get_extensions(agg->packet, size, &padding);
+    if (padding_size <= 0 || opus_packet_get_nb_frames(agg->packet, size) != frames ||
+        opus_packet_extensions_find(padding, padding_size, EXTENSION_FRAME_INFO, 0, &sent_info) != FRAME_INFO_HEADER_SIZE + frames + 1) {
+        return false;
+    }
+    opus_repacketizer_init(agg->splitter);
+    if (opus_repacketizer_cat(agg->splitter, agg->packet, size) != OPUS_OK) return false;
+    for (int i = 0; i < frames; i++) {
+        if ((((sent_info[0] << 8) | sent_info[1]) + i) % 65536 != agg->next_seq % 65536) return false;
+        agg->next_seq++;
+        int frame_size = opus_repacketizer_out_range(agg->splitter, i, i + 1, agg->frame, MAX_PACKET_SIZE);
+        if (frame_size > 0) frame_size = opus_packet_unpad(agg->frame, frame_size);
+        if (frame_size < 0) return false;
+        agg->split_hash = hash_packet(agg->split_hash, agg->frame, frame_size);
+    }
+    return true;
+}
+
+static bool flush_aggregated(Aggregation* agg) {
+    if (agg->pending == 0) return true;
+    int frames = agg->pending;
+    int size = opus_repacketizer_out(agg->aggregator, agg->packet, MAX_PACKET_SIZE - FRAME_INFO_ROOM);
+    agg->pending = 0;
+    return size > 0 && send_aggregated(agg, size, agg->first_seq, agg->levels, frames);
+}
+
+// ns per packet to get at the first frame's frame info with
+// opus_packet_extensions_find and with a full opus_packet_extensions_parse
+static void time_frame_info(const Aggregation* agg, double* find_ns, double* parse_ns) {
+    OpusExtensionData extensions[48];
+    const unsigned char* padding;
+    const unsigned char* info;
+    long found = 0;
+    // The first pass only warms the caches for whichever lookup goes first
+    for (int pass = 0; pass < 2; pass++) {
+        found = 0;
+        double start = now_ns();
+        for (long p = 0; p < agg->packets; p++) {
+            const unsigned char* packet = agg->sent + (size_t)p * MAX_PACKET_SIZE;
+            int padding_size = opus_packet_get_extensions(packet, agg->sent_sizes[p], &padding);
+            if (padding_size > 0) found += opus_packet_extensions_find(padding, padding_size, EXTENSION_FRAME_INFO, 0, &info) > 0;
+        }
+        *find_ns = (now_ns() - start) / agg->packets;
+        start = now_ns();
+        for (long p = 0; p < agg->packets; p++) {
+            const unsigned char* packet = agg->sent + (size_t)p * MAX_PACKET_SIZE;
+            int padding_size = opus_packet_get_extensions(packet, agg->sent_sizes[p], &padding);
+            opus_int32 count = 48;
+            if (padding_size > 0 && opus_packet_extensions_parse(padding, padding_size, extensions, &count) == OPUS_OK) {
+                for (int e = 0; e < count; e++) {
+                    if (extensions[e].id == EXTENSION_FRAME_INFO && extensions[e].frame == 0) {
+                        found++;
+                        break;
+                    }
+                }
+            }
+        }
+        *parse_ns = (now_ns() - start) / agg->packets;
+    }
+    if (found != 2 * agg->packets) fprintf(stderr, "frame info missing from %ld packets\n", 2 * agg->packets - found);
+}
+
+// The config's packets sent 1 to MAX_AGGREGATE frames at a time the way
+// src/client.cpp does it (frame info added to every packet, silence frames
+// alone, a new packet whenever a frame can't join the current one) and split
+// back into single frames the way the relay does for listeners that ask,
+// which must give back the encoder's packets in order. Reports packets per
+// second and what the headers and frame info cost next to the audio.
+static bool run_aggregation(FILE* out, const Corpus* corpus, Config config, bool* first) {
+    int frames = corpus->samples / config.frame_size;
+    unsigned char* packets = malloc((size_t)frames * MAX_PACKET_SIZE);
+    int* sizes = malloc(frames * sizeof(int));
+    OpusEncoder* encoder = create_encoder(config);
+    Aggregation agg = {opus_repacketizer_create(), opus_repacketizer_create()};
+    agg.sent = malloc((size_t)frames * MAX_PACKET_SIZE);
+    agg.sent_sizes = malloc(frames * sizeof(int));
+    bool ok = encoder && agg.aggregator && agg.splitter;
+    long audio_bytes = 0;
+
+    for (int i = 0; i < frames && ok; i++) {
+        sizes[i] = opus_encode_float(encoder, corpus->pcm[config.channels] + (size_t)i * config.frame_size * config.channels,
+                                     config.frame_size, packets + (size_t)i * MAX_PACKET_SIZE, MAX_PACKET_SIZE - FRAME_INFO_ROOM);
+        if (sizes[i] < 0) {
+            fprintf(stderr, "Opus encode error: %s\n", opus_strerror(sizes[i]));
+            ok = false;
+        }
+    }
+    unsigned int reference_hash = ok ? hash_packets(packets, sizes, frames) : 0;
+    for (int i = 0; i < frames && ok; i++) audio_bytes += sizes[i];
+    double seconds = (double)frames * config.frame_size / SAMPLE_RATE;
+    double base_packets_per_second = 0.0;
+
+    for (int n = 1; n <= MAX_AGGREGATE && ok; n++) {
+        agg.pending = 0;
+        agg.packets = 0;
+        agg.payload_bytes = 0;
+        agg.next_seq = 0;
+        agg.split_hash = FNV_OFFSET;
+        double start = now_ns();
+        for (int i = 0; i < frames && ok; i++) {
+            const unsigned char* packet = packets + (size_t)i * MAX_PACKET_SIZE;
+            unsigned char level = sizes[i] <= DTX_MAX_PAYLOAD ? 127 : 0x80 | 30;
+            if (n == 1 || sizes[i] <= DTX_MAX_PAYLOAD) {
+                ok = flush_aggregated(&agg);
+                memcpy(agg.packet, packet, sizes[i]);
+                ok = ok && send_aggregated(&agg, sizes[i], i, &level, 1);
+                continue;
+            }
+            if (agg.pending == 0 || opus_repacketizer_cat(agg.aggregator, packet, sizes[i]) != OPUS_OK) {
+                ok = flush_aggregated(&agg);
+                opus_repacketizer_init(agg.aggregator);
+                ok = ok && opus_repacketizer_cat(agg.aggregator, packet, sizes[i]) == OPUS_OK;
+                agg.first_seq = i;
+            }
+            agg.levels[agg.pending++] = level;
+            if (ok && agg.pending >= n) ok = flush_aggregated(&agg);
+        }
+        ok = ok && flush_aggregated(&agg);
+        double ns_per_frame = (now_ns() - start) / frames;
+        if (!ok) {
+            fprintf(stderr, "%s: repacketizing %d frames per packet failed\n", corpus->name, n);
+            break;
+        }
+        if (agg.split_hash != reference_hash) {
+            fprintf(stderr, "%s: %d frames per packet split back differs from the encoder's packets (%08x vs %08x)\n",
+                    corpus->name, n, agg.split_hash, reference_hash);
+            ok = false;
+            break;
+        }
+
+        double find_ns, parse_ns;
+        time_frame_info(&agg, &find_ns, &parse_ns);
+        double packets_per_second = agg.packets / seconds;
+        double header_bps = agg.packets * PACKET_OVERHEAD_BYTES * 8.0 / seconds;
+        double frame_info_bps = (agg.payload_bytes - audio_bytes) * 8.0 / seconds;
+        double audio_bps = audio_bytes * 8.0 / seconds;
+        if (n == 1) base_packets_per_second = packets_per_second;
+        fprintf(stderr, "%-6s %-10s %-8s ch=%d c=%-2d %6d bps %4.1f ms: %d frames/packet %6.1f packets/s (%.2fx fewer), "
+                        "headers %6.0f bps, frame info %5.0f bps, audio %6.0f bps, overhead %4.1f%% of the wire, "
+                        "%5.0f ns/frame, frame info find %4.0f ns parse %4.0f ns\n",
+                corpus->name, "aggregate", application_name(config.application), config.channels, config.complexity,
+                config.bitrate, config.frame_size * 1000.0 / SAMPLE_RATE, n, packets_per_second,
+                base_packets_per_second / packets_per_second, header_bps, frame_info_bps, audio_bps,
+                100.0 * (header_bps + frame_info_bps) / (header_bps + frame_info_bps + audio_bps), ns_per_frame,
+                find_ns, parse_ns);
+        fprintf(out, "%s\n    {\"corpus\": \"%s\", \"sweep\": \"aggregation\", \"application\": \"%s\", \"channels\": %d, "
+                     "\"complexity\": %d, \"bitrate\": %d, \"frame_ms\": %g, \"frames\": %d, \"frames_per_packet\": %d, "
+                     "\"bitstream_hash\": \"%08x\", \"packets_per_second\": %.2f, \"header_bps\": %.0f, "
+                     "\"frame_info_bps\": %.0f, \"audio_bps\": %.0f, \"repacketize_ns_per_frame\": %.0f, "
+                     "\"frame_info_ns\": {\"find\": %.0f, \"parse\": %.0f}}",
+                *first ? "" : ",", corpus->name, application_name(config.application), config.channels,
+                config.complexity, config.bitrate, config.frame_size * 1000.0 / SAMPLE_RATE, frames, n,
+                agg.split_hash, packets_per_second, header_bps, frame_info_bps, audio_bps, ns_per_frame,
+                find_ns, parse_ns);
+        *first = false;
+    }
+
+    if (encoder) opus_encoder_destroy(encoder);
+    if (agg.aggregator) opus_repacketizer_destroy(agg.aggregator);
+    if (agg.splitter) opus_repacketizer_destroy(agg.splitter);
+    free(agg.sent);
+    free(agg.sent_sizes);
+    free(packets);
+    free(sizes);
+    return ok;
+}
+
+// Every sweep varies one setting of the production config, which also shows up
+// once on its own as the "production" entry
+static bool run_corpus(FILE* out, const Corpus* corpus, bool* first) {
+    Config config;
+    if (!run_sweep(out, corpus, "production", production, first)) return false;
+
+    for (size_t i = 0; i < sizeof(applications) / sizeof(applications[0]); i++) {
+        if (applications[i] == production.application) continue;
+        config = production;
+        config.application = applications[i];
+        if (!run_sweep(out, corpus, "application", config, first)) return false;
+    }
+    for (size_t i = 0; i < sizeof(channel_counts) / sizeof(channel_counts[0]); i++) {
+        if (channel_counts[i] == production.channels) continue;
+        config = production;
+        config.channels = channel_counts[i];
+        if (!run_sweep(out, corpus, "channels", config, first)) return false;
+    }
+    for (size_t i = 0; i < sizeof(complexities) / sizeof(complexities[0]); i++) {
+        if (complexities[i] == production.complexity) continue;
+        config = production;
+        config.complexity = complexities[i];
+        if (!run_sweep(out, corpus, "complexity", config, first)) return false;
+    }
+    for (size_t i = 0; i < sizeof(bitrates) / sizeof(bitrates[0]); i++) {
+        if (bitrates[i] == production.bitrate) continue;
+        config = production;
+        config.bitrate = bitrates[i];
+        if (!run_sweep(out, corpus, "bitrate", config, first)) return false;
+    }
+    for (size_t i = 0; i < sizeof(frame_sizes) / sizeof(frame_sizes[0]); i++) {
+        if (frame_sizes[i] == production.frame_size) continue;
+        config = production;
+        config.frame_size = frame_sizes[i];
+        if (!run_sweep(out, corpus, "frame_size", config, first)) return false;
+    }
+    // Complexity 10 too, where the analysis is a smaller share of the frame
+    if (!run_pipelined(out, corpus, production, first)) return false;
+    config = production;
+    config.complexity = 10;
+    if (!run_pipelined(out, corpus, config, first)) return false;
+    // One call at several rates
+    if (!run_tiers(out, corpus, production, first)) return false;
+    // A slow link packing frames together
+    if (!run_aggregation(out, corpus, production, first)) return false;
+    // A recording with many channels, with every stream's full budget and
+    // with one datagram for the whole frame
+    if (!run_projection(out, corpus, AMBISONIC_CHANNELS * MAX_PACKET_SIZE, first)) return false;
+    return run_projection(out, corpus, MAX_PACKET_SIZE, first);
+}
+
+static void usage(char* program) {
+    fprintf(stderr, "Usage: %s [output.json] [seconds <n>]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    const char* output_path = NULL;
+    int seconds = DEFAULT_SECONDS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "seconds") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+            if (seconds <= 0) usage(argv[0]);
+        } else if (!output_path) {
+            output_path = argv[i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    int samples = seconds * SAMPLE_RATE;
+    Corpus speech = {"speech", {0}, samples};
+    Corpus music = {"music", {0}, samples};
+
+    speech.pcm[1] = malloc(samples * sizeof(float));
+    speech.pcm[2] = malloc(samples * 2 * sizeof(float));
+    corpus_generate_speech(speech.pcm[1], samples, 1);
+    // Stereo speech is the same talker slightly off center
+    for (int i = 0; i < samples; i++) {
+        speech.pcm[2][2 * i] = speech.pcm[1][i];
+        speech.pcm[2][2 * i + 1] = speech.pcm[1][i] * 0.7f;
+    }
+    music.pcm[1] = malloc(samples * sizeof(float));
+    music.pcm[2] = malloc(samples * 2 * sizeof(float));
+    corpus_generate_music(music.pcm[1], samples, 1, 1);
+    corpus_generate_music(music.pcm[2], samples, 2, 1);
+
+    FILE* out = stdout;
+    if (output_path) {
+        out = fopen(output_path, "w");
+        if (!out) {
+            perror(output_path);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n  \"opus_version\": \"%s\",\n  \"corpus_seconds\": %d,\n  \"results\": [", opus_get_version_string(), seconds);
+    bool first = true;
+    bool ok = run_corpus(out, &speech, &first) && run_corpus(out, &music, &first);
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) fclose(out);
+
+    for (int c = 1; c <= MAX_CHANNELS; c++) {
+        free(speech.pcm[c]);
+        free(music.pcm[c]);
+    }
+    return ok ? 0 : 1;
+}
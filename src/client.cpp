@@ -6,7 +6,11 @@
 #include <condition_variable>
 #include <vector>
 #include <chrono>
+#include <algorithm>
+#include <random>
+#include <cmath>
 #include <opusfile/include/opusfile.h>
+#include "receiver_stats.h"
 
 #ifdef _WIN32
 #define NOMINMAX
@@ -24,6 +28,11 @@
 
 #include <stdlib.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MIX_SSE
+#endif
+
 #define BUFFER_SIZE 1024
 #define SAMPLE_RATE 48000  // Opus native sample rate
 #define CHANNELS 1
@@ -31,6 +40,32 @@
 #define JITTER_BUFFER_SIZE 8 // packets of buffering to handle network jitter
 #define OPUS_APPLICATION OPUS_APPLICATION_VOIP
 #define MAX_PACKET_SIZE 1500
+#define MAX_MESSAGE_SIZE (MAX_PACKET_SIZE + 32) // Opus packet plus our message header
+#define FRAME_BUDGET_US (FRAME_SIZE * 1000000LL / SAMPLE_RATE) // 20ms of wall time per frame
+#define GOVERNOR_WINDOW 50 // encoded frames per complexity decision (1 second)
+#define GOVERNOR_CALM_WINDOWS 3 // windows well under budget before stepping complexity back up
+#define BITRATE_MIN 6000
+#define BITRATE_START 16000 // 16 kbps for voice
+#define BITRATE_MAX 24000
+#define BITRATE_STEP_UP 1000 // additive increase per calm report
+#define QUEUE_DELAY_OVERUSE_US 50000 // queuing delay we back off at
+#define QUEUE_DELAY_CALM_US 20000 // queuing delay we are allowed to probe up from
+#define DELAY_TREND_OVERUSE_US 10000 // queue growth per report we back off at
+#define DTX_MAX_PAYLOAD 2 // Opus DTX frames are 1-2 bytes, the relay only forwards some of them
+#define MAX_FRAMES_PER_PACKET 6 // 120ms, the most one Opus packet can carry
+#define MAX_PACKET_FRAMES 48 // what a packet from anyone can hold, 120ms of 2.5ms frames
+#define PACKET_OVERHEAD_BYTES (4 + AUDIO_HEADER_SIZE + 40) // length prefix, our header, TCP/IPv4
+#define DTX_TIMEOUT_MS 1000 // stop comfort noise if not even a keepalive showed up for this long
+#define PCM_RING_CAPACITY 8192 // decoded samples, power of two above a few frames
+#define PCM_RING_TARGET (2 * FRAME_SIZE * CHANNELS) // the frame being played plus one ahead
+#define DECODE_POLL_MS 2
+#define MAX_STREAMS 8 // remote talkers we keep a decoder for at once
+#define STREAM_IDLE_TIMEOUT_MS 10000 // decoders of streams quiet for this long are released
+#define STREAM_STEAL_MS 1000 // a new talker may take over the longest quiet slot after this long
+#define SPEAKER_STEAL_DB 10 // or the slot of a talker this much softer than it
+#define SPEAKER_STEAL_HOLD_MS 400 // if it stays that much louder for this long
+#define SPEAKER_STEAL_GAP_MS 150 // longest gap between its packets that still counts as staying
+#define SPEAKER_RELEASE_DB_PER_S 20 // how fast a talker's held level falls while it is quieter
 
 void init_sockets() {
 #ifdef _WIN32
@@ -98,26 +133,56 @@ int connect_to_server(int sock, const char *server_name, int server_port) {
     return 0;
 }
 
+std::mutex send_mutex; // capture thread sends audio, receiver thread sends reports
+
+bool send_all(int sock, const char *data, size_t size) {
+    while (size > 0) {
+        int bytes_sent = send(sock, data, static_cast<int>(size), 0);
+        if (bytes_sent <= 0) {
+            perror("Send failed");
+            return false;
+        }
+        data += bytes_sent;
+        size -= bytes_sent;
+    }
+    return true;
+}
+
+bool recv_all(int sock, char *buffer, size_t size) {
+    while (size > 0) {
+        int bytes_received = recv(sock, buffer, static_cast<int>(size), 0);
+        if (bytes_received <= 0) {
+            return false;
+        }
+        buffer += bytes_received;
+        size -= bytes_received;
+    }
+    return true;
+}
+
 size_t send_data(int sock, const char *data, size_t size) {
-    // First send the size of the packet (4 bytes)
-    uint32_t packet_size = htonl(static_cast<uint32_t>(size));
-    if (send(sock, reinterpret_cast<const char*>(&packet_size), sizeof(packet_size), 0) != sizeof(packet_size)) {
-        perror("Failed to send packet size");
+    // Size of the packet (4 bytes) followed by the actual data, written in one go
+    // so packets from different threads never interleave on the stream
+    char frame[sizeof(uint32_t) + MAX_MESSAGE_SIZE];
+    if (size > MAX_MESSAGE_SIZE) {
+        fprintf(stderr, "Packet too large: %zu > %d\n", size, MAX_MESSAGE_SIZE);
         return 0;
     }
-    
-    // Then send the actual data
-    size_t bytes_sent = send(sock, data, size, 0);
-    if (bytes_sent < 0) {
-        perror("Send failed");
+    uint32_t packet_size = htonl(static_cast<uint32_t>(size));
+    memcpy(frame, &packet_size, sizeof(packet_size));
+    memcpy(frame + sizeof(packet_size), data, size);
+
+    std::lock_guard<std::mutex> lock(send_mutex);
+    if (!send_all(sock, frame, sizeof(packet_size) + size)) {
+        return 0;
     }
-    return bytes_sent;
+    return size;
 }
 
 size_t receive_data(int sock, char *buffer, size_t buffer_size) {
     // First receive the packet size
     uint32_t packet_size;
-    if (recv(sock, reinterpret_cast<char*>(&packet_size), sizeof(packet_size), 0) != sizeof(packet_size)) {
+    if (!recv_all(sock, reinterpret_cast<char*>(&packet_size), sizeof(packet_size))) {
         perror("Failed to receive packet size");
         return 0;
     }
@@ -129,12 +194,106 @@ size_t receive_data(int sock, char *buffer, size_t buffer_size) {
     }
     
     // Then receive the actual data
-    size_t bytes_received = recv(sock, buffer, packet_size, 0);
-    if (bytes_received < 0) {
+    if (!recv_all(sock, buffer, packet_size)) {
         perror("Receive failed");
         return 0;
     }
-    return static_cast<size_t>(bytes_received);
+    return static_cast<size_t>(packet_size);
+}
+
+// Every packet on the wire starts with a one byte message type.
+// Audio:  type, u32 stream id, Opus packet of one or more consecutive
+//         frames. The first frame carries the frame info in an Opus packet
+//         extension: u16 sequence number of that frame (the others follow
+//         on from it), one u8 audio level per frame (LEVEL_ACTIVE unless it
+//         is a DTX silence frame, below that its level in -dBov), then when
+//         the packet went out as the sender's clock in ms minus
+//         FRAME_INFO_FRAME_MS per sequence number up to its last frame, an
+//         i8 when it fits and an i16 otherwise. The relay can split and thin
+//         packets and receivers can order frames without decoding audio.
+// Report: type, u32 stream id reported on, u32 highest sequence seen,
+//         u8 fraction lost (/256), u32 interarrival jitter in us,
+//         u32 queuing delay in us, i32 queuing delay change since the
+//         previous report in us
+// Listener config: type, u8 flags, read by the relay and not forwarded
+enum MessageType : unsigned char {
+    MESSAGE_AUDIO = 1,
+    MESSAGE_RECEIVER_REPORT = 2,
+    MESSAGE_LISTENER_CONFIG = 3,
+};
+
+#define AUDIO_HEADER_SIZE 5
+#define EXTENSION_FRAME_INFO 120 // one of the long extension ids, clear of DRED's 126
+#define FRAME_INFO_HEADER_SIZE 2 // sequence number, the levels and the clock offset follow
+#define FRAME_INFO_FRAME_MS 20 // the clock offset counts from this much per sequence number
+#define FRAME_INFO_CLOCK_MAX 2 // bytes of clock offset
+// What adding the frame info can grow a packet by: its extension id, the
+// header, levels and clock offset, and turning the packet into a padded code
+// 3 one. The encoder leaves it free.
+#define FRAME_INFO_ROOM (1 + FRAME_INFO_HEADER_SIZE + MAX_FRAMES_PER_PACKET + FRAME_INFO_CLOCK_MAX + 3)
+#define LEVEL_ACTIVE 0x80
+#define LEVEL_SILENT 127
+#define RECEIVER_REPORT_SIZE 22
+#define LISTENER_CONFIG_SIZE 2
+#define LISTENER_SPLIT_FRAMES 0x01 // relay splits multi-frame packets into one message per frame
+
+void put_u16(unsigned char* p, uint16_t value) {
+    value = htons(value);
+    memcpy(p, &value, sizeof(value));
+}
+
+uint16_t get_u16(const unsigned char* p) {
+    uint16_t value;
+    memcpy(&value, p, sizeof(value));
+    return ntohs(value);
+}
+
+void put_u32(unsigned char* p, uint32_t value) {
+    value = htonl(value);
+    memcpy(p, &value, sizeof(value));
+}
+
+uint32_t get_u32(const unsigned char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return ntohl(value);
+}
+
+// Writes the clock offset of a frame info at p, as small as it fits, and
+// returns its size. Offsets past an i16 wrap.
+int put_clock_offset(unsigned char* p, int32_t offset) {
+    if (offset >= INT8_MIN && offset <= INT8_MAX) {
+        p[0] = static_cast<unsigned char>(offset);
+        return 1;
+    }
+    put_u16(p, static_cast<uint16_t>(offset));
+    return 2;
+}
+
+// The clock offset of a frame info of size bytes whose packet holds frames,
+// false when there is none of either size
+bool get_clock_offset(const unsigned char* info, opus_int32 size, int frames, int32_t* offset) {
+    const unsigned char* p = info + FRAME_INFO_HEADER_SIZE + frames;
+    switch (size - FRAME_INFO_HEADER_SIZE - frames) {
+    case 1: *offset = static_cast<int8_t>(p[0]); return true;
+    case 2: *offset = static_cast<int16_t>(get_u16(p)); return true;
+    default: return false;
+    }
+}
+
+void put_receiver_report(unsigned char* out, uint32_t ssrc, const ReceiverReport& report) {
+    out[0] = MESSAGE_RECEIVER_REPORT;
+    put_u32(out + 1, ssrc);
+    put_u32(out + 5, report.highest_seq);
+    out[9] = static_cast<unsigned char>(report.fraction_lost);
+    put_u32(out + 10, report.jitter_us);
+    put_u32(out + 14, report.queue_delay_us);
+    put_u32(out + 18, static_cast<uint32_t>(report.trend_us));
+}
+
+uint32_t now_ms() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
 }
 
 #define MINIAUDIO_IMPLEMENTATION
@@ -142,8 +301,10 @@ size_t receive_data(int sock, char *buffer, size_t buffer_size) {
 
 int sock;
 std::atomic<bool> running{true};
+uint32_t local_ssrc; // id of the stream we send, random per run
 
 struct AudioPacket {
+    uint32_t seq;
     std::vector<unsigned char> data; // Compressed Opus data
     std::chrono::steady_clock::time_point timestamp;
 };
@@ -156,7 +317,8 @@ private:
     size_t max_size;
     
 public:
-    JitterBuffer(size_t size) : max_size(size) {}
+    // Room for a whole aggregated packet on top of the jitter allowance
+    JitterBuffer(size_t size = JITTER_BUFFER_SIZE + MAX_FRAMES_PER_PACKET) : max_size(size) {}
     
     void push(AudioPacket&& packet) {
         std::unique_lock<std::mutex> lock(mtx);
@@ -190,13 +352,418 @@ public:
     }
 };
 
-JitterBuffer jitterBuffer(JITTER_BUFFER_SIZE);
+// Keeps opus_encode_float inside a share of the frame budget by stepping
+// OPUS_SET_COMPLEXITY down when the tail of the encode times gets too close
+// to the deadline, and back up only after several calm windows so it doesn't
+// oscillate. record() runs on the capture thread and never allocates.
+class EncoderGovernor {
+private:
+    long long samples[GOVERNOR_WINDOW];
+    int sample_count = 0;
+    int complexity;
+    int max_complexity;
+    long long high_watermark_us;
+    long long low_watermark_us;
+    int calm_windows = 0;
+
+    static long long percentile(const long long* sorted, int count, int p) {
+        int index = (count * p + 99) / 100 - 1;
+        return sorted[std::max(0, std::min(index, count - 1))];
+    }
+
+public:
+    std::atomic<int> current_complexity;
+    std::atomic<long long> p50_us{0};
+    std::atomic<long long> p95_us{0};
+    std::atomic<long long> p99_us{0};
+    std::atomic<unsigned> windows{0};
+
+    EncoderGovernor(int max_complexity, int headroom_percent)
+        : complexity(max_complexity), max_complexity(max_complexity),
+          current_complexity(max_complexity) {
+        // Step down when p99 eats into the headroom, step up only when even
+        // the slowest frames use less than half of what we allow ourselves
+        high_watermark_us = FRAME_BUDGET_US * (100 - headroom_percent) / 100;
+        low_watermark_us = high_watermark_us / 2;
+    }
+
+    void record(OpusEncoder* enc, long long encode_us) {
+        samples[sample_count++] = encode_us;
+        if (sample_count < GOVERNOR_WINDOW) return;
+        sample_count = 0;
+
+        std::sort(samples, samples + GOVERNOR_WINDOW);
+        long long p50 = percentile(samples, GOVERNOR_WINDOW, 50);
+        long long p95 = percentile(samples, GOVERNOR_WINDOW, 95);
+        long long p99 = percentile(samples, GOVERNOR_WINDOW, 99);
+
+        int next = complexity;
+        if (p99 > high_watermark_us) {
+            // Way over budget drops two steps at once so we recover quickly
+            next -= (p99 > FRAME_BUDGET_US) ? 2 : 1;
+            calm_windows = 0;
+        } else if (p99 < low_watermark_us) {
+            if (++calm_windows >= GOVERNOR_CALM_WINDOWS) {
+                next += 1;
+                calm_windows = 0;
+            }
+        } else {
+            calm_windows = 0;
+        }
+        next = std::max(0, std::min(next, max_complexity));
+
+        if (next != complexity) {
+            complexity = next;
+            opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY(complexity));
+        }
+
+        p50_us = p50;
+        p95_us = p95;
+        p99_us = p99;
+        current_complexity = complexity;
+        windows++;
+    }
+};
+
+EncoderGovernor* governor = nullptr;
+
+// Sender side of the feedback loop. Backs the bitrate off as soon as the
+// reported queuing delay or its growth says a queue is forming (before the
+// TCP send buffer fills up), cuts it further on loss, and probes back up
+// additively once the path is calm. Packet loss percentage and in-band FEC
+// follow the smoothed loss. With aggregation allowed, a link where our
+// headers cost more than the audio packs more frames per packet before it
+// gives up bitrate (one more frame saves PACKET_OVERHEAD_BYTES every packet,
+// a bitrate step only a few bytes a frame), and hands the latency back first
+// once calm. Every listener reports on our stream, so reports are merged and
+// acted on at most once per report interval, taking the worst loss and delay
+// any listener saw since the last step. Reports arrive on the receiver thread,
+// the resulting targets are applied to the encoder on the capture thread.
+class CongestionController {
+private:
+    int bitrate = BITRATE_START;
+    int frames_per_packet = 1;
+    double loss_percent = 0.0;
+    int hold_reports = 0;
+
+    // Worst of the reports merged since the last step
+    bool pending = false;
+    bool stepped = false;
+    uint32_t last_step_ms = 0;
+    unsigned worst_fraction_lost = 0;
+    uint32_t worst_jitter_us = 0;
+    uint32_t worst_queue_delay_us = 0;
+    int32_t worst_trend_us = 0;
+
+public:
+    int max_frames_per_packet = 1; // set before the first report, 1 keeps one frame per packet
+    std::atomic<int> target_bitrate{BITRATE_START};
+    std::atomic<int> target_frames_per_packet{1};
+    std::atomic<int> target_loss_percent{0};
+    std::atomic<unsigned> generation{0};
+    std::atomic<unsigned> last_jitter_us{0};
+    std::atomic<unsigned> last_queue_delay_us{0};
+
+    // Listeners report about once per REPORT_INTERVAL_MS each, at their own
+    // phase. A step is taken once three quarters of an interval have passed
+    // since the last one, so a single listener still drives a step per report
+    // while N listeners no longer drive N.
+    void add_report(uint32_t now, unsigned fraction_lost, uint32_t jitter_us, uint32_t queue_delay_us, int32_t trend_us) {
+        if (!pending) {
+            worst_fraction_lost = fraction_lost;
+            worst_jitter_us = jitter_us;
+            worst_queue_delay_us = queue_delay_us;
+            worst_trend_us = trend_us;
+            pending = true;
+        } else {
+            worst_fraction_lost = std::max(worst_fraction_lost, fraction_lost);
+            worst_jitter_us = std::max(worst_jitter_us, jitter_us);
+            worst_queue_delay_us = std::max(worst_queue_delay_us, queue_delay_us);
+            worst_trend_us = std::max(worst_trend_us, trend_us);
+        }
+
+        if (stepped && now - last_step_ms < REPORT_INTERVAL_MS * 3 / 4) return;
+        stepped = true;
+        last_step_ms = now;
+        pending = false;
+        on_report(worst_fraction_lost, worst_jitter_us, worst_queue_delay_us, worst_trend_us);
+    }
+
+private:
+    void on_report(unsigned fraction_lost, uint32_t jitter_us, uint32_t queue_delay_us, int32_t trend_us) {
+        double loss = fraction_lost / 256.0;
+        loss_percent += (loss * 100.0 - loss_percent) / 4.0;
+
+        int next = bitrate;
+        int next_frames = frames_per_packet;
+        bool header_limited = bitrate * FRAME_SIZE / SAMPLE_RATE / 8 < PACKET_OVERHEAD_BYTES;
+        if (queue_delay_us > QUEUE_DELAY_OVERUSE_US || trend_us > DELAY_TREND_OVERUSE_US) {
+            if (header_limited && frames_per_packet < max_frames_per_packet) {
+                next_frames = frames_per_packet + 1;
+            } else {
+                next = bitrate * 85 / 100;
+            }
+            hold_reports = 2;
+        } else if (loss > 0.1) {
+            next = static_cast<int>(bitrate * (1.0 - 0.5 * loss));
+            hold_reports = 2;
+        } else if (hold_reports > 0) {
+            hold_reports--;
+        } else if (queue_delay_us < QUEUE_DELAY_CALM_US && loss < 0.02) {
+            if (frames_per_packet > 1) {
+                next_frames = frames_per_packet - 1;
+            } else {
+                next = bitrate + BITRATE_STEP_UP;
+            }
+        }
+        bitrate = std::max(BITRATE_MIN, std::min(next, BITRATE_MAX));
+        frames_per_packet = std::max(1, std::min(next_frames, max_frames_per_packet));
+
+        target_bitrate = bitrate;
+        target_frames_per_packet = frames_per_packet;
+        target_loss_percent = std::min(30, static_cast<int>(loss_percent + 0.5));
+        last_jitter_us = jitter_us;
+        last_queue_delay_us = queue_delay_us;
+        generation++;
+    }
+};
+
+CongestionController congestionController;
+
+// Single producer (decode thread), single consumer (playback callback) ring of
+// decoded samples. Capacity must be a power of two.
+class PcmRing {
+private:
+    std::vector<float> buffer;
+    size_t mask;
+    std::atomic<size_t> head{0}; // total samples written, owned by the producer
+    std::atomic<size_t> tail{0}; // total samples read, owned by the consumer
+
+public:
+    PcmRing(size_t capacity) : buffer(capacity), mask(capacity - 1) {}
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t write(const float* data, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        count = std::min(count, buffer.size() - (h - t));
+        for (size_t i = 0; i < count; i++) {
+            buffer[(h + i) & mask] = data[i];
+        }
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t read(float* out, size_t count) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        count = std::min(count, h - t);
+        for (size_t i = 0; i < count; i++) {
+            out[i] = buffer[(t + i) & mask];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+};
+
+PcmRing pcmRing(PCM_RING_CAPACITY);
+
+// Everything we keep per remote talker. The playout state is what
+// decode_next_frame needs to carry from one frame to the next.
+struct RemoteStream {
+    bool active = false;
+    uint32_t ssrc = 0;
+    OpusDecoder* decoder = nullptr;
+    JitterBuffer jitter;
+    ReceiverStats stats;
+    std::chrono::steady_clock::time_point last_packet;
+    float level = LEVEL_SILENT; // peak held -dBov, speaker selection keeps the loudest talkers
+    uint32_t highest_seq = 0; // widens the 16 bit sequence numbers on the wire
+    bool has_seq = false;
+
+    uint32_t unwrap_seq(uint16_t seq) {
+        if (!has_seq) {
+            has_seq = true;
+            highest_seq = seq;
+            return seq;
+        }
+        uint32_t full = highest_seq + static_cast<int16_t>(seq - static_cast<uint16_t>(highest_seq));
+        if (static_cast<int32_t>(full - highest_seq) > 0) highest_seq = full;
+        return full;
+    }
+
+    // The packet we popped but haven't played yet because frames before it went missing
+    AudioPacket pending;
+    bool has_pending = false;
+    uint32_t expected_seq = 0;
+    bool has_expected = false;
+    // Last silence frame we got, replayed through the decoder's DTX path for comfort noise
+    AudioPacket last_dtx;
+    bool in_dtx = false;
+};
+
+// Fixed set of decoders carved out of one preallocated block, handed out per
+// stream id. Streams that go quiet are released so a big room only ever
+// costs MAX_STREAMS decoders. Receiver and decode threads share it under mtx.
+class DecoderPool {
+private:
+    std::vector<unsigned char> memory;
+    int decoder_size;
+
+    // The newcomer currently waiting to take a softer talker's slot, and
+    // since when its packets have been loud enough to do so
+    struct Contender {
+        bool valid = false;
+        uint32_t ssrc = 0;
+        std::chrono::steady_clock::time_point since;
+        std::chrono::steady_clock::time_point last;
+    } contender;
+
+    // Called for every packet of ssrc that is loud enough to steal. True once
+    // it has been loud enough without a gap for SPEAKER_STEAL_HOLD_MS.
+    bool holds_louder(uint32_t ssrc, std::chrono::steady_clock::time_point now) {
+        bool fresh = contender.valid && now - contender.last <= std::chrono::milliseconds(SPEAKER_STEAL_GAP_MS);
+        if (fresh && contender.ssrc != ssrc) return false; // one newcomer at a time
+        if (!fresh || contender.ssrc != ssrc) {
+            contender.valid = true;
+            contender.ssrc = ssrc;
+            contender.since = now;
+        }
+        contender.last = now;
+        return now - contender.since >= std::chrono::milliseconds(SPEAKER_STEAL_HOLD_MS);
+    }
+
+public:
+    std::mutex mtx;
+    RemoteStream streams[MAX_STREAMS];
+
+    bool init() {
+        decoder_size = opus_decoder_get_size(CHANNELS);
+        if (decoder_size <= 0) return false;
+        memory.resize(static_cast<size_t>(decoder_size) * MAX_STREAMS);
+        for (int i = 0; i < MAX_STREAMS; i++) {
+            streams[i].decoder = reinterpret_cast<OpusDecoder*>(memory.data() + static_cast<size_t>(decoder_size) * i);
+        }
+        return true;
+    }
+
+    // Must be called with mtx held. level is the -dBov of the packet asking,
+    // a newcomer that stays much louder than the softest talker for
+    // SPEAKER_STEAL_HOLD_MS takes its decoder, a single click does not.
+    RemoteStream* acquire(uint32_t ssrc, std::chrono::steady_clock::time_point now, int level) {
+        RemoteStream* free_slot = nullptr;
+        RemoteStream* quietest = nullptr;
+        RemoteStream* softest = nullptr;
+        for (RemoteStream& stream : streams) {
+            if (stream.active && stream.ssrc == ssrc) return &stream;
+            if (!stream.active) {
+                if (!free_slot) free_slot = &stream;
+                continue;
+            }
+            if (!quietest || stream.last_packet < quietest->last_packet) quietest = &stream;
+            if (!softest || stream.level > softest->level) softest = &stream;
+        }
+
+        RemoteStream* slot = free_slot;
+        if (!slot && quietest && now - quietest->last_packet > std::chrono::milliseconds(STREAM_STEAL_MS)) {
+            slot = quietest;
+        }
+        if (!slot && softest) {
+            if (softest->level - level >= SPEAKER_STEAL_DB) {
+                if (holds_louder(ssrc, now)) slot = softest;
+            } else if (contender.ssrc == ssrc) {
+                contender.valid = false; // it has to start over
+            }
+        }
+        if (!slot) return nullptr; // Room is louder than MAX_STREAMS, drop the newcomer
+        if (contender.ssrc == ssrc) contender.valid = false;
+
+        int error = opus_decoder_init(slot->decoder, SAMPLE_RATE, CHANNELS);
+        if (error != OPUS_OK) {
+            fprintf(stderr, "Failed to init Opus decoder: %s\n", opus_strerror(error));
+            return nullptr;
+        }
+        slot->active = true;
+        slot->ssrc = ssrc;
+        slot->jitter.clear();
+        slot->stats = ReceiverStats();
+        slot->last_packet = now;
+        slot->level = static_cast<float>(level);
+        slot->has_seq = false;
+        slot->has_pending = false;
+        slot->has_expected = false;
+        slot->in_dtx = false;
+        return slot;
+    }
+
+    // Must be called with mtx held. Moves the held level of a stream that got
+    // a packet of level -dBov, elapsed after its previous one: up to a louder
+    // packet at once, down to a quieter one at SPEAKER_RELEASE_DB_PER_S, so a
+    // pause between words doesn't make a talker look soft.
+    static void update_level(RemoteStream& stream, int level, std::chrono::steady_clock::duration elapsed) {
+        if (level <= stream.level) {
+            stream.level = static_cast<float>(level);
+            return;
+        }
+        float release = SPEAKER_RELEASE_DB_PER_S * std::chrono::duration<float>(elapsed).count();
+        stream.level = std::min(static_cast<float>(level), stream.level + release);
+    }
+
+    // Must be called with mtx held
+    void evict_idle(std::chrono::steady_clock::time_point now) {
+        for (RemoteStream& stream : streams) {
+            if (stream.active && now - stream.last_packet > std::chrono::milliseconds(STREAM_IDLE_TIMEOUT_MS)) {
+                stream.active = false;
+                stream.jitter.clear();
+            }
+        }
+    }
+};
+
+DecoderPool decoderPool;
+
+// dst += src, the decode thread sums every talker into one frame this way
+void mix_add(float* dst, const float* src, int count) {
+    int i = 0;
+#ifdef MIX_SSE
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_loadu_ps(src + i)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] += src[i];
+    }
+}
+
+// Keeps the sum of several talkers inside [-1, 1]
+void mix_clamp(float* dst, int count) {
+    int i = 0;
+#ifdef MIX_SSE
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_min_ps(hi, _mm_max_ps(lo, _mm_loadu_ps(dst + i))));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = std::max(-1.0f, std::min(dst[i], 1.0f));
+    }
+}
 
-// Opus encoder and decoder
+// Opus encoder, decoders come from decoderPool
 OpusEncoder* encoder = nullptr;
-OpusDecoder* decoder = nullptr;
+// Frames encoded but not sent yet while the congestion controller has us
+// packing several per packet, only touched from the capture thread
+OpusRepacketizer* aggregator = nullptr;
+unsigned char aggregate_frames[MAX_FRAMES_PER_PACKET][MAX_PACKET_SIZE];
+unsigned char aggregate_levels[MAX_FRAMES_PER_PACKET];
+uint32_t aggregate_first_seq = 0;
+int aggregate_count = 0;
 
-void init_opus() {
+void init_opus(int max_complexity) {
     int error;
     
     // Initialize encoder
@@ -207,14 +774,20 @@ void init_opus() {
     }
     
     // Set encoder options
-    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(16000)); // 16 kbps for voice
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(BITRATE_START)); // Congestion controller moves it from here
     opus_encoder_ctl(encoder, OPUS_SET_VBR(1)); // Enable VBR
-    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(8)); // Max complexity for best quality
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(max_complexity)); // Starting point, the governor lowers it under load
+    opus_encoder_ctl(encoder, OPUS_SET_DTX(1)); // 1-2 byte frames in silence, the relay drops most of them
+
+    aggregator = opus_repacketizer_create();
+    if (!aggregator) {
+        fprintf(stderr, "Failed to create Opus repacketizer\n");
+        exit(EXIT_FAILURE);
+    }
     
-    // Initialize decoder
-    decoder = opus_decoder_create(SAMPLE_RATE, CHANNELS, &error);
-    if (error != OPUS_OK) {
-        fprintf(stderr, "Failed to create Opus decoder: %s\n", opus_strerror(error));
+    // Preallocate decoders for remote streams
+    if (!decoderPool.init()) {
+        fprintf(stderr, "Failed to size Opus decoders\n");
         exit(EXIT_FAILURE);
     }
 }
@@ -224,10 +797,58 @@ void cleanup_opus() {
         opus_encoder_destroy(encoder);
         encoder = nullptr;
     }
-    if (decoder) {
-        opus_decoder_destroy(decoder);
-        decoder = nullptr;
+    if (aggregator) {
+        opus_repacketizer_destroy(aggregator);
+        aggregator = nullptr;
+    }
+}
+
+// Level of a frame as carried in its frame info, RFC 6464 style
+unsigned char audio_level(const float* pcm, int count, bool active) {
+    float energy = 0.0f;
+    for (int i = 0; i < count; i++) energy += pcm[i] * pcm[i];
+    float dbov = 10.0f * std::log10(energy / count + 1e-13f);
+    int level = std::max(0, std::min(static_cast<int>(-dbov + 0.5f), LEVEL_SILENT));
+    return static_cast<unsigned char>((active ? LEVEL_ACTIVE : 0) | level);
+}
+
+// Adds the frame info for the frames of the Opus packet already at
+// message + AUDIO_HEADER_SIZE, consecutive from seq on, fills in our header
+// in front of it and sends it
+void send_audio(unsigned char* message, int packet_size, uint32_t seq, const unsigned char* levels, int frames) {
+    // Counted from where the first packet went out, the offset then only
+    // moves with how late the capture callback runs and clock drift
+    uint32_t last_seq = seq + frames - 1;
+    uint32_t now = now_ms();
+    static uint32_t clock_base = now - FRAME_INFO_FRAME_MS * last_seq;
+    unsigned char info[FRAME_INFO_HEADER_SIZE + MAX_FRAMES_PER_PACKET + FRAME_INFO_CLOCK_MAX];
+    put_u16(info, static_cast<uint16_t>(seq));
+    memcpy(info + FRAME_INFO_HEADER_SIZE, levels, frames);
+    int info_size = FRAME_INFO_HEADER_SIZE + frames;
+    info_size += put_clock_offset(info + info_size, static_cast<int32_t>(now - clock_base - FRAME_INFO_FRAME_MS * last_seq));
+    OpusExtensionData extension = {EXTENSION_FRAME_INFO, 0, info, info_size};
+    packet_size = opus_packet_add_extensions(message + AUDIO_HEADER_SIZE, packet_size, MAX_PACKET_SIZE, &extension, 1);
+    if (packet_size < 0) {
+        fprintf(stderr, "Opus extension error: %s\n", opus_strerror(packet_size));
+        return;
+    }
+    message[0] = MESSAGE_AUDIO;
+    put_u32(message + 1, local_ssrc);
+    send_data(sock, reinterpret_cast<const char*>(message), AUDIO_HEADER_SIZE + packet_size);
+}
+
+// Sends the frames gathered so far as one packet
+void flush_aggregate() {
+    if (aggregate_count == 0) return;
+    unsigned char message[AUDIO_HEADER_SIZE + MAX_PACKET_SIZE];
+    int frames = aggregate_count;
+    aggregate_count = 0;
+    opus_int32 packet_size = opus_repacketizer_out(aggregator, message + AUDIO_HEADER_SIZE, MAX_PACKET_SIZE - FRAME_INFO_ROOM);
+    if (packet_size < 0) {
+        fprintf(stderr, "Opus repacketizer error: %s\n", opus_strerror(packet_size));
+        return;
     }
+    send_audio(message, packet_size, aggregate_first_seq, aggregate_levels, frames);
 }
 
 // Capture callback for microphone input
@@ -235,78 +856,296 @@ void capture_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_
     (void)pOutput; // Unused in capture callback
     
     if (pInput) {
-        // Encode the audio with Opus
-        unsigned char compressed_data[MAX_PACKET_SIZE];
+        // Pick up whatever the congestion controller decided since the last frame
+        static unsigned applied_generation = 0;
+        unsigned generation = congestionController.generation;
+        if (generation != applied_generation) {
+            int loss_percent = congestionController.target_loss_percent;
+            opus_encoder_ctl(encoder, OPUS_SET_BITRATE(congestionController.target_bitrate.load()));
+            opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(loss_percent));
+            opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(loss_percent > 0 ? 1 : 0));
+            applied_generation = generation;
+        }
+
+        // Encode the audio with Opus behind our message header, or into the
+        // next aggregate slot when frames are being packed together
+        static uint32_t seq = 0;
+        int frames_per_packet = congestionController.target_frames_per_packet;
+        unsigned char message[AUDIO_HEADER_SIZE + MAX_PACKET_SIZE];
+        unsigned char* frame = frames_per_packet > 1 ? aggregate_frames[aggregate_count] : message + AUDIO_HEADER_SIZE;
+        auto encode_start = std::chrono::steady_clock::now();
         int compressed_size = opus_encode_float(encoder, 
                                               reinterpret_cast<const float*>(pInput), 
                                               FRAME_SIZE, 
-                                              compressed_data, 
-                                              MAX_PACKET_SIZE);
+                                              frame, 
+                                              MAX_PACKET_SIZE - FRAME_INFO_ROOM);
+        auto encode_time = std::chrono::steady_clock::now() - encode_start;
+        governor->record(encoder, std::chrono::duration_cast<std::chrono::microseconds>(encode_time).count());
         
         if (compressed_size > 0) {
-            send_data(sock, reinterpret_cast<const char*>(compressed_data), compressed_size);
+            bool dtx = compressed_size <= DTX_MAX_PAYLOAD;
+            uint32_t frame_seq = seq++;
+            unsigned char level = audio_level(reinterpret_cast<const float*>(pInput), FRAME_SIZE * CHANNELS, !dtx);
+            if (frames_per_packet <= 1 || dtx) {
+                // Silence frames go out on their own so the relay can still
+                // thin them out, and close whatever was being gathered
+                flush_aggregate();
+                if (frame != message + AUDIO_HEADER_SIZE) memcpy(message + AUDIO_HEADER_SIZE, frame, compressed_size);
+                send_audio(message, compressed_size, frame_seq, &level, 1);
+            } else {
+                // Frames only ever join the frame right before them, so the
+                // ones in a packet are consecutive
+                bool added = aggregate_count > 0 && opus_repacketizer_cat(aggregator, frame, compressed_size) == OPUS_OK;
+                if (!added) {
+                    // First frame, or one whose mode or bandwidth can't share
+                    // a packet with the frames before it
+                    flush_aggregate();
+                    if (frame != aggregate_frames[0]) memcpy(aggregate_frames[0], frame, compressed_size);
+                    opus_repacketizer_init(aggregator);
+                    opus_repacketizer_cat(aggregator, aggregate_frames[0], compressed_size);
+                    aggregate_first_seq = frame_seq;
+                }
+                aggregate_levels[aggregate_count] = level;
+                if (++aggregate_count >= frames_per_packet) flush_aggregate();
+            }
         } else {
             fprintf(stderr, "Opus encode error: %s\n", opus_strerror(compressed_size));
         }
     }
 }
 
-// Playback callback for headphone output
-void playback_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
-    (void)pInput; // Unused in playback callback
-    
-    AudioPacket packet;
-    memset(pOutput, 0, frameCount * CHANNELS * sizeof(float));
-    if (jitterBuffer.pop(packet)) {
-        float pcm_data[FRAME_SIZE * CHANNELS];
-        int decoded_samples = opus_decode_float(decoder, 
-                                              packet.data.data(), 
-                                              packet.data.size(), 
+// Decodes the next frame of one stream to play into pcm_data, concealing losses with FEC/PLC
+// and silence with comfort noise. Returns the number of samples per channel,
+// 0 when there is nothing to play right now.
+int decode_next_frame(RemoteStream& stream, float* pcm_data) {
+    if (!stream.has_pending) {
+        stream.has_pending = stream.jitter.pop(stream.pending);
+    }
+
+    int decoded_samples = 0;
+    if (stream.has_pending) {
+        int gap = stream.has_expected ? static_cast<int32_t>(stream.pending.seq - stream.expected_seq) : 0;
+        if (gap > 0 && gap <= JITTER_BUFFER_SIZE && !stream.in_dtx) {
+            // Conceal the missing frame, from the next packet's in-band FEC when
+            // it is the frame right before it, otherwise with plain PLC
+            if (gap == 1) {
+                decoded_samples = opus_decode_float(stream.decoder, stream.pending.data.data(), stream.pending.data.size(),
+                                                    pcm_data, FRAME_SIZE, 1);
+            } else {
+                decoded_samples = opus_decode_float(stream.decoder, NULL, 0, pcm_data, FRAME_SIZE, 0);
+            }
+            stream.expected_seq++;
+        } else {
+            // Gaps after a silence frame are frames the relay didn't forward
+            decoded_samples = opus_decode_float(stream.decoder, 
+                                              stream.pending.data.data(), 
+                                              stream.pending.data.size(), 
                                               pcm_data,
                                               FRAME_SIZE, 
                                               0);
-        
-        if (decoded_samples > 0) {
-            size_t samplesToCopy = std::min(static_cast<size_t>(decoded_samples * CHANNELS), 
-                                           static_cast<size_t>(frameCount * CHANNELS));
-            memcpy(pOutput, pcm_data, samplesToCopy * sizeof(float)); 
+            stream.expected_seq = stream.pending.seq + 1;
+            stream.has_expected = true;
+            stream.has_pending = false;
+            stream.in_dtx = stream.pending.data.size() <= DTX_MAX_PAYLOAD;
+            if (stream.in_dtx) {
+                stream.last_dtx = stream.pending;
+            }
+        }
+    } else if (stream.in_dtx) {
+        if (std::chrono::steady_clock::now() - stream.last_dtx.timestamp < std::chrono::milliseconds(DTX_TIMEOUT_MS)) {
+            decoded_samples = opus_decode_float(stream.decoder, stream.last_dtx.data.data(), stream.last_dtx.data.size(),
+                                                pcm_data, FRAME_SIZE, 0);
+            stream.expected_seq++;
         } else {
-            fprintf(stderr, "Opus decode error: %s\n", opus_strerror(decoded_samples));
+            stream.in_dtx = false;
+        }
+    }
+
+    if (decoded_samples < 0) {
+        fprintf(stderr, "Opus decode error: %s\n", opus_strerror(decoded_samples));
+        return 0;
+    }
+    return decoded_samples;
+}
+
+
+// Keeps the PCM ring one frame ahead of the playback callback so decoder
+// cost spikes (CELT transients, PLC) land here instead of on the audio thread
+void decode_audio_data() {
+    float pcm_data[FRAME_SIZE * CHANNELS];
+    float mix[FRAME_SIZE * CHANNELS];
+
+    while (running) {
+        std::unique_lock<std::mutex> lock(decoderPool.mtx);
+        decoderPool.evict_idle(std::chrono::steady_clock::now());
+
+        while (pcmRing.size() < PCM_RING_TARGET) {
+            // Talkers that have nothing for this frame contribute silence
+            int mixed_samples = 0;
+            memset(mix, 0, sizeof(mix));
+            for (RemoteStream& stream : decoderPool.streams) {
+                if (!stream.active) continue;
+                int decoded_samples = decode_next_frame(stream, pcm_data);
+                if (decoded_samples <= 0) continue;
+                mix_add(mix, pcm_data, decoded_samples * CHANNELS);
+                mixed_samples = std::max(mixed_samples, decoded_samples);
+            }
+            if (mixed_samples == 0) break;
+            mix_clamp(mix, mixed_samples * CHANNELS);
+            pcmRing.write(mix, mixed_samples * CHANNELS);
         }
+
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(DECODE_POLL_MS));
     }
 }
 
+// Playback callback for headphone output, only copies what the decode thread prepared
+void playback_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
+    (void)pInput; // Unused in playback callback
+
+    float* out = reinterpret_cast<float*>(pOutput);
+    size_t wanted = frameCount * CHANNELS;
+    size_t copied = pcmRing.read(out, wanted);
+    // Underrun, play silence for the rest
+    memset(out + copied, 0, (wanted - copied) * sizeof(float));
+}
+
 void receive_audio_data() {
-    std::vector<unsigned char> receive_buffer(MAX_PACKET_SIZE);
+    std::vector<unsigned char> receive_buffer(MAX_MESSAGE_SIZE);
+    // The frames of one message, each goes into the jitter buffer on its own
+    AudioPacket packets[MAX_PACKET_FRAMES];
+    const unsigned char* frame_data[MAX_PACKET_FRAMES];
+    opus_int16 frame_sizes[MAX_PACKET_FRAMES];
     
     while (running) {
         size_t bytes_received = receive_data(sock, reinterpret_cast<char*>(receive_buffer.data()), 
                                             receive_buffer.size());
-        if (bytes_received > 0) {
-            AudioPacket packet;
-            packet.data.assign(receive_buffer.begin(), receive_buffer.begin() + bytes_received);
-            packet.timestamp = std::chrono::steady_clock::now();
-            
-            jitterBuffer.push(std::move(packet));
-        } else if (bytes_received == 0) {
+        if (bytes_received == 0) {
             // Connection closed
             running = false;
             break;
         }
+
+        const unsigned char* message = receive_buffer.data();
+        uint32_t arrival_ms = now_ms();
+        if (message[0] == MESSAGE_AUDIO && bytes_received > AUDIO_HEADER_SIZE) {
+            uint32_t ssrc = get_u32(message + 1);
+            const unsigned char* payload = message + AUDIO_HEADER_SIZE;
+            opus_int32 payload_size = static_cast<opus_int32>(bytes_received - AUDIO_HEADER_SIZE);
+            auto timestamp = std::chrono::steady_clock::now();
+
+            // Frames are placed by the frame info, packets without it (or
+            // that don't parse) have nowhere to go
+            unsigned char toc;
+            const unsigned char* padding;
+            const unsigned char* info = nullptr;
+            opus_int32 info_size = 0;
+            int32_t clock_offset;
+            int frames = opus_packet_parse(payload, payload_size, &toc, frame_data, frame_sizes, nullptr);
+            opus_int32 padding_size = opus_packet_get_extensions(payload, payload_size, &padding);
+            if (frames >= 1 && padding_size > 0) {
+                info_size = opus_packet_extensions_find(padding, padding_size, EXTENSION_FRAME_INFO, 0, &info);
+            }
+            if (!info || !get_clock_offset(info, info_size, frames, &clock_offset)) continue;
+
+            // The decoder gets each frame as a plain single frame packet
+            int level = LEVEL_SILENT;
+            bool active = false;
+            uint16_t first_seq = get_u16(info);
+            for (int i = 0; i < frames; i++) {
+                AudioPacket& packet = packets[i];
+                packet.seq = static_cast<uint16_t>(first_seq + i);
+                packet.timestamp = timestamp;
+                packet.data.resize(1 + frame_sizes[i]);
+                packet.data[0] = toc & 0xFC;
+                memcpy(packet.data.data() + 1, frame_data[i], frame_sizes[i]);
+                unsigned char frame_level = info[FRAME_INFO_HEADER_SIZE + i];
+                level = std::min(level, frame_level & LEVEL_SILENT);
+                active = active || (frame_level & LEVEL_ACTIVE);
+            }
+
+            bool report_due = false;
+            unsigned char report[RECEIVER_REPORT_SIZE];
+            {
+                std::lock_guard<std::mutex> lock(decoderPool.mtx);
+                RemoteStream* stream = decoderPool.acquire(ssrc, timestamp, level);
+                if (!stream) continue;
+
+                // The frames of a packet are consecutive from the sequence
+                // number in its frame info, the clock offset there counts
+                // from the last one
+                DecoderPool::update_level(*stream, level, timestamp - stream->last_packet);
+                stream->last_packet = timestamp;
+                for (int i = 0; i < frames; i++) {
+                    packets[i].seq = stream->unwrap_seq(static_cast<uint16_t>(packets[i].seq));
+                }
+                uint32_t send_ms = FRAME_INFO_FRAME_MS * packets[frames - 1].seq + static_cast<uint32_t>(clock_offset);
+                stream->stats.on_audio(packets[0].seq, send_ms, arrival_ms, frames == 1 && !active, frames);
+                for (int i = 0; i < frames; i++) {
+                    stream->jitter.push(std::move(packets[i]));
+                }
+
+                report_due = stream->stats.report_due(arrival_ms);
+                if (report_due) {
+                    put_receiver_report(report, ssrc, stream->stats.make_report(arrival_ms));
+                }
+            }
+
+            if (report_due) {
+                send_data(sock, reinterpret_cast<const char*>(report), sizeof(report));
+            }
+        } else if (message[0] == MESSAGE_RECEIVER_REPORT && bytes_received >= RECEIVER_REPORT_SIZE) {
+            // Every listener reports, we only care about reports on our own stream
+            if (get_u32(message + 1) != local_ssrc) continue;
+            congestionController.add_report(now_ms(),
+                                            message[9],
+                                            get_u32(message + 10),
+                                            get_u32(message + 14),
+                                            static_cast<int32_t>(get_u32(message + 18)));
+        }
     }
 }
 
+void usage(const char* program) {
+    fprintf(stderr, "Usage: %s <server_hostname_or_ip> <server_port> [complexity <0-10>] [headroom <percent>] "
+                    "[aggregate <frames 1-%d>] [split]\n", program, MAX_FRAMES_PER_PACKET);
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <server_hostname_or_ip> <server_port>\n", argv[0]);
+    if (argc < 3) {
+        usage(argv[0]);
         return EXIT_FAILURE;
     }
 
     const char* server_name = argv[1];
     int server_port = atoi(argv[2]);
 
+    int max_complexity = 8; // Max complexity for best quality
+    int headroom_percent = 50; // Share of the frame budget the encoder must leave free
+    int max_frames_per_packet = 1; // Frames the sender may pack into one packet on a header-limited link
+    bool split_frames = false; // Have the relay split other senders' packets into single frames
+
+    for (int i = 3; i < argc; i++) {
+        if (strcmp(argv[i], "complexity") == 0 && i + 1 < argc) {
+            max_complexity = std::max(0, std::min(atoi(argv[++i]), 10));
+        } else if (strcmp(argv[i], "headroom") == 0 && i + 1 < argc) {
+            headroom_percent = std::max(0, std::min(atoi(argv[++i]), 95));
+        } else if (strcmp(argv[i], "aggregate") == 0 && i + 1 < argc) {
+            max_frames_per_packet = std::max(1, std::min(atoi(argv[++i]), MAX_FRAMES_PER_PACKET));
+        } else if (strcmp(argv[i], "split") == 0) {
+            split_frames = true;
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
     init_sockets();
-    init_opus();
+    init_opus(max_complexity);
+    local_ssrc = std::random_device()();
+    governor = new EncoderGovernor(max_complexity, headroom_percent);
+    congestionController.max_frames_per_packet = max_frames_per_packet;
 
     sock = create_socket();
     if (sock < 0) {
@@ -328,6 +1167,11 @@ int main(int argc, char* argv[]) {
 
     printf("Connected to the server at %s:%d.\n", server_name, server_port);
 
+    if (split_frames) {
+        unsigned char config[LISTENER_CONFIG_SIZE] = {MESSAGE_LISTENER_CONFIG, LISTENER_SPLIT_FRAMES};
+        send_data(sock, reinterpret_cast<const char*>(config), sizeof(config));
+    }
+
     // Initialize separate capture (microphone) and playback (headphones) devices
     ma_device_config capture_config = ma_device_config_init(ma_device_type_capture);
     capture_config.capture.format   = ma_format_f32;
@@ -389,30 +1233,52 @@ int main(int argc, char* argv[]) {
     printf("  Playback: %s\n", playback_device.playback.name);
 
     std::thread receiverThread(receive_audio_data);
+    std::thread decoderThread(decode_audio_data);
 
     // Main loop
+    unsigned reported_windows = 0;
+    int reported_complexity = max_complexity;
+    int reported_bitrate = BITRATE_START;
+    int reported_frames_per_packet = 1;
     while (running) {
-        // Monitor jitter buffer fill level
-        size_t buffer_size = jitterBuffer.size();
-        if (buffer_size < 1) {
-            // Buffer underrun - we might want to increase buffer size
-            // printf("Warning: Jitter buffer underrun (%zu packets)\n", buffer_size);
-        } else if (buffer_size > JITTER_BUFFER_SIZE * 2) {
-            // Buffer overrun - we might want to drop some packets
-            // printf("Warning: Jitter buffer overrun (%zu packets)\n", buffer_size);
-            jitterBuffer.clear();
+        // Report encoder load every 5 seconds or whenever the governor moves
+        unsigned windows = governor->windows;
+        int complexity = governor->current_complexity;
+        if (windows != reported_windows && (windows % 5 == 0 || complexity != reported_complexity)) {
+            printf("Encoder: complexity %d, encode time p50 %.2fms p95 %.2fms p99 %.2fms\n",
+                   complexity,
+                   governor->p50_us / 1000.0,
+                   governor->p95_us / 1000.0,
+                   governor->p99_us / 1000.0);
+            reported_windows = windows;
+            reported_complexity = complexity;
         }
-        
+
+        int bitrate = congestionController.target_bitrate;
+        int frames_per_packet = congestionController.target_frames_per_packet;
+        if (bitrate != reported_bitrate || frames_per_packet != reported_frames_per_packet) {
+            printf("Network: bitrate %d bps, %d frames/packet, loss %d%%, jitter %.1fms, queuing delay %.1fms\n",
+                   bitrate,
+                   frames_per_packet,
+                   congestionController.target_loss_percent.load(),
+                   congestionController.last_jitter_us / 1000.0,
+                   congestionController.last_queue_delay_us / 1000.0);
+            reported_bitrate = bitrate;
+            reported_frames_per_packet = frames_per_packet;
+        }
+
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
     // Cleanup
     receiverThread.join();
+    decoderThread.join();
     ma_device_uninit(&playback_device);
     ma_device_uninit(&capture_device);
     close_socket(sock);
     cleanup_opus();
     cleanup_sockets();
+    delete governor;
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,148 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Synthetic test audio for the headless tools (workload, benchmarks), so they
+// don't depend on a recorded corpus being around. 48 kHz mono float.
+
+#define CORPUS_SAMPLE_RATE 48000
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct {
+    unsigned state;
+} Corpus_Rng;
+
+static float corpus_rand(Corpus_Rng* rng) {
+    rng->state = rng->state * 1664525u + 1013904223u;
+    return (float)(rng->state >> 8) / (float)(1 << 24); // [0, 1)
+}
+
+// Two pole resonator, one per formant
+typedef struct {
+    float a1, a2, gain;
+    float y1, y2;
+} Corpus_Resonator;
+
+static void corpus_resonator_set(Corpus_Resonator* r, float freq, float bandwidth) {
+    float radius = expf(-(float)M_PI * bandwidth / CORPUS_SAMPLE_RATE);
+    r->a1 = 2.0f * radius * cosf(2.0f * (float)M_PI * freq / CORPUS_SAMPLE_RATE);
+    r->a2 = -radius * radius;
+    r->gain = 1.0f - radius;
+}
+
+static float corpus_resonator_run(Corpus_Resonator* r, float x) {
+    float y = r->gain * x + r->a1 * r->y1 + r->a2 * r->y2;
+    r->y2 = r->y1;
+    r->y1 = y;
+    return y;
+}
+
+// Speech-like signal: talk spurts of voiced syllables (glottal pulse train with
+// a gliding pitch through three formant resonators) and unvoiced fricatives
+// (filtered noise), separated by pauses long enough for VAD and DTX to kick in.
+static void corpus_generate_speech(float* pcm, int samples, unsigned seed) {
+    // Formant sets loosely following /a/ /i/ /u/ /e/ /o/
+    static const float formants[5][3] = {
+        {730, 1090, 2440}, {270, 2290, 3010}, {300, 870, 2240}, {530, 1840, 2480}, {570, 840, 2410},
+    };
+    Corpus_Rng rng = {seed * 2654435761u + 1};
+    Corpus_Resonator res[3];
+    memset(res, 0, sizeof(res));
+
+    int i = 0;
+    while (i < samples) {
+        // Talk spurt of 1-3 seconds, then a pause of 0.3-1.5 seconds
+        int spurt_end = i + (int)((1.0f + 2.0f * corpus_rand(&rng)) * CORPUS_SAMPLE_RATE);
+        float f0 = 90.0f + 130.0f * corpus_rand(&rng);
+        while (i < samples && i < spurt_end) {
+            int syllable = (int)((0.12f + 0.18f * corpus_rand(&rng)) * CORPUS_SAMPLE_RATE);
+            bool voiced = corpus_rand(&rng) < 0.8f;
+            const float* f = formants[(int)(corpus_rand(&rng) * 5) % 5];
+            for (int k = 0; k < 3; k++) corpus_resonator_set(&res[k], f[k], 80.0f + 40.0f * k);
+            float glide = (corpus_rand(&rng) - 0.5f) * 40.0f;
+            float level = 0.3f + 0.5f * corpus_rand(&rng);
+            float phase = 0.0f;
+
+            for (int n = 0; n < syllable && i < samples && i < spurt_end; n++, i++) {
+                float t = (float)n / syllable;
+                float env = sinf((float)M_PI * t) * level;
+                float excitation;
+                if (voiced) {
+                    float pitch = f0 + glide * t;
+                    phase += pitch / CORPUS_SAMPLE_RATE;
+                    excitation = 0.0f;
+                    if (phase >= 1.0f) {
+                        phase -= 1.0f;
+                        excitation = 1.0f;
+                    }
+                    excitation += (corpus_rand(&rng) - 0.5f) * 0.02f;
+                } else {
+                    excitation = (corpus_rand(&rng) - 0.5f) * 0.5f;
+                }
+                float y = 0.0f;
+                for (int k = 0; k < 3; k++) y += corpus_resonator_run(&res[k], excitation) / (k + 1);
+                pcm[i] = y * env * 4.0f;
+            }
+        }
+
+        int pause_end = i + (int)((0.3f + 1.2f * corpus_rand(&rng)) * CORPUS_SAMPLE_RATE);
+        for (; i < samples && i < pause_end; i++) {
+            pcm[i] = (corpus_rand(&rng) - 0.5f) * 0.0005f; // room noise
+        }
+    }
+}
+
+// Music-like signal: a chord progression of harmonic tones with plucked
+// envelopes over a bass line, plus noise-burst percussion on the beat. With
+// two channels the voices are panned apart so stereo coding has work to do.
+// Output is interleaved.
+static void corpus_generate_music(float* pcm, int samples, int channels, unsigned seed) {
+    // Semitone offsets from A2 (110 Hz) for a I-V-vi-IV progression in C
+    static const int chords[4][3] = {{3, 7, 10}, {10, 14, 17}, {12, 15, 19}, {8, 12, 15}};
+    Corpus_Rng rng = {seed * 2654435761u + 7};
+    int beat = CORPUS_SAMPLE_RATE / 2; // 120 bpm
+    float phases[4] = {0};
+    float drum = 0.0f;
+
+    for (int i = 0; i < samples; i++) {
+        int bar = i / (beat * 4);
+        int in_beat = i % beat;
+        const int* chord = chords[bar % 4];
+        float t = (float)in_beat / CORPUS_SAMPLE_RATE;
+        float pluck = expf(-3.0f * t);
+
+        if (in_beat == 0) drum = 0.4f + 0.3f * corpus_rand(&rng);
+        drum *= 0.9992f;
+        float hit = drum * (corpus_rand(&rng) - 0.5f);
+
+        float left = 0.0f, right = 0.0f;
+        for (int v = 0; v < 4; v++) {
+            // Voice 3 is the bass, an octave under the root
+            int semitone = v < 3 ? chord[v] + 12 : chord[0] - 12;
+            float freq = 110.0f * powf(2.0f, semitone / 12.0f);
+            phases[v] += freq / CORPUS_SAMPLE_RATE;
+            if (phases[v] >= 1.0f) phases[v] -= 1.0f;
+            float x = 0.0f;
+            for (int h = 1; h <= 4; h++) x += sinf(2.0f * (float)M_PI * h * phases[v]) / (h * h);
+            x *= (v < 3 ? 0.12f * pluck : 0.25f);
+            float pan = (v + 0.5f) / 4.0f;
+            left += x * (1.0f - pan);
+            right += x * pan;
+        }
+
+        if (channels == 1) {
+            pcm[i] = (left + right) * 0.7f + hit;
+        } else {
+            pcm[i * channels] = left + hit;
+            pcm[i * channels + 1] = right + hit * 0.8f;
+        }
+    }
+}
+
+#endif // CORPUS_H
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "cpu_support.h"
+#include "lpcnet.h"
+#include "dred_rdovae_enc.h"
+#include "fargan.h"
+#include "osce.h"
+#include "corpus.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Throughput of the neural models opus ships, at every dispatch level this
+// cpu supports: the DRED encoder (one 20 ms latent frame from two 10 ms
+// feature frames), FARGAN synthesis (one 10 ms frame) and LACE enhancement
+// (one 20 ms SILK frame at 16 kHz). Their int8 layers run through
+// compute_linear, which is where the SSE/AVX2/AVX-512 GEMVs differ. Reports
+// frames per second on one core, and how far each level's output strays from
+// the AVX2 one: the int8 GEMVs only differ when VNNI skips a saturation of
+// the 16 bit pair sums the other levels do, LACE also goes through the
+// AVX-512 celt_pitch_xcorr which sums in another order. Built against a dnn
+// archive of its own, see run_dnn_bench in nob.c.
+
+#define CORPUS_SECONDS 4
+#define FRAME_16K 160 // 10 ms
+#define FRAMES (CORPUS_SECONDS * 100)
+#define BATCHES 9 // median of these passes over the corpus
+#define MAX_LEVELS 7
+
+static const char* arch_names[] = {"c", "sse", "sse2", "sse4.1", "avx2", "avx512", "avx512 vnni"};
+#define REFERENCE_ARCH 4 // avx2
+
+typedef struct {
+    const float* features; // NB_TOTAL_FEATURES per 10 ms frame
+    const float* pcm; // 16 kHz, int16 scale
+} Model_Input;
+
+typedef struct {
+    const char* name;
+    double frame_ms; // audio per call
+    // Runs the model over the whole corpus from a fresh state, out gets
+    // whatever it produces so the levels can be compared
+    void (*run)(const Model_Input* in, float* out, int arch);
+} Model;
+
+static RDOVAEEnc rdovae_enc_model;
+static FARGANState fargan_state;
+static OSCEModel osce_model;
+static silk_decoder_state osce_dec;
+static silk_decoder_control osce_ctrl;
+
+static void run_dred_encoder(const Model_Input* in, float* out, int arch) {
+    static RDOVAEEncState state;
+    float input[2 * DRED_NUM_FEATURES];
+    memset(&state, 0, sizeof(state));
+    for (int f = 0; f + 1 < FRAMES; f += 2) {
+        memcpy(input, &in->features[f * NB_TOTAL_FEATURES], DRED_NUM_FEATURES * sizeof(float));
+        memcpy(input + DRED_NUM_FEATURES, &in->features[(f + 1) * NB_TOTAL_FEATURES], DRED_NUM_FEATURES * sizeof(float));
+        dred_rdovae_encode_dframe(&state, &rdovae_enc_model, &out[(f / 2) * (DRED_LATENT_DIM + DRED_STATE_DIM)],
+                                  &out[(f / 2) * (DRED_LATENT_DIM + DRED_STATE_DIM) + DRED_LATENT_DIM], input, arch);
+    }
+}
+
+static void run_fargan(const Model_Input* in, float* out, int arch) {
+    float features0[5 * NB_FEATURES];
+    float pcm0[FARGAN_CONT_SAMPLES];
+    for (int f = 0; f < 5; f++) memcpy(&features0[f * NB_FEATURES], &in->features[f * NB_TOTAL_FEATURES], NB_FEATURES * sizeof(float));
+    for (int i = 0; i < FARGAN_CONT_SAMPLES; i++) pcm0[i] = in->pcm[i] * (1.0f / 32768.0f);
+    fargan_init(&fargan_state);
+    fargan_state.arch = arch;
+    fargan_cont(&fargan_state, pcm0, features0);
+    for (int f = 5; f < FRAMES; f++) {
+        fargan_synthesize(&fargan_state, &out[f * FRAME_16K], &in->features[f * NB_TOTAL_FEATURES]);
+    }
+}
+
+// LACE only reads the decoded signal and a handful of the decoder's
+// parameters, a voiced frame's worth of plausible ones is enough to drive it
+static void run_lace(const Model_Input* in, float* out, int arch) {
+    opus_int16 xq[2 * FRAME_16K];
+    memset(&osce_dec, 0, sizeof(osce_dec));
+    memset(&osce_ctrl, 0, sizeof(osce_ctrl));
+    osce_dec.fs_kHz = 16;
+    osce_dec.nb_subfr = MAX_NB_SUBFR;
+    osce_dec.LPC_order = MAX_LPC_ORDER;
+    osce_dec.indices.signalType = TYPE_VOICED;
+    for (int k = 0; k < 2; k++) {
+        osce_ctrl.PredCoef_Q12[k][0] = 6000;
+        osce_ctrl.PredCoef_Q12[k][1] = -3000;
+        osce_ctrl.PredCoef_Q12[k][2] = 1000;
+    }
+    for (int k = 0; k < MAX_NB_SUBFR; k++) {
+        osce_ctrl.pitchL[k] = 100;
+        osce_ctrl.LTPCoef_Q14[k * LTP_ORDER + LTP_ORDER / 2] = 8192;
+        osce_ctrl.Gains_Q16[k] = 500 << 16;
+    }
+    osce_reset(&osce_dec.osce, OSCE_METHOD_LACE);
+    for (int f = 0; f + 1 < FRAMES; f += 2) {
+        for (int i = 0; i < 2 * FRAME_16K; i++) xq[i] = (opus_int16)in->pcm[f * FRAME_16K + i];
+        osce_enhance_frame(&osce_model, &osce_dec, &osce_ctrl, xq, 240, arch);
+        for (int i = 0; i < 2 * FRAME_16K; i++) out[f * FRAME_16K + i] = xq[i];
+    }
+}
+
+static const Model models[] = {
+    {"dred_encoder", 20.0, run_dred_encoder},
+    {"fargan", 10.0, run_fargan},
+    {"lace", 20.0, run_lace},
+};
+
+static double now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+#endif
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Median ns per frame over whole passes of the corpus for every level up to
+// arch. The levels take turns within each batch so the machine's drift hits
+// them all alike.
+static void time_model(const Model* model, const Model_Input* in, float* out, int arch, double* level_ns) {
+    double batch_ns[MAX_LEVELS][BATCHES];
+    int calls = (int)(FRAMES * 10.0 / model->frame_ms);
+    for (int b = 0; b < BATCHES; b++) {
+        for (int level = 0; level <= arch; level++) {
+            double start = now_ns();
+            model->run(in, out, level);
+            batch_ns[level][b] = (now_ns() - start) / calls;
+        }
+    }
+    for (int level = 0; level <= arch; level++) {
+        qsort(batch_ns[level], BATCHES, sizeof(double), compare_double);
+        level_ns[level] = batch_ns[level][BATCHES / 2];
+    }
+}
+
+static double max_difference(const float* a, const float* b, int count) {
+    double result = 0.0;
+    for (int i = 0; i < count; i++) {
+        double diff = fabs((double)a[i] - b[i]);
+        if (diff > result) result = diff;
+    }
+    return result;
+}
+
+static void usage(char* program) {
+    fprintf(stderr, "Usage: %s [output.json]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2) usage(argv[0]);
+    const char* output_path = argc == 2 ? argv[1] : NULL;
+
+    // 16 kHz speech, decimated from the 48 kHz corpus (its formants are all
+    // well below 8 kHz) and featurized once for every run
+    int samples = CORPUS_SECONDS * CORPUS_SAMPLE_RATE;
+    float* pcm48 = malloc(samples * sizeof(float));
+    float* pcm = malloc(FRAMES * FRAME_16K * sizeof(float));
+    float* features = calloc(FRAMES * NB_TOTAL_FEATURES, sizeof(float));
+    int out_count = FRAMES * FRAME_16K;
+    float* out = calloc(out_count, sizeof(float));
+    float* reference = calloc(out_count, sizeof(float));
+    corpus_generate_speech(pcm48, samples, 1);
+    for (int i = 0; i < FRAMES * FRAME_16K; i++) pcm[i] = pcm48[3 * i] * 32768.0f;
+
+    int arch = opus_select_arch();
+    LPCNetEncState* lpcnet = lpcnet_encoder_create();
+    for (int f = 0; f < FRAMES; f++) {
+        lpcnet_compute_single_frame_features_float(lpcnet, &pcm[f * FRAME_16K], &features[f * NB_TOTAL_FEATURES], arch);
+    }
+    lpcnet_encoder_destroy(lpcnet);
+
+    if (init_rdovaeenc(&rdovae_enc_model, rdovaeenc_arrays) != 0 || osce_load_models(&osce_model, NULL, 0) != 0) {
+        fprintf(stderr, "Failed to load the built-in model weights\n");
+        return 1;
+    }
+    osce_model.loaded = 1;
+
+    FILE* output = stdout;
+    if (output_path) {
+        output = fopen(output_path, "w");
+        if (!output) {
+            perror(output_path);
+            return 1;
+        }
+    }
+
+    Model_Input input = {.features = features, .pcm = pcm};
+    int reference_arch = arch < REFERENCE_ARCH ? arch : REFERENCE_ARCH;
+    fprintf(output, "{\n  \"arch\": %d,\n  \"results\": [", arch);
+    for (size_t m = 0; m < sizeof(models) / sizeof(models[0]); m++) {
+        double level_ns[MAX_LEVELS];
+        memset(reference, 0, out_count * sizeof(float));
+        models[m].run(&input, reference, reference_arch);
+        time_model(&models[m], &input, out, arch, level_ns);
+        for (int level = 0; level <= arch; level++) {
+            memset(out, 0, out_count * sizeof(float));
+            models[m].run(&input, out, level);
+            double difference = max_difference(reference, out, out_count);
+            double fps = 1e9 / level_ns[level];
+            double realtime = fps * models[m].frame_ms / 1000.0;
+
+            fprintf(stderr, "%-14s %-12s %9.1f us/frame %9.0f frames/s %7.1fx realtime  max diff vs %s %.2e\n",
+                    models[m].name, arch_names[level], level_ns[level] / 1000.0, fps, realtime, arch_names[reference_arch], difference);
+            fprintf(output, "%s\n    {\"model\": \"%s\", \"level\": \"%s\", \"us_per_frame\": %.2f, \"frames_per_second\": %.1f, \"realtime\": %.2f, \"max_diff\": %.3e}",
+                    m == 0 && level == 0 ? "" : ",", models[m].name, arch_names[level], level_ns[level] / 1000.0, fps, realtime, difference);
+        }
+    }
+    fprintf(output, "\n  ]\n}\n");
+    if (output != stdout) fclose(output);
+
+    free(pcm48);
+    free(pcm);
+    free(features);
+    free(out);
+    free(reference);
+    return 0;
+}
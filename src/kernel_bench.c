@@ -0,0 +1,418 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "main_FLP.h"
+#include "pitch_est_defines.h"
+#include "pitch.h"
+#include "mlp.h"
+#include "mapping_matrix.h"
+#include "cpu_support.h"
+#include "corpus.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Per-function benchmark of the SILK float analysis kernels, the tonality
+// analysis classifier layers and the projection (ambisonics) matrices. Every
+// kernel
+// runs twice on the same generated speech: the C version (which keeps using
+// the dispatched inner product) and whatever the library dispatches to on
+// this cpu (the SIMD version when there is one),
+// at the sizes the encoder calls them with at 16 kHz and the client's
+// complexity (the pitch search stages on the decimated 4 and 8 kHz signal). Reports ns per call and how far the dispatched output is from
+// C, as JSON so two builds can be diffed. Built against the internal opus
+// headers with the same defines as the archive, see run_bench in nob.c.
+
+#define CORPUS_SECONDS 2
+#define BATCH_CALLS 200
+#define BATCHES 51 // median of these
+
+// Encoder sizes at 16 kHz, complexity 8
+#define PITCH_LPC_WIN 384 // pitch_LPC_win_length
+#define PITCH_LPC_ORDER 16 // pitchEstimationLPCOrder
+#define SHAPE_WIN 240 // shapeWinLength
+#define SHAPE_ORDER 24 // shapingLPCOrder
+#define SHAPE_WARPING 0.24f // warping_Q16 / 65536 at 16 kHz
+#define LPC_ORDER 16 // predictLPCOrder
+#define LPC_SUBFR (80 + LPC_ORDER) // subframe plus the preceding samples
+#define LTP_SUBFR 80
+#define PITCH_SF_8KHZ (PE_SUBFR_LENGTH_MS * 8) // stage 1 runs this at 4 kHz too
+#define PITCH_MIN_LAG_4KHZ (PE_MIN_LAG_MS * 4)
+#define PITCH_MAX_LAG_4KHZ (PE_MAX_LAG_MS * 4)
+#define PITCH_MIN_LAG_8KHZ (PE_MIN_LAG_MS * 8)
+#define PITCH_MAX_LAG_8KHZ (PE_MAX_LAG_MS * 8)
+
+typedef struct {
+    const float* x; // input, with history in front for the LTP kernels
+    float out[SILK_MAX_ORDER_LPC * SILK_MAX_ORDER_LPC + 1];
+    int out_count;
+    int arch;
+} Kernel_Args;
+
+typedef void (*Kernel_Run)(Kernel_Args* args);
+
+typedef struct {
+    const char* name;
+    Kernel_Run c;
+    Kernel_Run dispatched;
+    int integer_input; // pitch stages see int16 valued samples in the encoder
+} Kernel;
+
+static void run_autocorrelation(Kernel_Args* a) {
+    silk_autocorrelation_FLP(a->out, a->x, PITCH_LPC_WIN, PITCH_LPC_ORDER + 1, a->arch);
+    a->out_count = PITCH_LPC_ORDER + 1;
+}
+
+static void run_autocorrelation_c(Kernel_Args* a) {
+    silk_autocorrelation_FLP_c(a->out, a->x, PITCH_LPC_WIN, PITCH_LPC_ORDER + 1, a->arch);
+    a->out_count = PITCH_LPC_ORDER + 1;
+}
+
+static void run_warped_autocorrelation(Kernel_Args* a) {
+    silk_warped_autocorrelation_FLP(a->out, a->x, SHAPE_WARPING, SHAPE_WIN, SHAPE_ORDER, a->arch);
+    a->out_count = SHAPE_ORDER + 1;
+}
+
+static void run_warped_autocorrelation_c(Kernel_Args* a) {
+    silk_warped_autocorrelation_FLP_c(a->out, a->x, SHAPE_WARPING, SHAPE_WIN, SHAPE_ORDER);
+    a->out_count = SHAPE_ORDER + 1;
+}
+
+static void run_burg_modified(Kernel_Args* a) {
+    a->out[LPC_ORDER] = silk_burg_modified_FLP(a->out, a->x, 1.0f / 1e4f, LPC_SUBFR, MAX_NB_SUBFR, LPC_ORDER, a->arch);
+    a->out_count = LPC_ORDER + 1;
+}
+
+static void run_burg_modified_c(Kernel_Args* a) {
+    a->out[LPC_ORDER] = silk_burg_modified_FLP_c(a->out, a->x, 1.0f / 1e4f, LPC_SUBFR, MAX_NB_SUBFR, LPC_ORDER, a->arch);
+    a->out_count = LPC_ORDER + 1;
+}
+
+static void run_corr_matrix(Kernel_Args* a) {
+    silk_corrMatrix_FLP(a->x, LTP_SUBFR, LTP_ORDER, a->out, a->arch);
+    a->out_count = LTP_ORDER * LTP_ORDER;
+}
+
+static void run_corr_matrix_c(Kernel_Args* a) {
+    silk_corrMatrix_FLP_c(a->x, LTP_SUBFR, LTP_ORDER, a->out, a->arch);
+    a->out_count = LTP_ORDER * LTP_ORDER;
+}
+
+static void run_corr_vector(Kernel_Args* a) {
+    silk_corrVector_FLP(a->x, a->x + MAX_PITCH_LAG_MS * 16, LTP_SUBFR, LTP_ORDER, a->out, a->arch);
+    a->out_count = LTP_ORDER;
+}
+
+static void run_corr_vector_c(Kernel_Args* a) {
+    silk_corrVector_FLP_c(a->x, a->x + MAX_PITCH_LAG_MS * 16, LTP_SUBFR, LTP_ORDER, a->out, a->arch);
+    a->out_count = LTP_ORDER;
+}
+
+// Stage 1 of the pitch search for one subframe, including its cross
+// correlation, over every lag
+static void run_pitch_stage1_with(Kernel_Args* a, int c) {
+    opus_val32 xcorr[PITCH_MAX_LAG_4KHZ - PITCH_MIN_LAG_4KHZ + 1];
+    const float* target = a->x + PITCH_MAX_LAG_4KHZ;
+    memset(a->out, 0, (PITCH_MAX_LAG_4KHZ + 1) * sizeof(float));
+    celt_pitch_xcorr(target, target - PITCH_MAX_LAG_4KHZ, xcorr, PITCH_SF_8KHZ,
+                     PITCH_MAX_LAG_4KHZ - PITCH_MIN_LAG_4KHZ + 1, a->arch);
+    if (c) silk_P_Ana_calc_corr_st1_FLP_c(a->out, xcorr, target, PITCH_SF_8KHZ, PITCH_MIN_LAG_4KHZ, PITCH_MAX_LAG_4KHZ, a->arch);
+    else silk_P_Ana_calc_corr_st1_FLP(a->out, xcorr, target, PITCH_SF_8KHZ, PITCH_MIN_LAG_4KHZ, PITCH_MAX_LAG_4KHZ, a->arch);
+    a->out_count = PITCH_MAX_LAG_4KHZ + 1;
+}
+
+static void run_pitch_stage1(Kernel_Args* a) {
+    run_pitch_stage1_with(a, 0);
+}
+
+static void run_pitch_stage1_c(Kernel_Args* a) {
+    run_pitch_stage1_with(a, 1);
+}
+
+// Stage 2 of the pitch search for one subframe over every lag, the worst
+// case: the encoder only asks for the lags around the stage 1 candidates
+static const opus_int16* pitch_stage2_lags(void) {
+    static opus_int16 lags[PITCH_MAX_LAG_8KHZ - PITCH_MIN_LAG_8KHZ + 1];
+    for (int i = 0; i < PITCH_MAX_LAG_8KHZ - PITCH_MIN_LAG_8KHZ + 1; i++) lags[i] = PITCH_MIN_LAG_8KHZ + i;
+    return lags;
+}
+
+static void run_pitch_stage2(Kernel_Args* a) {
+    memset(a->out, 0, (PITCH_MAX_LAG_8KHZ + 1) * sizeof(float));
+    silk_P_Ana_calc_corr_st2_FLP(a->out, a->x + PE_LTP_MEM_LENGTH_MS * 8, pitch_stage2_lags(),
+                                 PITCH_MAX_LAG_8KHZ - PITCH_MIN_LAG_8KHZ + 1, PITCH_SF_8KHZ, a->arch);
+    a->out_count = PITCH_MAX_LAG_8KHZ + 1;
+}
+
+static void run_pitch_stage2_c(Kernel_Args* a) {
+    memset(a->out, 0, (PITCH_MAX_LAG_8KHZ + 1) * sizeof(float));
+    silk_P_Ana_calc_corr_st2_FLP_c(a->out, a->x + PE_LTP_MEM_LENGTH_MS * 8, pitch_stage2_lags(),
+                                   PITCH_MAX_LAG_8KHZ - PITCH_MIN_LAG_8KHZ + 1, PITCH_SF_8KHZ, a->arch);
+    a->out_count = PITCH_MAX_LAG_8KHZ + 1;
+}
+
+// The speech/music classifier's first dense layer and its GRU, fed speech
+// samples in place of the 25 features (and the GRU state)
+static void run_mlp_dense(Kernel_Args* a) {
+    analysis_compute_dense(&layer0, a->out, a->x, a->arch);
+    a->out_count = layer0.nb_neurons;
+}
+
+static void run_mlp_dense_c(Kernel_Args* a) {
+    analysis_compute_dense_c(&layer0, a->out, a->x);
+    a->out_count = layer0.nb_neurons;
+}
+
+static void run_mlp_gru(Kernel_Args* a) {
+    memcpy(a->out, a->x + layer1.nb_inputs, layer1.nb_neurons * sizeof(float));
+    analysis_compute_gru(&layer1, a->out, a->x, a->arch);
+    a->out_count = layer1.nb_neurons;
+}
+
+static void run_mlp_gru_c(Kernel_Args* a) {
+    memcpy(a->out, a->x + layer1.nb_inputs, layer1.nb_neurons * sizeof(float));
+    analysis_compute_gru_c(&layer1, a->out, a->x);
+    a->out_count = layer1.nb_neurons;
+}
+
+static const Kernel kernels[] = {
+    {"autocorrelation", run_autocorrelation_c, run_autocorrelation},
+    {"warped_autocorrelation", run_warped_autocorrelation_c, run_warped_autocorrelation},
+    {"burg_modified", run_burg_modified_c, run_burg_modified},
+    {"corr_matrix", run_corr_matrix_c, run_corr_matrix},
+    {"corr_vector", run_corr_vector_c, run_corr_vector},
+    {"pitch_stage1", run_pitch_stage1_c, run_pitch_stage1, 1},
+    {"pitch_stage2", run_pitch_stage2_c, run_pitch_stage2, 1},
+    {"mlp_dense", run_mlp_dense_c, run_mlp_dense},
+    {"mlp_gru", run_mlp_gru_c, run_mlp_gru},
+};
+
+// The projection encoder's mixing and the decoder's demixing matrix at every
+// ambisonic order, over a 20 ms frame at 48 kHz: the per-channel loop they
+// used to run against the whole-frame kernel. Each channel is the speech
+// delayed by a few samples more than the one before.
+#define MATRIX_FRAME 960
+#define MATRIX_CALLS 20
+#define MATRIX_MAX_CHANNELS 38
+#define MATRIX_CHANNEL_DELAY 7
+
+typedef struct {
+    const char* name;
+    const MappingMatrix* matrix;
+    const opus_int16* data;
+    int data_size;
+    int demixing;
+} Matrix_Case;
+
+static const Matrix_Case matrix_cases[] = {
+    {"mixing_order1", &mapping_matrix_foa_mixing, mapping_matrix_foa_mixing_data, sizeof(mapping_matrix_foa_mixing_data), 0},
+    {"mixing_order2", &mapping_matrix_soa_mixing, mapping_matrix_soa_mixing_data, sizeof(mapping_matrix_soa_mixing_data), 0},
+    {"mixing_order3", &mapping_matrix_toa_mixing, mapping_matrix_toa_mixing_data, sizeof(mapping_matrix_toa_mixing_data), 0},
+    {"mixing_order4", &mapping_matrix_fourthoa_mixing, mapping_matrix_fourthoa_mixing_data, sizeof(mapping_matrix_fourthoa_mixing_data), 0},
+    {"mixing_order5", &mapping_matrix_fifthoa_mixing, mapping_matrix_fifthoa_mixing_data, sizeof(mapping_matrix_fifthoa_mixing_data), 0},
+    {"demixing_order1", &mapping_matrix_foa_demixing, mapping_matrix_foa_demixing_data, sizeof(mapping_matrix_foa_demixing_data), 1},
+    {"demixing_order2", &mapping_matrix_soa_demixing, mapping_matrix_soa_demixing_data, sizeof(mapping_matrix_soa_demixing_data), 1},
+    {"demixing_order3", &mapping_matrix_toa_demixing, mapping_matrix_toa_demixing_data, sizeof(mapping_matrix_toa_demixing_data), 1},
+    {"demixing_order4", &mapping_matrix_fourthoa_demixing, mapping_matrix_fourthoa_demixing_data, sizeof(mapping_matrix_fourthoa_demixing_data), 1},
+    {"demixing_order5", &mapping_matrix_fifthoa_demixing, mapping_matrix_fifthoa_demixing_data, sizeof(mapping_matrix_fifthoa_demixing_data), 1},
+};
+
+static void run_matrix(const Matrix_Case* test, const MappingMatrix* matrix, const float* in, float* out, int arch) {
+    int channels = matrix->rows;
+    if (test->demixing) {
+        mapping_matrix_multiply_frame_out_float(matrix, in, channels, out, channels, MATRIX_FRAME, arch);
+    } else {
+        mapping_matrix_multiply_frame_in_float(matrix, in, channels, out, channels, MATRIX_FRAME, arch);
+    }
+}
+
+static void run_matrix_per_channel(const Matrix_Case* test, const MappingMatrix* matrix, const float* in, float* out, int arch) {
+    // Same layout as the whole-frame version so the outputs compare directly
+    int channels = matrix->rows;
+    int stride = test->demixing ? channels : MAPPING_MATRIX_STRIDE(channels);
+    if (test->demixing) {
+        memset(out, 0, MATRIX_FRAME * channels * sizeof(float));
+        for (int c = 0; c < channels; c++) {
+            mapping_matrix_multiply_channel_out_float(matrix, in + c, c, channels, out, channels, MATRIX_FRAME);
+        }
+    } else {
+        for (int c = 0; c < channels; c++) {
+            mapping_matrix_multiply_channel_in_float(matrix, in, channels, out + c, c, stride, MATRIX_FRAME);
+        }
+    }
+    (void)arch;
+}
+
+static double now_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+#endif
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Median ns per call, walking the input along the corpus so the calls
+// don't all see the same frame
+static double time_kernel(Kernel_Run run, const float* pcm, int windows, int hop, int arch) {
+    double batch_ns[BATCHES];
+    Kernel_Args args = {.arch = arch};
+    for (int b = 0; b < BATCHES; b++) {
+        double start = now_ns();
+        for (int i = 0; i < BATCH_CALLS; i++) {
+            args.x = pcm + (size_t)((b * BATCH_CALLS + i) % windows) * hop;
+            run(&args);
+        }
+        batch_ns[b] = (now_ns() - start) / BATCH_CALLS;
+    }
+    qsort(batch_ns, BATCHES, sizeof(double), compare_double);
+    return batch_ns[BATCHES / 2];
+}
+
+// Largest difference from C over every window, relative to the largest C output
+static double max_error(const Kernel* kernel, const float* pcm, int windows, int hop, int arch) {
+    double max_diff = 0.0, max_ref = 0.0;
+    for (int w = 0; w < windows; w++) {
+        Kernel_Args ref = {.x = pcm + (size_t)w * hop, .arch = arch};
+        Kernel_Args got = ref;
+        kernel->c(&ref);
+        kernel->dispatched(&got);
+        for (int i = 0; i < ref.out_count; i++) {
+            double diff = fabs((double)ref.out[i] - got.out[i]);
+            if (diff > max_diff) max_diff = diff;
+            if (fabs(ref.out[i]) > max_ref) max_ref = fabs(ref.out[i]);
+        }
+    }
+    return max_ref > 0.0 ? max_diff / max_ref : max_diff;
+}
+
+typedef void (*Matrix_Run)(const Matrix_Case* test, const MappingMatrix* matrix, const float* in, float* out, int arch);
+
+// Median ns per 20 ms frame, walking the frames along the corpus
+static double time_matrix(Matrix_Run run, const Matrix_Case* test, const MappingMatrix* matrix, const float* frames, int frame_count,
+                          float* out, int arch) {
+    double batch_ns[BATCHES];
+    int channels = matrix->rows;
+    for (int b = 0; b < BATCHES; b++) {
+        double start = now_ns();
+        for (int i = 0; i < MATRIX_CALLS; i++) {
+            int frame = (b * MATRIX_CALLS + i) % frame_count;
+            run(test, matrix, frames + (size_t)frame * MATRIX_FRAME * channels, out, arch);
+        }
+        batch_ns[b] = (now_ns() - start) / MATRIX_CALLS;
+    }
+    qsort(batch_ns, BATCHES, sizeof(double), compare_double);
+    return batch_ns[BATCHES / 2];
+}
+
+// Largest difference from the per-channel loop over every frame, relative to
+// its largest output
+static double matrix_error(const Matrix_Case* test, const MappingMatrix* matrix, const float* frames, int frame_count, float* ref,
+                           float* got, int arch) {
+    double max_diff = 0.0, max_ref = 0.0;
+    int channels = matrix->rows;
+    int count = MATRIX_FRAME * (test->demixing ? channels : MAPPING_MATRIX_STRIDE(channels));
+    for (int f = 0; f < frame_count; f++) {
+        const float* in = frames + (size_t)f * MATRIX_FRAME * channels;
+        run_matrix_per_channel(test, matrix, in, ref, arch);
+        run_matrix(test, matrix, in, got, arch);
+        for (int i = 0; i < count; i++) {
+            if (!test->demixing && i % MAPPING_MATRIX_STRIDE(channels) >= channels) continue;
+            double diff = fabs((double)ref[i] - got[i]);
+            if (diff > max_diff) max_diff = diff;
+            if (fabs(ref[i]) > max_ref) max_ref = fabs(ref[i]);
+        }
+    }
+    return max_ref > 0.0 ? max_diff / max_ref : max_diff;
+}
+
+static void usage(char* program) {
+    fprintf(stderr, "Usage: %s [output.json]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2) usage(argv[0]);
+    const char* output_path = argc == 2 ? argv[1] : NULL;
+
+    // Every kernel reads at most this much from a window start
+    int span = MAX_NB_SUBFR * LPC_SUBFR;
+    if (span < PITCH_LPC_WIN) span = PITCH_LPC_WIN;
+    if (span < MAX_PITCH_LAG_MS * 16 + LTP_SUBFR) span = MAX_PITCH_LAG_MS * 16 + LTP_SUBFR;
+    int samples = CORPUS_SECONDS * CORPUS_SAMPLE_RATE;
+    int hop = 160; // 10 ms at 16 kHz
+    int windows = (samples - span) / hop;
+    float* pcm = malloc(samples * sizeof(float));
+    float* pcm_int = malloc(samples * sizeof(float));
+    corpus_generate_speech(pcm, samples, 1);
+    for (int i = 0; i < samples; i++) pcm_int[i] = (float)silk_float2int(pcm[i] * 16384.0f);
+    int arch = opus_select_arch();
+
+    FILE* out = stdout;
+    if (output_path) {
+        out = fopen(output_path, "w");
+        if (!out) {
+            perror(output_path);
+            return 1;
+        }
+    }
+
+    fprintf(out, "{\n  \"arch\": %d,\n  \"results\": [", arch);
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        const float* input = kernels[k].integer_input ? pcm_int : pcm;
+        double c_ns = time_kernel(kernels[k].c, input, windows, hop, arch);
+        double dispatched_ns = time_kernel(kernels[k].dispatched, input, windows, hop, arch);
+        double error = max_error(&kernels[k], input, windows, hop, arch);
+
+        fprintf(stderr, "%-24s c %8.1f ns/call  dispatched %8.1f ns/call  speedup %5.2fx  max rel error %.2e\n",
+                kernels[k].name, c_ns, dispatched_ns, c_ns / dispatched_ns, error);
+        fprintf(out, "%s\n    {\"kernel\": \"%s\", \"c_ns\": %.1f, \"dispatched_ns\": %.1f, \"speedup\": %.3f, \"max_rel_error\": %.3e}",
+                k == 0 ? "" : ",", kernels[k].name, c_ns, dispatched_ns, c_ns / dispatched_ns, error);
+    }
+
+    int frame_count = (samples - MATRIX_MAX_CHANNELS * MATRIX_CHANNEL_DELAY) / MATRIX_FRAME;
+    float* frames = malloc((size_t)samples * MATRIX_MAX_CHANNELS * sizeof(float));
+    float* ref = malloc(MATRIX_FRAME * MAPPING_MATRIX_STRIDE(MATRIX_MAX_CHANNELS) * sizeof(float));
+    float* got = malloc(MATRIX_FRAME * MAPPING_MATRIX_STRIDE(MATRIX_MAX_CHANNELS) * sizeof(float));
+    for (size_t m = 0; m < sizeof(matrix_cases) / sizeof(matrix_cases[0]); m++) {
+        const Matrix_Case* test = &matrix_cases[m];
+        MappingMatrix* matrix = malloc(mapping_matrix_get_size(test->matrix->rows, test->matrix->cols));
+        mapping_matrix_init(matrix, test->matrix->rows, test->matrix->cols, test->matrix->gain, test->data, test->data_size);
+        int channels = matrix->rows;
+        for (int i = 0; i < frame_count * MATRIX_FRAME; i++) {
+            for (int c = 0; c < channels; c++) frames[(size_t)i * channels + c] = pcm[i + c * MATRIX_CHANNEL_DELAY];
+        }
+        double c_ns = time_matrix(run_matrix_per_channel, test, matrix, frames, frame_count, ref, arch);
+        double dispatched_ns = time_matrix(run_matrix, test, matrix, frames, frame_count, got, arch);
+        double error = matrix_error(test, matrix, frames, frame_count, ref, got, arch);
+
+        fprintf(stderr, "%-24s c %8.1f ns/call  dispatched %8.1f ns/call  speedup %5.2fx  max rel error %.2e\n",
+                test->name, c_ns, dispatched_ns, c_ns / dispatched_ns, error);
+        fprintf(out, ",\n    {\"kernel\": \"%s\", \"c_ns\": %.1f, \"dispatched_ns\": %.1f, \"speedup\": %.3f, \"max_rel_error\": %.3e}",
+                test->name, c_ns, dispatched_ns, c_ns / dispatched_ns, error);
+        free(matrix);
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) fclose(out);
+
+    free(frames);
+    free(ref);
+    free(got);
+
+    free(pcm);
+    free(pcm_int);
+    return 0;
+}
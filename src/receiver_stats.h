@@ -0,0 +1,128 @@
+#ifndef RECEIVER_STATS_H
+#define RECEIVER_STATS_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+
+#define REPORT_INTERVAL_MS 1000 // how often the receiver reports back to the sender
+#define DELAY_BASELINE_REPORTS 30 // reports the minimum transit time is remembered for
+#define SEQ_MAX_MISORDER 100 // frames a sequence number may jump back before we take it as a restart
+
+// What goes into a receiver report, see the message layout in client.cpp
+struct ReceiverReport {
+    uint32_t highest_seq;
+    unsigned fraction_lost; // /256
+    uint32_t jitter_us;
+    uint32_t queue_delay_us;
+    int32_t trend_us;
+};
+
+// Receiver side of the feedback loop. Tracks sequence gaps, RFC 3550 style
+// interarrival jitter and how far the one-way transit time sits above the
+// lowest one seen recently, which is the queue building up somewhere between
+// the two clients (clocks don't need to agree, only their offset is cancelled).
+// Only touched from the receiver thread.
+class ReceiverStats {
+private:
+    bool started = false;
+    uint32_t highest_seq = 0;
+    uint32_t interval_base_seq = 0;
+    uint32_t interval_received = 0;
+    uint32_t interval_dtx_gap = 0;
+    bool last_was_dtx = false;
+    int32_t last_transit = 0;
+    double jitter_us = 0.0;
+    int64_t interval_transit_sum = 0;
+    int32_t interval_min_transit = INT32_MAX;
+    int32_t baseline[DELAY_BASELINE_REPORTS];
+    int baseline_count = 0;
+    int baseline_next = 0;
+    int64_t last_queue_delay_us = 0;
+    uint32_t last_report_ms = 0;
+
+public:
+    // One call per message, frames is how many consecutive frames from seq on
+    // it carried
+    void on_audio(uint32_t seq, uint32_t send_ms, uint32_t arrival_ms, bool dtx, int frames = 1) {
+        int32_t transit = static_cast<int32_t>(arrival_ms - send_ms);
+        if (!started) {
+            started = true;
+            highest_seq = seq;
+            interval_base_seq = seq;
+            last_transit = transit;
+            last_report_ms = arrival_ms;
+        }
+
+        // A sender that restarted under the same stream id (or a sequence
+        // number that jumped back further than reordering explains) carries
+        // on from the new numbers, what this interval already got counts as
+        // expected
+        if (static_cast<int32_t>(seq - highest_seq) < -SEQ_MAX_MISORDER) {
+            highest_seq = seq - 1;
+            interval_base_seq = seq - interval_received;
+            interval_dtx_gap = 0;
+        }
+
+        uint32_t last_seq = seq + frames - 1;
+        if (static_cast<int32_t>(last_seq - highest_seq) > 0) {
+            // Silence frames the relay dropped after a DTX frame aren't loss
+            if (last_was_dtx && static_cast<int32_t>(seq - highest_seq) > 1) {
+                interval_dtx_gap += seq - highest_seq - 1;
+            }
+            highest_seq = last_seq;
+        }
+        interval_received += frames;
+        last_was_dtx = dtx;
+
+        double d = std::abs(static_cast<double>(transit - last_transit)) * 1000.0;
+        jitter_us += (d - jitter_us) / 16.0;
+        last_transit = transit;
+
+        interval_transit_sum += transit;
+        interval_min_transit = std::min(interval_min_transit, transit);
+    }
+
+    bool report_due(uint32_t now) {
+        return started && interval_received > 0 && now - last_report_ms >= REPORT_INTERVAL_MS;
+    }
+
+    ReceiverReport make_report(uint32_t now) {
+        // The sequence can end up behind the interval's start, e.g. when only
+        // late frames arrived since the last report, so never expect fewer
+        // frames than we got
+        int64_t span = static_cast<int64_t>(static_cast<int32_t>(highest_seq - interval_base_seq)) + 1;
+        int64_t expected = std::max<int64_t>(span - interval_dtx_gap, interval_received);
+        int64_t lost = expected - interval_received;
+
+        ReceiverReport report;
+        report.highest_seq = highest_seq;
+        report.fraction_lost = expected > 0 ? static_cast<unsigned>(std::min<int64_t>(255, lost * 256 / expected)) : 0;
+
+        baseline[baseline_next] = interval_min_transit;
+        baseline_next = (baseline_next + 1) % DELAY_BASELINE_REPORTS;
+        baseline_count = std::min(baseline_count + 1, DELAY_BASELINE_REPORTS);
+        int32_t min_transit = *std::min_element(baseline, baseline + baseline_count);
+
+        int64_t mean_transit = interval_received > 0
+            ? interval_transit_sum / static_cast<int64_t>(interval_received)
+            : min_transit;
+        int64_t queue_delay_us = (mean_transit - min_transit) * 1000;
+        int64_t trend_us = queue_delay_us - last_queue_delay_us;
+
+        report.jitter_us = static_cast<uint32_t>(jitter_us);
+        report.queue_delay_us = static_cast<uint32_t>(queue_delay_us);
+        report.trend_us = static_cast<int32_t>(trend_us);
+
+        last_queue_delay_us = queue_delay_us;
+        last_report_ms = now;
+        interval_base_seq = highest_seq + 1;
+        interval_received = 0;
+        interval_dtx_gap = 0;
+        interval_transit_sum = 0;
+        interval_min_transit = INT32_MAX;
+        return report;
+    }
+};
+
+#endif // RECEIVER_STATS_H
@@ -8,11 +8,61 @@
 #include <fcntl.h>
 #include <assert.h>
 #include <pthread.h>
+#include <signal.h>
 #include <sys/socket.h>
+#include <opus.h>
 #define NOB_IMPLEMENATION
 #include "../nob.h"
 
-#define MAX_CLIENTS 2
+#define MAX_CLIENTS 16
+#define MAX_MESSAGE_SIZE (1500 + 32) // Opus packet plus the client's message header
+
+// Message layout, keep in sync with src/client.cpp
+#define MESSAGE_AUDIO 1
+#define MESSAGE_LISTENER_CONFIG 3
+#define AUDIO_HEADER_SIZE 5
+#define EXTENSION_FRAME_INFO 120 // on the first frame: u16 sequence number, u8 audio level per frame, i8 or i16 clock offset
+#define FRAME_INFO_HEADER_SIZE 2
+#define FRAME_INFO_FRAME_MS 20 // the clock offset counts from this much per sequence number
+#define FRAME_INFO_CLOCK_MAX 2
+#define LEVEL_ACTIVE 0x80 // in the audio level, clear on DTX silence frames
+#define LISTENER_CONFIG_SIZE 2
+#define LISTENER_SPLIT_FRAMES 0x01 // wants one Opus frame per audio message
+#define DTX_KEEPALIVE_FRAMES 20 // forward one silence frame every 400ms
+#define MAX_PACKET_FRAMES 48 // an Opus packet holds at most 120ms of 2.5ms frames
+// Every frame of a packet as its own length-prefixed message, each frame gains
+// at most its TOC, frame count and padding length bytes and its own frame info
+// on top of the headers
+#define SPLIT_BUFFER_SIZE (MAX_MESSAGE_SIZE + MAX_PACKET_FRAMES * \
+    (sizeof(uint32_t) + AUDIO_HEADER_SIZE + 3 + 1 + FRAME_INFO_HEADER_SIZE + 1 + FRAME_INFO_CLOCK_MAX))
+// Messages waiting for one listener, about 640ms of 20ms frames. A listener
+// that falls further behind loses the oldest ones, the others never wait on it.
+#define SEND_QUEUE_MESSAGES 32
+
+typedef struct {
+    unsigned char data[SPLIT_BUFFER_SIZE];
+    size_t size;
+} queued_message;
+
+// What a listener's sender thread writes out. The slot's queue lives as long
+// as the relay, generation tells the connections that use it apart.
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t ready;
+    queued_message *messages;
+    int head;
+    int count;
+    unsigned generation; // changed under clients_mutex too
+    bool closed;
+    size_t dropped;
+} send_queue;
+
+// A listener as the forwarding loop sees it, taken under clients_mutex
+typedef struct {
+    int index;
+    unsigned generation;
+    bool split_frames;
+} forward_target;
 
 typedef struct {
     int fd;
@@ -20,59 +70,310 @@ typedef struct {
     int index;
     bool active;
     pthread_t thread_id;
+    bool in_dtx;
+    int dtx_since_forward;
+    size_t dtx_skipped;
+    bool split_frames; // set from the client's listener config, under clients_mutex
+    send_queue queue;
+    pthread_t sender_id;
 } client_info;
 
 
 bool echoMode = false;
+volatile sig_atomic_t stopping = 0;
 
 client_info clients[MAX_CLIENTS];
 int client_count = 0;
 pthread_mutex_t clients_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+bool read_all(int fd, void *buff, size_t size) {
+    char *p = buff;
+    while (size > 0) {
+        int read_count = read(fd, p, size);
+        if (read_count <= 0) return false;
+        p += read_count;
+        size -= read_count;
+    }
+    return true;
+}
+
+bool write_all(int fd, const void *buff, size_t size) {
+    const char *p = buff;
+    while (size > 0) {
+        int write_count = write(fd, p, size);
+        if (write_count <= 0) return false;
+        p += write_count;
+        size -= write_count;
+    }
+    return true;
+}
+
+// A single DTX frame, told by its frame info. The sender writes that first
+// in the padding, so the lookup doesn't walk the rest of it.
+bool is_silence(const unsigned char *message, uint32_t size) {
+    if (message[0] != MESSAGE_AUDIO || size <= AUDIO_HEADER_SIZE) return false;
+    const unsigned char *payload = message + AUDIO_HEADER_SIZE;
+    opus_int32 payload_size = size - AUDIO_HEADER_SIZE;
+    if (opus_packet_get_nb_frames(payload, payload_size) != 1) return false;
+
+    const unsigned char *padding, *info;
+    opus_int32 padding_size = opus_packet_get_extensions(payload, payload_size, &padding);
+    if (padding_size <= 0) return false;
+    opus_int32 info_size = opus_packet_extensions_find(padding, padding_size, EXTENSION_FRAME_INFO, 0, &info);
+    return info && info_size > FRAME_INFO_HEADER_SIZE + 1 && !(info[FRAME_INFO_HEADER_SIZE] & LEVEL_ACTIVE);
+}
+
+// Silence frames are only worth forwarding when they start a silent stretch
+// (so the receiver switches to comfort noise) and every so often after that
+// as a keepalive, everything in between is dropped here.
+bool should_forward(client_info *client, const unsigned char *message, uint32_t size) {
+    bool dtx = is_silence(message, size);
+    if (!dtx) {
+        client->in_dtx = false;
+        return true;
+    }
+
+    if (!client->in_dtx || ++client->dtx_since_forward >= DTX_KEEPALIVE_FRAMES) {
+        client->in_dtx = true;
+        client->dtx_since_forward = 0;
+        return true;
+    }
+
+    client->dtx_skipped++;
+    return false;
+}
+
+// Rewrites an audio message carrying several Opus frames (a sender aggregating
+// on a slow link) as one length-prefixed audio message per frame, for
+// listeners that asked to keep getting single-frame packets. Each frame gets
+// a frame info of its own, with its sequence number and level and a clock
+// offset that still comes to the packet's clock. Returns the bytes written to out, 0 when the message goes
+// out as is (not audio, a single frame, or unparsable).
+size_t split_frames(OpusRepacketizer *rp, const unsigned char *message, uint32_t size, unsigned char *out) {
+    if (message[0] != MESSAGE_AUDIO || size <= AUDIO_HEADER_SIZE) return 0;
+    const unsigned char *payload = message + AUDIO_HEADER_SIZE;
+    opus_int32 payload_size = size - AUDIO_HEADER_SIZE;
+    int frames = opus_packet_get_nb_frames(payload, payload_size);
+    if (frames <= 1) return 0;
+
+    const unsigned char *padding, *info;
+    opus_int32 padding_size = opus_packet_get_extensions(payload, payload_size, &padding);
+    if (padding_size <= 0) return 0;
+    opus_int32 info_size = opus_packet_extensions_find(padding, padding_size, EXTENSION_FRAME_INFO, 0, &info);
+    const unsigned char *clock = info + FRAME_INFO_HEADER_SIZE + frames;
+    int32_t offset;
+    switch (info_size - FRAME_INFO_HEADER_SIZE - frames) {
+    case 1: offset = (int8_t)clock[0]; break;
+    case 2: offset = (int16_t)((clock[0] << 8) | clock[1]); break;
+    default: return 0;
+    }
+    unsigned seq = (info[0] << 8) | info[1];
+
+    opus_repacketizer_init(rp);
+    if (opus_repacketizer_cat(rp, payload, payload_size) != OPUS_OK) return 0;
+
+    size_t written = 0;
+    for (int i = 0; i < frames; i++) {
+        unsigned char *frame = out + written;
+        opus_int32 room = SPLIT_BUFFER_SIZE - written - sizeof(uint32_t) - AUDIO_HEADER_SIZE;
+        unsigned char *packet = frame + sizeof(uint32_t) + AUDIO_HEADER_SIZE;
+        opus_int32 len = opus_repacketizer_out_range(rp, i, i + 1, packet, room);
+        // The first frame brings the whole packet's frame info along
+        if (len > 0) len = opus_packet_unpad(packet, len);
+        if (len < 0) return 0;
+
+        unsigned char frame_info[FRAME_INFO_HEADER_SIZE + 1 + FRAME_INFO_CLOCK_MAX];
+        frame_info[0] = (unsigned char)((seq + i) >> 8);
+        frame_info[1] = (unsigned char)(seq + i);
+        frame_info[FRAME_INFO_HEADER_SIZE] = info[FRAME_INFO_HEADER_SIZE + i];
+        // Counted from this frame instead of the packet's last one
+        int32_t frame_offset = offset + FRAME_INFO_FRAME_MS * (frames - 1 - i);
+        int frame_info_size = FRAME_INFO_HEADER_SIZE + 1;
+        if (frame_offset >= INT8_MIN && frame_offset <= INT8_MAX) {
+            frame_info[frame_info_size++] = (unsigned char)frame_offset;
+        } else {
+            frame_info[frame_info_size++] = (unsigned char)((uint16_t)frame_offset >> 8);
+            frame_info[frame_info_size++] = (unsigned char)frame_offset;
+        }
+        OpusExtensionData extension = {EXTENSION_FRAME_INFO, 0, frame_info, frame_info_size};
+        len = opus_packet_add_extensions(packet, len, room, &extension, 1);
+        if (len < 0) return 0;
+
+        uint32_t message_size = htonl(AUDIO_HEADER_SIZE + len);
+        memcpy(frame, &message_size, sizeof(message_size));
+        memcpy(frame + sizeof(uint32_t), message, AUDIO_HEADER_SIZE);
+        written += sizeof(uint32_t) + AUDIO_HEADER_SIZE + len;
+    }
+    return written;
+}
+
+// Queues one message for a listener, unless the connection it was meant for
+// has gone. A full queue drops its oldest message.
+void queue_push(send_queue *queue, unsigned generation, const unsigned char *data, size_t size) {
+    pthread_mutex_lock(&queue->mutex);
+    if (queue->generation == generation && !queue->closed) {
+        if (queue->count == SEND_QUEUE_MESSAGES) {
+            queue->head = (queue->head + 1) % SEND_QUEUE_MESSAGES;
+            queue->count--;
+            queue->dropped++;
+        }
+        queued_message *slot = &queue->messages[(queue->head + queue->count) % SEND_QUEUE_MESSAGES];
+        memcpy(slot->data, data, size);
+        slot->size = size;
+        queue->count++;
+        pthread_cond_signal(&queue->ready);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+// Writes a listener's queue out until its connection closes. A write that
+// fails shuts the socket down, so the client's own thread sees it and cleans up.
+void *send_loop(void *arg) {
+    client_info *client = (client_info *)arg;
+    send_queue *queue = &client->queue;
+    unsigned char *data = malloc(SPLIT_BUFFER_SIZE);
+    if (!data) {
+        perror("malloc failed");
+        shutdown(client->fd, SHUT_RDWR);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&queue->mutex);
+    while (true) {
+        while (queue->count == 0 && !queue->closed) pthread_cond_wait(&queue->ready, &queue->mutex);
+        if (queue->closed) break;
+        queued_message *message = &queue->messages[queue->head];
+        size_t size = message->size;
+        memcpy(data, message->data, size);
+        queue->head = (queue->head + 1) % SEND_QUEUE_MESSAGES;
+        queue->count--;
+
+        pthread_mutex_unlock(&queue->mutex);
+        bool ok = write_all(client->fd, data, size);
+        pthread_mutex_lock(&queue->mutex);
+        if (!ok) {
+            queue->closed = true;
+            shutdown(client->fd, SHUT_RDWR);
+        }
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    free(data);
+    return NULL;
+}
+
+void handle_stop(int sig) {
+    (void)sig;
+    stopping = 1;
+}
+
 void *handle_client(void *arg) {
     client_info *client = (client_info *)arg;
     int client_fd = client->fd;
     int client_index = client->index;
 
+    // Stop signals are for the accept loop in main
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, NULL);
+
     printf("Thread started for client %d\n", client_index);
     
-    float* buff = (float*)malloc(48000 * 2 * sizeof(float) + 128);
-    if (!buff) {
+    // Length prefix followed by the message, forwarded as one write
+    unsigned char* buff = (unsigned char*)malloc(sizeof(uint32_t) + MAX_MESSAGE_SIZE);
+    unsigned char* split = (unsigned char*)malloc(SPLIT_BUFFER_SIZE);
+    OpusRepacketizer* rp = opus_repacketizer_create();
+    bool sending = false;
+    if (!buff || !split || !rp) {
         perror("malloc failed");
         goto cleanup;
     }
+    if (pthread_create(&client->sender_id, NULL, send_loop, client) != 0) {
+        perror("pthread_create failed");
+        goto cleanup;
+    }
+    sending = true;
 
     while (true) {
-        int read_count = read(client_fd, buff, 48000 * 2 * sizeof(float) + 128);
-        if (read_count <= 0) {
+        uint32_t message_size;
+        if (!read_all(client_fd, buff, sizeof(message_size))) {
+            break;
+        }
+        memcpy(&message_size, buff, sizeof(message_size));
+        message_size = ntohl(message_size);
+        if (message_size == 0 || message_size > MAX_MESSAGE_SIZE) {
+            fprintf(stderr, "Client %d sent a bad message size: %u\n", client_index, message_size);
+            break;
+        }
+        if (!read_all(client_fd, buff + sizeof(message_size), message_size)) {
             break;
         }
+        size_t frame_size = sizeof(message_size) + message_size;
+        const unsigned char *message = buff + sizeof(message_size);
+
+        // Listener preferences stay with the relay
+        if (message[0] == MESSAGE_LISTENER_CONFIG) {
+            if (message_size >= LISTENER_CONFIG_SIZE) {
+                pthread_mutex_lock(&clients_mutex);
+                client->split_frames = (message[1] & LISTENER_SPLIT_FRAMES) != 0;
+                pthread_mutex_unlock(&clients_mutex);
+            }
+            continue;
+        }
 
+        if (!should_forward(client, message, message_size)) {
+            continue;
+        }
+
+        // Who gets it is decided under the lock, the copying and splitting
+        // happen after it
+        forward_target targets[MAX_CLIENTS];
+        int target_count = 0;
         pthread_mutex_lock(&clients_mutex);
-        
         if (client_count == 1 && echoMode) {
             // Echo mode - single client
-            if (write(client_fd, buff, read_count) <= 0) {
-                pthread_mutex_unlock(&clients_mutex);
-                break;
-            }
-        } else if (client_count == 2) {
-            // Forward mode - send to other client
-            int other_index = (client_index == 0) ? 1 : 0;
-            if (clients[other_index].active) {
-                if (write(clients[other_index].fd, buff, read_count) <= 0) {
-                    pthread_mutex_unlock(&clients_mutex);
-                    break;
-                }
+            targets[target_count++] = (forward_target){client_index, client->queue.generation, client->split_frames};
+        } else if (client_count >= 2) {
+            // Forward mode - send to every other client
+            for (int other_index = 0; other_index < MAX_CLIENTS; other_index++) {
+                client_info *other = &clients[other_index];
+                if (other_index == client_index || !other->active) continue;
+                targets[target_count++] = (forward_target){other_index, other->queue.generation, other->split_frames};
             }
         }
-        
         pthread_mutex_unlock(&clients_mutex);
+
+        // The split is done at most once per message, for the first listener
+        // that asked for single frames
+        long split_size = -1;
+        for (int t = 0; t < target_count; t++) {
+            send_queue *queue = &clients[targets[t].index].queue;
+            if (targets[t].split_frames && split_size < 0) {
+                split_size = split_frames(rp, message, message_size, split);
+            }
+            if (targets[t].split_frames && split_size > 0) {
+                queue_push(queue, targets[t].generation, split, split_size);
+            } else {
+                queue_push(queue, targets[t].generation, buff, frame_size);
+            }
+        }
     }
 
 cleanup:
-    printf("Client %d disconnected\n", client_index);
+    // Wake the sender and stop it mid-write if the peer stopped reading
+    pthread_mutex_lock(&client->queue.mutex);
+    client->queue.closed = true;
+    pthread_cond_signal(&client->queue.ready);
+    pthread_mutex_unlock(&client->queue.mutex);
+    shutdown(client_fd, SHUT_RDWR);
+    if (sending) pthread_join(client->sender_id, NULL);
+
+    printf("Client %d disconnected (%zu silence frames not forwarded, %zu dropped for a slow link)\n",
+           client_index, client->dtx_skipped, client->queue.dropped);
     free(buff);
+    free(split);
+    if (rp) opus_repacketizer_destroy(rp);
     
     pthread_mutex_lock(&clients_mutex);
     close(client_fd);
@@ -107,6 +408,17 @@ int main(int argc, char** argv) {
         }
     }
 
+    // A peer leaving mid-write must not take the relay down with it
+    signal(SIGPIPE, SIG_IGN);
+
+    // SIGINT/SIGTERM interrupt accept and let main return normally, so
+    // atexit work (like writing PGO profiles) still happens
+    struct sigaction stop_action = {0};
+    stop_action.sa_handler = handle_stop;
+    sigemptyset(&stop_action.sa_mask);
+    sigaction(SIGINT, &stop_action, NULL);
+    sigaction(SIGTERM, &stop_action, NULL);
+
     int server_fd;
     struct sockaddr_in address;
     int addrlen = sizeof(address);
@@ -117,6 +429,13 @@ int main(int argc, char** argv) {
         clients[i].fd = -1;
         clients[i].active = false;
         clients[i].index = i;
+        pthread_mutex_init(&clients[i].queue.mutex, NULL);
+        pthread_cond_init(&clients[i].queue.ready, NULL);
+        clients[i].queue.messages = malloc(SEND_QUEUE_MESSAGES * sizeof(queued_message));
+        if (!clients[i].queue.messages) {
+            perror("malloc failed");
+            exit(EXIT_FAILURE);
+        }
     }
 
     if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
@@ -153,13 +472,13 @@ int main(int argc, char** argv) {
 
     printf("Listening on %s:%d...\n", hostname, port);
 
-    while (true) {
+    while (!stopping) {
         int client_fd;
         struct sockaddr_in client_addr;
         socklen_t client_addrlen = sizeof(client_addr);
 
         if ((client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &client_addrlen)) < 0) {
-            perror("accept failed");
+            if (!stopping) perror("accept failed");
             continue;
         }
 
@@ -192,6 +511,18 @@ int main(int argc, char** argv) {
         clients[client_index].fd = client_fd;
         clients[client_index].addr = client_addr;
         clients[client_index].active = true;
+        clients[client_index].in_dtx = false;
+        clients[client_index].dtx_since_forward = 0;
+        clients[client_index].dtx_skipped = 0;
+        clients[client_index].split_frames = false;
+        send_queue *queue = &clients[client_index].queue;
+        pthread_mutex_lock(&queue->mutex);
+        queue->generation++;
+        queue->head = 0;
+        queue->count = 0;
+        queue->closed = false;
+        queue->dropped = 0;
+        pthread_mutex_unlock(&queue->mutex);
         client_count++;
 
         printf("Connection accepted from %s:%d (client %d/%d)\n", 
@@ -212,6 +543,7 @@ int main(int argc, char** argv) {
         pthread_mutex_unlock(&clients_mutex);
     }
 
+    printf("Shutting down\n");
     close(server_fd);
     return 0;
 }
\ No newline at end of file
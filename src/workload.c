@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/tcp.h>
+#include <opus.h>
+#include "corpus.h"
+
+// Headless run of what a call does to the codec and the relay, used by the
+// PGO build in nob.c to train the profile and to time the result
+
+#define SAMPLE_RATE 48000
+#define CHANNELS 1
+#define FRAME_SIZE 960
+#define MAX_PACKET_SIZE 1500
+#define CORPUS_SECONDS 60
+#define LOSS_EVERY 50 // every 50th packet is treated as lost to run FEC/PLC in the decoder
+
+// Message layout, keep in sync with src/client.cpp
+#define MESSAGE_AUDIO 1
+#define AUDIO_HEADER_SIZE 5
+#define EXTENSION_FRAME_INFO 120
+#define FRAME_INFO_HEADER_SIZE 2 // then one level per frame and the clock offset
+#define LEVEL_ACTIVE 0x80
+#define LEVEL_SILENT 127
+#define DTX_MAX_PAYLOAD 2
+#define SPEECH_LEVEL 30 // -dBov the frame info claims for every active frame
+
+#define RELAY_CLIENTS 4
+#define RELAY_ROUNDS 20 // passes over the encoded corpus per client
+#define CONNECT_ATTEMPTS 100 // 20ms apart, the relay may still be starting
+
+typedef struct {
+    unsigned char data[MAX_PACKET_SIZE];
+    int size;
+} Packet;
+
+typedef struct {
+    Packet* packets;
+    int count;
+} Packets;
+
+double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+bool load_corpus(const char* path, float** pcm, int* samples) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    *samples = size / sizeof(float);
+    *pcm = malloc(*samples * sizeof(float));
+    bool ok = *pcm && fread(*pcm, sizeof(float), *samples, f) == (size_t)*samples;
+    fclose(f);
+    return ok;
+}
+
+// Same encoder settings the client starts a call with. The cold start is what
+// joining a call costs right after launch: creating both ends and getting the
+// first frame through each while the codec's code and tables are still cold.
+bool run_codec(const float* pcm, int frames, Packets* out, double* encode_us, double* decode_us, double* cold_start_us) {
+    int error;
+    double setup_start = now_seconds();
+    OpusEncoder* encoder = opus_encoder_create(SAMPLE_RATE, CHANNELS, OPUS_APPLICATION_VOIP, &error);
+    if (error != OPUS_OK) {
+        fprintf(stderr, "Failed to create Opus encoder: %s\n", opus_strerror(error));
+        return false;
+    }
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(16000));
+    opus_encoder_ctl(encoder, OPUS_SET_VBR(1));
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(8));
+    opus_encoder_ctl(encoder, OPUS_SET_DTX(1));
+
+    OpusDecoder* decoder = opus_decoder_create(SAMPLE_RATE, CHANNELS, &error);
+    if (error != OPUS_OK) {
+        fprintf(stderr, "Failed to create Opus decoder: %s\n", opus_strerror(error));
+        opus_encoder_destroy(encoder);
+        return false;
+    }
+
+    double setup_us = (now_seconds() - setup_start) * 1e6;
+
+    out->packets = malloc(frames * sizeof(Packet));
+    out->count = frames;
+
+    double start = now_seconds();
+    for (int i = 0; i < frames; i++) {
+        // Halfway through the congestion controller would have seen loss
+        if (i == frames / 2) {
+            opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(5));
+            opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(1));
+        }
+        out->packets[i].size = opus_encode_float(encoder, pcm + i * FRAME_SIZE * CHANNELS, FRAME_SIZE,
+                                                 out->packets[i].data, MAX_PACKET_SIZE);
+        if (out->packets[i].size < 0) {
+            fprintf(stderr, "Opus encode error: %s\n", opus_strerror(out->packets[i].size));
+            return false;
+        }
+        if (i == 0) *cold_start_us = setup_us + (now_seconds() - start) * 1e6;
+    }
+    *encode_us = (now_seconds() - start) * 1e6 / frames;
+
+    float decoded[FRAME_SIZE * CHANNELS];
+    start = now_seconds();
+    for (int i = 0; i < frames; i++) {
+        int decoded_samples;
+        if (i % LOSS_EVERY == LOSS_EVERY - 1 && i + 1 < frames) {
+            decoded_samples = opus_decode_float(decoder, out->packets[i + 1].data, out->packets[i + 1].size,
+                                                decoded, FRAME_SIZE, 1);
+        } else {
+            decoded_samples = opus_decode_float(decoder, out->packets[i].data, out->packets[i].size,
+                                                decoded, FRAME_SIZE, 0);
+        }
+        if (decoded_samples < 0) {
+            fprintf(stderr, "Opus decode error: %s\n", opus_strerror(decoded_samples));
+            return false;
+        }
+        if (i == 0) *cold_start_us += (now_seconds() - start) * 1e6;
+    }
+    *decode_us = (now_seconds() - start) * 1e6 / frames;
+
+    opus_encoder_destroy(encoder);
+    opus_decoder_destroy(decoder);
+    return true;
+}
+
+typedef struct {
+    int fd;
+    long messages;
+} Relay_Reader;
+
+void* relay_reader(void* arg) {
+    Relay_Reader* reader = arg;
+    unsigned char buff[64 * 1024];
+    size_t pending = 0;
+
+    while (true) {
+        int read_count = read(reader->fd, buff + pending, sizeof(buff) - pending);
+        if (read_count <= 0) break;
+        pending += read_count;
+
+        // Count whole length-prefixed messages, keep the partial tail
+        size_t offset = 0;
+        while (pending - offset >= sizeof(uint32_t)) {
+            uint32_t size;
+            memcpy(&size, buff + offset, sizeof(size));
+            size = ntohl(size);
+            if (pending - offset < sizeof(size) + size) break;
+            offset += sizeof(size) + size;
+            reader->messages++;
+        }
+        memmove(buff, buff + offset, pending - offset);
+        pending -= offset;
+    }
+    return NULL;
+}
+
+int connect_relay(const char* host, int port) {
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) <= 0) {
+        fprintf(stderr, "Invalid relay address: %s\n", host);
+        return -1;
+    }
+
+    for (int attempt = 0; attempt < CONNECT_ATTEMPTS; attempt++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            perror("socket failed");
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            int flag = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+            return fd;
+        }
+        close(fd);
+        usleep(20 * 1000);
+    }
+    perror("connect failed");
+    return -1;
+}
+
+// Every client pushes the encoded corpus through the relay as fast as it
+// takes it while the others drain what gets forwarded to them
+bool run_relay(const char* host, int port, const Packets* packets, double* messages_per_sec) {
+    int fds[RELAY_CLIENTS];
+    Relay_Reader readers[RELAY_CLIENTS];
+    pthread_t threads[RELAY_CLIENTS];
+
+    for (int c = 0; c < RELAY_CLIENTS; c++) {
+        fds[c] = connect_relay(host, port);
+        if (fds[c] < 0) return false;
+        readers[c].fd = fds[c];
+        readers[c].messages = 0;
+    }
+    // Let the relay register everyone before the first message
+    usleep(100 * 1000);
+
+    // Every packet with the frame info the client adds, once up front
+    Packet* wire = malloc(packets->count * sizeof(Packet));
+    for (int i = 0; i < packets->count; i++) {
+        // Sent right on time, the clock offset is 0
+        unsigned char info[FRAME_INFO_HEADER_SIZE + 2] = {0};
+        uint16_t seq = htons((uint16_t)i);
+        memcpy(info, &seq, 2);
+        info[FRAME_INFO_HEADER_SIZE] = packets->packets[i].size <= DTX_MAX_PAYLOAD ? LEVEL_SILENT : LEVEL_ACTIVE | SPEECH_LEVEL;
+        OpusExtensionData extension = {EXTENSION_FRAME_INFO, 0, info, sizeof(info)};
+        memcpy(wire[i].data, packets->packets[i].data, packets->packets[i].size);
+        wire[i].size = opus_packet_add_extensions(wire[i].data, packets->packets[i].size, MAX_PACKET_SIZE, &extension, 1);
+        if (wire[i].size < 0) {
+            fprintf(stderr, "Opus extension error: %s\n", opus_strerror(wire[i].size));
+            free(wire);
+            return false;
+        }
+    }
+
+    double start = now_seconds();
+    for (int c = 0; c < RELAY_CLIENTS; c++) {
+        pthread_create(&threads[c], NULL, relay_reader, &readers[c]);
+    }
+
+    unsigned char frame[sizeof(uint32_t) + AUDIO_HEADER_SIZE + MAX_PACKET_SIZE];
+    for (int round = 0; round < RELAY_ROUNDS; round++) {
+        for (int i = 0; i < packets->count; i++) {
+            for (int c = 0; c < RELAY_CLIENTS; c++) {
+                uint32_t size = htonl(AUDIO_HEADER_SIZE + wire[i].size);
+                uint32_t ssrc = htonl(c + 1);
+                memcpy(frame, &size, 4);
+                frame[4] = MESSAGE_AUDIO;
+                memcpy(frame + 5, &ssrc, 4);
+                memcpy(frame + 4 + AUDIO_HEADER_SIZE, wire[i].data, wire[i].size);
+
+                size_t total = 4 + AUDIO_HEADER_SIZE + wire[i].size;
+                if (write(fds[c], frame, total) != (ssize_t)total) {
+                    perror("write to relay failed");
+                    free(wire);
+                    return false;
+                }
+            }
+        }
+    }
+
+    for (int c = 0; c < RELAY_CLIENTS; c++) {
+        shutdown(fds[c], SHUT_WR);
+    }
+    long messages = 0;
+    for (int c = 0; c < RELAY_CLIENTS; c++) {
+        pthread_join(threads[c], NULL);
+        messages += readers[c].messages;
+        close(fds[c]);
+    }
+    *messages_per_sec = messages / (now_seconds() - start);
+    free(wire);
+    return true;
+}
+
+void usage(char* program) {
+    fprintf(stderr, "Usage: %s <report_path> [relay <host> <port>] [corpus <f32_48k_mono.raw>]\n", program);
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) usage(argv[0]);
+    const char* report_path = argv[1];
+    const char* relay_host = NULL;
+    int relay_port = 0;
+    const char* corpus_path = NULL;
+
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "relay") == 0 && i + 2 < argc) {
+            relay_host = argv[++i];
+            relay_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "corpus") == 0 && i + 1 < argc) {
+            corpus_path = argv[++i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    float* pcm;
+    int samples;
+    if (corpus_path) {
+        if (!load_corpus(corpus_path, &pcm, &samples)) return 1;
+    } else {
+        samples = CORPUS_SECONDS * SAMPLE_RATE;
+        pcm = malloc(samples * sizeof(float));
+        corpus_generate_speech(pcm, samples, 1);
+    }
+    int frames = samples / (FRAME_SIZE * CHANNELS);
+
+    Packets packets;
+    double encode_us, decode_us, cold_start_us;
+    if (!run_codec(pcm, frames, &packets, &encode_us, &decode_us, &cold_start_us)) return 1;
+    printf("Codec: encode %.1f us/frame, decode %.1f us/frame over %d frames, cold start %.0f us\n", encode_us,
+           decode_us, frames, cold_start_us);
+
+    double relay_rate = 0.0;
+    if (relay_host) {
+        if (!run_relay(relay_host, relay_port, &packets, &relay_rate)) return 1;
+        printf("Relay: %.0f messages/s delivered\n", relay_rate);
+    }
+
+    FILE* report = fopen(report_path, "w");
+    if (!report) {
+        perror(report_path);
+        return 1;
+    }
+    fprintf(report, "encode_us_per_frame %f\n", encode_us);
+    fprintf(report, "decode_us_per_frame %f\n", decode_us);
+    fprintf(report, "relay_messages_per_sec %f\n", relay_rate);
+    fprintf(report, "cold_start_us %f\n", cold_start_us);
+    fclose(report);
+
+    free(packets.packets);
+    free(pcm);
+    return 0;
+}
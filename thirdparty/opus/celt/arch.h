@@ -115,6 +115,42 @@ void celt_fatal(const char *str, const char *file, int line)
 #define OPUS_FAST_INT64 0
 #endif
 
+/* A build specialized for a single stream defines OPUS_FIXED_SAMPLE_RATE,
+   OPUS_FIXED_CHANNELS and OPUS_FIXED_FRAME_SIZE. The states still keep the
+   rate and channel count, but the code reads them through these macros and
+   sees constants the branches and loop bounds fold on. Encoders and decoders
+   for anything else fail to initialize. A decoder still takes stereo
+   packets (and downmixes them), so only the encoder's coded channel count is
+   pinned. */
+#ifdef OPUS_FIXED_SAMPLE_RATE
+#define OPUS_API_FS(Fs) ((opus_int32)OPUS_FIXED_SAMPLE_RATE)
+#define OPUS_FS_SUPPORTED(Fs) ((Fs) == OPUS_FIXED_SAMPLE_RATE)
+#else
+#define OPUS_API_FS(Fs) (Fs)
+#define OPUS_FS_SUPPORTED(Fs) 1
+#endif
+
+#ifdef OPUS_FIXED_CHANNELS
+#define OPUS_API_CHANNELS(channels) OPUS_FIXED_CHANNELS
+#define OPUS_CHANNELS_SUPPORTED(channels) ((channels) == OPUS_FIXED_CHANNELS)
+#else
+#define OPUS_API_CHANNELS(channels) (channels)
+#define OPUS_CHANNELS_SUPPORTED(channels) 1
+#endif
+
+#if defined(OPUS_FIXED_CHANNELS) && OPUS_FIXED_CHANNELS == 1
+#define OPUS_ENC_STREAM_CHANNELS(channels) 1
+#else
+#define OPUS_ENC_STREAM_CHANNELS(channels) (channels)
+#endif
+
+/* CELT's up/downsampling factor to and from 48 kHz */
+#if defined(OPUS_FIXED_SAMPLE_RATE) && !defined(CUSTOM_MODES)
+#define CELT_RESAMPLING(factor) (48000/OPUS_FIXED_SAMPLE_RATE)
+#else
+#define CELT_RESAMPLING(factor) (factor)
+#endif
+
 #define PRINT_MIPS(file)
 
 #ifdef FIXED_POINT
@@ -523,7 +523,7 @@ static void prefilter_and_fold(CELTDecoder * OPUS_RESTRICT st, int N)
    VARDECL(opus_val32, etmp);
    mode = st->mode;
    overlap = st->overlap;
-   CC = st->channels;
+   CC = OPUS_API_CHANNELS(st->channels);
    ALLOC(etmp, overlap, opus_val32);
    c=0; do {
       decode_mem[c] = st->_decode_mem + c*(DECODE_BUFFER_SIZE+overlap);
@@ -609,7 +609,7 @@ static void celt_decode_lost(CELTDecoder * OPUS_RESTRICT st, int N, int LM
 {
    int c;
    int i;
-   const int C = st->channels;
+   const int C = OPUS_API_CHANNELS(st->channels);
    celt_sig *decode_mem[2];
    celt_sig *out_syn[2];
    opus_val16 *lpc;
@@ -693,7 +693,7 @@ static void celt_decode_lost(CELTDecoder * OPUS_RESTRICT st, int N, int LM
       }
       st->rng = seed;
 
-      celt_synthesis(mode, X, out_syn, oldBandE, start, effEnd, C, C, 0, LM, st->downsample, 0, st->arch);
+      celt_synthesis(mode, X, out_syn, oldBandE, start, effEnd, C, C, 0, LM, CELT_RESAMPLING(st->downsample), 0, st->arch);
       st->prefilter_and_fold = 0;
       /* Skip regular PLC until we get two consecutive packets. */
       st->skip_plc = 1;
@@ -994,7 +994,7 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    int shortBlocks;
    int isTransient;
    int intra_ener;
-   const int CC = st->channels;
+   const int CC = OPUS_API_CHANNELS(st->channels);
    int LM, M;
    int start;
    int end;
@@ -1028,7 +1028,7 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    eBands = mode->eBands;
    start = st->start;
    end = st->end;
-   frame_size *= st->downsample;
+   frame_size *= CELT_RESAMPLING(st->downsample);
 
    lpc = (opus_val16*)(st->_decode_mem+(DECODE_BUFFER_SIZE+overlap)*CC);
    oldBandE = lpc+CC*CELT_LPC_ORDER;
@@ -1090,9 +1090,9 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
       , lpcnet
 #endif
                       );
-      deemphasis(out_syn, pcm, N, CC, st->downsample, mode->preemph, st->preemph_memD, accum);
+      deemphasis(out_syn, pcm, N, CC, CELT_RESAMPLING(st->downsample), mode->preemph, st->preemph_memD, accum);
       RESTORE_STACK;
-      return frame_size/st->downsample;
+      return frame_size/CELT_RESAMPLING(st->downsample);
    }
 #ifdef ENABLE_DEEP_PLC
    else {
@@ -1297,7 +1297,7 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
       prefilter_and_fold(st, N);
    }
    celt_synthesis(mode, X, out_syn, oldBandE, start, effEnd,
-                  C, CC, isTransient, LM, st->downsample, silence, st->arch);
+                  C, CC, isTransient, LM, CELT_RESAMPLING(st->downsample), silence, st->arch);
 
    c=0; do {
       st->postfilter_period=IMAX(st->postfilter_period, COMBFILTER_MINPERIOD);
@@ -1357,7 +1357,7 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    } while (++c<2);
    st->rng = dec->rng;
 
-   deemphasis(out_syn, pcm, N, CC, st->downsample, mode->preemph, st->preemph_memD, accum);
+   deemphasis(out_syn, pcm, N, CC, CELT_RESAMPLING(st->downsample), mode->preemph, st->preemph_memD, accum);
    st->loss_duration = 0;
    st->prefilter_and_fold = 0;
    RESTORE_STACK;
@@ -1365,7 +1365,7 @@ int celt_decode_with_ec_dred(CELTDecoder * OPUS_RESTRICT st, const unsigned char
       return OPUS_INTERNAL_ERROR;
    if(ec_get_error(dec))
       st->error = 1;
-   return frame_size/st->downsample;
+   return frame_size/CELT_RESAMPLING(st->downsample);
 }
 
 int celt_decode_with_ec(CELTDecoder * OPUS_RESTRICT st, const unsigned char *data,
@@ -1396,7 +1396,7 @@ int opus_custom_decode_float(CELTDecoder * OPUS_RESTRICT st, const unsigned char
    if (pcm==NULL)
       return OPUS_BAD_ARG;
 
-   C = st->channels;
+   C = OPUS_API_CHANNELS(st->channels);
    N = frame_size;
 
    ALLOC(out, C*N, opus_int16);
@@ -1426,7 +1426,7 @@ int opus_custom_decode(CELTDecoder * OPUS_RESTRICT st, const unsigned char *data
    if (pcm==NULL)
       return OPUS_BAD_ARG;
 
-   C = st->channels;
+   C = OPUS_API_CHANNELS(st->channels);
    N = frame_size;
    ALLOC(out, C*N, celt_sig);
 
@@ -1508,19 +1508,19 @@ int opus_custom_decoder_ctl(CELTDecoder * OPUS_RESTRICT st, int request, ...)
          opus_int32 *value = va_arg(ap, opus_int32*);
          if (value==NULL)
             goto bad_arg;
-         *value = st->overlap/st->downsample;
+         *value = st->overlap/CELT_RESAMPLING(st->downsample);
       }
       break;
       case OPUS_RESET_STATE:
       {
          int i;
          opus_val16 *lpc, *oldBandE, *oldLogE, *oldLogE2;
-         lpc = (opus_val16*)(st->_decode_mem+(DECODE_BUFFER_SIZE+st->overlap)*st->channels);
-         oldBandE = lpc+st->channels*CELT_LPC_ORDER;
+         lpc = (opus_val16*)(st->_decode_mem+(DECODE_BUFFER_SIZE+st->overlap)*OPUS_API_CHANNELS(st->channels));
+         oldBandE = lpc+OPUS_API_CHANNELS(st->channels)*CELT_LPC_ORDER;
          oldLogE = oldBandE + 2*st->mode->nbEBands;
          oldLogE2 = oldLogE + 2*st->mode->nbEBands;
          OPUS_CLEAR((char*)&st->DECODER_RESET_START,
-               opus_custom_decoder_get_size(st->mode, st->channels)-
+               opus_custom_decoder_get_size(st->mode, OPUS_API_CHANNELS(st->channels))-
                ((char*)&st->DECODER_RESET_START - (char*)st));
          for (i=0;i<2*st->mode->nbEBands;i++)
             oldLogE[i]=oldLogE2[i]=-QCONST16(28.f,DB_SHIFT);
@@ -1453,8 +1453,8 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
    opus_val16 *oldBandE, *oldLogE, *oldLogE2, *energyError;
    int shortBlocks=0;
    int isTransient=0;
-   const int CC = st->channels;
-   const int C = st->stream_channels;
+   const int CC = OPUS_API_CHANNELS(st->channels);
+   const int C = OPUS_ENC_STREAM_CHANNELS(st->stream_channels);
    int LM, M;
    int tf_select;
    int nbFilledBytes, nbAvailableBytes;
@@ -1516,7 +1516,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
       return OPUS_BAD_ARG;
    }
 
-   frame_size *= st->upsample;
+   frame_size *= CELT_RESAMPLING(st->upsample);
    for (LM=0;LM<=mode->maxLM;LM++)
       if (mode->shortMdctSize<<LM==frame_size)
          break;
@@ -1641,8 +1641,8 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
 
    ALLOC(in, CC*(N+overlap), celt_sig);
 
-   sample_max=MAX32(st->overlap_max, celt_maxabs16(pcm, C*(N-overlap)/st->upsample));
-   st->overlap_max=celt_maxabs16(pcm+C*(N-overlap)/st->upsample, C*overlap/st->upsample);
+   sample_max=MAX32(st->overlap_max, celt_maxabs16(pcm, C*(N-overlap)/CELT_RESAMPLING(st->upsample)));
+   st->overlap_max=celt_maxabs16(pcm+C*(N-overlap)/CELT_RESAMPLING(st->upsample), C*overlap/CELT_RESAMPLING(st->upsample));
    sample_max=MAX32(sample_max, st->overlap_max);
 #ifdef FIXED_POINT
    silence = (sample_max==0);
@@ -1677,7 +1677,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
 #ifndef FIXED_POINT
       need_clip = st->clip && sample_max>65536.f;
 #endif
-      celt_preemphasis(pcm+c, in+c*(N+overlap)+overlap, N, CC, st->upsample,
+      celt_preemphasis(pcm+c, in+c*(N+overlap)+overlap, N, CC, CELT_RESAMPLING(st->upsample),
                   mode->preemph, st->preemph_memE+c, need_clip);
    } while (++c<CC);
 
@@ -1742,7 +1742,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
    ALLOC(bandLogE2, C*nbEBands, opus_val16);
    if (secondMdct)
    {
-      compute_mdcts(mode, 0, in, freq, C, CC, LM, st->upsample, st->arch);
+      compute_mdcts(mode, 0, in, freq, C, CC, LM, CELT_RESAMPLING(st->upsample), st->arch);
       compute_band_energies(mode, freq, bandE, effEnd, C, LM, st->arch);
       amp2Log2(mode, effEnd, end, bandE, bandLogE2, C);
       for (c=0;c<C;c++)
@@ -1752,7 +1752,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
       }
    }
 
-   compute_mdcts(mode, shortBlocks, in, freq, C, CC, LM, st->upsample, st->arch);
+   compute_mdcts(mode, shortBlocks, in, freq, C, CC, LM, CELT_RESAMPLING(st->upsample), st->arch);
    /* This should catch any NaN in the CELT input. Since we're not supposed to see any (they're filtered
       at the Opus layer), just abort. */
    celt_assert(!celt_isnan(freq[0]) && (C==1 || !celt_isnan(freq[N])));
@@ -1881,7 +1881,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
       {
          isTransient = 1;
          shortBlocks = M;
-         compute_mdcts(mode, shortBlocks, in, freq, C, CC, LM, st->upsample, st->arch);
+         compute_mdcts(mode, shortBlocks, in, freq, C, CC, LM, CELT_RESAMPLING(st->upsample), st->arch);
          compute_band_energies(mode, freq, bandE, effEnd, C, LM, st->arch);
          amp2Log2(mode, effEnd, end, bandE, bandLogE, C);
          /* Compensate for the scaling of short vs long mdcts */
@@ -2284,7 +2284,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
       } while (++c<CC);
 
       celt_synthesis(mode, X, out_mem, oldBandE, start, effEnd,
-                     C, CC, isTransient, LM, st->upsample, silence, st->arch);
+                     C, CC, isTransient, LM, CELT_RESAMPLING(st->upsample), silence, st->arch);
 
       c=0; do {
          st->prefilter_period=IMAX(st->prefilter_period, COMBFILTER_MINPERIOD);
@@ -2299,7 +2299,7 @@ int celt_encode_with_ec(CELTEncoder * OPUS_RESTRICT st, const opus_val16 * pcm,
       } while (++c<CC);
 
       /* We reuse freq[] as scratch space for the de-emphasis */
-      deemphasis(out_mem, (opus_val16*)pcm, N, CC, st->upsample, mode->preemph, st->preemph_memD, 0);
+      deemphasis(out_mem, (opus_val16*)pcm, N, CC, CELT_RESAMPLING(st->upsample), mode->preemph, st->preemph_memD, 0);
       st->prefilter_period_old = st->prefilter_period;
       st->prefilter_gain_old = st->prefilter_gain;
       st->prefilter_tapset_old = st->prefilter_tapset;
@@ -2386,7 +2386,7 @@ int opus_custom_encode_float(CELTEncoder * OPUS_RESTRICT st, const float * pcm,
    if (pcm==NULL)
       return OPUS_BAD_ARG;
 
-   C = st->channels;
+   C = OPUS_API_CHANNELS(st->channels);
    N = frame_size;
    ALLOC(in, C*N, opus_int16);
 
@@ -2413,7 +2413,7 @@ int opus_custom_encode(CELTEncoder * OPUS_RESTRICT st, const opus_int16 * pcm, i
    if (pcm==NULL)
       return OPUS_BAD_ARG;
 
-   C=st->channels;
+   C=OPUS_API_CHANNELS(st->channels);
    N=frame_size;
    ALLOC(in, C*N, celt_sig);
    for (j=0;j<C*N;j++) {
@@ -2503,7 +2503,7 @@ int opus_custom_encoder_ctl(CELTEncoder * OPUS_RESTRICT st, int request, ...)
          opus_int32 value = va_arg(ap, opus_int32);
          if (value<=500 && value!=OPUS_BITRATE_MAX)
             goto bad_arg;
-         value = IMIN(value, 260000*st->channels);
+         value = IMIN(value, 260000*OPUS_API_CHANNELS(st->channels));
          st->bitrate = value;
       }
       break;
@@ -2553,13 +2553,13 @@ int opus_custom_encoder_ctl(CELTEncoder * OPUS_RESTRICT st, int request, ...)
       {
          int i;
          opus_val16 *oldBandE, *oldLogE, *oldLogE2;
-         oldBandE = (opus_val16*)(st->in_mem+st->channels*(st->mode->overlap+COMBFILTER_MAXPERIOD));
-         oldLogE = oldBandE + st->channels*st->mode->nbEBands;
-         oldLogE2 = oldLogE + st->channels*st->mode->nbEBands;
+         oldBandE = (opus_val16*)(st->in_mem+OPUS_API_CHANNELS(st->channels)*(st->mode->overlap+COMBFILTER_MAXPERIOD));
+         oldLogE = oldBandE + OPUS_API_CHANNELS(st->channels)*st->mode->nbEBands;
+         oldLogE2 = oldLogE + OPUS_API_CHANNELS(st->channels)*st->mode->nbEBands;
          OPUS_CLEAR((char*)&st->ENCODER_RESET_START,
-               opus_custom_encoder_get_size(st->mode, st->channels)-
+               opus_custom_encoder_get_size(st->mode, OPUS_API_CHANNELS(st->channels))-
                ((char*)&st->ENCODER_RESET_START - (char*)st));
-         for (i=0;i<st->channels*st->mode->nbEBands;i++)
+         for (i=0;i<OPUS_API_CHANNELS(st->channels)*st->mode->nbEBands;i++)
             oldLogE[i]=oldLogE2[i]=-QCONST16(28.f,DB_SHIFT);
          st->vbr_offset = 0;
          st->delayedIntra = 1;
@@ -110,6 +110,10 @@ typedef struct kiss_fft_state{
 #include "arm/fft_arm.h"
 #endif
 
+#if defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(FIXED_POINT)
+#include "x86/kiss_fft_sse.h"
+#endif
+
 /*typedef struct kiss_fft_state* kiss_fft_cfg;*/
 
 /**
@@ -57,6 +57,10 @@ typedef struct {
 #include "arm/mdct_arm.h"
 #endif
 
+#if defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(FIXED_POINT)
+#include "x86/mdct_sse.h"
+#endif
+
 
 int clt_mdct_init(mdct_lookup *l,int N, int maxshift, int arch);
 void clt_mdct_clear(mdct_lookup *l, int arch);
@@ -235,7 +235,7 @@ CELTMode *opus_custom_mode_create(opus_int32 Fs, int frame_size, int *error)
    int LM;
    int arch = opus_select_arch();
    ALLOC_STACK;
-#if !defined(VAR_ARRAYS) && !defined(USE_ALLOCA)
+#if !defined(VAR_ARRAYS) && !defined(USE_ALLOCA) && !defined(OPUS_SCRATCH_ARENA)
    if (global_stack==NULL)
       goto failure;
 #endif
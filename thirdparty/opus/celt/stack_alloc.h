@@ -35,12 +35,11 @@
 #include "opus_types.h"
 #include "opus_defines.h"
 
-#if (!defined (VAR_ARRAYS) && !defined (USE_ALLOCA) && !defined (NONTHREADSAFE_PSEUDOSTACK))
-#define USE_ALLOCA
-// #error "Opus requires one of VAR_ARRAYS, USE_ALLOCA, or NONTHREADSAFE_PSEUDOSTACK be defined to select the temporary allocation mode."
+#if (!defined (VAR_ARRAYS) && !defined (USE_ALLOCA) && !defined (NONTHREADSAFE_PSEUDOSTACK) && !defined (OPUS_SCRATCH_ARENA))
+#error "Opus requires one of VAR_ARRAYS, USE_ALLOCA, NONTHREADSAFE_PSEUDOSTACK or OPUS_SCRATCH_ARENA be defined to select the temporary allocation mode."
 #endif
 
-#ifdef USE_ALLOCA
+#if defined(USE_ALLOCA) || defined(OPUS_SCRATCH_ARENA)
 # ifdef _WIN32
 #  include <malloc.h>
 # else
@@ -114,6 +113,95 @@
 #define ALLOC_STACK
 #define ALLOC_NONE 0
 
+#elif defined(OPUS_SCRATCH_ARENA)
+
+#include <stddef.h>
+
+/* Every encoder/decoder carries its own scratch arena at the end of its
+   allocation. opus_encode_native()/opus_decode_native() make it current for
+   the calling thread, so the temporaries of a frame land in memory the
+   previous frame already warmed up rather than on the caller's stack.
+   Allocations made without a current arena, or that do not fit, fall back
+   to alloca. */
+
+#if defined(_MSC_VER)
+# define OPUS_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+# define OPUS_THREAD_LOCAL __thread
+#else
+# define OPUS_THREAD_LOCAL _Thread_local
+#endif
+
+/* The arena starts on a cache line, allocations are aligned like alloca's */
+#define OPUS_SCRATCH_ALIGN 64
+#define OPUS_SCRATCH_ALLOC_ALIGN 16
+
+typedef struct {
+   char *base;
+   char *top;
+   char *end;
+   opus_int32 peak; /* Largest demand seen, including allocations that did not fit */
+} OpusScratch;
+
+#ifdef CELT_C
+OPUS_THREAD_LOCAL OpusScratch *opus_scratch_current=0;
+#else
+extern OPUS_THREAD_LOCAL OpusScratch *opus_scratch_current;
+#endif
+
+static OPUS_INLINE void *opus_scratch_alloc(size_t bytes)
+{
+   OpusScratch *s = opus_scratch_current;
+   size_t pad;
+   opus_int32 used;
+   if (s == NULL)
+      return NULL;
+   pad = (OPUS_SCRATCH_ALLOC_ALIGN - (size_t)s->top) & (OPUS_SCRATCH_ALLOC_ALIGN - 1);
+   used = (opus_int32)(s->top - s->base + pad + bytes);
+   if (used > s->peak)
+      s->peak = used;
+   if ((size_t)(s->end - s->top) < pad + bytes)
+      return NULL;
+   s->top += pad + bytes;
+   return s->top - bytes;
+}
+
+/* Makes the size bytes of arena at mem (which needs OPUS_SCRATCH_ALIGN-1 bytes
+   of slack for the alignment) current, returns the arena to restore. The
+   alignment is worked out here rather than stored so a state stays valid
+   when it is copied somewhere else. */
+static OPUS_INLINE OpusScratch *opus_scratch_enter(OpusScratch *scratch, char *mem, opus_int32 size, opus_int32 peak)
+{
+   OpusScratch *prev = opus_scratch_current;
+   scratch->base = mem + ((OPUS_SCRATCH_ALIGN - (size_t)mem) & (OPUS_SCRATCH_ALIGN - 1));
+   scratch->top = scratch->base;
+   scratch->end = scratch->base + size;
+   scratch->peak = peak;
+   opus_scratch_current = scratch;
+   return prev;
+}
+
+/* Returns the updated peak of the arena being left */
+static OPUS_INLINE opus_int32 opus_scratch_leave(OpusScratch *prev)
+{
+   opus_int32 peak = opus_scratch_current->peak;
+   opus_scratch_current = prev;
+   return peak;
+}
+
+# ifdef _WIN32
+#  define OPUS_SCRATCH_ALLOCA(bytes) _alloca(bytes)
+# else
+#  define OPUS_SCRATCH_ALLOCA(bytes) alloca(bytes)
+# endif
+
+#define VARDECL(type, var) type *var
+#define ALLOC(var, size, type) ((var = (type*)opus_scratch_alloc(sizeof(type)*(size))) != NULL ? (void)0 : (void)(var = (type*)OPUS_SCRATCH_ALLOCA(sizeof(type)*(size))))
+#define SAVE_STACK char *_saved_stack = opus_scratch_current ? opus_scratch_current->top : NULL
+#define RESTORE_STACK (_saved_stack ? (void)(opus_scratch_current->top = _saved_stack) : (void)0)
+#define ALLOC_STACK SAVE_STACK
+#define ALLOC_NONE 0
+
 #else
 
 #ifdef CELT_C
@@ -0,0 +1,346 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "x86cpu.h"
+#include "kiss_fft.h"
+#include "_kiss_fft_guts.h"
+#include "kiss_fft_sse.h"
+
+#if defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(FIXED_POINT)
+
+/* The butterflies below work on four consecutive kiss_fft_cpx at a time, one
+   __m256 holding r0 i0 r1 i1 r2 i2 r3 i3. The twiddles of a stage are taken
+   from the interleaved kiss_fft twiddle table with one 64-bit gather per four
+   complex values. Results match opus_fft_impl() within float rounding, the
+   complex products use FMA. */
+
+static OPUS_INLINE __m256 cmul_avx2(__m256 a, __m256 b)
+{
+   __m256 br = _mm256_moveldup_ps(b);
+   __m256 bi = _mm256_movehdup_ps(b);
+   __m256 as = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+   return _mm256_fmaddsub_ps(a, br, _mm256_mul_ps(as, bi));
+}
+
+/* Multiplies every complex value by -i: (r, i) -> (i, -r) */
+static OPUS_INLINE __m256 mul_neg_i_avx2(__m256 a)
+{
+   const __m256 odd_sign = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0x80000000, 0, 0x80000000,
+                                                                0, 0x80000000, 0, 0x80000000));
+   return _mm256_xor_ps(_mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1)), odd_sign);
+}
+
+/* Loads tw[idx[0..3]] as four complex values */
+static OPUS_INLINE __m256 load_twiddles_avx2(const kiss_twiddle_cpx *tw, __m128i idx)
+{
+   return _mm256_castpd_ps(_mm256_i32gather_pd((const double *)(const void *)tw, idx, 8));
+}
+
+/* Transposes a 4x4 block of complex values held one row per register */
+static OPUS_INLINE void transpose_cpx_4x4_avx2(__m256 *v0, __m256 *v1, __m256 *v2, __m256 *v3)
+{
+   __m256d t0, t1, t2, t3;
+   t0 = _mm256_unpacklo_pd(_mm256_castps_pd(*v0), _mm256_castps_pd(*v1));
+   t1 = _mm256_unpackhi_pd(_mm256_castps_pd(*v0), _mm256_castps_pd(*v1));
+   t2 = _mm256_unpacklo_pd(_mm256_castps_pd(*v2), _mm256_castps_pd(*v3));
+   t3 = _mm256_unpackhi_pd(_mm256_castps_pd(*v2), _mm256_castps_pd(*v3));
+   *v0 = _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x20));
+   *v1 = _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x20));
+   *v2 = _mm256_castpd_ps(_mm256_permute2f128_pd(t0, t2, 0x31));
+   *v3 = _mm256_castpd_ps(_mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+static void kf_bfly2_avx2(kiss_fft_cpx *Fout, int N)
+{
+   int i;
+   const float tw = 0.7071067812f;
+   /* Twiddles 1, (1-i)/sqrt(2), -i, -(1+i)/sqrt(2) for the radix-2 after a
+      radix-4 (m==4) */
+   const __m256 w = _mm256_setr_ps(1.f, 0.f, tw, -tw, 0.f, -1.f, -tw, -tw);
+   for (i=0;i<N;i++)
+   {
+      __m256 f0 = _mm256_loadu_ps((float*)Fout);
+      __m256 t = cmul_avx2(_mm256_loadu_ps((float*)(Fout+4)), w);
+      _mm256_storeu_ps((float*)(Fout+4), _mm256_sub_ps(f0, t));
+      _mm256_storeu_ps((float*)Fout, _mm256_add_ps(f0, t));
+      Fout += 8;
+   }
+}
+
+static void kf_bfly4_avx2(kiss_fft_cpx *Fout, const size_t fstride,
+                          const kiss_fft_state *st, int m, int N, int mm)
+{
+   int i;
+   if (m==1)
+   {
+      /* Degenerate case where all the twiddles are 1, four butterflies at a
+         time with their inputs transposed into columns. */
+      for (i=0;i+4<=N;i+=4)
+      {
+         __m256 a0, a1, a2, a3, s0, s1;
+         a0 = _mm256_loadu_ps((float*)Fout);
+         a1 = _mm256_loadu_ps((float*)(Fout+4));
+         a2 = _mm256_loadu_ps((float*)(Fout+8));
+         a3 = _mm256_loadu_ps((float*)(Fout+12));
+         transpose_cpx_4x4_avx2(&a0, &a1, &a2, &a3);
+         s0 = _mm256_sub_ps(a0, a2);
+         a0 = _mm256_add_ps(a0, a2);
+         s1 = _mm256_add_ps(a1, a3);
+         a2 = _mm256_sub_ps(a0, s1);
+         a0 = _mm256_add_ps(a0, s1);
+         s1 = mul_neg_i_avx2(_mm256_sub_ps(a1, a3));
+         a1 = _mm256_add_ps(s0, s1);
+         a3 = _mm256_sub_ps(s0, s1);
+         transpose_cpx_4x4_avx2(&a0, &a1, &a2, &a3);
+         _mm256_storeu_ps((float*)Fout, a0);
+         _mm256_storeu_ps((float*)(Fout+4), a1);
+         _mm256_storeu_ps((float*)(Fout+8), a2);
+         _mm256_storeu_ps((float*)(Fout+12), a3);
+         Fout += 16;
+      }
+      for (;i<N;i++)
+      {
+         kiss_fft_cpx scratch0, scratch1;
+         C_SUB( scratch0 , *Fout, Fout[2] );
+         C_ADDTO(*Fout, Fout[2]);
+         C_ADD( scratch1 , Fout[1] , Fout[3] );
+         C_SUB( Fout[2], *Fout, scratch1 );
+         C_ADDTO( *Fout , scratch1 );
+         C_SUB( scratch1 , Fout[1] , Fout[3] );
+         Fout[1].r = scratch0.r + scratch1.i;
+         Fout[1].i = scratch0.i - scratch1.r;
+         Fout[3].r = scratch0.r - scratch1.i;
+         Fout[3].i = scratch0.i + scratch1.r;
+         Fout+=4;
+      }
+   } else {
+      int j;
+      const int m2=2*m;
+      const int m3=3*m;
+      const __m128i step = _mm_set1_epi32(4*(int)fstride);
+      kiss_fft_cpx * Fout_beg = Fout;
+      for (i=0;i<N;i++)
+      {
+         __m128i idx = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32((int)fstride));
+         Fout = Fout_beg + i*mm;
+         /* m is a multiple of 4 for the static modes, checked by the caller */
+         for (j=0;j<m;j+=4)
+         {
+            __m256 f0, s0, s1, s2, s3, s4, s5;
+            s0 = cmul_avx2(_mm256_loadu_ps((float*)(Fout+m)), load_twiddles_avx2(st->twiddles, idx));
+            s1 = cmul_avx2(_mm256_loadu_ps((float*)(Fout+m2)), load_twiddles_avx2(st->twiddles, _mm_add_epi32(idx, idx)));
+            s2 = cmul_avx2(_mm256_loadu_ps((float*)(Fout+m3)),
+                           load_twiddles_avx2(st->twiddles, _mm_add_epi32(idx, _mm_add_epi32(idx, idx))));
+            f0 = _mm256_loadu_ps((float*)Fout);
+            s5 = _mm256_sub_ps(f0, s1);
+            f0 = _mm256_add_ps(f0, s1);
+            s3 = _mm256_add_ps(s0, s2);
+            s4 = mul_neg_i_avx2(_mm256_sub_ps(s0, s2));
+            _mm256_storeu_ps((float*)(Fout+m2), _mm256_sub_ps(f0, s3));
+            _mm256_storeu_ps((float*)Fout, _mm256_add_ps(f0, s3));
+            _mm256_storeu_ps((float*)(Fout+m), _mm256_add_ps(s5, s4));
+            _mm256_storeu_ps((float*)(Fout+m3), _mm256_sub_ps(s5, s4));
+            idx = _mm_add_epi32(idx, step);
+            Fout += 4;
+         }
+      }
+   }
+}
+
+static void kf_bfly3_avx2(kiss_fft_cpx *Fout, const size_t fstride,
+                          const kiss_fft_state *st, int m, int N, int mm)
+{
+   int i, j;
+   const size_t m2 = 2*m;
+   const __m128i step = _mm_set1_epi32(4*(int)fstride);
+   const __m256 half = _mm256_set1_ps(.5f);
+   const __m256 epi3 = _mm256_set1_ps(st->twiddles[fstride*m].i);
+   kiss_fft_cpx * Fout_beg = Fout;
+   for (i=0;i<N;i++)
+   {
+      __m128i idx = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32((int)fstride));
+      Fout = Fout_beg + i*mm;
+      for (j=0;j<m;j+=4)
+      {
+         __m256 f0, fm, s0, s1, s2, s3;
+         s1 = cmul_avx2(_mm256_loadu_ps((float*)(Fout+m)), load_twiddles_avx2(st->twiddles, idx));
+         s2 = cmul_avx2(_mm256_loadu_ps((float*)(Fout+m2)), load_twiddles_avx2(st->twiddles, _mm_add_epi32(idx, idx)));
+         s3 = _mm256_add_ps(s1, s2);
+         s0 = mul_neg_i_avx2(_mm256_mul_ps(_mm256_sub_ps(s1, s2), epi3));
+         f0 = _mm256_loadu_ps((float*)Fout);
+         fm = _mm256_sub_ps(f0, _mm256_mul_ps(s3, half));
+         _mm256_storeu_ps((float*)Fout, _mm256_add_ps(f0, s3));
+         _mm256_storeu_ps((float*)(Fout+m2), _mm256_add_ps(fm, s0));
+         _mm256_storeu_ps((float*)(Fout+m), _mm256_sub_ps(fm, s0));
+         idx = _mm_add_epi32(idx, step);
+         Fout += 4;
+      }
+   }
+}
+
+static void kf_bfly5_avx2(kiss_fft_cpx *Fout, const size_t fstride,
+                          const kiss_fft_state *st, int m, int N, int mm)
+{
+   int i, u;
+   const __m128i step = _mm_set1_epi32(4*(int)fstride);
+   const __m256 yar = _mm256_set1_ps(st->twiddles[fstride*m].r);
+   const __m256 yai = _mm256_set1_ps(st->twiddles[fstride*m].i);
+   const __m256 ybr = _mm256_set1_ps(st->twiddles[fstride*2*m].r);
+   const __m256 ybi = _mm256_set1_ps(st->twiddles[fstride*2*m].i);
+   kiss_fft_cpx * Fout_beg = Fout;
+   for (i=0;i<N;i++)
+   {
+      __m128i idx = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), _mm_set1_epi32((int)fstride));
+      kiss_fft_cpx *Fout0=Fout_beg + i*mm;
+      kiss_fft_cpx *Fout1=Fout0+m;
+      kiss_fft_cpx *Fout2=Fout0+2*m;
+      kiss_fft_cpx *Fout3=Fout0+3*m;
+      kiss_fft_cpx *Fout4=Fout0+4*m;
+      for (u=0;u<m;u+=4)
+      {
+         __m256 s0, s1, s2, s3, s4, s5, s6, s7, s8, s9, s10, s11, s12;
+         __m128i idx2 = _mm_add_epi32(idx, idx);
+         s0 = _mm256_loadu_ps((float*)Fout0);
+         s1 = cmul_avx2(_mm256_loadu_ps((float*)Fout1), load_twiddles_avx2(st->twiddles, idx));
+         s2 = cmul_avx2(_mm256_loadu_ps((float*)Fout2), load_twiddles_avx2(st->twiddles, idx2));
+         s3 = cmul_avx2(_mm256_loadu_ps((float*)Fout3), load_twiddles_avx2(st->twiddles, _mm_add_epi32(idx2, idx)));
+         s4 = cmul_avx2(_mm256_loadu_ps((float*)Fout4), load_twiddles_avx2(st->twiddles, _mm_add_epi32(idx2, idx2)));
+         s7 = _mm256_add_ps(s1, s4);
+         s10 = _mm256_sub_ps(s1, s4);
+         s8 = _mm256_add_ps(s2, s3);
+         s9 = _mm256_sub_ps(s2, s3);
+         _mm256_storeu_ps((float*)Fout0, _mm256_add_ps(s0, _mm256_add_ps(s7, s8)));
+
+         s5 = _mm256_add_ps(s0, _mm256_fmadd_ps(s7, yar, _mm256_mul_ps(s8, ybr)));
+         s6 = mul_neg_i_avx2(_mm256_fmadd_ps(s10, yai, _mm256_mul_ps(s9, ybi)));
+         _mm256_storeu_ps((float*)Fout1, _mm256_sub_ps(s5, s6));
+         _mm256_storeu_ps((float*)Fout4, _mm256_add_ps(s5, s6));
+
+         s11 = _mm256_add_ps(s0, _mm256_fmadd_ps(s7, ybr, _mm256_mul_ps(s8, yar)));
+         s12 = mul_neg_i_avx2(_mm256_fmsub_ps(s9, yai, _mm256_mul_ps(s10, ybi)));
+         _mm256_storeu_ps((float*)Fout2, _mm256_add_ps(s11, s12));
+         _mm256_storeu_ps((float*)Fout3, _mm256_sub_ps(s11, s12));
+
+         idx = _mm_add_epi32(idx, step);
+         Fout0 += 4; Fout1 += 4; Fout2 += 4; Fout3 += 4; Fout4 += 4;
+      }
+   }
+}
+
+/* The static modes only have radix-2 stages with m==4 and other stages with
+   m a multiple of 4 (or the degenerate radix-4 with m==1), custom modes can
+   have anything */
+static int stage_supported_avx2(int p, int m)
+{
+   if (p==2)
+      return m==4;
+   if (p==4 && m==1)
+      return 1;
+   return (m&3)==0;
+}
+
+void opus_fft_impl_avx2(const kiss_fft_state *st, kiss_fft_cpx *fout)
+{
+   int m2, m;
+   int p;
+   int L;
+   int fstride[MAXFACTORS];
+   int i;
+   int shift;
+
+   /* st->shift can be -1 */
+   shift = st->shift>0 ? st->shift : 0;
+
+   fstride[0] = 1;
+   L=0;
+   do {
+      p = st->factors[2*L];
+      m = st->factors[2*L+1];
+      if (!stage_supported_avx2(p, m))
+      {
+         opus_fft_impl(st, fout);
+         return;
+      }
+      fstride[L+1] = fstride[L]*p;
+      L++;
+   } while(m!=1);
+   m = st->factors[2*L-1];
+   for (i=L-1;i>=0;i--)
+   {
+      if (i!=0)
+         m2 = st->factors[2*i-1];
+      else
+         m2 = 1;
+      switch (st->factors[2*i])
+      {
+      case 2:
+         kf_bfly2_avx2(fout, fstride[i]);
+         break;
+      case 4:
+         kf_bfly4_avx2(fout,fstride[i]<<shift,st,m, fstride[i], m2);
+         break;
+      case 3:
+         kf_bfly3_avx2(fout,fstride[i]<<shift,st,m, fstride[i], m2);
+         break;
+      case 5:
+         kf_bfly5_avx2(fout,fstride[i]<<shift,st,m, fstride[i], m2);
+         break;
+      }
+      m = m2;
+   }
+}
+
+void opus_fft_avx2(const kiss_fft_state *st, const kiss_fft_cpx *fin, kiss_fft_cpx *fout)
+{
+   int i;
+   const __m256 scale = _mm256_set1_ps(st->scale);
+
+   celt_assert2 (fin != fout, "In-place FFT not supported");
+   /* Bit-reverse the input */
+   for (i=0;i+4<=st->nfft;i+=4)
+   {
+      __m256 x = _mm256_mul_ps(_mm256_loadu_ps((const float*)(fin+i)), scale);
+      __m128 lo = _mm256_castps256_ps128(x);
+      __m128 hi = _mm256_extractf128_ps(x, 1);
+      _mm_storel_pi((__m64*)(void*)&fout[st->bitrev[i]], lo);
+      _mm_storeh_pi((__m64*)(void*)&fout[st->bitrev[i+1]], lo);
+      _mm_storel_pi((__m64*)(void*)&fout[st->bitrev[i+2]], hi);
+      _mm_storeh_pi((__m64*)(void*)&fout[st->bitrev[i+3]], hi);
+   }
+   for (;i<st->nfft;i++)
+   {
+      fout[st->bitrev[i]].r = st->scale*fin[i].r;
+      fout[st->bitrev[i]].i = st->scale*fin[i].i;
+   }
+   opus_fft_impl_avx2(st, fout);
+}
+
+#endif /* OPUS_X86_MAY_HAVE_AVX2 && !FIXED_POINT */
@@ -0,0 +1,326 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "x86cpu.h"
+#include "mdct.h"
+#include "kiss_fft.h"
+#include "_kiss_fft_guts.h"
+#include "stack_alloc.h"
+#include "mdct_sse.h"
+#include "kiss_fft_sse.h"
+
+#if defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(FIXED_POINT)
+
+/* AVX2 versions of clt_mdct_forward_c()/clt_mdct_backward_c(). The pre- and
+   post-rotations handle four complex values per iteration with the trig
+   table's cos/sin halves interleaved into complex twiddles on the fly, the
+   N/4 point FFT runs on opus_fft_impl_avx2(). */
+
+static OPUS_INLINE __m256 cmul_avx2(__m256 a, __m256 b)
+{
+   __m256 br = _mm256_moveldup_ps(b);
+   __m256 bi = _mm256_movehdup_ps(b);
+   __m256 as = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+   return _mm256_fmaddsub_ps(a, br, _mm256_mul_ps(as, bi));
+}
+
+/* Complex twiddles t[i+k] + j*t[N4+i+k], k=0..3 */
+static OPUS_INLINE __m256 load_trig_avx2(const kiss_twiddle_scalar *t, int N4, int i)
+{
+   __m128 c = _mm_loadu_ps(t+i);
+   __m128 s = _mm_loadu_ps(t+N4+i);
+   return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_unpacklo_ps(c, s)), _mm_unpackhi_ps(c, s), 1);
+}
+
+static OPUS_INLINE __m256 reverse_avx2(__m256 x)
+{
+   return _mm256_permutevar8x32_ps(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+/* Reverses the order of four complex values */
+static OPUS_INLINE __m256 reverse_cpx_avx2(__m256 x)
+{
+   return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(x), _MM_SHUFFLE(0, 1, 2, 3)));
+}
+
+/* Stores four complex values to out[idx[0..3]] */
+static OPUS_INLINE void scatter_cpx_avx2(kiss_fft_cpx *out, const opus_int16 *idx, __m256 x)
+{
+   __m128 lo = _mm256_castps256_ps128(x);
+   __m128 hi = _mm256_extractf128_ps(x, 1);
+   _mm_storel_pi((__m64*)(void*)&out[idx[0]], lo);
+   _mm_storeh_pi((__m64*)(void*)&out[idx[1]], lo);
+   _mm_storel_pi((__m64*)(void*)&out[idx[2]], hi);
+   _mm_storeh_pi((__m64*)(void*)&out[idx[3]], hi);
+}
+
+void clt_mdct_forward_avx2(const mdct_lookup *l, kiss_fft_scalar *in, kiss_fft_scalar * OPUS_RESTRICT out,
+      const opus_val16 *window, int overlap, int shift, int stride, int arch)
+{
+   int i;
+   int N, N2, N4;
+   VARDECL(kiss_fft_scalar, f);
+   VARDECL(kiss_fft_cpx, f2);
+   const kiss_fft_state *st = l->kfft[shift];
+   const kiss_twiddle_scalar *trig;
+   SAVE_STACK;
+   (void)arch;
+
+   N = l->n;
+   trig = l->trig;
+   for (i=0;i<shift;i++)
+   {
+      N >>= 1;
+      trig += N;
+   }
+   N2 = N>>1;
+   N4 = N>>2;
+
+   ALLOC(f, N2, kiss_fft_scalar);
+   ALLOC(f2, N4, kiss_fft_cpx);
+
+   /* Window, shuffle, fold, same as clt_mdct_forward_c() */
+   {
+      const kiss_fft_scalar * OPUS_RESTRICT xp1 = in+(overlap>>1);
+      const kiss_fft_scalar * OPUS_RESTRICT xp2 = in+N2-1+(overlap>>1);
+      kiss_fft_scalar * OPUS_RESTRICT yp = f;
+      const opus_val16 * OPUS_RESTRICT wp1 = window+(overlap>>1);
+      const opus_val16 * OPUS_RESTRICT wp2 = window+(overlap>>1)-1;
+      for(i=0;i<((overlap+3)>>2);i++)
+      {
+         *yp++ = MULT16_32_Q15(*wp2, xp1[N2]) + MULT16_32_Q15(*wp1,*xp2);
+         *yp++ = MULT16_32_Q15(*wp1, *xp1)    - MULT16_32_Q15(*wp2, xp2[-N2]);
+         xp1+=2;
+         xp2-=2;
+         wp1+=2;
+         wp2-=2;
+      }
+      wp1 = window;
+      wp2 = window+overlap-1;
+      for(;i<N4-((overlap+3)>>2);i++)
+      {
+         *yp++ = *xp2;
+         *yp++ = *xp1;
+         xp1+=2;
+         xp2-=2;
+      }
+      for(;i<N4;i++)
+      {
+         *yp++ =  -MULT16_32_Q15(*wp1, xp1[-N2]) + MULT16_32_Q15(*wp2, *xp2);
+         *yp++ = MULT16_32_Q15(*wp2, *xp1)     + MULT16_32_Q15(*wp1, xp2[N2]);
+         xp1+=2;
+         xp2-=2;
+         wp1+=2;
+         wp2-=2;
+      }
+   }
+   /* Pre-rotation, scaled and stored in bit-reversed order */
+   {
+      const __m256 scale = _mm256_set1_ps(st->scale);
+      for(i=0;i+4<=N4;i+=4)
+      {
+         __m256 y = cmul_avx2(_mm256_loadu_ps(f+2*i), load_trig_avx2(trig, N4, i));
+         scatter_cpx_avx2(f2, st->bitrev+i, _mm256_mul_ps(y, scale));
+      }
+      for(;i<N4;i++)
+      {
+         kiss_fft_cpx yc;
+         kiss_fft_scalar re = f[2*i], im = f[2*i+1];
+         yc.r = st->scale*(re*trig[i] - im*trig[N4+i]);
+         yc.i = st->scale*(im*trig[i] + re*trig[N4+i]);
+         f2[st->bitrev[i]] = yc;
+      }
+   }
+
+   /* N/4 complex FFT, does not downscale anymore */
+   opus_fft_impl_avx2(st, f2);
+
+   /* Post-rotate */
+   {
+      kiss_fft_scalar * OPUS_RESTRICT yp1 = out;
+      kiss_fft_scalar * OPUS_RESTRICT yp2 = out+stride*(N2-1);
+      const __m256 real_sign = _mm256_castsi256_ps(_mm256_setr_epi32(0x80000000, 0, 0x80000000, 0,
+                                                                     0x80000000, 0, 0x80000000, 0));
+      for(i=0;i+4<=N4;i+=4)
+      {
+         /* (-re, im) of f2*t is (yr, yi) */
+         float y[8];
+         int k;
+         __m256 z = cmul_avx2(_mm256_loadu_ps((float*)(f2+i)), load_trig_avx2(trig, N4, i));
+         _mm256_storeu_ps(y, _mm256_xor_ps(z, real_sign));
+         for (k=0;k<4;k++)
+         {
+            *yp1 = y[2*k];
+            *yp2 = y[2*k+1];
+            yp1 += 2*stride;
+            yp2 -= 2*stride;
+         }
+      }
+      for(;i<N4;i++)
+      {
+         *yp1 = f2[i].i*trig[N4+i] - f2[i].r*trig[i];
+         *yp2 = f2[i].r*trig[N4+i] + f2[i].i*trig[i];
+         yp1 += 2*stride;
+         yp2 -= 2*stride;
+      }
+   }
+   RESTORE_STACK;
+}
+
+void clt_mdct_backward_avx2(const mdct_lookup *l, kiss_fft_scalar *in, kiss_fft_scalar * OPUS_RESTRICT out,
+      const opus_val16 * OPUS_RESTRICT window, int overlap, int shift, int stride, int arch)
+{
+   int i;
+   int N, N2, N4;
+   const kiss_twiddle_scalar *trig;
+   (void) arch;
+
+   N = l->n;
+   trig = l->trig;
+   for (i=0;i<shift;i++)
+   {
+      N >>= 1;
+      trig += N;
+   }
+   N2 = N>>1;
+   N4 = N>>2;
+
+   /* Pre-rotate, (x1 + j*x2)*t gives (yi, yr), which is already the real and
+      imaginary swap for using an FFT instead of an IFFT */
+   {
+      kiss_fft_cpx * OPUS_RESTRICT yp = (kiss_fft_cpx*)(out+(overlap>>1));
+      const opus_int16 * OPUS_RESTRICT bitrev = l->kfft[shift]->bitrev;
+      /* in[2*i*stride] interleaved with in[stride*(N2-1) - 2*i*stride] */
+      __m256i idx = _mm256_setr_epi32(0, stride*(N2-1), 2*stride, stride*(N2-1)-2*stride,
+                                      4*stride, stride*(N2-1)-4*stride, 6*stride, stride*(N2-1)-6*stride);
+      const __m256i step = _mm256_setr_epi32(8*stride, -8*stride, 8*stride, -8*stride,
+                                             8*stride, -8*stride, 8*stride, -8*stride);
+      for(i=0;i+4<=N4;i+=4)
+      {
+         __m256 x = _mm256_i32gather_ps(in, idx, 4);
+         scatter_cpx_avx2(yp, bitrev+i, cmul_avx2(x, load_trig_avx2(trig, N4, i)));
+         idx = _mm256_add_epi32(idx, step);
+      }
+      for(;i<N4;i++)
+      {
+         kiss_fft_scalar x1 = in[2*i*stride];
+         kiss_fft_scalar x2 = in[stride*(N2-1) - 2*i*stride];
+         yp[bitrev[i]].i = x2*trig[i] + x1*trig[N4+i];
+         yp[bitrev[i]].r = x1*trig[i] - x2*trig[N4+i];
+      }
+   }
+
+   opus_fft_impl_avx2(l->kfft[shift], (kiss_fft_cpx*)(out+(overlap>>1)));
+
+   /* Post-rotate and de-shuffle from both ends of the buffer at once to make
+      it in-place. For every complex k, (im + j*re)*conj(t) = (yr, -yi) with
+      yr going back to k and yi to N4-1-k, so four values from the front and
+      their four partners from the back are done together. */
+   {
+      kiss_fft_cpx * yp = (kiss_fft_cpx*)(out+(overlap>>1));
+      const __m256 imag_sign = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0x80000000, 0, 0x80000000,
+                                                                     0, 0x80000000, 0, 0x80000000));
+      for(i=0;2*i+8<=N4;i+=4)
+      {
+         int back = N4-4-i;
+         __m256 front_t = _mm256_xor_ps(load_trig_avx2(trig, N4, i), imag_sign);
+         __m256 back_t = _mm256_xor_ps(load_trig_avx2(trig, N4, back), imag_sign);
+         __m256 zf = cmul_avx2(_mm256_permute_ps(_mm256_loadu_ps((float*)(yp+i)), _MM_SHUFFLE(2, 3, 0, 1)), front_t);
+         __m256 zb = cmul_avx2(_mm256_permute_ps(_mm256_loadu_ps((float*)(yp+back)), _MM_SHUFFLE(2, 3, 0, 1)), back_t);
+         _mm256_storeu_ps((float*)(yp+i), _mm256_xor_ps(_mm256_blend_ps(zf, reverse_cpx_avx2(zb), 0xAA), imag_sign));
+         _mm256_storeu_ps((float*)(yp+back), _mm256_xor_ps(_mm256_blend_ps(zb, reverse_cpx_avx2(zf), 0xAA), imag_sign));
+      }
+      {
+         kiss_fft_scalar * yp0 = out+(overlap>>1)+2*i;
+         kiss_fft_scalar * yp1 = out+(overlap>>1)+N2-2-2*i;
+         /* Loop to (N4+1)>>1 to handle odd N4. When N4 is odd, the
+            middle pair will be computed twice. */
+         for(;i<(N4+1)>>1;i++)
+         {
+            kiss_fft_scalar re, im, yr, yi;
+            kiss_twiddle_scalar t0, t1;
+            re = yp0[1];
+            im = yp0[0];
+            t0 = trig[i];
+            t1 = trig[N4+i];
+            yr = re*t0 + im*t1;
+            yi = re*t1 - im*t0;
+            re = yp1[1];
+            im = yp1[0];
+            yp0[0] = yr;
+            yp1[1] = yi;
+
+            t0 = trig[(N4-i-1)];
+            t1 = trig[(N2-i-1)];
+            yr = re*t0 + im*t1;
+            yi = re*t1 - im*t0;
+            yp1[0] = yr;
+            yp0[1] = yi;
+            yp0 += 2;
+            yp1 -= 2;
+         }
+      }
+   }
+
+   /* Mirror on both sides for TDAC */
+   {
+      kiss_fft_scalar * OPUS_RESTRICT xp1 = out+overlap-1;
+      kiss_fft_scalar * OPUS_RESTRICT yp1 = out;
+      const opus_val16 * OPUS_RESTRICT wp1 = window;
+      const opus_val16 * OPUS_RESTRICT wp2 = window+overlap-1;
+
+      for(i = 0; i+8 <= overlap/2; i+=8)
+      {
+         __m256 x1 = reverse_avx2(_mm256_loadu_ps(xp1-7));
+         __m256 x2 = _mm256_loadu_ps(yp1);
+         __m256 w1 = _mm256_loadu_ps(wp1);
+         __m256 w2 = reverse_avx2(_mm256_loadu_ps(wp2-7));
+         _mm256_storeu_ps(yp1, _mm256_fmsub_ps(w2, x2, _mm256_mul_ps(w1, x1)));
+         _mm256_storeu_ps(xp1-7, reverse_avx2(_mm256_fmadd_ps(w1, x2, _mm256_mul_ps(w2, x1))));
+         yp1 += 8;
+         xp1 -= 8;
+         wp1 += 8;
+         wp2 -= 8;
+      }
+      for(; i < overlap/2; i++)
+      {
+         kiss_fft_scalar x1, x2;
+         x1 = *xp1;
+         x2 = *yp1;
+         *yp1++ = MULT16_32_Q15(*wp2, x2) - MULT16_32_Q15(*wp1, x1);
+         *xp1-- = MULT16_32_Q15(*wp1, x2) + MULT16_32_Q15(*wp2, x1);
+         wp1++;
+         wp2--;
+      }
+   }
+}
+
+#endif /* OPUS_X86_MAY_HAVE_AVX2 && !FIXED_POINT */
@@ -0,0 +1,168 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "x86cpu.h"
+#include "pitch.h"
+
+#if defined(OPUS_X86_MAY_HAVE_AVX512) && !defined(FIXED_POINT)
+
+/* Lanes [0, n) of a 16 float vector */
+static OPUS_INLINE __mmask16 tail_mask_avx512(int n)
+{
+   return (__mmask16)((1U << n) - 1);
+}
+
+/* out[k] = horizontal sum of v[k] for the 16 accumulators. The halves are
+   folded together pairwise so every step is one add for two accumulators. */
+static OPUS_INLINE __m512 reduce_16x16_avx512(const __m512 v[16])
+{
+   int k;
+   __m512 r[8], s[4], a, b, c;
+   /* [v_k 8 partials | v_k+8 8 partials] */
+   for (k=0;k<8;k++)
+      r[k] = _mm512_add_ps(_mm512_shuffle_f32x4(v[k], v[k+8], _MM_SHUFFLE(1, 0, 1, 0)),
+                           _mm512_shuffle_f32x4(v[k], v[k+8], _MM_SHUFFLE(3, 2, 3, 2)));
+   /* 128-bit lanes hold 4 partials of v_k, v_k+8, v_k+4, v_k+12 */
+   for (k=0;k<4;k++)
+      s[k] = _mm512_add_ps(_mm512_shuffle_f32x4(r[k], r[k+4], _MM_SHUFFLE(2, 0, 2, 0)),
+                           _mm512_shuffle_f32x4(r[k], r[k+4], _MM_SHUFFLE(3, 1, 3, 1)));
+   /* 4x4 transpose and add within every 128-bit lane */
+   a = _mm512_add_ps(_mm512_unpacklo_ps(s[0], s[1]), _mm512_unpackhi_ps(s[0], s[1]));
+   b = _mm512_add_ps(_mm512_unpacklo_ps(s[2], s[3]), _mm512_unpackhi_ps(s[2], s[3]));
+   c = _mm512_add_ps(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 1, 0)),
+                     _mm512_shuffle_ps(a, b, _MM_SHUFFLE(3, 2, 3, 2)));
+   /* Lanes are v0-3, v8-11, v4-7, v12-15 at this point */
+   return _mm512_shuffle_f32x4(c, c, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+/* Like xcorr_kernel_avx() in pitch_avx.c, but 16 results at a time. */
+static void xcorr_kernel_16_avx512(const float *x, const float *y, float sum[16], int len)
+{
+   int i, k;
+   __m512 xsum[16];
+   for (k=0;k<16;k++)
+      xsum[k] = _mm512_setzero_ps();
+   for (i=0;i<len-15;i+=16)
+   {
+      __m512 x0 = _mm512_loadu_ps(x+i);
+      for (k=0;k<16;k++)
+         xsum[k] = _mm512_fmadd_ps(x0, _mm512_loadu_ps(y+i+k), xsum[k]);
+   }
+   if (i != len)
+   {
+      __mmask16 m = tail_mask_avx512(len-i);
+      __m512 x0 = _mm512_maskz_loadu_ps(m, x+i);
+      for (k=0;k<16;k++)
+         xsum[k] = _mm512_fmadd_ps(x0, _mm512_maskz_loadu_ps(m, y+i+k), xsum[k]);
+   }
+   _mm512_storeu_ps(sum, reduce_16x16_avx512(xsum));
+}
+
+void xcorr_kernel_avx512(const opus_val16 *x, const opus_val16 *y, opus_val32 sum[4], int len)
+{
+   int i;
+   __m512 xsum0, xsum1, xsum2, xsum3;
+   __m128 s01, s23;
+   xsum0 = xsum1 = xsum2 = xsum3 = _mm512_setzero_ps();
+   for (i=0;i<len-15;i+=16)
+   {
+      __m512 x0 = _mm512_loadu_ps(x+i);
+      xsum0 = _mm512_fmadd_ps(x0, _mm512_loadu_ps(y+i  ), xsum0);
+      xsum1 = _mm512_fmadd_ps(x0, _mm512_loadu_ps(y+i+1), xsum1);
+      xsum2 = _mm512_fmadd_ps(x0, _mm512_loadu_ps(y+i+2), xsum2);
+      xsum3 = _mm512_fmadd_ps(x0, _mm512_loadu_ps(y+i+3), xsum3);
+   }
+   if (i != len)
+   {
+      __mmask16 m = tail_mask_avx512(len-i);
+      __m512 x0 = _mm512_maskz_loadu_ps(m, x+i);
+      xsum0 = _mm512_fmadd_ps(x0, _mm512_maskz_loadu_ps(m, y+i  ), xsum0);
+      xsum1 = _mm512_fmadd_ps(x0, _mm512_maskz_loadu_ps(m, y+i+1), xsum1);
+      xsum2 = _mm512_fmadd_ps(x0, _mm512_maskz_loadu_ps(m, y+i+2), xsum2);
+      xsum3 = _mm512_fmadd_ps(x0, _mm512_maskz_loadu_ps(m, y+i+3), xsum3);
+   }
+   /* Fold each accumulator down to 128 bits, then the usual SSE hadd tree */
+   xsum0 = _mm512_add_ps(xsum0, _mm512_shuffle_f32x4(xsum0, xsum0, _MM_SHUFFLE(1, 0, 3, 2)));
+   xsum1 = _mm512_add_ps(xsum1, _mm512_shuffle_f32x4(xsum1, xsum1, _MM_SHUFFLE(1, 0, 3, 2)));
+   xsum2 = _mm512_add_ps(xsum2, _mm512_shuffle_f32x4(xsum2, xsum2, _MM_SHUFFLE(1, 0, 3, 2)));
+   xsum3 = _mm512_add_ps(xsum3, _mm512_shuffle_f32x4(xsum3, xsum3, _MM_SHUFFLE(1, 0, 3, 2)));
+   s01 = _mm_hadd_ps(_mm_add_ps(_mm512_castps512_ps128(xsum0), _mm512_extractf32x4_ps(xsum0, 1)),
+                     _mm_add_ps(_mm512_castps512_ps128(xsum1), _mm512_extractf32x4_ps(xsum1, 1)));
+   s23 = _mm_hadd_ps(_mm_add_ps(_mm512_castps512_ps128(xsum2), _mm512_extractf32x4_ps(xsum2, 1)),
+                     _mm_add_ps(_mm512_castps512_ps128(xsum3), _mm512_extractf32x4_ps(xsum3, 1)));
+   _mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), _mm_hadd_ps(s01, s23)));
+}
+
+void dual_inner_prod_avx512(const opus_val16 *x, const opus_val16 *y01, const opus_val16 *y02,
+      int N, opus_val32 *xy1, opus_val32 *xy2)
+{
+   int i;
+   __m512 xsum1, xsum2;
+   xsum1 = _mm512_setzero_ps();
+   xsum2 = _mm512_setzero_ps();
+   for (i=0;i<N-15;i+=16)
+   {
+      __m512 xi = _mm512_loadu_ps(x+i);
+      xsum1 = _mm512_fmadd_ps(xi, _mm512_loadu_ps(y01+i), xsum1);
+      xsum2 = _mm512_fmadd_ps(xi, _mm512_loadu_ps(y02+i), xsum2);
+   }
+   if (i != N)
+   {
+      __mmask16 m = tail_mask_avx512(N-i);
+      __m512 xi = _mm512_maskz_loadu_ps(m, x+i);
+      xsum1 = _mm512_fmadd_ps(xi, _mm512_maskz_loadu_ps(m, y01+i), xsum1);
+      xsum2 = _mm512_fmadd_ps(xi, _mm512_maskz_loadu_ps(m, y02+i), xsum2);
+   }
+   *xy1 = _mm512_reduce_add_ps(xsum1);
+   *xy2 = _mm512_reduce_add_ps(xsum2);
+}
+
+void celt_pitch_xcorr_avx512(const float *_x, const float *_y, float *xcorr, int len, int max_pitch, int arch)
+{
+   int i;
+   celt_assert(max_pitch>0);
+   (void)arch;
+   for (i=0;i<max_pitch-15;i+=16)
+   {
+      xcorr_kernel_16_avx512(_x, _y+i, &xcorr[i], len);
+   }
+   for (;i<max_pitch-3;i+=4)
+   {
+      xcorr[i] = xcorr[i+1] = xcorr[i+2] = xcorr[i+3] = 0;
+      xcorr_kernel_avx512(_x, _y+i, &xcorr[i], len);
+   }
+   for (;i<max_pitch;i++)
+   {
+      xcorr[i] = celt_inner_prod(_x, _y+i, len, arch);
+   }
+}
+
+#endif
@@ -53,12 +53,25 @@ void xcorr_kernel_sse(
                     int              len);
 #endif
 
+#if defined(OPUS_X86_MAY_HAVE_AVX512) && !defined(FIXED_POINT)
+void xcorr_kernel_avx512(
+                    const opus_val16 *x,
+                    const opus_val16 *y,
+                    opus_val32       sum[4],
+                    int              len);
+#endif
+
 #if defined(OPUS_X86_PRESUME_SSE4_1) && defined(FIXED_POINT)
 #define OVERRIDE_XCORR_KERNEL
 #define xcorr_kernel(x, y, sum, len, arch) \
     ((void)arch, xcorr_kernel_sse4_1(x, y, sum, len))
 
-#elif defined(OPUS_X86_PRESUME_SSE) && !defined(FIXED_POINT)
+#elif defined(OPUS_X86_PRESUME_AVX512) && !defined(FIXED_POINT)
+#define OVERRIDE_XCORR_KERNEL
+#define xcorr_kernel(x, y, sum, len, arch) \
+    ((void)arch, xcorr_kernel_avx512(x, y, sum, len))
+
+#elif defined(OPUS_X86_PRESUME_SSE) && !defined(FIXED_POINT) && !(defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX512))
 #define OVERRIDE_XCORR_KERNEL
 #define xcorr_kernel(x, y, sum, len, arch) \
     ((void)arch, xcorr_kernel_sse(x, y, sum, len))
@@ -147,18 +160,25 @@ void comb_filter_const_sse(opus_val32 *y,
     opus_val16  g12);
 
 
-#if defined(OPUS_X86_PRESUME_SSE)
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+void dual_inner_prod_avx512(const opus_val16 *x,
+    const opus_val16 *y01,
+    const opus_val16 *y02,
+    int               N,
+    opus_val32       *xy1,
+    opus_val32       *xy2);
+#endif
+
+#if defined(OPUS_X86_PRESUME_AVX512)
+#define OVERRIDE_DUAL_INNER_PROD
+# define dual_inner_prod(x, y01, y02, N, xy1, xy2, arch) \
+    ((void)(arch),dual_inner_prod_avx512(x, y01, y02, N, xy1, xy2))
+#elif defined(OPUS_X86_PRESUME_SSE) && !(defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX512))
 #define OVERRIDE_DUAL_INNER_PROD
-#define OVERRIDE_COMB_FILTER_CONST
 # define dual_inner_prod(x, y01, y02, N, xy1, xy2, arch) \
     ((void)(arch),dual_inner_prod_sse(x, y01, y02, N, xy1, xy2))
-
-# define comb_filter_const(y, x, T, N, g10, g11, g12, arch) \
-    ((void)(arch),comb_filter_const_sse(y, x, T, N, g10, g11, g12))
 #elif defined(OPUS_HAVE_RTCD)
-
 #define OVERRIDE_DUAL_INNER_PROD
-#define OVERRIDE_COMB_FILTER_CONST
 extern void (*const DUAL_INNER_PROD_IMPL[OPUS_ARCHMASK + 1])(
               const opus_val16 *x,
               const opus_val16 *y01,
@@ -169,7 +189,15 @@ extern void (*const DUAL_INNER_PROD_IMPL[OPUS_ARCHMASK + 1])(
 
 #define dual_inner_prod(x, y01, y02, N, xy1, xy2, arch) \
     ((*DUAL_INNER_PROD_IMPL[(arch) & OPUS_ARCHMASK])(x, y01, y02, N, xy1, xy2))
+#endif
 
+#if defined(OPUS_X86_PRESUME_SSE)
+#define OVERRIDE_COMB_FILTER_CONST
+# define comb_filter_const(y, x, T, N, g10, g11, g12, arch) \
+    ((void)(arch),comb_filter_const_sse(y, x, T, N, g10, g11, g12))
+#elif defined(OPUS_HAVE_RTCD)
+
+#define OVERRIDE_COMB_FILTER_CONST
 extern void (*const COMB_FILTER_CONST_IMPL[OPUS_ARCHMASK + 1])(
               opus_val32 *y,
               opus_val32 *x,
@@ -188,12 +216,21 @@ extern void (*const COMB_FILTER_CONST_IMPL[OPUS_ARCHMASK + 1])(
 
 void celt_pitch_xcorr_avx2(const float *_x, const float *_y, float *xcorr, int len, int max_pitch, int arch);
 
-#if defined(OPUS_X86_PRESUME_AVX2)
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+void celt_pitch_xcorr_avx512(const float *_x, const float *_y, float *xcorr, int len, int max_pitch, int arch);
+#endif
+
+#if defined(OPUS_X86_PRESUME_AVX512)
+
+#define OVERRIDE_PITCH_XCORR
+# define celt_pitch_xcorr celt_pitch_xcorr_avx512
+
+#elif defined(OPUS_X86_PRESUME_AVX2) && !(defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX512))
 
 #define OVERRIDE_PITCH_XCORR
 # define celt_pitch_xcorr celt_pitch_xcorr_avx2
 
-#elif defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX2)
+#elif defined(OPUS_HAVE_RTCD) && (defined(OPUS_X86_MAY_HAVE_AVX2) || defined(OPUS_X86_MAY_HAVE_AVX512))
 
 #define OVERRIDE_PITCH_XCORR
 extern void (*const PITCH_XCORR_IMPL[OPUS_ARCHMASK + 1])(
@@ -209,7 +246,7 @@ extern void (*const PITCH_XCORR_IMPL[OPUS_ARCHMASK + 1])(
     ((*PITCH_XCORR_IMPL[(arch) & OPUS_ARCHMASK])(_x, _y, xcorr, len, max_pitch, arch))
 
 
-#endif /* OPUS_X86_PRESUME_AVX2 && !OPUS_HAVE_RTCD */
+#endif /* OPUS_X86_PRESUME_AVX512 */
 
 #endif /* OPUS_X86_MAY_HAVE_SSE && !FIXED_POINT */
 
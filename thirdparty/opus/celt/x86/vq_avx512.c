@@ -0,0 +1,201 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "celt_lpc.h"
+#include "stack_alloc.h"
+#include "mathops.h"
+#include "vq.h"
+#include "x86cpu.h"
+
+#if defined(OPUS_X86_MAY_HAVE_AVX512) && !defined(FIXED_POINT)
+
+/* iy[] only has room for N+3 entries, so its accesses stop at N */
+static OPUS_INLINE __mmask16 iy_mask_avx512(int j, int N)
+{
+   return N-j >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1U << (N-j)) - 1);
+}
+
+/* Same search as op_pvq_search_sse2(), 16 bins at a time. The pre-search
+   uses an exact reciprocal like op_pvq_search_c() and the pulse search
+   compares with a 14-bit rsqrt, ties go to the lowest index. */
+opus_val16 op_pvq_search_avx512(celt_norm *_X, int *iy, int K, int N, int arch)
+{
+   int i, j;
+   int pulsesLeft;
+   float xy, yy;
+   VARDECL(celt_norm, y);
+   VARDECL(celt_norm, X);
+   VARDECL(int, signy);
+   __m512 sums;
+   SAVE_STACK;
+
+   (void)arch;
+   ALLOC(y, N+15, celt_norm);
+   ALLOC(X, N+15, celt_norm);
+   ALLOC(signy, N+15, int);
+
+   OPUS_COPY(X, _X, N);
+   for (j=N;j<N+15;j++)
+      X[j] = 0;
+   sums = _mm512_setzero_ps();
+   for (j=0;j<N;j+=16)
+   {
+      __m512 x16 = _mm512_loadu_ps(&X[j]);
+      __mmask16 s16 = _mm512_cmp_ps_mask(x16, _mm512_setzero_ps(), _CMP_LT_OQ);
+      /* Get rid of the sign */
+      x16 = _mm512_abs_ps(x16);
+      sums = _mm512_add_ps(sums, x16);
+      /* Clear y and iy in case we don't do the projection. */
+      _mm512_storeu_ps(&y[j], _mm512_setzero_ps());
+      _mm512_mask_storeu_epi32(&iy[j], iy_mask_avx512(j, N), _mm512_setzero_si512());
+      _mm512_storeu_ps(&X[j], x16);
+      _mm512_storeu_si512(&signy[j], _mm512_movm_epi32(s16));
+   }
+
+   xy = yy = 0;
+
+   pulsesLeft = K;
+
+   /* Do a pre-search by projecting on the pyramid */
+   if (K > (N>>1))
+   {
+      __m512i pulses_sum;
+      __m512 yy16, xy16;
+      __m512 rcp16;
+      opus_val32 sum = _mm512_reduce_add_ps(sums);
+      /* If X is too small, just replace it with a pulse at 0 */
+      /* Prevents infinities and NaNs from causing too many pulses
+         to be allocated. 64 is an approximation of infinity here. */
+      if (!(sum > EPSILON && sum < 64))
+      {
+         X[0] = QCONST16(1.f,14);
+         j=1; do
+            X[j]=0;
+         while (++j<N);
+         sum = QCONST16(1.f,14);
+      }
+      /* Using K+e with e < 1 guarantees we cannot get more than K pulses. */
+      rcp16 = _mm512_set1_ps((K+.8f)/sum);
+      xy16 = yy16 = _mm512_setzero_ps();
+      pulses_sum = _mm512_setzero_si512();
+      for (j=0;j<N;j+=16)
+      {
+         __m512 x16, y16;
+         __m512i iy16;
+         x16 = _mm512_loadu_ps(&X[j]);
+         iy16 = _mm512_cvttps_epi32(_mm512_mul_ps(x16, rcp16));
+         pulses_sum = _mm512_add_epi32(pulses_sum, iy16);
+         _mm512_mask_storeu_epi32(&iy[j], iy_mask_avx512(j, N), iy16);
+         y16 = _mm512_cvtepi32_ps(iy16);
+         xy16 = _mm512_fmadd_ps(x16, y16, xy16);
+         yy16 = _mm512_fmadd_ps(y16, y16, yy16);
+         /* double the y[] vector so we don't have to do it in the search loop. */
+         _mm512_storeu_ps(&y[j], _mm512_add_ps(y16, y16));
+      }
+      pulsesLeft -= _mm512_reduce_add_epi32(pulses_sum);
+      xy = _mm512_reduce_add_ps(xy16);
+      yy = _mm512_reduce_add_ps(yy16);
+   }
+   for (j=N;j<N+15;j++)
+   {
+      X[j] = -100;
+      y[j] = 100;
+   }
+   celt_sig_assert(pulsesLeft>=0);
+
+   /* This should never happen, but just in case it does (e.g. on silence)
+      we fill the first bin with pulses. */
+   if (pulsesLeft > N+3)
+   {
+      opus_val16 tmp = (opus_val16)pulsesLeft;
+      yy = MAC16_16(yy, tmp, tmp);
+      yy = MAC16_16(yy, tmp, y[0]);
+      iy[0] += pulsesLeft;
+      pulsesLeft=0;
+   }
+
+   for (i=0;i<pulsesLeft;i++)
+   {
+      int best_id;
+      __m512 xy16, yy16;
+      __m512 max;
+      __m512i count, pos;
+      __mmask16 is_max;
+      const __m512i sixteens = _mm512_set1_epi32(16);
+      /* The squared magnitude term gets added anyway, so we might as well
+         add it outside the loop */
+      yy = ADD16(yy, 1);
+      xy16 = _mm512_set1_ps(xy);
+      yy16 = _mm512_set1_ps(yy);
+      max = _mm512_setzero_ps();
+      pos = _mm512_setzero_si512();
+      count = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+      for (j=0;j<N;j+=16)
+      {
+         __m512 x16, y16, r16;
+         __mmask16 better;
+         x16 = _mm512_add_ps(_mm512_loadu_ps(&X[j]), xy16);
+         y16 = _mm512_add_ps(_mm512_loadu_ps(&y[j]), yy16);
+         r16 = _mm512_mul_ps(x16, _mm512_rsqrt14_ps(y16));
+         /* Update the index of the max, then the max. */
+         better = _mm512_cmp_ps_mask(r16, max, _CMP_GT_OQ);
+         pos = _mm512_mask_mov_epi32(pos, better, count);
+         max = _mm512_mask_mov_ps(max, better, r16);
+         count = _mm512_add_epi32(count, sixteens);
+      }
+      /* Lowest index among the lanes that hold the global max */
+      is_max = _mm512_cmp_ps_mask(max, _mm512_set1_ps(_mm512_reduce_max_ps(max)), _CMP_EQ_OQ);
+      best_id = _mm512_mask_reduce_min_epi32(is_max, pos);
+
+      /* Updating the sums of the new pulse(s) */
+      xy = ADD32(xy, EXTEND32(X[best_id]));
+      /* We're multiplying y[j] by two so we don't have to do it here */
+      yy = ADD16(yy, y[best_id]);
+
+      /* Only now that we've made the final choice, update y/iy */
+      /* Multiplying y[j] by 2 so we don't have to do it everywhere else */
+      y[best_id] += 2;
+      iy[best_id]++;
+   }
+
+   /* Put the original sign back */
+   for (j=0;j<N;j+=16)
+   {
+      __mmask16 m = iy_mask_avx512(j, N);
+      __m512i y16 = _mm512_maskz_loadu_epi32(m, &iy[j]);
+      __m512i s16 = _mm512_loadu_si512(&signy[j]);
+      _mm512_mask_storeu_epi32(&iy[j], m, _mm512_xor_si512(_mm512_add_epi32(y16, s16), s16));
+   }
+   RESTORE_STACK;
+   return yy;
+}
+
+#endif
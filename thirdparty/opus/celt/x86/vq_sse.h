@@ -31,7 +31,17 @@
 
 opus_val16 op_pvq_search_sse2(celt_norm *_X, int *iy, int K, int N, int arch);
 
-#if defined(OPUS_X86_PRESUME_SSE2)
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+opus_val16 op_pvq_search_avx512(celt_norm *_X, int *iy, int K, int N, int arch);
+#endif
+
+#if defined(OPUS_X86_PRESUME_AVX512)
+
+#define OVERRIDE_OP_PVQ_SEARCH
+#define op_pvq_search(x, iy, K, N, arch) \
+    (op_pvq_search_avx512(x, iy, K, N, arch))
+
+#elif defined(OPUS_X86_PRESUME_SSE2) && !(defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX512))
 
 #define OVERRIDE_OP_PVQ_SEARCH
 #define op_pvq_search(x, iy, K, N, arch) \
@@ -34,6 +34,8 @@
 #include "pitch.h"
 #include "pitch_sse.h"
 #include "vq.h"
+#include "kiss_fft.h"
+#include "mdct.h"
 
 #if defined(OPUS_HAVE_RTCD)
 
@@ -53,7 +55,9 @@ void (*const CELT_FIR_IMPL[OPUS_ARCHMASK + 1])(
   celt_fir_c,
   celt_fir_c,
   MAY_HAVE_SSE4_1(celt_fir), /* sse4.1  */
-  MAY_HAVE_SSE4_1(celt_fir)  /* avx  */
+  MAY_HAVE_SSE4_1(celt_fir), /* avx  */
+  MAY_HAVE_SSE4_1(celt_fir), /* avx512  */
+  MAY_HAVE_SSE4_1(celt_fir)  /* avx512 vnni */
 };
 
 void (*const XCORR_KERNEL_IMPL[OPUS_ARCHMASK + 1])(
@@ -66,7 +70,9 @@ void (*const XCORR_KERNEL_IMPL[OPUS_ARCHMASK + 1])(
   xcorr_kernel_c,
   xcorr_kernel_c,
   MAY_HAVE_SSE4_1(xcorr_kernel), /* sse4.1  */
-  MAY_HAVE_SSE4_1(xcorr_kernel)  /* avx  */
+  MAY_HAVE_SSE4_1(xcorr_kernel), /* avx  */
+  MAY_HAVE_SSE4_1(xcorr_kernel), /* avx512  */
+  MAY_HAVE_SSE4_1(xcorr_kernel)  /* avx512 vnni */
 };
 
 #endif
@@ -83,14 +89,17 @@ opus_val32 (*const CELT_INNER_PROD_IMPL[OPUS_ARCHMASK + 1])(
   celt_inner_prod_c,
   MAY_HAVE_SSE2(celt_inner_prod),
   MAY_HAVE_SSE4_1(celt_inner_prod), /* sse4.1  */
-  MAY_HAVE_SSE4_1(celt_inner_prod)  /* avx  */
+  MAY_HAVE_SSE4_1(celt_inner_prod), /* avx  */
+  MAY_HAVE_SSE4_1(celt_inner_prod), /* avx512  */
+  MAY_HAVE_SSE4_1(celt_inner_prod)  /* avx512 vnni */
 };
 
 #endif
 
 # else
 
-#if defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)
+#if !defined(OPUS_X86_PRESUME_AVX512) && (defined(OPUS_X86_MAY_HAVE_AVX512) || \
+ (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)))
 
 void (*const PITCH_XCORR_IMPL[OPUS_ARCHMASK + 1])(
          const float *_x,
@@ -104,13 +113,72 @@ void (*const PITCH_XCORR_IMPL[OPUS_ARCHMASK + 1])(
   celt_pitch_xcorr_c,
   celt_pitch_xcorr_c,
   celt_pitch_xcorr_c,
-  MAY_HAVE_AVX2(celt_pitch_xcorr)
+  MAY_HAVE_AVX2(celt_pitch_xcorr),   /* avx */
+  MAY_HAVE_AVX512(celt_pitch_xcorr), /* avx512 */
+  MAY_HAVE_AVX512(celt_pitch_xcorr)  /* avx512 vnni */
 };
 
 #endif
 
+#if defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)
 
-#if defined(OPUS_X86_MAY_HAVE_SSE) && !defined(OPUS_X86_PRESUME_SSE)
+void (*const OPUS_FFT[OPUS_ARCHMASK + 1])(
+         const kiss_fft_state *cfg,
+         const kiss_fft_cpx *fin,
+         kiss_fft_cpx *fout
+) = {
+  opus_fft_c,                        /* non-sse */
+  opus_fft_c,
+  opus_fft_c,
+  opus_fft_c,
+  MAY_HAVE_AVX2(opus_fft),
+  MAY_HAVE_AVX2(opus_fft),
+  MAY_HAVE_AVX2(opus_fft)
+};
+
+void (*const CLT_MDCT_FORWARD_IMPL[OPUS_ARCHMASK + 1])(
+         const mdct_lookup *l,
+         kiss_fft_scalar *in,
+         kiss_fft_scalar * OPUS_RESTRICT out,
+         const opus_val16 *window,
+         int overlap,
+         int shift,
+         int stride,
+         int arch
+) = {
+  clt_mdct_forward_c,                /* non-sse */
+  clt_mdct_forward_c,
+  clt_mdct_forward_c,
+  clt_mdct_forward_c,
+  MAY_HAVE_AVX2(clt_mdct_forward),
+  MAY_HAVE_AVX2(clt_mdct_forward),
+  MAY_HAVE_AVX2(clt_mdct_forward)
+};
+
+void (*const CLT_MDCT_BACKWARD_IMPL[OPUS_ARCHMASK + 1])(
+         const mdct_lookup *l,
+         kiss_fft_scalar *in,
+         kiss_fft_scalar * OPUS_RESTRICT out,
+         const opus_val16 *window,
+         int overlap,
+         int shift,
+         int stride,
+         int arch
+) = {
+  clt_mdct_backward_c,               /* non-sse */
+  clt_mdct_backward_c,
+  clt_mdct_backward_c,
+  clt_mdct_backward_c,
+  MAY_HAVE_AVX2(clt_mdct_backward),
+  MAY_HAVE_AVX2(clt_mdct_backward),
+  MAY_HAVE_AVX2(clt_mdct_backward)
+};
+
+#endif
+
+
+#if !defined(OPUS_X86_PRESUME_AVX512) && (defined(OPUS_X86_MAY_HAVE_AVX512) || \
+ (defined(OPUS_X86_MAY_HAVE_SSE) && !defined(OPUS_X86_PRESUME_SSE)))
 
 void (*const XCORR_KERNEL_IMPL[OPUS_ARCHMASK + 1])(
          const opus_val16 *x,
@@ -122,19 +190,9 @@ void (*const XCORR_KERNEL_IMPL[OPUS_ARCHMASK + 1])(
   MAY_HAVE_SSE(xcorr_kernel),
   MAY_HAVE_SSE(xcorr_kernel),
   MAY_HAVE_SSE(xcorr_kernel),
-  MAY_HAVE_SSE(xcorr_kernel)
-};
-
-opus_val32 (*const CELT_INNER_PROD_IMPL[OPUS_ARCHMASK + 1])(
-         const opus_val16 *x,
-         const opus_val16 *y,
-         int              N
-) = {
-  celt_inner_prod_c,                /* non-sse */
-  MAY_HAVE_SSE(celt_inner_prod),
-  MAY_HAVE_SSE(celt_inner_prod),
-  MAY_HAVE_SSE(celt_inner_prod),
-  MAY_HAVE_SSE(celt_inner_prod)
+  MAY_HAVE_SSE(xcorr_kernel),
+  MAY_HAVE_AVX512(xcorr_kernel), /* avx512 */
+  MAY_HAVE_AVX512(xcorr_kernel)  /* avx512 vnni */
 };
 
 void (*const DUAL_INNER_PROD_IMPL[OPUS_ARCHMASK + 1])(
@@ -149,7 +207,27 @@ void (*const DUAL_INNER_PROD_IMPL[OPUS_ARCHMASK + 1])(
   MAY_HAVE_SSE(dual_inner_prod),
   MAY_HAVE_SSE(dual_inner_prod),
   MAY_HAVE_SSE(dual_inner_prod),
-  MAY_HAVE_SSE(dual_inner_prod)
+  MAY_HAVE_SSE(dual_inner_prod),
+  MAY_HAVE_AVX512(dual_inner_prod), /* avx512 */
+  MAY_HAVE_AVX512(dual_inner_prod)  /* avx512 vnni */
+};
+
+#endif
+
+#if defined(OPUS_X86_MAY_HAVE_SSE) && !defined(OPUS_X86_PRESUME_SSE)
+
+opus_val32 (*const CELT_INNER_PROD_IMPL[OPUS_ARCHMASK + 1])(
+         const opus_val16 *x,
+         const opus_val16 *y,
+         int              N
+) = {
+  celt_inner_prod_c,                /* non-sse */
+  MAY_HAVE_SSE(celt_inner_prod),
+  MAY_HAVE_SSE(celt_inner_prod),
+  MAY_HAVE_SSE(celt_inner_prod),
+  MAY_HAVE_SSE(celt_inner_prod),
+  MAY_HAVE_SSE(celt_inner_prod),
+  MAY_HAVE_SSE(celt_inner_prod)
 };
 
 void (*const COMB_FILTER_CONST_IMPL[OPUS_ARCHMASK + 1])(
@@ -165,13 +243,16 @@ void (*const COMB_FILTER_CONST_IMPL[OPUS_ARCHMASK + 1])(
   MAY_HAVE_SSE(comb_filter_const),
   MAY_HAVE_SSE(comb_filter_const),
   MAY_HAVE_SSE(comb_filter_const),
+  MAY_HAVE_SSE(comb_filter_const),
+  MAY_HAVE_SSE(comb_filter_const),
   MAY_HAVE_SSE(comb_filter_const)
 };
 
 
 #endif
 
-#if defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_SSE2)
+#if !defined(OPUS_X86_PRESUME_AVX512) && (defined(OPUS_X86_MAY_HAVE_AVX512) || \
+ (defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_SSE2)))
 opus_val16 (*const OP_PVQ_SEARCH_IMPL[OPUS_ARCHMASK + 1])(
       celt_norm *_X, int *iy, int K, int N, int arch
 ) = {
@@ -179,7 +260,9 @@ opus_val16 (*const OP_PVQ_SEARCH_IMPL[OPUS_ARCHMASK + 1])(
   op_pvq_search_c,
   MAY_HAVE_SSE2(op_pvq_search),
   MAY_HAVE_SSE2(op_pvq_search),
-  MAY_HAVE_SSE2(op_pvq_search)
+  MAY_HAVE_SSE2(op_pvq_search),
+  MAY_HAVE_AVX512(op_pvq_search), /* avx512 */
+  MAY_HAVE_AVX512(op_pvq_search)  /* avx512 vnni */
 };
 #endif
 
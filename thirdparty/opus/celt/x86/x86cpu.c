@@ -39,7 +39,9 @@
   ((defined(OPUS_X86_MAY_HAVE_SSE) && !defined(OPUS_X86_PRESUME_SSE)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_SSE2)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE4_1) && !defined(OPUS_X86_PRESUME_SSE4_1)) || \
-  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)))
+  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)) || \
+  (defined(OPUS_X86_MAY_HAVE_AVX512) && !defined(OPUS_X86_PRESUME_AVX512)) || \
+  (defined(OPUS_X86_MAY_HAVE_AVX512_VNNI) && !defined(OPUS_X86_PRESUME_AVX512_VNNI)))
 
 #if defined(_MSC_VER)
 
@@ -99,6 +101,18 @@ static void cpuid(unsigned int CPUInfo[4], unsigned int InfoType)
 
 #endif
 
+/* Which register states the OS saves on context switches (XCR0). */
+static unsigned int xgetbv0(void)
+{
+#if defined(_MSC_VER)
+    return (unsigned int)_xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    return eax;
+#endif
+}
+
 typedef struct CPU_Feature{
     /*  SIMD: 128-bit */
     int HW_SSE;
@@ -106,6 +120,10 @@ typedef struct CPU_Feature{
     int HW_SSE41;
     /*  SIMD: 256-bit */
     int HW_AVX2;
+    /*  SIMD: 512-bit (F, DQ, BW and VL, i.e. x86-64-v4) */
+    int HW_AVX512;
+    /*  8-bit dot products on top of the above */
+    int HW_AVX512_VNNI;
 } CPU_Feature;
 
 static void opus_cpu_feature_check(CPU_Feature *cpu_feature)
@@ -122,11 +140,19 @@ static void opus_cpu_feature_check(CPU_Feature *cpu_feature)
         cpu_feature->HW_SSE2 = (info[3] & (1 << 26)) != 0;
         cpu_feature->HW_SSE41 = (info[2] & (1 << 19)) != 0;
         cpu_feature->HW_AVX2 = (info[2] & (1 << 28)) != 0 && (info[2] & (1 << 12)) != 0;
+        /* The OS has to save the opmask and upper ZMM registers too */
+        cpu_feature->HW_AVX512 = (info[2] & (1 << 27)) != 0 && (xgetbv0() & 0xE6) == 0xE6;
         if (cpu_feature->HW_AVX2 && nIds >= 7) {
             cpuid(info, 7);
             cpu_feature->HW_AVX2 = cpu_feature->HW_AVX2 && (info[1] & (1 << 5)) != 0;
+            cpu_feature->HW_AVX512 = cpu_feature->HW_AVX512 && cpu_feature->HW_AVX2 &&
+                                     (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 17)) != 0 &&
+                                     (info[1] & (1 << 30)) != 0 && (info[1] & (1U << 31)) != 0;
+            cpu_feature->HW_AVX512_VNNI = cpu_feature->HW_AVX512 && (info[2] & (1 << 11)) != 0;
         } else {
             cpu_feature->HW_AVX2 = 0;
+            cpu_feature->HW_AVX512 = 0;
+            cpu_feature->HW_AVX512_VNNI = 0;
         }
     }
     else {
@@ -134,6 +160,8 @@ static void opus_cpu_feature_check(CPU_Feature *cpu_feature)
         cpu_feature->HW_SSE2 = 0;
         cpu_feature->HW_SSE41 = 0;
         cpu_feature->HW_AVX2 = 0;
+        cpu_feature->HW_AVX512 = 0;
+        cpu_feature->HW_AVX512_VNNI = 0;
     }
 }
 
@@ -169,6 +197,18 @@ static int opus_select_arch_impl(void)
     }
     arch++;
 
+    if (!cpu_feature.HW_AVX512)
+    {
+        return arch;
+    }
+    arch++;
+
+    if (!cpu_feature.HW_AVX512_VNNI)
+    {
+        return arch;
+    }
+    arch++;
+
     return arch;
 }
 
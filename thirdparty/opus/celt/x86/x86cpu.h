@@ -52,11 +52,25 @@
 #  define MAY_HAVE_AVX2(name) name ## _c
 # endif
 
+# if defined(OPUS_X86_MAY_HAVE_AVX512)
+#  define MAY_HAVE_AVX512(name) name ## _avx512
+# else
+#  define MAY_HAVE_AVX512(name) name ## _c
+# endif
+
+# if defined(OPUS_X86_MAY_HAVE_AVX512_VNNI)
+#  define MAY_HAVE_AVX512_VNNI(name) name ## _avx512vnni
+# else
+#  define MAY_HAVE_AVX512_VNNI(name) name ## _c
+# endif
+
 # if defined(OPUS_HAVE_RTCD) && \
   ((defined(OPUS_X86_MAY_HAVE_SSE) && !defined(OPUS_X86_PRESUME_SSE)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_SSE2)) || \
   (defined(OPUS_X86_MAY_HAVE_SSE4_1) && !defined(OPUS_X86_PRESUME_SSE4_1)) || \
-  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)))
+  (defined(OPUS_X86_MAY_HAVE_AVX2) && !defined(OPUS_X86_PRESUME_AVX2)) || \
+  (defined(OPUS_X86_MAY_HAVE_AVX512) && !defined(OPUS_X86_PRESUME_AVX512)) || \
+  (defined(OPUS_X86_MAY_HAVE_AVX512_VNNI) && !defined(OPUS_X86_PRESUME_AVX512_VNNI)))
 int opus_select_arch(void);
 # endif
 
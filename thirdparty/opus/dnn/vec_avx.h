@@ -775,6 +775,203 @@ static inline void sparse_sgemv8x4(float *out, const float *weights, const int *
    }
 }
 
+#if defined(__AVX512BW__) && defined(__AVX512VL__)
+
+/* With AVX-512 we process two consecutive 8x4 blocks (8 rows by 8 columns,
+   64 contiguous bytes of weights) per instruction. The low half of the
+   input vector holds the broadcast of the first 4 inputs and the high half
+   the broadcast of the next 4; the two halves are summed at the end. */
+#if defined(__AVX512VNNI__)
+
+#define opus_mm512_dpbusds_epi32(src, a, b) _mm512_dpbusds_epi32(src, a, b)
+
+#else
+
+static inline __m512i opus_mm512_dpbusds_epi32(__m512i src, __m512i a, __m512i b) {
+  __m512i ones, tmp;
+  ones = _mm512_set1_epi16(1);
+  tmp = _mm512_maddubs_epi16(a, b);
+  tmp = _mm512_madd_epi16(tmp, ones);
+  return _mm512_add_epi32(src, tmp);
+}
+
+#endif
+
+static inline __m512i mm512_broadcast_x8(const unsigned char *x0, const unsigned char *x1) {
+  return _mm512_inserti64x4(_mm512_castsi256_si512(_mm256_broadcastd_epi32(_mm_loadu_si32(x0))),
+                            _mm256_broadcastd_epi32(_mm_loadu_si32(x1)), 1);
+}
+
+static inline __m256i mm512_fold_epi32(__m512i a, __m512i b) {
+  a = _mm512_add_epi32(a, b);
+  return _mm256_add_epi32(_mm512_castsi512_si256(a), _mm512_extracti64x4_epi64(a, 1));
+}
+
+static inline void sparse_cgemv8x4(float *_out, const opus_int8 *w, const int *idx, const float *scale, int rows, int cols, const float *_x)
+{
+   int i, j;
+   unsigned char x[MAX_INPUTS];
+   vector_ps_to_epi8(x, _x, cols);
+   for (i=0;i<rows;i+=8)
+   {
+      int colblocks;
+      __m512i vy0, vy1, vy2, vy3;
+      __m256i vy;
+      __m256 vout;
+      colblocks = *idx++;
+      vy0 = _mm512_setzero_si512();
+      vy1 = _mm512_setzero_si512();
+      vy2 = _mm512_setzero_si512();
+      vy3 = _mm512_setzero_si512();
+      j=0;
+      for (;j<colblocks-7;j+=8)
+      {
+         vy0 = opus_mm512_dpbusds_epi32(vy0, mm512_broadcast_x8(&x[idx[0]], &x[idx[1]]),
+                                        _mm512_loadu_si512((const void*)w));
+         vy1 = opus_mm512_dpbusds_epi32(vy1, mm512_broadcast_x8(&x[idx[2]], &x[idx[3]]),
+                                        _mm512_loadu_si512((const void*)(w+64)));
+         vy2 = opus_mm512_dpbusds_epi32(vy2, mm512_broadcast_x8(&x[idx[4]], &x[idx[5]]),
+                                        _mm512_loadu_si512((const void*)(w+128)));
+         vy3 = opus_mm512_dpbusds_epi32(vy3, mm512_broadcast_x8(&x[idx[6]], &x[idx[7]]),
+                                        _mm512_loadu_si512((const void*)(w+192)));
+         idx += 8;
+         w += 256;
+      }
+      for (;j<colblocks-3;j+=4)
+      {
+         vy0 = opus_mm512_dpbusds_epi32(vy0, mm512_broadcast_x8(&x[idx[0]], &x[idx[1]]),
+                                        _mm512_loadu_si512((const void*)w));
+         vy1 = opus_mm512_dpbusds_epi32(vy1, mm512_broadcast_x8(&x[idx[2]], &x[idx[3]]),
+                                        _mm512_loadu_si512((const void*)(w+64)));
+         idx += 4;
+         w += 128;
+      }
+      if (j<colblocks-1)
+      {
+         vy0 = opus_mm512_dpbusds_epi32(vy0, mm512_broadcast_x8(&x[idx[0]], &x[idx[1]]),
+                                        _mm512_loadu_si512((const void*)w));
+         idx += 2;
+         w += 64;
+         j += 2;
+      }
+      vy = mm512_fold_epi32(_mm512_add_epi32(vy0, vy2), _mm512_add_epi32(vy1, vy3));
+      if (j<colblocks)
+      {
+         vy = opus_mm256_dpbusds_epi32(vy, _mm256_broadcastd_epi32(_mm_loadu_si32(&x[*idx++])),
+                                       _mm256_loadu_si256((const __m256i *)(void*)w));
+         w += 32;
+      }
+      vout = _mm256_cvtepi32_ps(vy);
+      vout = _mm256_mul_ps(vout, _mm256_loadu_ps(&scale[i]));
+      _mm256_storeu_ps(&_out[i], vout);
+   }
+}
+
+static inline void cgemv8x4(float *_out, const opus_int8 *w, const float *scale, int rows, int cols, const float *_x)
+{
+   int i, j;
+   unsigned char x[MAX_INPUTS];
+   __m512i vx[MAX_INPUTS/8];
+   vector_ps_to_epi8(x, _x, cols);
+   /* The groups of four row blocks share the inputs, so expand them once
+      when there are any. */
+   if (rows >= 32) {
+      for (j=0;j<cols-7;j+=8) vx[j>>3] = mm512_broadcast_x8(&x[j], &x[j+4]);
+   }
+   i=0;
+   /* Four row blocks at a time keep enough independent sums in flight to
+      hide the latency of the dot products. */
+   for (;i<rows-31;i+=32)
+   {
+      const opus_int8 *w1, *w2, *w3;
+      __m512i vy0, vy1, vy2, vy3, vy4, vy5, vy6, vy7;
+      __m256i vy;
+      w1 = w + 8*cols;
+      w2 = w1 + 8*cols;
+      w3 = w2 + 8*cols;
+      vy0 = _mm512_setzero_si512();
+      vy1 = _mm512_setzero_si512();
+      vy2 = _mm512_setzero_si512();
+      vy3 = _mm512_setzero_si512();
+      vy4 = _mm512_setzero_si512();
+      vy5 = _mm512_setzero_si512();
+      vy6 = _mm512_setzero_si512();
+      vy7 = _mm512_setzero_si512();
+      for (j=0;j<cols-15;j+=16)
+      {
+         vy0 = opus_mm512_dpbusds_epi32(vy0, vx[j>>3], _mm512_loadu_si512((const void*)&w[8*j]));
+         vy1 = opus_mm512_dpbusds_epi32(vy1, vx[j>>3], _mm512_loadu_si512((const void*)&w1[8*j]));
+         vy2 = opus_mm512_dpbusds_epi32(vy2, vx[j>>3], _mm512_loadu_si512((const void*)&w2[8*j]));
+         vy3 = opus_mm512_dpbusds_epi32(vy3, vx[j>>3], _mm512_loadu_si512((const void*)&w3[8*j]));
+         vy4 = opus_mm512_dpbusds_epi32(vy4, vx[(j>>3)+1], _mm512_loadu_si512((const void*)&w[8*j+64]));
+         vy5 = opus_mm512_dpbusds_epi32(vy5, vx[(j>>3)+1], _mm512_loadu_si512((const void*)&w1[8*j+64]));
+         vy6 = opus_mm512_dpbusds_epi32(vy6, vx[(j>>3)+1], _mm512_loadu_si512((const void*)&w2[8*j+64]));
+         vy7 = opus_mm512_dpbusds_epi32(vy7, vx[(j>>3)+1], _mm512_loadu_si512((const void*)&w3[8*j+64]));
+      }
+      if (j<cols-7)
+      {
+         vy0 = opus_mm512_dpbusds_epi32(vy0, vx[j>>3], _mm512_loadu_si512((const void*)&w[8*j]));
+         vy1 = opus_mm512_dpbusds_epi32(vy1, vx[j>>3], _mm512_loadu_si512((const void*)&w1[8*j]));
+         vy2 = opus_mm512_dpbusds_epi32(vy2, vx[j>>3], _mm512_loadu_si512((const void*)&w2[8*j]));
+         vy3 = opus_mm512_dpbusds_epi32(vy3, vx[j>>3], _mm512_loadu_si512((const void*)&w3[8*j]));
+         j += 8;
+      }
+      if (j<cols)
+      {
+         /* The last 4 columns only fill the low half, the zero inputs in the
+            high half cancel whatever the cast leaves there. */
+         __m512i vxj;
+         vxj = _mm512_zextsi256_si512(_mm256_broadcastd_epi32(_mm_loadu_si32(&x[j])));
+         vy0 = opus_mm512_dpbusds_epi32(vy0, vxj, _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i *)(void*)&w[8*j])));
+         vy1 = opus_mm512_dpbusds_epi32(vy1, vxj, _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i *)(void*)&w1[8*j])));
+         vy2 = opus_mm512_dpbusds_epi32(vy2, vxj, _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i *)(void*)&w2[8*j])));
+         vy3 = opus_mm512_dpbusds_epi32(vy3, vxj, _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i *)(void*)&w3[8*j])));
+      }
+      vy = mm512_fold_epi32(vy0, vy4);
+      _mm256_storeu_ps(&_out[i], _mm256_mul_ps(_mm256_cvtepi32_ps(vy), _mm256_loadu_ps(&scale[i])));
+      vy = mm512_fold_epi32(vy1, vy5);
+      _mm256_storeu_ps(&_out[i+8], _mm256_mul_ps(_mm256_cvtepi32_ps(vy), _mm256_loadu_ps(&scale[i+8])));
+      vy = mm512_fold_epi32(vy2, vy6);
+      _mm256_storeu_ps(&_out[i+16], _mm256_mul_ps(_mm256_cvtepi32_ps(vy), _mm256_loadu_ps(&scale[i+16])));
+      vy = mm512_fold_epi32(vy3, vy7);
+      _mm256_storeu_ps(&_out[i+24], _mm256_mul_ps(_mm256_cvtepi32_ps(vy), _mm256_loadu_ps(&scale[i+24])));
+      w += 32*cols;
+   }
+   for (;i<rows;i+=8)
+   {
+      __m512i vy0, vy1;
+      __m256i vy;
+      __m256 vout;
+      vy0 = _mm512_setzero_si512();
+      vy1 = _mm512_setzero_si512();
+      j=0;
+      for (;j<cols-15;j+=16)
+      {
+         vy0 = opus_mm512_dpbusds_epi32(vy0, mm512_broadcast_x8(&x[j], &x[j+4]), _mm512_loadu_si512((const void*)w));
+         vy1 = opus_mm512_dpbusds_epi32(vy1, mm512_broadcast_x8(&x[j+8], &x[j+12]), _mm512_loadu_si512((const void*)(w+64)));
+         w += 128;
+      }
+      if (j<cols-7)
+      {
+         vy0 = opus_mm512_dpbusds_epi32(vy0, mm512_broadcast_x8(&x[j], &x[j+4]), _mm512_loadu_si512((const void*)w));
+         w += 64;
+         j += 8;
+      }
+      vy = mm512_fold_epi32(vy0, vy1);
+      if (j<cols)
+      {
+         vy = opus_mm256_dpbusds_epi32(vy, _mm256_broadcastd_epi32(_mm_loadu_si32(&x[j])),
+                                       _mm256_loadu_si256((const __m256i *)(void*)w));
+         w += 32;
+      }
+      vout = _mm256_cvtepi32_ps(vy);
+      vout = _mm256_mul_ps(vout, _mm256_loadu_ps(&scale[i]));
+      _mm256_storeu_ps(&_out[i], vout);
+   }
+}
+
+#else
+
 static inline void sparse_cgemv8x4(float *_out, const opus_int8 *w, const int *idx, const float *scale, int rows, int cols, const float *_x)
 {
    int i, j;
@@ -876,6 +1073,8 @@ static inline void cgemv8x4(float *_out, const opus_int8 *w, const float *scale,
    }
 }
 
+#endif /* __AVX512BW__ && __AVX512VL__ */
+
 #define SCALE (128.f*127.f)
 #define SCALE_1 (1.f/128.f/127.f)
 #define USE_SU_BIAS
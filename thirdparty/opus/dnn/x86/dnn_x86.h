@@ -49,8 +49,38 @@ void compute_activation_avx2(float *output, const float *input, int N, int activ
 void compute_conv2d_avx2(const Conv2dLayer *conv, float *out, float *mem, const float *in, int height, int hstride, int activation);
 #endif
 
+#if defined(OPUS_X86_MAY_HAVE_AVX512)
+void compute_linear_avx512(const LinearLayer *linear, float *out, const float *in);
+void compute_activation_avx512(float *output, const float *input, int N, int activation);
+void compute_conv2d_avx512(const Conv2dLayer *conv, float *out, float *mem, const float *in, int height, int hstride, int activation);
+#endif
+
+#if defined(OPUS_X86_MAY_HAVE_AVX512_VNNI)
+void compute_linear_avx512vnni(const LinearLayer *linear, float *out, const float *in);
+void compute_activation_avx512vnni(float *output, const float *input, int N, int activation);
+void compute_conv2d_avx512vnni(const Conv2dLayer *conv, float *out, float *mem, const float *in, int height, int hstride, int activation);
+#endif
+
+
+#if defined(OPUS_X86_PRESUME_AVX512_VNNI)
+
+#define OVERRIDE_COMPUTE_LINEAR
+#define compute_linear(linear, out, in, arch) ((void)(arch),compute_linear_avx512vnni(linear, out, in))
+#define OVERRIDE_COMPUTE_ACTIVATION
+#define compute_activation(output, input, N, activation, arch) ((void)(arch),compute_activation_avx512vnni(output, input, N, activation))
+#define OVERRIDE_COMPUTE_CONV2D
+#define compute_conv2d(conv, out, mem, in, height, hstride, activation, arch) ((void)(arch),compute_conv2d_avx512vnni(conv, out, mem, in, height, hstride, activation))
+
+#elif defined(OPUS_X86_PRESUME_AVX512) && !defined(OPUS_X86_MAY_HAVE_AVX512_VNNI)
+
+#define OVERRIDE_COMPUTE_LINEAR
+#define compute_linear(linear, out, in, arch) ((void)(arch),compute_linear_avx512(linear, out, in))
+#define OVERRIDE_COMPUTE_ACTIVATION
+#define compute_activation(output, input, N, activation, arch) ((void)(arch),compute_activation_avx512(output, input, N, activation))
+#define OVERRIDE_COMPUTE_CONV2D
+#define compute_conv2d(conv, out, mem, in, height, hstride, activation, arch) ((void)(arch),compute_conv2d_avx512(conv, out, mem, in, height, hstride, activation))
 
-#if defined(OPUS_X86_PRESUME_AVX2)
+#elif defined(OPUS_X86_PRESUME_AVX2) && !defined(OPUS_X86_MAY_HAVE_AVX512) && !defined(OPUS_X86_MAY_HAVE_AVX512_VNNI)
 
 #define OVERRIDE_COMPUTE_LINEAR
 #define compute_linear(linear, out, in, arch) ((void)(arch),compute_linear_avx2(linear, out, in))
@@ -77,7 +107,7 @@ void compute_conv2d_avx2(const Conv2dLayer *conv, float *out, float *mem, const
 #define OVERRIDE_COMPUTE_CONV2D
 #define compute_conv2d(conv, out, mem, in, height, hstride, activation, arch) ((void)(arch),compute_conv2d_sse2(conv, out, mem, in, height, hstride, activation))
 
-#elif defined(OPUS_HAVE_RTCD) && (defined(OPUS_X86_MAY_HAVE_AVX2) || defined(OPUS_X86_MAY_HAVE_SSE4_1) || defined(OPUS_X86_MAY_HAVE_SSE2))
+#elif defined(OPUS_HAVE_RTCD) && (defined(OPUS_X86_MAY_HAVE_AVX512_VNNI) || defined(OPUS_X86_MAY_HAVE_AVX512) || defined(OPUS_X86_MAY_HAVE_AVX2) || defined(OPUS_X86_MAY_HAVE_SSE4_1) || defined(OPUS_X86_MAY_HAVE_SSE2))
 
 extern void (*const DNN_COMPUTE_LINEAR_IMPL[OPUS_ARCHMASK + 1])(
                     const LinearLayer *linear,
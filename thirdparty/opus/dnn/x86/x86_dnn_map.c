@@ -34,7 +34,9 @@
 
 #if defined(OPUS_HAVE_RTCD)
 
-#if (defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_AVX2))
+#if (defined(OPUS_X86_MAY_HAVE_SSE2) && !defined(OPUS_X86_PRESUME_AVX512_VNNI) && \
+  !(defined(OPUS_X86_PRESUME_AVX512) && !defined(OPUS_X86_MAY_HAVE_AVX512_VNNI)) && \
+  !(defined(OPUS_X86_PRESUME_AVX2) && !defined(OPUS_X86_MAY_HAVE_AVX512) && !defined(OPUS_X86_MAY_HAVE_AVX512_VNNI)))
 
 void (*const DNN_COMPUTE_LINEAR_IMPL[OPUS_ARCHMASK + 1])(
          const LinearLayer *linear,
@@ -45,7 +47,9 @@ void (*const DNN_COMPUTE_LINEAR_IMPL[OPUS_ARCHMASK + 1])(
   compute_linear_c,
   MAY_HAVE_SSE2(compute_linear),
   MAY_HAVE_SSE4_1(compute_linear), /* sse4.1  */
-  MAY_HAVE_AVX2(compute_linear)  /* avx  */
+  MAY_HAVE_AVX2(compute_linear), /* avx  */
+  MAY_HAVE_AVX512(compute_linear), /* avx512 */
+  MAY_HAVE_AVX512_VNNI(compute_linear)  /* avx512 vnni */
 };
 
 void (*const DNN_COMPUTE_ACTIVATION_IMPL[OPUS_ARCHMASK + 1])(
@@ -58,7 +62,9 @@ void (*const DNN_COMPUTE_ACTIVATION_IMPL[OPUS_ARCHMASK + 1])(
   compute_activation_c,
   MAY_HAVE_SSE2(compute_activation),
   MAY_HAVE_SSE4_1(compute_activation), /* sse4.1  */
-  MAY_HAVE_AVX2(compute_activation)  /* avx  */
+  MAY_HAVE_AVX2(compute_activation), /* avx  */
+  MAY_HAVE_AVX512(compute_activation), /* avx512 */
+  MAY_HAVE_AVX512_VNNI(compute_activation)  /* avx512 vnni */
 };
 
 void (*const DNN_COMPUTE_CONV2D_IMPL[OPUS_ARCHMASK + 1])(
@@ -74,7 +80,9 @@ void (*const DNN_COMPUTE_CONV2D_IMPL[OPUS_ARCHMASK + 1])(
   compute_conv2d_c,
   MAY_HAVE_SSE2(compute_conv2d),
   MAY_HAVE_SSE4_1(compute_conv2d), /* sse4.1  */
-  MAY_HAVE_AVX2(compute_conv2d)  /* avx  */
+  MAY_HAVE_AVX2(compute_conv2d), /* avx  */
+  MAY_HAVE_AVX512(compute_conv2d), /* avx512 */
+  MAY_HAVE_AVX512_VNNI(compute_conv2d)  /* avx512 vnni */
 };
 
 #endif
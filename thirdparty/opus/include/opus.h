@@ -163,6 +163,11 @@ extern "C" {
   */
 typedef struct OpusEncoder OpusEncoder;
 
+/** Tonality analysis running ahead of an encoder on another thread.
+  * @see opus_analysis_ahead_create
+  */
+typedef struct OpusAnalysisAhead OpusAnalysisAhead;
+
 /** Gets the size of an <code>OpusEncoder</code> structure.
   * @param[in] channels <tt>int</tt>: Number of channels.
   *                                   This must be 1 or 2.
@@ -309,6 +314,52 @@ OPUS_EXPORT OPUS_WARN_UNUSED_RESULT opus_int32 opus_encode_float(
     opus_int32 max_data_bytes
 ) OPUS_ARG_NONNULL(1) OPUS_ARG_NONNULL(2) OPUS_ARG_NONNULL(4);
 
+/** Encodes one frame of the same input at several bitrates.
+  *
+  * Each encoder is one tier of a simulcast, set up with its own bitrate (or
+  * any other setting). The packets are exactly those of calling
+  * opus_encode_float() on each encoder in turn. The first encoder runs the
+  * tonality analysis as usual. The others skip it and take over its result,
+  * if their analysis state is exactly that of the first encoder: same
+  * sampling rate, channel count, LSB depth and frame duration, complexity 7
+  * or higher (10 in fixed point) on all of them, and fed the same input
+  * since they were created (or copied with opus_encoder_copy()) without
+  * being reset apart. The rest of each encode
+  * depends on the bitrate and is done once per tier. Encoders with an
+  * #OpusAnalysisAhead attached take the usual path.
+  * @param [in] st <tt>OpusEncoder* const*</tt>: \a count distinct encoders, the first one runs the analysis.
+  * @param [in] pcm <tt>const float*</tt>: Input for every encoder, as for opus_encode_float().
+  * @param [in] count <tt>int</tt>: Number of encoders, at least 1.
+  * @param [in] frame_size <tt>int</tt>: Samples per channel in the input, as for opus_encode_float().
+  * @param [out] data <tt>unsigned char* const*</tt>: Output payload for each encoder.
+  * @param [in] max_data_bytes <tt>opus_int32</tt>: Size of each output payload.
+  * @param [out] ret <tt>opus_int32*</tt>: For each encoder, what opus_encode_float()
+  *                                        would have returned.
+  * @returns #OPUS_OK, or #OPUS_BAD_ARG if \a count is below 1.
+  */
+OPUS_EXPORT int opus_encode_float_tiers(
+    OpusEncoder *const *st,
+    const float *pcm,
+    int count,
+    int frame_size,
+    unsigned char *const *data,
+    opus_int32 max_data_bytes,
+    opus_int32 *ret
+) OPUS_ARG_NONNULL(1) OPUS_ARG_NONNULL(2) OPUS_ARG_NONNULL(5) OPUS_ARG_NONNULL(7);
+
+/** Copies the complete state of one encoder into another.
+  *
+  * dst then encodes exactly as src would from this point on, settings
+  * included, so a warm encoder can be forked, e.g. into another bitrate tier
+  * for opus_encode_float_tiers(), or saved and restored. This is a copy of
+  * the fixed size state, without the encoder's scratch memory.
+  * @param [out] dst <tt>OpusEncoder*</tt>: Encoder initialized with the same channel count as src.
+  * @param [in] src <tt>const OpusEncoder*</tt>: Encoder to copy.
+  * @returns #OPUS_OK, or #OPUS_BAD_ARG if the channel counts differ or
+  *          either encoder has an #OpusAnalysisAhead attached.
+  */
+OPUS_EXPORT int opus_encoder_copy(OpusEncoder *dst, const OpusEncoder *src) OPUS_ARG_NONNULL(1) OPUS_ARG_NONNULL(2);
+
 /** Frees an <code>OpusEncoder</code> allocated by opus_encoder_create().
   * @param[in] st <tt>OpusEncoder*</tt>: State to be freed.
   */
@@ -326,6 +377,48 @@ OPUS_EXPORT void opus_encoder_destroy(OpusEncoder *st);
   * @see opus_encoderctls
   */
 OPUS_EXPORT int opus_encoder_ctl(OpusEncoder *st, int request, ...) OPUS_ARG_NONNULL(1);
+
+/** Runs the tonality analysis of an encoder one frame ahead on another thread.
+  *
+  * With complexity 7 or higher (10 in fixed-point builds) and a sampling
+  * rate of 16 kHz or more, opus_encode_float() spends a good part of each
+  * call analyzing the frame it was given. Once this object is attached, a
+  * helper thread calls opus_analysis_ahead_float() with every frame the
+  * encoder is about to see, and opus_encode_float() only picks up the
+  * result. The helper analyzes frame n+1 while the encoder codes frame n,
+  * so the caller must have frame n+1 in hand before it finishes encoding
+  * frame n to get any overlap. The packets are the same as without it.
+  *
+  * Every opus_encode_float() call that passes its argument checks must be
+  * matched by exactly one opus_analysis_ahead_float() call that returns
+  * #OPUS_OK for the same frame (an invalid frame size fails both), in the
+  * same order and with the same frame size, from a single helper thread.
+  * Each side blocks until the other has caught up, so the helper never gets
+  * more than one frame ahead, and an encode whose frame the helper never
+  * analyzes blocks forever (sleeping, after a short spin). Only the float API
+  * can be used while the object is attached, and the LSB depth should not
+  * change.
+  * @param [in] st <tt>OpusEncoder*</tt>: Encoder to attach to.
+  * @param [out] error <tt>int*</tt>: #OPUS_OK on success, #OPUS_BAD_ARG if
+  *                                   one is already attached.
+  * @returns The attached object, or NULL on failure.
+  */
+OPUS_EXPORT OPUS_WARN_UNUSED_RESULT OpusAnalysisAhead *opus_analysis_ahead_create(OpusEncoder *st, int *error) OPUS_ARG_NONNULL(1);
+
+/** Analyzes the next frame for the encoder, from the helper thread.
+  * @param [in] ahead <tt>OpusAnalysisAhead*</tt>: Object from opus_analysis_ahead_create().
+  * @param [in] pcm <tt>float*</tt>: The same input that will be passed to opus_encode_float().
+  * @param [in] frame_size <tt>int</tt>: The same frame size that will be passed to opus_encode_float().
+  * @returns #OPUS_OK or #OPUS_BAD_ARG for an invalid frame size.
+  */
+OPUS_EXPORT int opus_analysis_ahead_float(OpusAnalysisAhead *ahead, const float *pcm, int frame_size) OPUS_ARG_NONNULL(1) OPUS_ARG_NONNULL(2);
+
+/** Detaches and frees the object, the encoder goes back to analyzing inline.
+  * Call it once the helper has stopped and every frame it analyzed has been
+  * encoded, and before destroying the encoder.
+  * @param[in] ahead <tt>OpusAnalysisAhead*</tt>: Object to free.
+  */
+OPUS_EXPORT void opus_analysis_ahead_destroy(OpusAnalysisAhead *ahead) OPUS_ARG_NONNULL(1);
 /**@}*/
 
 /** @defgroup opus_decoder Opus Decoder
@@ -387,7 +480,8 @@ OPUS_EXPORT int opus_encoder_ctl(OpusEncoder *st, int request, ...) OPUS_ARG_NON
   * a time and any required locking must be performed by the caller. Separate
   * streams must be decoded with separate decoder states and can be decoded
   * in parallel unless the library was compiled with NONTHREADSAFE_PSEUDOSTACK
-  * defined.
+  * defined. States built with OPUS_SCRATCH_ARENA keep their temporaries in
+  * their own allocation and can be used in parallel as well.
   *
   */
 
@@ -1090,6 +1184,83 @@ OPUS_EXPORT int opus_multistream_packet_pad(unsigned char *data, opus_int32 len,
   */
 OPUS_EXPORT OPUS_WARN_UNUSED_RESULT opus_int32 opus_multistream_packet_unpad(unsigned char *data, opus_int32 len, int nb_streams);
 
+/** One extension carried in the padding of an Opus packet.
+  * Ids 2 to 31 carry 0 or 1 byte of payload, ids 32 to 127 any length. The
+  * repacketizer keeps every extension with its frame when packets are merged
+  * or split.
+  */
+typedef struct OpusExtensionData {
+   int id;                    /**< 2 to 127 */
+   int frame;                 /**< Index of the frame in the packet it belongs to */
+   const unsigned char *data; /**< Payload */
+   opus_int32 len;            /**< Payload size in bytes */
+} OpusExtensionData;
+
+/** Writes extensions in the format of the padding of an Opus packet.
+  * @param[out] data <tt>unsigned char*</tt>: Output buffer, NULL to only
+  *                                          compute the size.
+  * @param len <tt>opus_int32</tt>: Size of the output buffer.
+  * @param[in] extensions <tt>const OpusExtensionData*</tt>: Extensions to write.
+  * @param nb_extensions <tt>opus_int32</tt>: Number of extensions.
+  * @param pad <tt>int</tt>: Fill the whole of \a len, with padding in front.
+  * @returns The number of bytes written, or an error code on failure.
+  * @retval #OPUS_BAD_ARG An extension had an invalid id, frame or length.
+  * @retval #OPUS_BUFFER_TOO_SMALL \a len was insufficient.
+  */
+OPUS_EXPORT opus_int32 opus_packet_extensions_generate(unsigned char *data, opus_int32 len, const OpusExtensionData *extensions, opus_int32 nb_extensions, int pad);
+
+/** Reads every extension out of the padding of an Opus packet, see
+  * opus_packet_get_extensions().
+  * @param[in] data <tt>const unsigned char*</tt>: The padding.
+  * @param len <tt>opus_int32</tt>: Size of the padding.
+  * @param[out] extensions <tt>OpusExtensionData*</tt>: The extensions found,
+  *                                                   their payloads point into \a data.
+  * @param[in,out] nb_extensions <tt>opus_int32*</tt>: Room in \a extensions on
+  *                                                  input, extensions found on output.
+  * @returns #OPUS_OK, or an error code on failure.
+  * @retval #OPUS_BUFFER_TOO_SMALL There are more than \a nb_extensions extensions.
+  * @retval #OPUS_INVALID_PACKET The padding is malformed.
+  */
+OPUS_EXPORT opus_int32 opus_packet_extensions_parse(const unsigned char *data, opus_int32 len, OpusExtensionData *extensions, opus_int32 *nb_extensions);
+
+/** Finds one extension in the padding of an Opus packet without parsing the
+  * rest. The walk skips runs of padding bytes at once and stops at the first
+  * match or once past \a frame, so an extension written first for its frame
+  * is found in constant time.
+  * @param[in] data <tt>const unsigned char*</tt>: The padding.
+  * @param len <tt>opus_int32</tt>: Size of the padding.
+  * @param id <tt>int</tt>: Extension id, 2 to 127.
+  * @param frame <tt>int</tt>: Index of the frame it belongs to.
+  * @param[out] payload <tt>const unsigned char**</tt>: The first such
+  *                                                 extension's payload, NULL if there is none.
+  * @returns The payload size (0 also when there is no such extension), or
+  *          #OPUS_INVALID_PACKET if the padding is malformed before it.
+  */
+OPUS_EXPORT opus_int32 opus_packet_extensions_find(const unsigned char *data, opus_int32 len, int id, int frame, const unsigned char **payload) OPUS_ARG_NONNULL(5);
+
+/** Locates the padding of an Opus packet, where its extensions are.
+  * @param[in] data <tt>const unsigned char*</tt>: The packet.
+  * @param len <tt>opus_int32</tt>: Size of the packet.
+  * @param[out] padding <tt>const unsigned char**</tt>: Start of the padding,
+  *                                                 NULL when the packet has none.
+  * @returns The size of the padding, or #OPUS_INVALID_PACKET.
+  */
+OPUS_EXPORT opus_int32 opus_packet_get_extensions(const unsigned char *data, opus_int32 len, const unsigned char **padding) OPUS_ARG_NONNULL(3);
+
+/** Adds extensions to an Opus packet in place, keeping those it already has.
+  * The packet grows by the extensions plus a few bytes of framing.
+  * @param[in,out] data <tt>unsigned char*</tt>: The packet.
+  * @param len <tt>opus_int32</tt>: Size of the packet.
+  * @param maxlen <tt>opus_int32</tt>: Size of the buffer holding it.
+  * @param[in] extensions <tt>const OpusExtensionData*</tt>: Extensions to add,
+  *                                                       \a frame counted within this packet.
+  * @param nb_extensions <tt>int</tt>: Number of extensions.
+  * @returns The new size of the packet, or an error code on failure.
+  * @retval #OPUS_BUFFER_TOO_SMALL \a maxlen was insufficient.
+  * @retval #OPUS_INVALID_PACKET \a data did not contain a valid Opus packet.
+  */
+OPUS_EXPORT OPUS_WARN_UNUSED_RESULT opus_int32 opus_packet_add_extensions(unsigned char *data, opus_int32 len, opus_int32 maxlen, const OpusExtensionData *extensions, int nb_extensions);
+
 /**@}*/
 
 #ifdef __cplusplus
@@ -173,6 +173,7 @@ extern "C" {
 #define OPUS_GET_DRED_DURATION_REQUEST 4051
 #define OPUS_SET_DNN_BLOB_REQUEST 4052
 /*#define OPUS_GET_DNN_BLOB_REQUEST 4053 */
+#define OPUS_GET_SCRATCH_PEAK_REQUEST 4054
 
 /** Defines for the presence of extended APIs. */
 #define OPUS_HAVE_OPUS_PROJECTION_H
@@ -757,6 +758,15 @@ extern "C" {
   * </dl>
   * @hideinitializer */
 #define OPUS_GET_IN_DTX(x) OPUS_GET_IN_DTX_REQUEST, __opus_check_int_ptr(x)
+/** Gets the most scratch memory a single encode or decode call has needed
+  * since the state was initialized.
+  * This is only implemented when the library was compiled with
+  * OPUS_SCRATCH_ARENA, where every state carries its own arena for codec
+  * temporaries. A value above the arena size means some temporaries fell
+  * back to the caller's stack.
+  * @param[out] x <tt>opus_int32 *</tt>: Peak scratch usage in bytes.
+  * @hideinitializer */
+#define OPUS_GET_SCRATCH_PEAK(x) OPUS_GET_SCRATCH_PEAK_REQUEST, __opus_check_int_ptr(x)
 
 /**@}*/
 
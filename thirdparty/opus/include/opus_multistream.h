@@ -46,6 +46,7 @@ extern "C" {
 /**@{*/
 #define __opus_check_encstate_ptr(ptr) ((ptr) + ((ptr) - (OpusEncoder**)(ptr)))
 #define __opus_check_decstate_ptr(ptr) ((ptr) + ((ptr) - (OpusDecoder**)(ptr)))
+#define __opus_check_encode_pool_ptr(ptr) ((void)((ptr) == (OpusEncodePool*)(ptr)), (ptr))
 /**@}*/
 
 /** These are the actual encoder and decoder CTL ID numbers.
@@ -54,6 +55,7 @@ extern "C" {
 /**@{*/
 #define OPUS_MULTISTREAM_GET_ENCODER_STATE_REQUEST 5120
 #define OPUS_MULTISTREAM_GET_DECODER_STATE_REQUEST 5122
+#define OPUS_MULTISTREAM_SET_ENCODE_POOL_REQUEST 5124
 /**@}*/
 
 /** @endcond */
@@ -98,6 +100,24 @@ extern "C" {
   */
 #define OPUS_MULTISTREAM_GET_DECODER_STATE(x,y) OPUS_MULTISTREAM_GET_DECODER_STATE_REQUEST, __opus_check_int(x), __opus_check_decstate_ptr(y)
 
+/** Encodes the streams of each frame on the threads of a pool.
+  * Every stream's encoder runs the whole frame on one thread, the caller's
+  * or one of the pool's. When \a max_data_bytes is large enough that no
+  * stream's budget depends on what the streams before it produced (at least
+  * 1278 bytes per stream for frames up to 20 ms) the packet is exactly that of
+  * the serial encode. Otherwise \a max_data_bytes is split between the streams
+  * up front in proportion to their bitrates, and only frames where a stream
+  * needs more than its share differ from the serial encode. In CBR mode the
+  * last stream is encoded after the others and fills the packet, so packet
+  * sizes are those of the serial encode. Also applies to projection encoders.
+  * @param[in] x <tt>OpusEncodePool*</tt>: Pool from opus_encode_pool_create(),
+  *                                        or NULL to encode serially (the
+  *                                        default). It must outlive its use
+  *                                        by the encoder.
+  * @hideinitializer
+  */
+#define OPUS_MULTISTREAM_SET_ENCODE_POOL(x) OPUS_MULTISTREAM_SET_ENCODE_POOL_REQUEST, __opus_check_encode_pool_ptr(x)
+
 /**@}*/
 
 /** @defgroup opus_multistream Opus Multistream API
@@ -174,6 +194,13 @@ extern "C" {
   */
 typedef struct OpusMSEncoder OpusMSEncoder;
 
+/** Persistent threads that encode the streams of a multistream frame in
+  * parallel.
+  * @see opus_encode_pool_create
+  * @see OPUS_MULTISTREAM_SET_ENCODE_POOL
+  */
+typedef struct OpusEncodePool OpusEncodePool;
+
 /** Opus multistream decoder state.
   * This contains the complete state of a multistream Opus decoder.
   * It is position independent and can be freely copied.
@@ -433,6 +460,25 @@ OPUS_EXPORT OPUS_WARN_UNUSED_RESULT int opus_multistream_encode_float(
   */
 OPUS_EXPORT void opus_multistream_encoder_destroy(OpusMSEncoder *st);
 
+/** Starts a pool of encoding threads.
+  * Attach it to any number of multistream or projection encoders with
+  * #OPUS_MULTISTREAM_SET_ENCODE_POOL. The thread calling the encode works
+  * along with the pool's, so \a threads is one less than the number of
+  * streams encoded at once. A pool serves one encode call at a time: encoders
+  * sharing it must not be encoded concurrently.
+  * @param threads <tt>int</tt>: Threads to start, 1 to 254.
+  * @param[out] error <tt>int *</tt>: Returns #OPUS_OK on success, or an error
+  *                                   code (see @ref opus_errorcodes) on
+  *                                   failure.
+  */
+OPUS_EXPORT OPUS_WARN_UNUSED_RESULT OpusEncodePool *opus_encode_pool_create(int threads, int *error);
+
+/** Stops the threads of a pool and frees it.
+  * No encoder may use it afterwards.
+  * @param pool <tt>OpusEncodePool*</tt>: Pool from opus_encode_pool_create().
+  */
+OPUS_EXPORT void opus_encode_pool_destroy(OpusEncodePool *pool) OPUS_ARG_NONNULL(1);
+
 /** Perform a CTL function on a multistream Opus encoder.
   *
   * Generally the request and subsequent arguments are generated by a
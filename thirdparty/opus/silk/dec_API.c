@@ -207,19 +207,19 @@ opus_int silk_Decode(                                   /* O    Returns error co
                 RESTORE_STACK;
                 return SILK_DEC_INVALID_SAMPLING_FREQUENCY;
             }
-            ret += silk_decoder_set_fs( &channel_state[ n ], fs_kHz_dec, decControl->API_sampleRate );
+            ret += silk_decoder_set_fs( &channel_state[ n ], fs_kHz_dec, OPUS_API_FS(decControl->API_sampleRate) );
         }
     }
 
-    if( decControl->nChannelsAPI == 2 && decControl->nChannelsInternal == 2 && ( psDec->nChannelsAPI == 1 || psDec->nChannelsInternal == 1 ) ) {
+    if( OPUS_API_CHANNELS(decControl->nChannelsAPI) == 2 && decControl->nChannelsInternal == 2 && ( OPUS_API_CHANNELS(psDec->nChannelsAPI) == 1 || psDec->nChannelsInternal == 1 ) ) {
         silk_memset( psDec->sStereo.pred_prev_Q13, 0, sizeof( psDec->sStereo.pred_prev_Q13 ) );
         silk_memset( psDec->sStereo.sSide, 0, sizeof( psDec->sStereo.sSide ) );
         silk_memcpy( &channel_state[ 1 ].resampler_state, &channel_state[ 0 ].resampler_state, sizeof( silk_resampler_state_struct ) );
     }
-    psDec->nChannelsAPI      = decControl->nChannelsAPI;
+    psDec->nChannelsAPI      = OPUS_API_CHANNELS(decControl->nChannelsAPI);
     psDec->nChannelsInternal = decControl->nChannelsInternal;
 
-    if( decControl->API_sampleRate > (opus_int32)MAX_API_FS_KHZ * 1000 || decControl->API_sampleRate < 8000 ) {
+    if( OPUS_API_FS(decControl->API_sampleRate) > (opus_int32)MAX_API_FS_KHZ * 1000 || OPUS_API_FS(decControl->API_sampleRate) < 8000 ) {
         ret = SILK_DEC_INVALID_SAMPLING_FREQUENCY;
         RESTORE_STACK;
         return( ret );
@@ -313,7 +313,7 @@ opus_int silk_Decode(                                   /* O    Returns error co
        we can delay allocating the temp buffer until after the SILK peak stack
        usage. We need to use a < and not a <= because of the two extra samples. */
     delay_stack_alloc = decControl->internalSampleRate*decControl->nChannelsInternal
-          < decControl->API_sampleRate*decControl->nChannelsAPI;
+          < OPUS_API_FS(decControl->API_sampleRate)*OPUS_API_CHANNELS(decControl->nChannelsAPI);
     ALLOC( samplesOut1_tmp_storage1, delay_stack_alloc ? ALLOC_NONE
            : decControl->nChannelsInternal*(channel_state[ 0 ].frame_length + 2 ),
            opus_int16 );
@@ -371,7 +371,7 @@ opus_int silk_Decode(                                   /* O    Returns error co
         channel_state[ n ].nFramesDecoded++;
     }
 
-    if( decControl->nChannelsAPI == 2 && decControl->nChannelsInternal == 2 ) {
+    if( OPUS_API_CHANNELS(decControl->nChannelsAPI) == 2 && decControl->nChannelsInternal == 2 ) {
         /* Convert Mid/Side to Left/Right */
         silk_stereo_MS_to_LR( &psDec->sStereo, samplesOut1_tmp[ 0 ], samplesOut1_tmp[ 1 ], MS_pred_Q13, channel_state[ 0 ].fs_kHz, nSamplesOutDec );
     } else {
@@ -381,12 +381,12 @@ opus_int silk_Decode(                                   /* O    Returns error co
     }
 
     /* Number of output samples */
-    *nSamplesOut = silk_DIV32( nSamplesOutDec * decControl->API_sampleRate, silk_SMULBB( channel_state[ 0 ].fs_kHz, 1000 ) );
+    *nSamplesOut = silk_DIV32( nSamplesOutDec * OPUS_API_FS(decControl->API_sampleRate), silk_SMULBB( channel_state[ 0 ].fs_kHz, 1000 ) );
 
     /* Set up pointers to temp buffers */
     ALLOC( samplesOut2_tmp,
-           decControl->nChannelsAPI == 2 ? *nSamplesOut : ALLOC_NONE, opus_int16 );
-    if( decControl->nChannelsAPI == 2 ) {
+           OPUS_API_CHANNELS(decControl->nChannelsAPI) == 2 ? *nSamplesOut : ALLOC_NONE, opus_int16 );
+    if( OPUS_API_CHANNELS(decControl->nChannelsAPI) == 2 ) {
         resample_out_ptr = samplesOut2_tmp;
     } else {
         resample_out_ptr = samplesOut;
@@ -401,13 +401,13 @@ opus_int silk_Decode(                                   /* O    Returns error co
        samplesOut1_tmp[ 0 ] = samplesOut1_tmp_storage2;
        samplesOut1_tmp[ 1 ] = samplesOut1_tmp_storage2 + channel_state[ 0 ].frame_length + 2;
     }
-    for( n = 0; n < silk_min( decControl->nChannelsAPI, decControl->nChannelsInternal ); n++ ) {
+    for( n = 0; n < silk_min( OPUS_API_CHANNELS(decControl->nChannelsAPI), decControl->nChannelsInternal ); n++ ) {
 
         /* Resample decoded signal to API_sampleRate */
         ret += silk_resampler( &channel_state[ n ].resampler_state, resample_out_ptr, &samplesOut1_tmp[ n ][ 1 ], nSamplesOutDec );
 
         /* Interleave if stereo output and stereo stream */
-        if( decControl->nChannelsAPI == 2 ) {
+        if( OPUS_API_CHANNELS(decControl->nChannelsAPI) == 2 ) {
             for( i = 0; i < *nSamplesOut; i++ ) {
                 samplesOut[ n + 2 * i ] = resample_out_ptr[ i ];
             }
@@ -415,7 +415,7 @@ opus_int silk_Decode(                                   /* O    Returns error co
     }
 
     /* Create two channel output from mono stream */
-    if( decControl->nChannelsAPI == 2 && decControl->nChannelsInternal == 1 ) {
+    if( OPUS_API_CHANNELS(decControl->nChannelsAPI) == 2 && decControl->nChannelsInternal == 1 ) {
         if ( stereo_to_mono ){
             /* Resample right channel for newly collapsed stereo just in case
                we weren't doing collapsing when switching to mono */
@@ -115,8 +115,8 @@ static opus_int silk_QueryEncoder(                      /* O    Returns error co
 
     state_Fxx = psEnc->state_Fxx;
 
-    encStatus->nChannelsAPI              = psEnc->nChannelsAPI;
-    encStatus->nChannelsInternal         = psEnc->nChannelsInternal;
+    encStatus->nChannelsAPI              = OPUS_API_CHANNELS(psEnc->nChannelsAPI);
+    encStatus->nChannelsInternal         = OPUS_ENC_STREAM_CHANNELS(psEnc->nChannelsInternal);
     encStatus->API_sampleRate            = state_Fxx[ 0 ].sCmn.API_fs_Hz;
     encStatus->maxInternalSampleRate     = state_Fxx[ 0 ].sCmn.maxInternal_fs_Hz;
     encStatus->minInternalSampleRate     = state_Fxx[ 0 ].sCmn.minInternal_fs_Hz;
@@ -178,7 +178,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
 
     encControl->switchReady = 0;
 
-    if( encControl->nChannelsInternal > psEnc->nChannelsInternal ) {
+    if( OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) > OPUS_ENC_STREAM_CHANNELS(psEnc->nChannelsInternal) ) {
         /* Mono -> Stereo transition: init state of second channel and stereo state */
         ret += silk_init_encoder( &psEnc->state_Fxx[ 1 ], psEnc->state_Fxx[ 0 ].sCmn.arch );
         silk_memset( psEnc->sStereo.pred_prev_Q13, 0, sizeof( psEnc->sStereo.pred_prev_Q13 ) );
@@ -189,18 +189,18 @@ opus_int silk_Encode(                                   /* O    Returns error co
         psEnc->sStereo.mid_side_amp_Q0[ 3 ] = 1;
         psEnc->sStereo.width_prev_Q14 = 0;
         psEnc->sStereo.smth_width_Q14 = SILK_FIX_CONST( 1, 14 );
-        if( psEnc->nChannelsAPI == 2 ) {
+        if( OPUS_API_CHANNELS(psEnc->nChannelsAPI) == 2 ) {
             silk_memcpy( &psEnc->state_Fxx[ 1 ].sCmn.resampler_state, &psEnc->state_Fxx[ 0 ].sCmn.resampler_state, sizeof( silk_resampler_state_struct ) );
             silk_memcpy( &psEnc->state_Fxx[ 1 ].sCmn.In_HP_State,     &psEnc->state_Fxx[ 0 ].sCmn.In_HP_State,     sizeof( psEnc->state_Fxx[ 1 ].sCmn.In_HP_State ) );
         }
     }
 
-    transition = (encControl->payloadSize_ms != psEnc->state_Fxx[ 0 ].sCmn.PacketSize_ms) || (psEnc->nChannelsInternal != encControl->nChannelsInternal);
+    transition = (encControl->payloadSize_ms != psEnc->state_Fxx[ 0 ].sCmn.PacketSize_ms) || (OPUS_ENC_STREAM_CHANNELS(psEnc->nChannelsInternal) != OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal));
 
-    psEnc->nChannelsAPI = encControl->nChannelsAPI;
-    psEnc->nChannelsInternal = encControl->nChannelsInternal;
+    psEnc->nChannelsAPI = OPUS_API_CHANNELS(encControl->nChannelsAPI);
+    psEnc->nChannelsInternal = OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal);
 
-    nBlocksOf10ms = silk_DIV32( 100 * nSamplesIn, encControl->API_sampleRate );
+    nBlocksOf10ms = silk_DIV32( 100 * nSamplesIn, OPUS_API_FS(encControl->API_sampleRate) );
     tot_blocks = ( nBlocksOf10ms > 1 ) ? nBlocksOf10ms >> 1 : 1;
     curr_block = 0;
     if( prefillFlag ) {
@@ -217,7 +217,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
             save_LP.saved_fs_kHz = psEnc->state_Fxx[ 0 ].sCmn.fs_kHz;
         }
         /* Reset Encoder */
-        for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+        for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
             ret = silk_init_encoder( &psEnc->state_Fxx[ n ], psEnc->state_Fxx[ n ].sCmn.arch );
             /* Restore the variable LP state. */
             if ( prefillFlag == 2 ) {
@@ -229,26 +229,26 @@ opus_int silk_Encode(                                   /* O    Returns error co
         encControl->payloadSize_ms = 10;
         tmp_complexity = encControl->complexity;
         encControl->complexity = 0;
-        for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+        for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
             psEnc->state_Fxx[ n ].sCmn.controlled_since_last_payload = 0;
             psEnc->state_Fxx[ n ].sCmn.prefillFlag = 1;
         }
     } else {
         /* Only accept input lengths that are a multiple of 10 ms */
-        if( nBlocksOf10ms * encControl->API_sampleRate != 100 * nSamplesIn || nSamplesIn < 0 ) {
+        if( nBlocksOf10ms * OPUS_API_FS(encControl->API_sampleRate) != 100 * nSamplesIn || nSamplesIn < 0 ) {
             celt_assert( 0 );
             RESTORE_STACK;
             return SILK_ENC_INPUT_INVALID_NO_OF_SAMPLES;
         }
         /* Make sure no more than one packet can be produced */
-        if( 1000 * (opus_int32)nSamplesIn > encControl->payloadSize_ms * encControl->API_sampleRate ) {
+        if( 1000 * (opus_int32)nSamplesIn > encControl->payloadSize_ms * OPUS_API_FS(encControl->API_sampleRate) ) {
             celt_assert( 0 );
             RESTORE_STACK;
             return SILK_ENC_INPUT_INVALID_NO_OF_SAMPLES;
         }
     }
 
-    for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+    for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
         /* Force the side channel to the same rate as the mid */
         opus_int force_fs_kHz = (n==1) ? psEnc->state_Fxx[0].sCmn.fs_kHz : 0;
         if( ( ret = silk_control_encoder( &psEnc->state_Fxx[ n ], encControl, psEnc->allowBandwidthSwitch, n, force_fs_kHz ) ) != 0 ) {
@@ -279,7 +279,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
         nSamplesToBuffer  = silk_min( nSamplesToBuffer, nSamplesToBufferMax );
         nSamplesFromInput = silk_DIV32_16( nSamplesToBuffer * psEnc->state_Fxx[ 0 ].sCmn.API_fs_Hz, psEnc->state_Fxx[ 0 ].sCmn.fs_kHz * 1000 );
         /* Resample and write to buffer */
-        if( encControl->nChannelsAPI == 2 && encControl->nChannelsInternal == 2 ) {
+        if( OPUS_API_CHANNELS(encControl->nChannelsAPI) == 2 && OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) == 2 ) {
             opus_int id = psEnc->state_Fxx[ 0 ].sCmn.nFramesEncoded;
             for( n = 0; n < nSamplesFromInput; n++ ) {
                 buf[ n ] = samplesIn[ 2 * n ];
@@ -302,7 +302,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
                 &psEnc->state_Fxx[ 1 ].sCmn.inputBuf[ psEnc->state_Fxx[ 1 ].sCmn.inputBufIx + 2 ], buf, nSamplesFromInput );
 
             psEnc->state_Fxx[ 1 ].sCmn.inputBufIx += nSamplesToBuffer;
-        } else if( encControl->nChannelsAPI == 2 && encControl->nChannelsInternal == 1 ) {
+        } else if( OPUS_API_CHANNELS(encControl->nChannelsAPI) == 2 && OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) == 1 ) {
             /* Combine left and right channels before resampling */
             for( n = 0; n < nSamplesFromInput; n++ ) {
                 sum = samplesIn[ 2 * n ] + samplesIn[ 2 * n + 1 ];
@@ -329,7 +329,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
             psEnc->state_Fxx[ 0 ].sCmn.inputBufIx += nSamplesToBuffer;
         }
 
-        samplesIn  += nSamplesFromInput * encControl->nChannelsAPI;
+        samplesIn  += nSamplesFromInput * OPUS_API_CHANNELS(encControl->nChannelsAPI);
         nSamplesIn -= nSamplesFromInput;
 
         /* Default */
@@ -345,13 +345,13 @@ opus_int silk_Encode(                                   /* O    Returns error co
             if( psEnc->state_Fxx[ 0 ].sCmn.nFramesEncoded == 0 && !prefillFlag ) {
                 /* Create space at start of payload for VAD and FEC flags */
                 opus_uint8 iCDF[ 2 ] = { 0, 0 };
-                iCDF[ 0 ] = 256 - silk_RSHIFT( 256, ( psEnc->state_Fxx[ 0 ].sCmn.nFramesPerPacket + 1 ) * encControl->nChannelsInternal );
+                iCDF[ 0 ] = 256 - silk_RSHIFT( 256, ( psEnc->state_Fxx[ 0 ].sCmn.nFramesPerPacket + 1 ) * OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) );
                 ec_enc_icdf( psRangeEnc, 0, iCDF, 8 );
                 curr_nBitsUsedLBRR = ec_tell( psRangeEnc );
 
                 /* Encode any LBRR data from previous packet */
                 /* Encode LBRR flags */
-                for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+                for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
                     LBRR_symbol = 0;
                     for( i = 0; i < psEnc->state_Fxx[ n ].sCmn.nFramesPerPacket; i++ ) {
                         LBRR_symbol |= silk_LSHIFT( psEnc->state_Fxx[ n ].sCmn.LBRR_flags[ i ], i );
@@ -364,11 +364,11 @@ opus_int silk_Encode(                                   /* O    Returns error co
 
                 /* Code LBRR indices and excitation signals */
                 for( i = 0; i < psEnc->state_Fxx[ 0 ].sCmn.nFramesPerPacket; i++ ) {
-                    for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+                    for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
                         if( psEnc->state_Fxx[ n ].sCmn.LBRR_flags[ i ] ) {
                             opus_int condCoding;
 
-                            if( encControl->nChannelsInternal == 2 && n == 0 ) {
+                            if( OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) == 2 && n == 0 ) {
                                 silk_stereo_encode_pred( psRangeEnc, psEnc->sStereo.predIx[ i ] );
                                 /* For LBRR data there's no need to code the mid-only flag if the side-channel LBRR flag is set */
                                 if( psEnc->state_Fxx[ 1 ].sCmn.LBRR_flags[ i ] == 0 ) {
@@ -389,7 +389,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
                 }
 
                 /* Reset LBRR flags */
-                for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+                for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
                     silk_memset( psEnc->state_Fxx[ n ].sCmn.LBRR_flags, 0, sizeof( psEnc->state_Fxx[ n ].sCmn.LBRR_flags ) );
                 }
                 curr_nBitsUsedLBRR = ec_tell( psRangeEnc ) - curr_nBitsUsedLBRR;
@@ -432,7 +432,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
             TargetRate_bps = silk_LIMIT( TargetRate_bps, encControl->bitRate, 5000 );
 
             /* Convert Left/Right to Mid/Side */
-            if( encControl->nChannelsInternal == 2 ) {
+            if( OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) == 2 ) {
                 silk_stereo_LR_to_MS( &psEnc->sStereo, &psEnc->state_Fxx[ 0 ].sCmn.inputBuf[ 2 ], &psEnc->state_Fxx[ 1 ].sCmn.inputBuf[ 2 ],
                     psEnc->sStereo.predIx[ psEnc->state_Fxx[ 0 ].sCmn.nFramesEncoded ], &psEnc->sStereo.mid_only_flags[ psEnc->state_Fxx[ 0 ].sCmn.nFramesEncoded ],
                     MStargetRates_bps, TargetRate_bps, psEnc->state_Fxx[ 0 ].sCmn.speech_activity_Q8, encControl->toMono,
@@ -469,7 +469,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
             silk_encode_do_VAD_Fxx( &psEnc->state_Fxx[ 0 ], activity );
 
             /* Encode */
-            for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+            for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
                 opus_int maxBits, useCBR;
 
                 /* Handling rate constraints */
@@ -485,7 +485,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
                 }
                 useCBR = encControl->useCBR && curr_block == tot_blocks - 1;
 
-                if( encControl->nChannelsInternal == 1 ) {
+                if( OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) == 1 ) {
                     channelRate_bps = TargetRate_bps;
                 } else {
                     channelRate_bps = MStargetRates_bps[ n ];
@@ -524,7 +524,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
             /* Insert VAD and FEC flags at beginning of bitstream */
             if( *nBytesOut > 0 && psEnc->state_Fxx[ 0 ].sCmn.nFramesEncoded == psEnc->state_Fxx[ 0 ].sCmn.nFramesPerPacket) {
                 flags = 0;
-                for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+                for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
                     for( i = 0; i < psEnc->state_Fxx[ n ].sCmn.nFramesPerPacket; i++ ) {
                         flags  = silk_LSHIFT( flags, 1 );
                         flags |= psEnc->state_Fxx[ n ].sCmn.VAD_flags[ i ];
@@ -533,11 +533,11 @@ opus_int silk_Encode(                                   /* O    Returns error co
                     flags |= psEnc->state_Fxx[ n ].sCmn.LBRR_flag;
                 }
                 if( !prefillFlag ) {
-                    ec_enc_patch_initial_bits( psRangeEnc, flags, ( psEnc->state_Fxx[ 0 ].sCmn.nFramesPerPacket + 1 ) * encControl->nChannelsInternal );
+                    ec_enc_patch_initial_bits( psRangeEnc, flags, ( psEnc->state_Fxx[ 0 ].sCmn.nFramesPerPacket + 1 ) * OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) );
                 }
 
                 /* Return zero bytes if all channels DTXed */
-                if( psEnc->state_Fxx[ 0 ].sCmn.inDTX && ( encControl->nChannelsInternal == 1 || psEnc->state_Fxx[ 1 ].sCmn.inDTX ) ) {
+                if( psEnc->state_Fxx[ 0 ].sCmn.inDTX && ( OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal) == 1 || psEnc->state_Fxx[ 1 ].sCmn.inDTX ) ) {
                     *nBytesOut = 0;
                 }
 
@@ -566,7 +566,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
         curr_block++;
     }
 
-    psEnc->nPrevChannelsInternal = encControl->nChannelsInternal;
+    psEnc->nPrevChannelsInternal = OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal);
 
     encControl->allowBandwidthSwitch = psEnc->allowBandwidthSwitch;
     encControl->inWBmodeWithoutVariableLP = psEnc->state_Fxx[ 0 ].sCmn.fs_kHz == 16 && psEnc->state_Fxx[ 0 ].sCmn.sLP.mode == 0;
@@ -575,7 +575,7 @@ opus_int silk_Encode(                                   /* O    Returns error co
     if( prefillFlag ) {
         encControl->payloadSize_ms = tmp_payloadSize_ms;
         encControl->complexity = tmp_complexity;
-        for( n = 0; n < encControl->nChannelsInternal; n++ ) {
+        for( n = 0; n < OPUS_ENC_STREAM_CHANNELS(encControl->nChannelsInternal); n++ ) {
             psEnc->state_Fxx[ n ].sCmn.controlled_since_last_payload = 0;
             psEnc->state_Fxx[ n ].sCmn.prefillFlag = 0;
         }
@@ -70,7 +70,7 @@ void silk_k2a_FLP(
 );
 
 /* compute autocorrelation */
-void silk_autocorrelation_FLP(
+void silk_autocorrelation_FLP_c(
     silk_float          *results,           /* O    result (length correlationCount)                            */
     const silk_float    *inputData,         /* I    input data to correlate                                     */
     opus_int            inputDataSize,      /* I    length of input                                             */
@@ -78,6 +78,11 @@ void silk_autocorrelation_FLP(
     int                 arch
 );
 
+#ifndef OVERRIDE_silk_autocorrelation_FLP
+#define silk_autocorrelation_FLP(results, inputData, inputDataSize, correlationCount, arch) \
+    silk_autocorrelation_FLP_c(results, inputData, inputDataSize, correlationCount, arch)
+#endif
+
 opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced, 1 unvoiced                      */
     const silk_float    *frame,             /* I    Signal of length PE_FRAME_LENGTH_MS*Fs_kHz                  */
     opus_int            *pitch_out,         /* O    Pitch lag values [nb_subfr]                                 */
@@ -93,6 +98,37 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
     int                 arch                /* I    Run-time architecture                                       */
 );
 
+/* Adds the normalized correlations of one subframe for the stage 1 pitch search */
+void silk_P_Ana_calc_corr_st1_FLP_c(
+    silk_float          C[],                /* I/O  normalized correlation per lag, indexed by lag              */
+    const opus_val32    xcorr[],            /* I    cross correlations, highest lag first                       */
+    const silk_float    target_ptr[],       /* I    subframe, preceded by at least max_lag samples              */
+    opus_int            sf_length,          /* I    sub frame length                                            */
+    opus_int            min_lag,            /* I    lowest lag                                                  */
+    opus_int            max_lag,            /* I    highest lag                                                 */
+    int                 arch                /* I    Run-time architecture                                       */
+);
+
+#ifndef OVERRIDE_silk_P_Ana_calc_corr_st1_FLP
+#define silk_P_Ana_calc_corr_st1_FLP(C, xcorr, target_ptr, sf_length, min_lag, max_lag, arch) \
+    silk_P_Ana_calc_corr_st1_FLP_c(C, xcorr, target_ptr, sf_length, min_lag, max_lag, arch)
+#endif
+
+/* Normalized correlations of one subframe for the stage 2 pitch search */
+void silk_P_Ana_calc_corr_st2_FLP_c(
+    silk_float          C[],                /* O    normalized correlation per lag, indexed by lag              */
+    const silk_float    target_ptr[],       /* I    subframe, preceded by at least d_comp[ last ] samples       */
+    const opus_int16    d_comp[],           /* I    lags to compute, ascending                                  */
+    opus_int            length_d_comp,      /* I    number of lags                                              */
+    opus_int            sf_length,          /* I    sub frame length                                            */
+    int                 arch                /* I    Run-time architecture                                       */
+);
+
+#ifndef OVERRIDE_silk_P_Ana_calc_corr_st2_FLP
+#define silk_P_Ana_calc_corr_st2_FLP(C, target_ptr, d_comp, length_d_comp, sf_length, arch) \
+    silk_P_Ana_calc_corr_st2_FLP_c(C, target_ptr, d_comp, length_d_comp, sf_length, arch)
+#endif
+
 void silk_insertion_sort_decreasing_FLP(
     silk_float          *a,                 /* I/O  Unsorted / Sorted vector                                    */
     opus_int            *idx,               /* O    Index vector for the sorted elements                        */
@@ -101,7 +137,7 @@ void silk_insertion_sort_decreasing_FLP(
 );
 
 /* Compute reflection coefficients from input signal */
-silk_float silk_burg_modified_FLP(          /* O    returns residual energy                                     */
+silk_float silk_burg_modified_FLP_c(        /* O    returns residual energy                                     */
     silk_float          A[],                /* O    prediction coefficients (length order)                      */
     const silk_float    x[],                /* I    input signal, length: nb_subfr*(D+L_sub)                    */
     const silk_float    minInvGain,         /* I    minimum inverse prediction gain                             */
@@ -111,6 +147,11 @@ silk_float silk_burg_modified_FLP(          /* O    returns residual energy
     int                 arch
 );
 
+#ifndef OVERRIDE_silk_burg_modified_FLP
+#define silk_burg_modified_FLP(A, x, minInvGain, subfr_length, nb_subfr, D, arch) \
+    silk_burg_modified_FLP_c(A, x, minInvGain, subfr_length, nb_subfr, D, arch)
+#endif
+
 /* multiply a vector by a constant */
 void silk_scale_vector_FLP(
     silk_float          *data1,
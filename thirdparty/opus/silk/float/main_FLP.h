@@ -97,7 +97,7 @@ void silk_noise_shape_analysis_FLP(
 );
 
 /* Autocorrelations for a warped frequency axis */
-void silk_warped_autocorrelation_FLP(
+void silk_warped_autocorrelation_FLP_c(
     silk_float                      *corr,                              /* O    Result [order + 1]                          */
     const silk_float                *input,                             /* I    Input data to correlate                     */
     const silk_float                warping,                            /* I    Warping coefficient                         */
@@ -105,6 +105,11 @@ void silk_warped_autocorrelation_FLP(
     const opus_int                  order                               /* I    Correlation order (even)                    */
 );
 
+#ifndef OVERRIDE_silk_warped_autocorrelation_FLP
+#define silk_warped_autocorrelation_FLP(corr, input, warping, length, order, arch) \
+    ((void)(arch), silk_warped_autocorrelation_FLP_c(corr, input, warping, length, order))
+#endif
+
 /* Calculation of LTP state scaling */
 void silk_LTP_scale_ctrl_FLP(
     silk_encoder_state_FLP          *psEnc,                             /* I/O  Encoder state FLP                           */
@@ -219,7 +224,7 @@ void silk_process_gains_FLP(
 /* Linear Algebra */
 /******************/
 /* Calculates correlation matrix X'*X */
-void silk_corrMatrix_FLP(
+void silk_corrMatrix_FLP_c(
     const silk_float                *x,                                 /* I    x vector [ L+order-1 ] used to create X     */
     const opus_int                  L,                                  /* I    Length of vectors                           */
     const opus_int                  Order,                              /* I    Max lag for correlation                     */
@@ -227,8 +232,13 @@ void silk_corrMatrix_FLP(
     int                             arch
 );
 
+#ifndef OVERRIDE_silk_corrMatrix_FLP
+#define silk_corrMatrix_FLP(x, L, Order, XX, arch) \
+    silk_corrMatrix_FLP_c(x, L, Order, XX, arch)
+#endif
+
 /* Calculates correlation vector X'*t */
-void silk_corrVector_FLP(
+void silk_corrVector_FLP_c(
     const silk_float                *x,                                 /* I    x vector [L+order-1] used to create X       */
     const silk_float                *t,                                 /* I    Target vector [L]                           */
     const opus_int                  L,                                  /* I    Length of vecors                            */
@@ -237,6 +247,11 @@ void silk_corrVector_FLP(
     int                             arch
 );
 
+#ifndef OVERRIDE_silk_corrVector_FLP
+#define silk_corrVector_FLP(x, t, L, Order, Xt, arch) \
+    silk_corrVector_FLP_c(x, t, L, Order, Xt, arch)
+#endif
+
 /* Apply sine window to signal vector.  */
 /* Window types:                        */
 /*  1 -> sine window from 0 to pi/2     */
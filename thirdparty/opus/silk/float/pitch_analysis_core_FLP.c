@@ -90,7 +90,7 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
     opus_val32 xcorr[ PE_MAX_LAG_MS * 4 - PE_MIN_LAG_MS * 4 + 1 ];
     silk_float CC[ PE_NB_CBKS_STAGE2_EXT ];
     const silk_float *target_ptr, *basis_ptr;
-    double    cross_corr, normalizer, energy, energy_tmp;
+    double    cross_corr, energy, energy_tmp;
     opus_int   d_srch[ PE_D_SRCH_LENGTH ];
     opus_int16 d_comp[ (PE_MAX_LAG >> 1) + 5 ];
     opus_int   length_d_srch, length_d_comp;
@@ -180,30 +180,8 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
 
         celt_pitch_xcorr( target_ptr, target_ptr-max_lag_4kHz, xcorr, sf_length_8kHz, max_lag_4kHz - min_lag_4kHz + 1, arch );
 
-        /* Calculate first vector products before loop */
-        cross_corr = xcorr[ max_lag_4kHz - min_lag_4kHz ];
-        normalizer = silk_energy_FLP( target_ptr, sf_length_8kHz ) +
-                     silk_energy_FLP( basis_ptr,  sf_length_8kHz ) +
-                     sf_length_8kHz * 4000.0f;
+        silk_P_Ana_calc_corr_st1_FLP( C[ 0 ], xcorr, target_ptr, sf_length_8kHz, min_lag_4kHz, max_lag_4kHz, arch );
 
-        C[ 0 ][ min_lag_4kHz ] += (silk_float)( 2 * cross_corr / normalizer );
-
-        /* From now on normalizer is computed recursively */
-        for( d = min_lag_4kHz + 1; d <= max_lag_4kHz; d++ ) {
-            basis_ptr--;
-
-            /* Check that we are within range of the array */
-            silk_assert( basis_ptr >= frame_4kHz );
-            silk_assert( basis_ptr + sf_length_8kHz <= frame_4kHz + frame_length_4kHz );
-
-            cross_corr = xcorr[ max_lag_4kHz - d ];
-
-            /* Add contribution of new sample and remove contribution from oldest sample */
-            normalizer +=
-                basis_ptr[ 0 ] * (double)basis_ptr[ 0 ] -
-                basis_ptr[ sf_length_8kHz ] * (double)basis_ptr[ sf_length_8kHz ];
-            C[ 0 ][ d ] += (silk_float)( 2 * cross_corr / normalizer );
-        }
         /* Update target pointer */
         target_ptr += sf_length_8kHz;
     }
@@ -287,18 +265,7 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
         target_ptr = &frame_8kHz[ PE_LTP_MEM_LENGTH_MS * 8 ];
     }
     for( k = 0; k < nb_subfr; k++ ) {
-        energy_tmp = silk_energy_FLP( target_ptr, sf_length_8kHz ) + 1.0;
-        for( j = 0; j < length_d_comp; j++ ) {
-            d = d_comp[ j ];
-            basis_ptr = target_ptr - d;
-            cross_corr = silk_inner_product_FLP( basis_ptr, target_ptr, sf_length_8kHz, arch );
-            if( cross_corr > 0.0f ) {
-                energy = silk_energy_FLP( basis_ptr, sf_length_8kHz );
-                C[ k ][ d ] = (silk_float)( 2 * cross_corr / ( energy + energy_tmp ) );
-            } else {
-                C[ k ][ d ] = 0.0f;
-            }
-        }
+        silk_P_Ana_calc_corr_st2_FLP( C[ k ], target_ptr, d_comp, length_d_comp, sf_length_8kHz, arch );
         target_ptr += sf_length_8kHz;
     }
 
@@ -476,6 +443,81 @@ opus_int silk_pitch_analysis_core_FLP(      /* O    Voicing estimate: 0 voiced,
     return 0;
 }
 
+/***********************************************************************
+ * Adds the normalized correlations of one subframe to C for the stage 1
+ * search, given the cross correlations xcorr[ max_lag - d ] for lags d in
+ * [ min_lag, max_lag ]. C is indexed by lag.
+ ***********************************************************************/
+void silk_P_Ana_calc_corr_st1_FLP_c(
+    silk_float          C[],                /* I/O  normalized correlation per lag                              */
+    const opus_val32    xcorr[],            /* I    cross correlations, highest lag first                       */
+    const silk_float    target_ptr[],       /* I    subframe, preceded by at least max_lag samples              */
+    opus_int            sf_length,          /* I    sub frame length                                            */
+    opus_int            min_lag,            /* I    lowest lag                                                  */
+    opus_int            max_lag,            /* I    highest lag                                                 */
+    int                 arch                /* I    Run-time architecture                                       */
+)
+{
+    const silk_float *basis_ptr;
+    double     cross_corr, normalizer;
+    opus_int   d;
+
+    (void)arch;
+    basis_ptr = target_ptr - min_lag;
+
+    /* Calculate first vector products before loop */
+    cross_corr = xcorr[ max_lag - min_lag ];
+    normalizer = silk_energy_FLP( target_ptr, sf_length ) +
+                 silk_energy_FLP( basis_ptr,  sf_length ) +
+                 sf_length * 4000.0f;
+
+    C[ min_lag ] += (silk_float)( 2 * cross_corr / normalizer );
+
+    /* From now on normalizer is computed recursively */
+    for( d = min_lag + 1; d <= max_lag; d++ ) {
+        basis_ptr--;
+
+        cross_corr = xcorr[ max_lag - d ];
+
+        /* Add contribution of new sample and remove contribution from oldest sample */
+        normalizer +=
+            basis_ptr[ 0 ] * (double)basis_ptr[ 0 ] -
+            basis_ptr[ sf_length ] * (double)basis_ptr[ sf_length ];
+        C[ d ] += (silk_float)( 2 * cross_corr / normalizer );
+    }
+}
+
+/***********************************************************************
+ * Calculates the normalized correlations of one subframe used in the
+ * stage 2 search, for each lag in d_comp. C is indexed by lag.
+ ***********************************************************************/
+void silk_P_Ana_calc_corr_st2_FLP_c(
+    silk_float          C[],                /* O    normalized correlation per lag                              */
+    const silk_float    target_ptr[],       /* I    subframe, preceded by at least d_comp[ last ] samples       */
+    const opus_int16    d_comp[],           /* I    lags to compute, ascending                                  */
+    opus_int            length_d_comp,      /* I    number of lags                                              */
+    opus_int            sf_length,          /* I    sub frame length                                            */
+    int                 arch                /* I    Run-time architecture                                       */
+)
+{
+    const silk_float *basis_ptr;
+    double     cross_corr, energy, energy_tmp;
+    opus_int   j, d;
+
+    energy_tmp = silk_energy_FLP( target_ptr, sf_length ) + 1.0;
+    for( j = 0; j < length_d_comp; j++ ) {
+        d = d_comp[ j ];
+        basis_ptr = target_ptr - d;
+        cross_corr = silk_inner_product_FLP( basis_ptr, target_ptr, sf_length, arch );
+        if( cross_corr > 0.0f ) {
+            energy = silk_energy_FLP( basis_ptr, sf_length );
+            C[ d ] = (silk_float)( 2 * cross_corr / ( energy + energy_tmp ) );
+        } else {
+            C[ d ] = 0.0f;
+        }
+    }
+}
+
 /***********************************************************************
  * Calculates the correlations used in stage 3 search. In order to cover
  * the whole lag codebook for all the searched offset lags (lag +- 2),
@@ -0,0 +1,62 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef SIGPROC_FLP_AVX2_H
+#define SIGPROC_FLP_AVX2_H
+
+#include <immintrin.h>
+#include "SigProc_FLP.h"
+
+/* Shared by the AVX2 float analysis kernels. Like the C versions they
+   accumulate in double, but in a different order and with FMA, so results
+   are close to but not bit-exact with the C code. */
+
+/* Horizontal sum of each of four accumulators, out lane k = sum of a_k */
+static OPUS_INLINE __m256d silk_sum4_pd_avx2( __m256d a0, __m256d a1, __m256d a2, __m256d a3 )
+{
+    __m256d h01, h23;
+    h01 = _mm256_hadd_pd( a0, a1 );
+    h23 = _mm256_hadd_pd( a2, a3 );
+    return _mm256_add_pd( _mm256_permute2f128_pd( h01, h23, 0x20 ),
+                          _mm256_permute2f128_pd( h01, h23, 0x31 ) );
+}
+
+static OPUS_INLINE double silk_hsum_pd_avx2( __m256d a )
+{
+    __m128d s;
+    s = _mm_add_pd( _mm256_castpd256_pd128( a ), _mm256_extractf128_pd( a, 1 ) );
+    return _mm_cvtsd_f64( _mm_add_sd( s, _mm_unpackhi_pd( s, s ) ) );
+}
+
+/* results[ i ] = sum_j x[ j ] * x[ j + i ] for i < count, x already in double */
+void silk_autocorrelation_double_avx2(
+    double              *results,
+    const double        *x,
+    opus_int            len,
+    opus_int            count
+);
+
+#endif
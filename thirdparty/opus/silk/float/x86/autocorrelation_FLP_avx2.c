@@ -0,0 +1,146 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "main_FLP.h"
+#include "SigProc_FLP_avx2.h"
+
+/* Inputs longer than the pitch LPC window are not seen by the encoder and
+   go to the C version */
+#define MAX_AUTOCORR_LENGTH FIND_PITCH_LPC_WIN_MAX
+
+void silk_autocorrelation_double_avx2(
+    double              *results,
+    const double        *x,
+    opus_int            len,
+    opus_int            count
+)
+{
+    opus_int i, j, k, n;
+
+    /* Eight lags at a time share the loads of x[ j ], enough independent
+       accumulators to keep the FMA units busy */
+    for( i = 0; i + 8 <= count; i += 8 ) {
+        __m256d acc[ 8 ];
+        double  tail[ 8 ];
+
+        for( k = 0; k < 8; k++ ) {
+            acc[ k ] = _mm256_setzero_pd();
+        }
+        /* Samples every one of the eight lags has */
+        n = silk_max_int( len - i - 7, 0 );
+        for( j = 0; j < n - 3; j += 4 ) {
+            __m256d x0 = _mm256_loadu_pd( &x[ j ] );
+            for( k = 0; k < 8; k++ ) {
+                acc[ k ] = _mm256_fmadd_pd( x0, _mm256_loadu_pd( &x[ j + i + k ] ), acc[ k ] );
+            }
+        }
+        _mm256_storeu_pd( &tail[ 0 ], silk_sum4_pd_avx2( acc[ 0 ], acc[ 1 ], acc[ 2 ], acc[ 3 ] ) );
+        _mm256_storeu_pd( &tail[ 4 ], silk_sum4_pd_avx2( acc[ 4 ], acc[ 5 ], acc[ 6 ], acc[ 7 ] ) );
+        for( k = 0; k < 8; k++ ) {
+            opus_int m;
+            for( m = j; m < len - i - k; m++ ) {
+                tail[ k ] += x[ m ] * x[ m + i + k ];
+            }
+            results[ i + k ] = tail[ k ];
+        }
+    }
+    /* Then four */
+    for( ; i + 4 <= count; i += 4 ) {
+        __m256d acc0, acc1, acc2, acc3;
+        __m256d sum;
+        double  tail[ 4 ];
+
+        acc0 = acc1 = acc2 = acc3 = _mm256_setzero_pd();
+        /* Samples every one of the four lags has */
+        n = silk_max_int( len - i - 3, 0 );
+        for( j = 0; j < n - 3; j += 4 ) {
+            __m256d x0 = _mm256_loadu_pd( &x[ j ] );
+            acc0 = _mm256_fmadd_pd( x0, _mm256_loadu_pd( &x[ j + i ] ), acc0 );
+            acc1 = _mm256_fmadd_pd( x0, _mm256_loadu_pd( &x[ j + i + 1 ] ), acc1 );
+            acc2 = _mm256_fmadd_pd( x0, _mm256_loadu_pd( &x[ j + i + 2 ] ), acc2 );
+            acc3 = _mm256_fmadd_pd( x0, _mm256_loadu_pd( &x[ j + i + 3 ] ), acc3 );
+        }
+        sum = silk_sum4_pd_avx2( acc0, acc1, acc2, acc3 );
+        _mm256_storeu_pd( tail, sum );
+        for( k = 0; k < 4; k++ ) {
+            opus_int m;
+            for( m = j; m < len - i - k; m++ ) {
+                tail[ k ] += x[ m ] * x[ m + i + k ];
+            }
+            results[ i + k ] = tail[ k ];
+        }
+    }
+    for( ; i < count; i++ ) {
+        __m256d acc = _mm256_setzero_pd();
+        double  sum;
+        for( j = 0; j < len - i - 3; j += 4 ) {
+            acc = _mm256_fmadd_pd( _mm256_loadu_pd( &x[ j ] ), _mm256_loadu_pd( &x[ j + i ] ), acc );
+        }
+        sum = silk_hsum_pd_avx2( acc );
+        for( ; j < len - i; j++ ) {
+            sum += x[ j ] * x[ j + i ];
+        }
+        results[ i ] = sum;
+    }
+}
+
+/* compute autocorrelation */
+void silk_autocorrelation_FLP_avx2(
+    silk_float          *results,           /* O    result (length correlationCount)                            */
+    const silk_float    *inputData,         /* I    input data to correlate                                     */
+    opus_int            inputDataSize,      /* I    length of input                                             */
+    opus_int            correlationCount,    /* I    number of correlation taps to compute                       */
+    int                 arch
+)
+{
+    opus_int i;
+    double   x[ MAX_AUTOCORR_LENGTH ];
+    double   C[ MAX_AUTOCORR_LENGTH ];
+
+    if( inputDataSize > MAX_AUTOCORR_LENGTH ) {
+        silk_autocorrelation_FLP_c( results, inputData, inputDataSize, correlationCount, arch );
+        return;
+    }
+    if( correlationCount > inputDataSize ) {
+        correlationCount = inputDataSize;
+    }
+
+    for( i = 0; i < inputDataSize - 3; i += 4 ) {
+        _mm256_storeu_pd( &x[ i ], _mm256_cvtps_pd( _mm_loadu_ps( &inputData[ i ] ) ) );
+    }
+    for( ; i < inputDataSize; i++ ) {
+        x[ i ] = inputData[ i ];
+    }
+
+    silk_autocorrelation_double_avx2( C, x, inputDataSize, correlationCount );
+    for( i = 0; i < correlationCount; i++ ) {
+        results[ i ] = (silk_float)C[ i ];
+    }
+}
@@ -0,0 +1,230 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "SigProc_FLP.h"
+#include "SigProc_FLP_avx2.h"
+#include "tuning_parameters.h"
+#include "define.h"
+
+#define MAX_FRAME_SIZE              384 /* subfr_length * nb_subfr = ( 0.005 * 16000 + 16 ) * 4 = 384*/
+
+/* Lanes in reverse order */
+#define REVERSE_PD( v ) _mm256_permute4x64_pd( v, 0x1B )
+
+/* Compute reflection coefficients from input signal. Same recursion as
+   silk_burg_modified_FLP_c(), with the correlations and the per subframe
+   row updates vectorized over a double copy of the input. */
+silk_float silk_burg_modified_FLP_avx2(     /* O    returns residual energy                                     */
+    silk_float          A[],                /* O    prediction coefficients (length order)                      */
+    const silk_float    x[],                /* I    input signal, length: nb_subfr*(D+L_sub)                    */
+    const silk_float    minInvGain,         /* I    minimum inverse prediction gain                             */
+    const opus_int      subfr_length,       /* I    input signal subframe length (incl. D preceding samples)    */
+    const opus_int      nb_subfr,           /* I    number of subframes stacked in x                            */
+    const opus_int      D,                  /* I    order                                                       */
+    int                 arch
+)
+{
+    opus_int         k, n, s, reached_max_gain;
+    double           C0, invGain, num, nrg_f, nrg_b, rc, Atmp, tmp1, tmp2;
+    const double     *x_ptr;
+    double           xd[ MAX_FRAME_SIZE ];
+    double           C_sub[ SILK_MAX_ORDER_LPC + 1 ];
+    double           C_first_row[ SILK_MAX_ORDER_LPC ], C_last_row[ SILK_MAX_ORDER_LPC ];
+    double           CAf[ SILK_MAX_ORDER_LPC + 1 ], CAb[ SILK_MAX_ORDER_LPC + 1 ];
+    double           Af[ SILK_MAX_ORDER_LPC ];
+    (void)arch;
+
+    celt_assert( subfr_length * nb_subfr <= MAX_FRAME_SIZE );
+
+    for( n = 0; n < nb_subfr * subfr_length - 3; n += 4 ) {
+        _mm256_storeu_pd( &xd[ n ], _mm256_cvtps_pd( _mm_loadu_ps( &x[ n ] ) ) );
+    }
+    for( ; n < nb_subfr * subfr_length; n++ ) {
+        xd[ n ] = x[ n ];
+    }
+
+    /* Compute autocorrelations, added over subframes */
+    silk_autocorrelation_double_avx2( &C0, xd, nb_subfr * subfr_length, 1 );
+    silk_memset( C_first_row, 0, SILK_MAX_ORDER_LPC * sizeof( double ) );
+    for( s = 0; s < nb_subfr; s++ ) {
+        silk_autocorrelation_double_avx2( C_sub, xd + s * subfr_length, subfr_length, D + 1 );
+        for( n = 1; n < D + 1; n++ ) {
+            C_first_row[ n - 1 ] += C_sub[ n ];
+        }
+    }
+    silk_memcpy( C_last_row, C_first_row, SILK_MAX_ORDER_LPC * sizeof( double ) );
+
+    /* Initialize */
+    CAb[ 0 ] = CAf[ 0 ] = C0 + FIND_LPC_COND_FAC * C0 + 1e-9f;
+    invGain = 1.0f;
+    reached_max_gain = 0;
+    for( n = 0; n < D; n++ ) {
+        /* Update first row of correlation matrix (without first element) */
+        /* Update last row of correlation matrix (without last element, stored in reversed order) */
+        /* Update C * Af */
+        /* Update C * flipud(Af) (stored in reversed order) */
+        for( s = 0; s < nb_subfr; s++ ) {
+            __m128  xn, xl;
+            __m256d t1, t2;
+            const silk_float *xs = x + s * subfr_length;
+            x_ptr = xd + s * subfr_length;
+            xn = _mm_set1_ps( xs[ n ] );
+            xl = _mm_set1_ps( xs[ subfr_length - n - 1 ] );
+            t1 = t2 = _mm256_setzero_pd();
+            for( k = 0; k < n - 3; k += 4 ) {
+                /* x_ptr[ n - k - 1 ] and x_ptr[ subfr_length - n + k ] for k .. k + 3 */
+                __m128  xf_s = _mm_shuffle_ps( _mm_loadu_ps( &xs[ n - k - 4 ] ), _mm_loadu_ps( &xs[ n - k - 4 ] ), 0x1B );
+                __m128  xb_s = _mm_loadu_ps( &xs[ subfr_length - n + k ] );
+                __m256d xf = REVERSE_PD( _mm256_loadu_pd( &x_ptr[ n - k - 4 ] ) );
+                __m256d xb = _mm256_loadu_pd( &x_ptr[ subfr_length - n + k ] );
+                __m256d a  = _mm256_loadu_pd( &Af[ k ] );
+                /* The row updates multiply in single precision, as the C version does */
+                _mm256_storeu_pd( &C_first_row[ k ], _mm256_sub_pd( _mm256_loadu_pd( &C_first_row[ k ] ), _mm256_cvtps_pd( _mm_mul_ps( xn, xf_s ) ) ) );
+                _mm256_storeu_pd( &C_last_row[ k ],  _mm256_sub_pd( _mm256_loadu_pd( &C_last_row[ k ] ),  _mm256_cvtps_pd( _mm_mul_ps( xl, xb_s ) ) ) );
+                t1 = _mm256_fmadd_pd( xf, a, t1 );
+                t2 = _mm256_fmadd_pd( xb, a, t2 );
+            }
+            tmp1 = x_ptr[ n ] + silk_hsum_pd_avx2( t1 );
+            tmp2 = x_ptr[ subfr_length - n - 1 ] + silk_hsum_pd_avx2( t2 );
+            for( ; k < n; k++ ) {
+                C_first_row[ k ] -= xs[ n ] * xs[ n - k - 1 ];
+                C_last_row[ k ]  -= xs[ subfr_length - n - 1 ] * xs[ subfr_length - n + k ];
+                Atmp = Af[ k ];
+                tmp1 += x_ptr[ n - k - 1 ] * Atmp;
+                tmp2 += x_ptr[ subfr_length - n + k ] * Atmp;
+            }
+            t1 = _mm256_set1_pd( tmp1 );
+            t2 = _mm256_set1_pd( tmp2 );
+            for( k = 0; k < n - 2; k += 4 ) {
+                /* x_ptr[ n - k ] and x_ptr[ subfr_length - n + k - 1 ] for k .. k + 3 */
+                __m256d xf = REVERSE_PD( _mm256_loadu_pd( &x_ptr[ n - k - 3 ] ) );
+                __m256d xb = _mm256_loadu_pd( &x_ptr[ subfr_length - n + k - 1 ] );
+                _mm256_storeu_pd( &CAf[ k ], _mm256_fnmadd_pd( t1, xf, _mm256_loadu_pd( &CAf[ k ] ) ) );
+                _mm256_storeu_pd( &CAb[ k ], _mm256_fnmadd_pd( t2, xb, _mm256_loadu_pd( &CAb[ k ] ) ) );
+            }
+            for( ; k <= n; k++ ) {
+                CAf[ k ] -= tmp1 * x_ptr[ n - k ];
+                CAb[ k ] -= tmp2 * x_ptr[ subfr_length - n + k - 1 ];
+            }
+        }
+        tmp1 = C_first_row[ n ];
+        tmp2 = C_last_row[ n ];
+        for( k = 0; k < n; k++ ) {
+            Atmp = Af[ k ];
+            tmp1 += C_last_row[  n - k - 1 ] * Atmp;
+            tmp2 += C_first_row[ n - k - 1 ] * Atmp;
+        }
+        CAf[ n + 1 ] = tmp1;
+        CAb[ n + 1 ] = tmp2;
+
+        /* Calculate nominator and denominator for the next order reflection (parcor) coefficient */
+        num = CAb[ n + 1 ];
+        nrg_b = CAb[ 0 ];
+        nrg_f = CAf[ 0 ];
+        for( k = 0; k < n; k++ ) {
+            Atmp = Af[ k ];
+            num   += CAb[ n - k ] * Atmp;
+            nrg_b += CAb[ k + 1 ] * Atmp;
+            nrg_f += CAf[ k + 1 ] * Atmp;
+        }
+        silk_assert( nrg_f > 0.0 );
+        silk_assert( nrg_b > 0.0 );
+
+        /* Calculate the next order reflection (parcor) coefficient */
+        rc = -2.0 * num / ( nrg_f + nrg_b );
+        silk_assert( rc > -1.0 && rc < 1.0 );
+
+        /* Update inverse prediction gain */
+        tmp1 = invGain * ( 1.0 - rc * rc );
+        if( tmp1 <= minInvGain ) {
+            /* Max prediction gain exceeded; set reflection coefficient such that max prediction gain is exactly hit */
+            rc = sqrt( 1.0 - minInvGain / invGain );
+            if( num > 0 ) {
+                /* Ensure adjusted reflection coefficients has the original sign */
+                rc = -rc;
+            }
+            invGain = minInvGain;
+            reached_max_gain = 1;
+        } else {
+            invGain = tmp1;
+        }
+
+        /* Update the AR coefficients */
+        for( k = 0; k < (n + 1) >> 1; k++ ) {
+            tmp1 = Af[ k ];
+            tmp2 = Af[ n - k - 1 ];
+            Af[ k ]         = tmp1 + rc * tmp2;
+            Af[ n - k - 1 ] = tmp2 + rc * tmp1;
+        }
+        Af[ n ] = rc;
+
+        if( reached_max_gain ) {
+            /* Reached max prediction gain; set remaining coefficients to zero and exit loop */
+            for( k = n + 1; k < D; k++ ) {
+                Af[ k ] = 0.0;
+            }
+            break;
+        }
+
+        /* Update C * Af and C * Ab */
+        for( k = 0; k <= n + 1; k++ ) {
+            tmp1 = CAf[ k ];
+            CAf[ k ]          += rc * CAb[ n - k + 1 ];
+            CAb[ n - k + 1  ] += rc * tmp1;
+        }
+    }
+
+    if( reached_max_gain ) {
+        /* Convert to silk_float */
+        for( k = 0; k < D; k++ ) {
+            A[ k ] = (silk_float)( -Af[ k ] );
+        }
+        /* Subtract energy of preceding samples from C0 */
+        for( s = 0; s < nb_subfr; s++ ) {
+            C0 -= silk_energy_FLP( x + s * subfr_length, D );
+        }
+        /* Approximate residual energy */
+        nrg_f = C0 * invGain;
+    } else {
+        /* Compute residual energy and store coefficients as silk_float */
+        nrg_f = CAf[ 0 ];
+        tmp1 = 1.0;
+        for( k = 0; k < D; k++ ) {
+            Atmp = Af[ k ];
+            nrg_f += CAf[ k + 1 ] * Atmp;
+            tmp1  += Atmp * Atmp;
+            A[ k ] = (silk_float)(-Atmp);
+        }
+        nrg_f -= FIND_LPC_COND_FAC * C0 * tmp1;
+    }
+
+    /* Return residual energy */
+    return (silk_float)nrg_f;
+}
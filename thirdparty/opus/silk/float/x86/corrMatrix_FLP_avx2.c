@@ -0,0 +1,149 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "main_FLP.h"
+#include "SigProc_FLP_avx2.h"
+
+/* out[ k ] = sum_{i < L} a[ i ] * b[ i - k ] for k < count, four lags sharing
+   the loads of a[ i ] */
+static void silk_xcorr_lags_FLP_avx2(
+    double                          *out,
+    const silk_float                *a,
+    const silk_float                *b,
+    const opus_int                  L,
+    const opus_int                  count
+)
+{
+    opus_int i, k;
+
+    for( k = 0; k + 4 <= count; k += 4 ) {
+        __m256d acc0, acc1, acc2, acc3;
+        double  sum[ 4 ];
+        opus_int m;
+
+        acc0 = acc1 = acc2 = acc3 = _mm256_setzero_pd();
+        for( i = 0; i < L - 3; i += 4 ) {
+            __m256d a0 = _mm256_cvtps_pd( _mm_loadu_ps( &a[ i ] ) );
+            acc0 = _mm256_fmadd_pd( a0, _mm256_cvtps_pd( _mm_loadu_ps( &b[ i - k ] ) ), acc0 );
+            acc1 = _mm256_fmadd_pd( a0, _mm256_cvtps_pd( _mm_loadu_ps( &b[ i - k - 1 ] ) ), acc1 );
+            acc2 = _mm256_fmadd_pd( a0, _mm256_cvtps_pd( _mm_loadu_ps( &b[ i - k - 2 ] ) ), acc2 );
+            acc3 = _mm256_fmadd_pd( a0, _mm256_cvtps_pd( _mm_loadu_ps( &b[ i - k - 3 ] ) ), acc3 );
+        }
+        _mm256_storeu_pd( sum, silk_sum4_pd_avx2( acc0, acc1, acc2, acc3 ) );
+        for( ; i < L; i++ ) {
+            for( m = 0; m < 4; m++ ) {
+                sum[ m ] += a[ i ] * (double)b[ i - k - m ];
+            }
+        }
+        for( m = 0; m < 4; m++ ) {
+            out[ k + m ] = sum[ m ];
+        }
+    }
+    for( ; k < count; k++ ) {
+        __m256d acc = _mm256_setzero_pd();
+        double  sum;
+        for( i = 0; i < L - 3; i += 4 ) {
+            acc = _mm256_fmadd_pd( _mm256_cvtps_pd( _mm_loadu_ps( &a[ i ] ) ),
+                                   _mm256_cvtps_pd( _mm_loadu_ps( &b[ i - k ] ) ), acc );
+        }
+        sum = silk_hsum_pd_avx2( acc );
+        for( ; i < L; i++ ) {
+            sum += a[ i ] * (double)b[ i - k ];
+        }
+        out[ k ] = sum;
+    }
+}
+
+/* Calculates correlation vector X'*t */
+void silk_corrVector_FLP_avx2(
+    const silk_float                *x,                                 /* I    x vector [L+order-1] used to create X       */
+    const silk_float                *t,                                 /* I    Target vector [L]                           */
+    const opus_int                  L,                                  /* I    Length of vecors                            */
+    const opus_int                  Order,                              /* I    Max lag for correlation                     */
+    silk_float                      *Xt,                                /* O    X'*t correlation vector [order]             */
+    int                             arch
+)
+{
+    opus_int lag;
+    double   Xt_d[ SILK_MAX_ORDER_LPC ];
+    (void)arch;
+
+    celt_assert( Order <= SILK_MAX_ORDER_LPC );
+
+    /* X[:,lag]'*t for all lags in one pass over t */
+    silk_xcorr_lags_FLP_avx2( Xt_d, t, &x[ Order - 1 ], L, Order );
+    for( lag = 0; lag < Order; lag++ ) {
+        Xt[ lag ] = (silk_float)Xt_d[ lag ];
+    }
+}
+
+/* Calculates correlation matrix X'*X */
+void silk_corrMatrix_FLP_avx2(
+    const silk_float                *x,                                 /* I    x vector [ L+order-1 ] used to create X     */
+    const opus_int                  L,                                  /* I    Length of vectors                           */
+    const opus_int                  Order,                              /* I    Max lag for correlation                     */
+    silk_float                      *XX,                                /* O    X'*X correlation matrix [order x order]     */
+    int                             arch
+)
+{
+    opus_int j, lag;
+    double  energy;
+    double  first_col[ SILK_MAX_ORDER_LPC ];
+    const silk_float *ptr1, *ptr2;
+    (void)arch;
+
+    celt_assert( Order <= SILK_MAX_ORDER_LPC );
+
+    ptr1 = &x[ Order - 1 ];                     /* First sample of column 0 of X */
+    /* X[:,0]'*X[:,lag] for all lags in one pass, lag 0 being the energy */
+    silk_xcorr_lags_FLP_avx2( first_col, ptr1, ptr1, L, Order );
+
+    energy = first_col[ 0 ];
+    matrix_ptr( XX, 0, 0, Order ) = ( silk_float )energy;
+    for( j = 1; j < Order; j++ ) {
+        /* Calculate X[:,j]'*X[:,j] */
+        energy += ptr1[ -j ] * ptr1[ -j ] - ptr1[ L - j ] * ptr1[ L - j ];
+        matrix_ptr( XX, j, j, Order ) = ( silk_float )energy;
+    }
+
+    ptr2 = &x[ Order - 2 ];                     /* First sample of column 1 of X */
+    for( lag = 1; lag < Order; lag++ ) {
+        energy = first_col[ lag ];
+        matrix_ptr( XX, lag, 0, Order ) = ( silk_float )energy;
+        matrix_ptr( XX, 0, lag, Order ) = ( silk_float )energy;
+        /* Calculate X[:,j]'*X[:,j + lag] */
+        for( j = 1; j < ( Order - lag ); j++ ) {
+            energy += ptr1[ -j ] * ptr2[ -j ] - ptr1[ L - j ] * ptr2[ L - j ];
+            matrix_ptr( XX, lag + j, j, Order ) = ( silk_float )energy;
+            matrix_ptr( XX, j, lag + j, Order ) = ( silk_float )energy;
+        }
+        ptr2--;                                 /* Next column of X */
+    }
+}
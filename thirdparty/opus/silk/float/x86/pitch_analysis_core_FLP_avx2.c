@@ -0,0 +1,200 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "SigProc_FLP_avx2.h"
+#include "pitch_est_defines.h"
+
+/* Adds the normalized correlations of one subframe for the stage 1 pitch
+   search, four lags at a time. The normalizer C updates one lag at a time is
+   a running sum over the lags, computed here as a prefix sum within each
+   block plus the carry from the previous one. The 4 kHz signal is integer
+   valued, so the sums are exact and C is bit-exact with the C version. */
+void silk_P_Ana_calc_corr_st1_FLP_avx2(
+    silk_float          C[],                /* I/O  normalized correlation per lag, indexed by lag              */
+    const opus_val32    xcorr[],            /* I    cross correlations, highest lag first                       */
+    const silk_float    target_ptr[],       /* I    subframe, preceded by at least max_lag samples              */
+    opus_int            sf_length,          /* I    sub frame length                                            */
+    opus_int            min_lag,            /* I    lowest lag                                                  */
+    opus_int            max_lag,            /* I    highest lag                                                 */
+    int                 arch                /* I    Run-time architecture                                       */
+)
+{
+    opus_int   d;
+    double     cross_corr, normalizer;
+    __m256d    norm, delta, old, zero, q;
+    __m128     x;
+
+    (void)arch;
+    zero = _mm256_setzero_pd();
+
+    /* Calculate first vector products before loop */
+    cross_corr = xcorr[ max_lag - min_lag ];
+    normalizer = silk_energy_FLP( target_ptr, sf_length ) +
+                 silk_energy_FLP( target_ptr - min_lag, sf_length ) +
+                 sf_length * 4000.0f;
+    C[ min_lag ] += (silk_float)( 2 * cross_corr / normalizer );
+
+    norm = _mm256_set1_pd( normalizer );
+    for( d = min_lag + 1; d + 3 <= max_lag; d += 4 ) {
+        /* Lane i is lag d + i: the new sample target[ -d - i ] comes in, the
+           oldest target[ sf_length - d - i ] goes out */
+        x     = _mm_loadu_ps( &target_ptr[ -d - 3 ] );
+        delta = _mm256_cvtps_pd( _mm_shuffle_ps( x, x, 0x1B ) );
+        x     = _mm_loadu_ps( &target_ptr[ sf_length - d - 3 ] );
+        old   = _mm256_cvtps_pd( _mm_shuffle_ps( x, x, 0x1B ) );
+        delta = _mm256_fmsub_pd( delta, delta, _mm256_mul_pd( old, old ) );
+
+        /* Prefix sum over the lanes, on top of the last normalizer */
+        delta = _mm256_add_pd( delta, _mm256_blend_pd( _mm256_permute4x64_pd( delta, 0x90 ), zero, 0x1 ) );
+        delta = _mm256_add_pd( delta, _mm256_permute2f128_pd( delta, delta, 0x08 ) );
+        norm  = _mm256_add_pd( _mm256_permute4x64_pd( norm, 0xFF ), delta );
+
+        x = _mm_loadu_ps( &xcorr[ max_lag - d - 3 ] );
+        q = _mm256_cvtps_pd( _mm_shuffle_ps( x, x, 0x1B ) );
+        q = _mm256_div_pd( _mm256_add_pd( q, q ), norm );
+        _mm_storeu_ps( &C[ d ], _mm_add_ps( _mm_loadu_ps( &C[ d ] ), _mm256_cvtpd_ps( q ) ) );
+    }
+    normalizer = _mm_cvtsd_f64( _mm256_castpd256_pd128( _mm256_permute4x64_pd( norm, 0xFF ) ) );
+    for( ; d <= max_lag; d++ ) {
+        cross_corr = xcorr[ max_lag - d ];
+        normalizer +=
+            target_ptr[ -d ] * (double)target_ptr[ -d ] -
+            target_ptr[ sf_length - d ] * (double)target_ptr[ sf_length - d ];
+        C[ d ] += (silk_float)( 2 * cross_corr / normalizer );
+    }
+}
+
+/* Longest history and subframe the stage 2 kernel keeps in double */
+#define ST2_MAX_LAG         ( ( PE_MAX_LAG >> 1 ) + 4 )
+#define ST2_MAX_SF_LENGTH   ( PE_SUBFR_LENGTH_MS * 8 )
+
+/* Normalized correlations of one subframe for the stage 2 pitch search.
+   The subframe and its history are converted to double once, then eight
+   consecutive lags share the loads of the subframe: lane l of lo holds lag
+   d0 + 7 - l and lane l of hi lag d0 + 3 - l. The cross correlation and
+   the basis energy of a lag are accumulated in the same pass, in double
+   like the C version. At 12 and 16 kHz the 8 kHz signal is integer valued,
+   so both sums are exact and C is bit-exact with the C version whatever the
+   summation order. */
+void silk_P_Ana_calc_corr_st2_FLP_avx2(
+    silk_float          C[],                /* O    normalized correlation per lag, indexed by lag              */
+    const silk_float    target_ptr[],       /* I    subframe, preceded by at least d_comp[ last ] samples       */
+    const opus_int16    d_comp[],           /* I    lags to compute, ascending                                  */
+    opus_int            length_d_comp,      /* I    number of lags                                              */
+    opus_int            sf_length,          /* I    sub frame length                                            */
+    int                 arch                /* I    Run-time architecture                                       */
+)
+{
+    const double *basis_ptr, *target_d;
+    opus_int   i, j, d0, d_max, len;
+    double     energy_tmp;
+    double     xd[ ST2_MAX_LAG + ST2_MAX_SF_LENGTH ];
+    silk_float C_blk[ 8 ];
+    __m256d    xc_lo0, xc_hi0, en_lo0, en_hi0, xc_lo1, xc_hi1, en_lo1, en_hi1;
+    __m256d    t, b_lo, b_hi, num, den, zero;
+    __m128     C_lo, C_hi;
+
+    if( length_d_comp <= 0 ) {
+        return;
+    }
+    d_max = d_comp[ length_d_comp - 1 ];
+    if( d_max < 7 || d_max > ST2_MAX_LAG || sf_length > ST2_MAX_SF_LENGTH ) {
+        /* A block would reach past the end of the subframe, or past xd */
+        silk_P_Ana_calc_corr_st2_FLP_c( C, target_ptr, d_comp, length_d_comp, sf_length, arch );
+        return;
+    }
+
+    /* xd[ 0 ] is target_ptr[ -d_max ] */
+    len = d_max + sf_length;
+    for( i = 0; i < len - 3; i += 4 ) {
+        _mm256_storeu_pd( &xd[ i ], _mm256_cvtps_pd( _mm_loadu_ps( &target_ptr[ i - d_max ] ) ) );
+    }
+    for( ; i < len; i++ ) {
+        xd[ i ] = target_ptr[ i - d_max ];
+    }
+    target_d = &xd[ d_max ];
+
+    energy_tmp = silk_energy_FLP( target_ptr, sf_length ) + 1.0;
+    zero = _mm256_setzero_pd();
+    j = 0;
+    while( j < length_d_comp ) {
+        /* Keep the block inside the lags C reads */
+        d0 = silk_min_int( d_comp[ j ], d_max - 7 );
+        basis_ptr = target_d - d0 - 7;
+
+        xc_lo0 = xc_hi0 = en_lo0 = en_hi0 = zero;
+        xc_lo1 = xc_hi1 = en_lo1 = en_hi1 = zero;
+        for( i = 0; i < sf_length - 1; i += 2 ) {
+            t      = _mm256_broadcast_sd( &target_d[ i ] );
+            b_lo   = _mm256_loadu_pd( &basis_ptr[ i ] );
+            b_hi   = _mm256_loadu_pd( &basis_ptr[ i + 4 ] );
+            xc_lo0 = _mm256_fmadd_pd( b_lo, t, xc_lo0 );
+            xc_hi0 = _mm256_fmadd_pd( b_hi, t, xc_hi0 );
+            en_lo0 = _mm256_fmadd_pd( b_lo, b_lo, en_lo0 );
+            en_hi0 = _mm256_fmadd_pd( b_hi, b_hi, en_hi0 );
+
+            t      = _mm256_broadcast_sd( &target_d[ i + 1 ] );
+            b_lo   = _mm256_loadu_pd( &basis_ptr[ i + 1 ] );
+            b_hi   = _mm256_loadu_pd( &basis_ptr[ i + 5 ] );
+            xc_lo1 = _mm256_fmadd_pd( b_lo, t, xc_lo1 );
+            xc_hi1 = _mm256_fmadd_pd( b_hi, t, xc_hi1 );
+            en_lo1 = _mm256_fmadd_pd( b_lo, b_lo, en_lo1 );
+            en_hi1 = _mm256_fmadd_pd( b_hi, b_hi, en_hi1 );
+        }
+        for( ; i < sf_length; i++ ) {
+            t      = _mm256_broadcast_sd( &target_d[ i ] );
+            b_lo   = _mm256_loadu_pd( &basis_ptr[ i ] );
+            b_hi   = _mm256_loadu_pd( &basis_ptr[ i + 4 ] );
+            xc_lo0 = _mm256_fmadd_pd( b_lo, t, xc_lo0 );
+            xc_hi0 = _mm256_fmadd_pd( b_hi, t, xc_hi0 );
+            en_lo0 = _mm256_fmadd_pd( b_lo, b_lo, en_lo0 );
+            en_hi0 = _mm256_fmadd_pd( b_hi, b_hi, en_hi0 );
+        }
+        xc_lo0 = _mm256_add_pd( xc_lo0, xc_lo1 );
+        xc_hi0 = _mm256_add_pd( xc_hi0, xc_hi1 );
+        en_lo0 = _mm256_add_pd( en_lo0, en_lo1 );
+        en_hi0 = _mm256_add_pd( en_hi0, en_hi1 );
+
+        /* C = 2 * cross_corr / ( energy + energy_tmp ) where cross_corr > 0 */
+        den  = _mm256_add_pd( en_lo0, _mm256_set1_pd( energy_tmp ) );
+        num  = _mm256_div_pd( _mm256_add_pd( xc_lo0, xc_lo0 ), den );
+        C_lo = _mm256_cvtpd_ps( _mm256_and_pd( num, _mm256_cmp_pd( xc_lo0, zero, _CMP_GT_OQ ) ) );
+        den  = _mm256_add_pd( en_hi0, _mm256_set1_pd( energy_tmp ) );
+        num  = _mm256_div_pd( _mm256_add_pd( xc_hi0, xc_hi0 ), den );
+        C_hi = _mm256_cvtpd_ps( _mm256_and_pd( num, _mm256_cmp_pd( xc_hi0, zero, _CMP_GT_OQ ) ) );
+
+        /* Back to ascending lags: C_blk[ m ] is lag d0 + m */
+        _mm_storeu_ps( &C_blk[ 0 ], _mm_shuffle_ps( C_hi, C_hi, 0x1B ) );
+        _mm_storeu_ps( &C_blk[ 4 ], _mm_shuffle_ps( C_lo, C_lo, 0x1B ) );
+        for( ; j < length_d_comp && d_comp[ j ] <= d0 + 7; j++ ) {
+            C[ d_comp[ j ] ] = C_blk[ d_comp[ j ] - d0 ];
+        }
+    }
+}
@@ -0,0 +1,175 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "main_FLP.h"
+
+/* Enough lanes for order + 1 correlations and zero padding on both sides of
+   the reversed input */
+#define MAX_GROUPS  ( MAX_SHAPE_LPC_ORDER / 4 + 1 )
+#define PAD         ( MAX_GROUPS * 4 )
+
+/* The C version runs the allpass sections one after the other for every
+   sample, so each sample waits on a chain of order dependent operations.
+   Here lane i of the state handles section i, one sample behind lane i - 1:
+   at step t lane i works on sample t - i, taking its input from what lane
+   i - 1 produced the step before. All sections then advance in parallel and
+   the run takes length + order steps.
+
+   Groups of four lanes are kept in named registers rather than arrays, which
+   the compiler would otherwise leave in memory on the dependency chain. */
+
+/* One step of group g, rot_lo carrying the top lane of group g - 1 */
+#define WARPED_GROUP_STEP( g, rot_lo )                                                                  \
+    in_new = _mm256_blend_pd( rot##g, rot_lo, 0x1 );                                                    \
+    /* Output of allpass section */                                                                     \
+    out##g = _mm256_fnmadd_pd( w, in_new, _mm256_fmadd_pd( w, out##g, in##g ) );                       \
+    in##g = in_new;                                                                                     \
+    /* Lane i multiplies by input[ t - i ], zero outside the frame */                                   \
+    acc##g = _mm256_fmadd_pd( in_new, _mm256_loadu_pd( &xr[ length - 1 - t + 4 * g ] ), acc##g );
+
+/* Up to order 16 */
+static void warped_autocorrelation_5_avx2(
+    double                          *C,
+    const double                    *xr,
+    const double                    warping,
+    const opus_int                  length,
+    const opus_int                  order
+)
+{
+    opus_int t;
+    __m256d  w, in_new, in0, in1, in2, in3, in4, out0, out1, out2, out3, out4, acc0, acc1, acc2, acc3, acc4;
+
+    w = _mm256_set1_pd( warping );
+    in0 = in1 = in2 = in3 = in4 = _mm256_setzero_pd();
+    out0 = out1 = out2 = out3 = out4 = _mm256_setzero_pd();
+    acc0 = acc1 = acc2 = acc3 = acc4 = _mm256_setzero_pd();
+    for( t = 0; t < length + order; t++ ) {
+        __m256d rot0 = _mm256_permute4x64_pd( out0, 0x93 );
+        __m256d rot1 = _mm256_permute4x64_pd( out1, 0x93 );
+        __m256d rot2 = _mm256_permute4x64_pd( out2, 0x93 );
+        __m256d rot3 = _mm256_permute4x64_pd( out3, 0x93 );
+        __m256d rot4 = _mm256_permute4x64_pd( out4, 0x93 );
+        WARPED_GROUP_STEP( 4, rot3 )
+        WARPED_GROUP_STEP( 3, rot2 )
+        WARPED_GROUP_STEP( 2, rot1 )
+        WARPED_GROUP_STEP( 1, rot0 )
+        /* Lane 0 takes the next input sample */
+        WARPED_GROUP_STEP( 0, _mm256_broadcast_sd( &xr[ length - 1 - t ] ) )
+    }
+    _mm256_storeu_pd( &C[ 0 ], acc0 );
+    _mm256_storeu_pd( &C[ 4 ], acc1 );
+    _mm256_storeu_pd( &C[ 8 ], acc2 );
+    _mm256_storeu_pd( &C[ 12 ], acc3 );
+    _mm256_storeu_pd( &C[ 16 ], acc4 );
+}
+
+/* Up to order 24 */
+static void warped_autocorrelation_7_avx2(
+    double                          *C,
+    const double                    *xr,
+    const double                    warping,
+    const opus_int                  length,
+    const opus_int                  order
+)
+{
+    opus_int t;
+    __m256d  w, in_new, in0, in1, in2, in3, in4, in5, in6, out0, out1, out2, out3, out4, out5, out6;
+    __m256d  acc0, acc1, acc2, acc3, acc4, acc5, acc6;
+
+    w = _mm256_set1_pd( warping );
+    in0 = in1 = in2 = in3 = in4 = in5 = in6 = _mm256_setzero_pd();
+    out0 = out1 = out2 = out3 = out4 = out5 = out6 = _mm256_setzero_pd();
+    acc0 = acc1 = acc2 = acc3 = acc4 = acc5 = acc6 = _mm256_setzero_pd();
+    for( t = 0; t < length + order; t++ ) {
+        __m256d rot0 = _mm256_permute4x64_pd( out0, 0x93 );
+        __m256d rot1 = _mm256_permute4x64_pd( out1, 0x93 );
+        __m256d rot2 = _mm256_permute4x64_pd( out2, 0x93 );
+        __m256d rot3 = _mm256_permute4x64_pd( out3, 0x93 );
+        __m256d rot4 = _mm256_permute4x64_pd( out4, 0x93 );
+        __m256d rot5 = _mm256_permute4x64_pd( out5, 0x93 );
+        __m256d rot6 = _mm256_permute4x64_pd( out6, 0x93 );
+        WARPED_GROUP_STEP( 6, rot5 )
+        WARPED_GROUP_STEP( 5, rot4 )
+        WARPED_GROUP_STEP( 4, rot3 )
+        WARPED_GROUP_STEP( 3, rot2 )
+        WARPED_GROUP_STEP( 2, rot1 )
+        WARPED_GROUP_STEP( 1, rot0 )
+        WARPED_GROUP_STEP( 0, _mm256_broadcast_sd( &xr[ length - 1 - t ] ) )
+    }
+    _mm256_storeu_pd( &C[ 0 ], acc0 );
+    _mm256_storeu_pd( &C[ 4 ], acc1 );
+    _mm256_storeu_pd( &C[ 8 ], acc2 );
+    _mm256_storeu_pd( &C[ 12 ], acc3 );
+    _mm256_storeu_pd( &C[ 16 ], acc4 );
+    _mm256_storeu_pd( &C[ 20 ], acc5 );
+    _mm256_storeu_pd( &C[ 24 ], acc6 );
+}
+
+/* Autocorrelations for a warped frequency axis */
+void silk_warped_autocorrelation_FLP_avx2(
+    silk_float                      *corr,                              /* O    Result [order + 1]                          */
+    const silk_float                *input,                             /* I    Input data to correlate                     */
+    const silk_float                warping,                            /* I    Warping coefficient                         */
+    const opus_int                  length,                             /* I    Length of input                             */
+    const opus_int                  order                               /* I    Correlation order (even)                    */
+)
+{
+    opus_int    n, i;
+    double      xr_buf[ PAD + SHAPE_LPC_WIN_MAX + PAD ];
+    double      *xr = xr_buf + PAD;
+    double      C[ MAX_GROUPS * 4 ];
+
+    /* Order must be even */
+    celt_assert( ( order & 1 ) == 0 );
+    celt_assert( order <= MAX_SHAPE_LPC_ORDER );
+
+    if( length > SHAPE_LPC_WIN_MAX ) {
+        silk_warped_autocorrelation_FLP_c( corr, input, warping, length, order );
+        return;
+    }
+
+    /* Input in reverse order, so input[ t - i ] for consecutive i is contiguous */
+    silk_memset( xr_buf, 0, sizeof( xr_buf ) );
+    for( n = 0; n < length; n++ ) {
+        xr[ length - 1 - n ] = input[ n ];
+    }
+
+    if( order <= 16 ) {
+        warped_autocorrelation_5_avx2( C, xr, warping, length, order );
+    } else {
+        warped_autocorrelation_7_avx2( C, xr, warping, length, order );
+    }
+
+    /* Copy correlations in silk_float output format */
+    for( i = 0; i < order + 1; i++ ) {
+        corr[ i ] = ( silk_float )C[ i ];
+    }
+}
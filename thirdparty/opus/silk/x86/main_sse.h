@@ -292,6 +292,192 @@ extern double (*const SILK_INNER_PRODUCT_FLP_IMPL[OPUS_ARCHMASK + 1])(
 
 #define silk_inner_product_FLP(data1, data2, dataSize, arch) ((void)arch,(*SILK_INNER_PRODUCT_FLP_IMPL[(arch) & OPUS_ARCHMASK])(data1, data2, dataSize))
 
+#endif
+
+void silk_autocorrelation_FLP_avx2(
+    silk_float          *results,
+    const silk_float    *inputData,
+    opus_int            inputDataSize,
+    opus_int            correlationCount,
+    int                 arch
+);
+
+silk_float silk_burg_modified_FLP_avx2(
+    silk_float          A[],
+    const silk_float    x[],
+    const silk_float    minInvGain,
+    const opus_int      subfr_length,
+    const opus_int      nb_subfr,
+    const opus_int      D,
+    int                 arch
+);
+
+void silk_warped_autocorrelation_FLP_avx2(
+    silk_float          *corr,
+    const silk_float    *input,
+    const silk_float    warping,
+    const opus_int      length,
+    const opus_int      order
+);
+
+void silk_corrMatrix_FLP_avx2(
+    const silk_float    *x,
+    const opus_int      L,
+    const opus_int      Order,
+    silk_float          *XX,
+    int                 arch
+);
+
+void silk_corrVector_FLP_avx2(
+    const silk_float    *x,
+    const silk_float    *t,
+    const opus_int      L,
+    const opus_int      Order,
+    silk_float          *Xt,
+    int                 arch
+);
+
+void silk_P_Ana_calc_corr_st1_FLP_avx2(
+    silk_float          C[],
+    const opus_val32    xcorr[],
+    const silk_float    target_ptr[],
+    opus_int            sf_length,
+    opus_int            min_lag,
+    opus_int            max_lag,
+    int                 arch
+);
+
+void silk_P_Ana_calc_corr_st2_FLP_avx2(
+    silk_float          C[],
+    const silk_float    target_ptr[],
+    const opus_int16    d_comp[],
+    opus_int            length_d_comp,
+    opus_int            sf_length,
+    int                 arch
+);
+
+#if defined (OPUS_X86_PRESUME_AVX2)
+
+#define OVERRIDE_silk_autocorrelation_FLP
+#define silk_autocorrelation_FLP(results, inputData, inputDataSize, correlationCount, arch) \
+    silk_autocorrelation_FLP_avx2(results, inputData, inputDataSize, correlationCount, arch)
+
+#define OVERRIDE_silk_burg_modified_FLP
+#define silk_burg_modified_FLP(A, x, minInvGain, subfr_length, nb_subfr, D, arch) \
+    silk_burg_modified_FLP_avx2(A, x, minInvGain, subfr_length, nb_subfr, D, arch)
+
+#define OVERRIDE_silk_warped_autocorrelation_FLP
+#define silk_warped_autocorrelation_FLP(corr, input, warping, length, order, arch) \
+    ((void)(arch), silk_warped_autocorrelation_FLP_avx2(corr, input, warping, length, order))
+
+#define OVERRIDE_silk_corrMatrix_FLP
+#define silk_corrMatrix_FLP(x, L, Order, XX, arch) \
+    silk_corrMatrix_FLP_avx2(x, L, Order, XX, arch)
+
+#define OVERRIDE_silk_corrVector_FLP
+#define silk_corrVector_FLP(x, t, L, Order, Xt, arch) \
+    silk_corrVector_FLP_avx2(x, t, L, Order, Xt, arch)
+
+#define OVERRIDE_silk_P_Ana_calc_corr_st1_FLP
+#define silk_P_Ana_calc_corr_st1_FLP(C, xcorr, target_ptr, sf_length, min_lag, max_lag, arch) \
+    silk_P_Ana_calc_corr_st1_FLP_avx2(C, xcorr, target_ptr, sf_length, min_lag, max_lag, arch)
+
+#define OVERRIDE_silk_P_Ana_calc_corr_st2_FLP
+#define silk_P_Ana_calc_corr_st2_FLP(C, target_ptr, d_comp, length_d_comp, sf_length, arch) \
+    silk_P_Ana_calc_corr_st2_FLP_avx2(C, target_ptr, d_comp, length_d_comp, sf_length, arch)
+
+#elif defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX2)
+
+extern void (*const SILK_AUTOCORRELATION_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float          *results,
+    const silk_float    *inputData,
+    opus_int            inputDataSize,
+    opus_int            correlationCount,
+    int                 arch
+);
+
+#define OVERRIDE_silk_autocorrelation_FLP
+#define silk_autocorrelation_FLP(results, inputData, inputDataSize, correlationCount, arch) \
+    ((*SILK_AUTOCORRELATION_FLP_IMPL[(arch) & OPUS_ARCHMASK])(results, inputData, inputDataSize, correlationCount, arch))
+
+extern silk_float (*const SILK_BURG_MODIFIED_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float          A[],
+    const silk_float    x[],
+    const silk_float    minInvGain,
+    const opus_int      subfr_length,
+    const opus_int      nb_subfr,
+    const opus_int      D,
+    int                 arch
+);
+
+#define OVERRIDE_silk_burg_modified_FLP
+#define silk_burg_modified_FLP(A, x, minInvGain, subfr_length, nb_subfr, D, arch) \
+    ((*SILK_BURG_MODIFIED_FLP_IMPL[(arch) & OPUS_ARCHMASK])(A, x, minInvGain, subfr_length, nb_subfr, D, arch))
+
+extern void (*const SILK_WARPED_AUTOCORRELATION_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float          *corr,
+    const silk_float    *input,
+    const silk_float    warping,
+    const opus_int      length,
+    const opus_int      order
+);
+
+#define OVERRIDE_silk_warped_autocorrelation_FLP
+#define silk_warped_autocorrelation_FLP(corr, input, warping, length, order, arch) \
+    ((*SILK_WARPED_AUTOCORRELATION_FLP_IMPL[(arch) & OPUS_ARCHMASK])(corr, input, warping, length, order))
+
+extern void (*const SILK_CORRMATRIX_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    const silk_float    *x,
+    const opus_int      L,
+    const opus_int      Order,
+    silk_float          *XX,
+    int                 arch
+);
+
+#define OVERRIDE_silk_corrMatrix_FLP
+#define silk_corrMatrix_FLP(x, L, Order, XX, arch) \
+    ((*SILK_CORRMATRIX_FLP_IMPL[(arch) & OPUS_ARCHMASK])(x, L, Order, XX, arch))
+
+extern void (*const SILK_CORRVECTOR_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    const silk_float    *x,
+    const silk_float    *t,
+    const opus_int      L,
+    const opus_int      Order,
+    silk_float          *Xt,
+    int                 arch
+);
+
+#define OVERRIDE_silk_corrVector_FLP
+#define silk_corrVector_FLP(x, t, L, Order, Xt, arch) \
+    ((*SILK_CORRVECTOR_FLP_IMPL[(arch) & OPUS_ARCHMASK])(x, t, L, Order, Xt, arch))
+
+extern void (*const SILK_P_ANA_CALC_CORR_ST1_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float          C[],
+    const opus_val32    xcorr[],
+    const silk_float    target_ptr[],
+    opus_int            sf_length,
+    opus_int            min_lag,
+    opus_int            max_lag,
+    int                 arch
+);
+
+#define OVERRIDE_silk_P_Ana_calc_corr_st1_FLP
+#define silk_P_Ana_calc_corr_st1_FLP(C, xcorr, target_ptr, sf_length, min_lag, max_lag, arch) \
+    ((*SILK_P_ANA_CALC_CORR_ST1_FLP_IMPL[(arch) & OPUS_ARCHMASK])(C, xcorr, target_ptr, sf_length, min_lag, max_lag, arch))
+
+extern void (*const SILK_P_ANA_CALC_CORR_ST2_FLP_IMPL[OPUS_ARCHMASK + 1])(
+    silk_float          C[],
+    const silk_float    target_ptr[],
+    const opus_int16    d_comp[],
+    opus_int            length_d_comp,
+    opus_int            sf_length,
+    int                 arch
+);
+
+#define OVERRIDE_silk_P_Ana_calc_corr_st2_FLP
+#define silk_P_Ana_calc_corr_st2_FLP(C, target_ptr, d_comp, length_d_comp, sf_length, arch) \
+    ((*SILK_P_ANA_CALC_CORR_ST2_FLP_IMPL[(arch) & OPUS_ARCHMASK])(C, target_ptr, d_comp, length_d_comp, sf_length, arch))
+
 #endif
 #endif
 
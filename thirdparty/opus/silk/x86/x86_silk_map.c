@@ -34,6 +34,7 @@
 #include "SigProc_FIX.h"
 #ifndef FIXED_POINT
 #include "SigProc_FLP.h"
+#include "main_FLP.h"
 #endif
 #include "pitch.h"
 #include "main.h"
@@ -53,7 +54,9 @@ opus_int64 (*const SILK_INNER_PROD16_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_inner_prod16_c,
   silk_inner_prod16_c,
   MAY_HAVE_SSE4_1( silk_inner_prod16 ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_inner_prod16 )  /* avx */
+  MAY_HAVE_SSE4_1( silk_inner_prod16 ), /* avx */
+  MAY_HAVE_SSE4_1( silk_inner_prod16 ), /* avx512 */
+  MAY_HAVE_SSE4_1( silk_inner_prod16 )  /* avx512 vnni */
 };
 
 #endif
@@ -66,7 +69,9 @@ opus_int (*const SILK_VAD_GETSA_Q8_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_VAD_GetSA_Q8_c,
   silk_VAD_GetSA_Q8_c,
   MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 )  /* avx */
+  MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 ), /* avx */
+  MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 ), /* avx512 */
+  MAY_HAVE_SSE4_1( silk_VAD_GetSA_Q8 )  /* avx512 vnni */
 };
 
 void (*const SILK_NSQ_IMPL[ OPUS_ARCHMASK + 1 ] )(
@@ -90,7 +95,9 @@ void (*const SILK_NSQ_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_NSQ_c,
   silk_NSQ_c,
   MAY_HAVE_SSE4_1( silk_NSQ ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_NSQ )  /* avx */
+  MAY_HAVE_SSE4_1( silk_NSQ ), /* avx */
+  MAY_HAVE_SSE4_1( silk_NSQ ), /* avx512 */
+  MAY_HAVE_SSE4_1( silk_NSQ )  /* avx512 vnni */
 };
 
 void (*const SILK_VQ_WMAT_EC_IMPL[ OPUS_ARCHMASK + 1 ] )(
@@ -111,7 +118,9 @@ void (*const SILK_VQ_WMAT_EC_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_VQ_WMat_EC_c,
   silk_VQ_WMat_EC_c,
   MAY_HAVE_SSE4_1( silk_VQ_WMat_EC ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_VQ_WMat_EC )  /* avx */
+  MAY_HAVE_SSE4_1( silk_VQ_WMat_EC ), /* avx */
+  MAY_HAVE_SSE4_1( silk_VQ_WMat_EC ), /* avx512 */
+  MAY_HAVE_SSE4_1( silk_VQ_WMat_EC )  /* avx512 vnni */
 };
 
 void (*const SILK_NSQ_DEL_DEC_IMPL[ OPUS_ARCHMASK + 1 ] )(
@@ -135,7 +144,9 @@ void (*const SILK_NSQ_DEL_DEC_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_NSQ_del_dec_c,
   silk_NSQ_del_dec_c,
   MAY_HAVE_SSE4_1( silk_NSQ_del_dec ), /* sse4.1 */
-  MAY_HAVE_AVX2( silk_NSQ_del_dec )  /* avx */
+  MAY_HAVE_AVX2( silk_NSQ_del_dec ), /* avx */
+  MAY_HAVE_AVX2( silk_NSQ_del_dec ), /* avx512 */
+  MAY_HAVE_AVX2( silk_NSQ_del_dec )  /* avx512 vnni */
 };
 
 #if defined(FIXED_POINT)
@@ -155,7 +166,9 @@ void (*const SILK_BURG_MODIFIED_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_burg_modified_c,
   silk_burg_modified_c,
   MAY_HAVE_SSE4_1( silk_burg_modified ), /* sse4.1 */
-  MAY_HAVE_SSE4_1( silk_burg_modified )  /* avx */
+  MAY_HAVE_SSE4_1( silk_burg_modified ), /* avx */
+  MAY_HAVE_SSE4_1( silk_burg_modified ), /* avx512 */
+  MAY_HAVE_SSE4_1( silk_burg_modified )  /* avx512 vnni */
 };
 
 #endif
@@ -171,7 +184,127 @@ double (*const SILK_INNER_PRODUCT_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
   silk_inner_product_FLP_c,
   silk_inner_product_FLP_c,
   silk_inner_product_FLP_c, /* sse4.1 */
-  MAY_HAVE_AVX2( silk_inner_product_FLP )  /* avx */
+  MAY_HAVE_AVX2( silk_inner_product_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_inner_product_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_inner_product_FLP )  /* avx512 vnni */
+};
+
+void (*const SILK_AUTOCORRELATION_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float          *results,
+    const silk_float    *inputData,
+    opus_int            inputDataSize,
+    opus_int            correlationCount,
+    int                 arch
+) = {
+  silk_autocorrelation_FLP_c,                  /* non-sse */
+  silk_autocorrelation_FLP_c,
+  silk_autocorrelation_FLP_c,
+  silk_autocorrelation_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_autocorrelation_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_autocorrelation_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_autocorrelation_FLP )  /* avx512 vnni */
+};
+
+silk_float (*const SILK_BURG_MODIFIED_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float          A[],
+    const silk_float    x[],
+    const silk_float    minInvGain,
+    const opus_int      subfr_length,
+    const opus_int      nb_subfr,
+    const opus_int      D,
+    int                 arch
+) = {
+  silk_burg_modified_FLP_c,                  /* non-sse */
+  silk_burg_modified_FLP_c,
+  silk_burg_modified_FLP_c,
+  silk_burg_modified_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_burg_modified_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_burg_modified_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_burg_modified_FLP )  /* avx512 vnni */
+};
+
+void (*const SILK_WARPED_AUTOCORRELATION_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float          *corr,
+    const silk_float    *input,
+    const silk_float    warping,
+    const opus_int      length,
+    const opus_int      order
+) = {
+  silk_warped_autocorrelation_FLP_c,                  /* non-sse */
+  silk_warped_autocorrelation_FLP_c,
+  silk_warped_autocorrelation_FLP_c,
+  silk_warped_autocorrelation_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_warped_autocorrelation_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_warped_autocorrelation_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_warped_autocorrelation_FLP )  /* avx512 vnni */
+};
+
+void (*const SILK_CORRMATRIX_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    const silk_float    *x,
+    const opus_int      L,
+    const opus_int      Order,
+    silk_float          *XX,
+    int                 arch
+) = {
+  silk_corrMatrix_FLP_c,                  /* non-sse */
+  silk_corrMatrix_FLP_c,
+  silk_corrMatrix_FLP_c,
+  silk_corrMatrix_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_corrMatrix_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_corrMatrix_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_corrMatrix_FLP )  /* avx512 vnni */
+};
+
+void (*const SILK_CORRVECTOR_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    const silk_float    *x,
+    const silk_float    *t,
+    const opus_int      L,
+    const opus_int      Order,
+    silk_float          *Xt,
+    int                 arch
+) = {
+  silk_corrVector_FLP_c,                  /* non-sse */
+  silk_corrVector_FLP_c,
+  silk_corrVector_FLP_c,
+  silk_corrVector_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_corrVector_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_corrVector_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_corrVector_FLP )  /* avx512 vnni */
+};
+
+void (*const SILK_P_ANA_CALC_CORR_ST1_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float          C[],
+    const opus_val32    xcorr[],
+    const silk_float    target_ptr[],
+    opus_int            sf_length,
+    opus_int            min_lag,
+    opus_int            max_lag,
+    int                 arch
+) = {
+  silk_P_Ana_calc_corr_st1_FLP_c,                  /* non-sse */
+  silk_P_Ana_calc_corr_st1_FLP_c,
+  silk_P_Ana_calc_corr_st1_FLP_c,
+  silk_P_Ana_calc_corr_st1_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_st1_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_st1_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_st1_FLP )  /* avx512 vnni */
+};
+
+void (*const SILK_P_ANA_CALC_CORR_ST2_FLP_IMPL[ OPUS_ARCHMASK + 1 ] )(
+    silk_float          C[],
+    const silk_float    target_ptr[],
+    const opus_int16    d_comp[],
+    opus_int            length_d_comp,
+    opus_int            sf_length,
+    int                 arch
+) = {
+  silk_P_Ana_calc_corr_st2_FLP_c,                  /* non-sse */
+  silk_P_Ana_calc_corr_st2_FLP_c,
+  silk_P_Ana_calc_corr_st2_FLP_c,
+  silk_P_Ana_calc_corr_st2_FLP_c, /* sse4.1 */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_st2_FLP ), /* avx */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_st2_FLP ), /* avx512 */
+  MAY_HAVE_AVX2( silk_P_Ana_calc_corr_st2_FLP )  /* avx512 vnni */
 };
 
 #endif
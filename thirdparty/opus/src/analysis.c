@@ -35,6 +35,8 @@
 #include <stdio.h>
 #endif
 
+#include <string.h>
+
 #include "mathops.h"
 #include "kiss_fft.h"
 #include "celt.h"
@@ -230,6 +232,24 @@ void tonality_analysis_reset(TonalityAnalysisState *tonal)
   OPUS_CLEAR(start, sizeof(TonalityAnalysisState) - (start - (char*)tonal));
 }
 
+int tonality_analysis_matches(const TonalityAnalysisState *a, const TonalityAnalysisState *b)
+{
+  size_t read_start = (const char*)&a->read_pos - (const char*)a;
+  size_t read_end = (const char*)(&a->read_subframe+1) - (const char*)a;
+  return memcmp(a, b, read_start) == 0
+      && memcmp((const char*)a+read_end, (const char*)b+read_end, sizeof(*a)-read_end) == 0;
+}
+
+void tonality_analysis_copy(TonalityAnalysisState *dst, const TonalityAnalysisState *src)
+{
+  int read_pos, read_subframe;
+  read_pos = dst->read_pos;
+  read_subframe = dst->read_subframe;
+  OPUS_COPY(dst, src, 1);
+  dst->read_pos = read_pos;
+  dst->read_subframe = read_subframe;
+}
+
 void tonality_get_info(TonalityAnalysisState *tonal, AnalysisInfo *info_out, int len)
 {
    int pos;
@@ -929,9 +949,9 @@ static void tonality_analysis(TonalityAnalysisState *tonal, const CELTMode *celt
     features[23] = info->tonality_slope + 0.069216f;
     features[24] = tonal->lowECount - 0.067930f;
 
-    analysis_compute_dense(&layer0, layer_out, features);
-    analysis_compute_gru(&layer1, tonal->rnn_state, layer_out);
-    analysis_compute_dense(&layer2, frame_probs, tonal->rnn_state);
+    analysis_compute_dense(&layer0, layer_out, features, tonal->arch);
+    analysis_compute_gru(&layer1, tonal->rnn_state, layer_out, tonal->arch);
+    analysis_compute_dense(&layer2, frame_probs, tonal->rnn_state, tonal->arch);
 
     /* Probability of speech or music vs noise */
     info->activity_probability = frame_probs[1];
@@ -955,10 +975,21 @@ static void tonality_analysis(TonalityAnalysisState *tonal, const CELTMode *celt
 void run_analysis(TonalityAnalysisState *analysis, const CELTMode *celt_mode, const void *analysis_pcm,
                  int analysis_frame_size, int frame_size, int c1, int c2, int C, opus_int32 Fs,
                  int lsb_depth, downmix_func downmix, AnalysisInfo *analysis_info)
+{
+   tonality_analysis_feed(analysis, celt_mode, analysis_pcm, analysis_frame_size, frame_size,
+         c1, c2, C, Fs, lsb_depth, downmix);
+   tonality_get_info(analysis, analysis_info, frame_size);
+}
+
+void tonality_analysis_feed(TonalityAnalysisState *analysis, const CELTMode *celt_mode, const void *analysis_pcm,
+                 int analysis_frame_size, int frame_size, int c1, int c2, int C, opus_int32 Fs,
+                 int lsb_depth, downmix_func downmix)
 {
    int offset;
    int pcm_len;
 
+   if (downmix == downmix_analyzed)
+      return;
    analysis_frame_size -= analysis_frame_size&1;
    if (analysis_pcm != NULL)
    {
@@ -976,8 +1007,18 @@ void run_analysis(TonalityAnalysisState *analysis, const CELTMode *celt_mode, co
 
       analysis->analysis_offset -= frame_size;
    }
+}
 
-   tonality_get_info(analysis, analysis_info, frame_size);
+void downmix_analyzed(const void *_x, opus_val32 *sub, int subframe, int offset, int c1, int c2, int C)
+{
+   (void)_x;
+   (void)sub;
+   (void)subframe;
+   (void)offset;
+   (void)c1;
+   (void)c2;
+   (void)C;
+   celt_assert(0);
 }
 
 #endif /* DISABLE_FLOAT_API */
@@ -96,8 +96,34 @@ void tonality_analysis_reset(TonalityAnalysisState *analysis);
 
 void tonality_get_info(TonalityAnalysisState *tonal, AnalysisInfo *info_out, int len);
 
+/** Whether the next tonality_analysis_feed() of the same input leaves a and b
+ * in the same state, i.e. everything but the read position matches.
+ */
+int tonality_analysis_matches(const TonalityAnalysisState *a, const TonalityAnalysisState *b);
+
+/** Copy the state of src into dst, except for dst's read position, which
+ * belongs to the encoder reading dst.
+ */
+void tonality_analysis_copy(TonalityAnalysisState *dst, const TonalityAnalysisState *src);
+
 void run_analysis(TonalityAnalysisState *analysis, const CELTMode *celt_mode, const void *analysis_pcm,
                  int analysis_frame_size, int frame_size, int c1, int c2, int C, opus_int32 Fs,
                  int lsb_depth, downmix_func downmix, AnalysisInfo *analysis_info);
 
+/** Analyze one frame of input without reading the result.
+ *
+ * This is the part of run_analysis() that does the work (FFT, features and
+ * the MLP). It only depends on the input and on the earlier calls, not on
+ * read_pos, so it can run ahead of tonality_get_info().
+ */
+void tonality_analysis_feed(TonalityAnalysisState *analysis, const CELTMode *celt_mode, const void *analysis_pcm,
+                 int analysis_frame_size, int frame_size, int c1, int c2, int C, opus_int32 Fs,
+                 int lsb_depth, downmix_func downmix);
+
+/** Marks that this frame's input was already fed, through a
+ * tonality_analysis_copy() from an analysis that read the same input. Never
+ * called, tonality_analysis_feed() returns right away.
+ */
+void downmix_analyzed(const void *_x, opus_val32 *sub, int subframe, int offset, int c1, int c2, int C);
+
 #endif
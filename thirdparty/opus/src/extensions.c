@@ -183,6 +183,73 @@ opus_int32 opus_packet_extensions_parse(const unsigned char *data, opus_int32 le
    return OPUS_OK;
 }
 
+/* Find the first extension with a given id on a given frame. Runs of 0x01
+   padding are skipped in one go, and since extensions come in frame order
+   the walk stops as soon as it is past the frame. */
+opus_int32 opus_packet_extensions_find(const unsigned char *data, opus_int32 len, int id, int frame, const unsigned char **payload)
+{
+   const unsigned char *curr_data;
+   opus_int32 curr_len;
+   int curr_frame=0;
+
+   celt_assert(len >= 0);
+   celt_assert(data != NULL || len == 0);
+
+   *payload = NULL;
+   curr_data = data;
+   curr_len = len;
+   while (curr_len > 0)
+   {
+      int curr_id;
+      opus_int32 header_size;
+      const unsigned char *start;
+      if (*curr_data == 0x01)
+      {
+         do {
+            curr_data++;
+            curr_len--;
+         } while (curr_len > 0 && *curr_data == 0x01);
+         continue;
+      }
+      curr_id = *curr_data>>1;
+      if (curr_id == 1)
+      {
+         if ((*curr_data&1) == 0)
+            curr_frame++;
+         else if (curr_len >= 2)
+            curr_frame += curr_data[1];
+         if (curr_frame > frame)
+            return 0;
+      }
+      start = curr_data;
+      curr_len = skip_extension(&curr_data, curr_len, &header_size);
+      if (curr_len < 0)
+         return OPUS_INVALID_PACKET;
+      if (curr_id == id && curr_frame == frame)
+      {
+         *payload = start + header_size;
+         return (opus_int32)(curr_data - start) - header_size;
+      }
+   }
+   return 0;
+}
+
+opus_int32 opus_packet_get_extensions(const unsigned char *data, opus_int32 len, const unsigned char **padding)
+{
+   const unsigned char *frames[48];
+   opus_int16 size[48];
+   opus_int32 padding_len;
+   int ret;
+
+   *padding = NULL;
+   ret = opus_packet_parse_impl(data, len, 0, NULL, frames, size, NULL, NULL, padding, &padding_len);
+   if (ret < 0)
+      return ret;
+   if (padding_len == 0)
+      *padding = NULL;
+   return padding_len;
+}
+
 opus_int32 opus_packet_extensions_generate(unsigned char *data, opus_int32 len, const opus_extension_data  *extensions, opus_int32 nb_extensions, int pad)
 {
    int max_frame=0;
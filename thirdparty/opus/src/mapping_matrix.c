@@ -31,6 +31,8 @@
 
 #include "arch.h"
 #include "float_cast.h"
+#include "os_support.h"
+#include "stack_alloc.h"
 #include "opus_private.h"
 #include "opus_defines.h"
 #include "mapping_matrix.h"
@@ -228,6 +230,254 @@ void mapping_matrix_multiply_channel_out_short(
   }
 }
 
+/* Samples converted per call of the kernels when their input or output needs
+   staging */
+#define MIX_BLOCK 64
+
+void mapping_matrix_mix_c(const float *coefs, int stride, int cols,
+    const float *input, int input_stride, float scale, float *output,
+    int frame_size)
+{
+  int i, row, col;
+
+  for (i = 0; i < frame_size; i++)
+  {
+    const float *x = input + i*input_stride;
+    float *y = output + i*stride;
+    for (row = 0; row < stride; row++)
+      y[row] = 0;
+    for (col = 0; col < cols; col++)
+    {
+      const float *c = coefs + col*stride;
+      for (row = 0; row < stride; row++)
+        y[row] += c[row]*x[col];
+    }
+    for (row = 0; row < stride; row++)
+      y[row] = scale*y[row];
+  }
+}
+
+void mapping_matrix_mix_int_c(const opus_int32 *coefs, int stride, int cols,
+    const opus_int16 *input, int input_stride, opus_int32 *output,
+    int frame_size)
+{
+  int i, row, col;
+
+  for (i = 0; i < frame_size; i++)
+  {
+    const opus_int16 *x = input + i*input_stride;
+    opus_int32 *y = output + i*stride;
+    for (row = 0; row < stride; row++)
+      y[row] = 0;
+    for (col = 0; col < cols; col++)
+    {
+      const opus_int32 *c = coefs + col*stride;
+      for (row = 0; row < stride; row++)
+        y[row] += (c[row]*x[col] + 16384) >> 15;
+    }
+  }
+}
+
+#if !defined(FIXED_POINT)
+/* The first rows x cols of the matrix times scale, column-major with the
+   columns padded to the kernels' stride */
+static void mix_coefs(const MappingMatrix *matrix, int rows, int cols,
+    float scale, float *coefs)
+{
+  opus_int16* matrix_data;
+  int stride, row, col;
+
+  matrix_data = mapping_matrix_get_data(matrix);
+  stride = MAPPING_MATRIX_STRIDE(rows);
+  for (col = 0; col < cols; col++)
+  {
+    for (row = 0; row < rows; row++)
+      coefs[col*stride + row] =
+        scale*matrix_data[MATRIX_INDEX(matrix->rows, row, col)];
+    for (; row < stride; row++)
+      coefs[col*stride + row] = 0;
+  }
+}
+#endif
+
+#ifndef DISABLE_FLOAT_API
+void mapping_matrix_multiply_frame_in_float(
+    const MappingMatrix *matrix,
+    const float *input,
+    int input_rows,
+    opus_val16 *output,
+    int output_rows,
+    int frame_size,
+    int arch)
+{
+#if defined(FIXED_POINT)
+  int row;
+
+  (void)arch;
+  for (row = 0; row < output_rows; row++)
+    mapping_matrix_multiply_channel_in_float(matrix, input, input_rows,
+      output + row, row, MAPPING_MATRIX_STRIDE(output_rows), frame_size);
+#else
+  int stride;
+  VARDECL(float, coefs);
+  ALLOC_STACK;
+
+  celt_assert(input_rows <= matrix->cols && output_rows <= matrix->rows);
+
+  stride = MAPPING_MATRIX_STRIDE(output_rows);
+  ALLOC(coefs, input_rows*stride, float);
+  mix_coefs(matrix, output_rows, input_rows, 1, coefs);
+  mapping_matrix_mix(coefs, stride, input_rows, input, input_rows,
+    1/32768.f, output, frame_size, arch);
+  RESTORE_STACK;
+#endif
+}
+
+void mapping_matrix_multiply_frame_out_float(
+    const MappingMatrix *matrix,
+    const opus_val16 *input,
+    int input_rows,
+    float *output,
+    int output_rows,
+    int frame_size,
+    int arch)
+{
+#if defined(FIXED_POINT)
+  int col;
+
+  (void)arch;
+  OPUS_CLEAR(output, frame_size*output_rows);
+  for (col = 0; col < input_rows; col++)
+    mapping_matrix_multiply_channel_out_float(matrix, input + col, col,
+      input_rows, output, output_rows, frame_size);
+#else
+  int stride, i, j, row;
+  VARDECL(float, coefs);
+  VARDECL(float, block);
+  ALLOC_STACK;
+
+  celt_assert(input_rows <= matrix->cols && output_rows <= matrix->rows);
+
+  stride = MAPPING_MATRIX_STRIDE(output_rows);
+  ALLOC(coefs, input_rows*stride, float);
+  ALLOC(block, MIX_BLOCK*stride, float);
+  mix_coefs(matrix, output_rows, input_rows, 1/32768.f, coefs);
+  for (i = 0; i < frame_size; i += MIX_BLOCK)
+  {
+    int n = IMIN(MIX_BLOCK, frame_size - i);
+    mapping_matrix_mix(coefs, stride, input_rows, input + i*input_rows,
+      input_rows, 1, block, n, arch);
+    for (j = 0; j < n; j++)
+    {
+      for (row = 0; row < output_rows; row++)
+        output[(i + j)*output_rows + row] = block[j*stride + row];
+    }
+  }
+  RESTORE_STACK;
+#endif
+}
+#endif /* DISABLE_FLOAT_API */
+
+void mapping_matrix_multiply_frame_in_short(
+    const MappingMatrix *matrix,
+    const opus_int16 *input,
+    int input_rows,
+    opus_val16 *output,
+    int output_rows,
+    int frame_size,
+    int arch)
+{
+#if defined(FIXED_POINT)
+  int row;
+
+  (void)arch;
+  for (row = 0; row < output_rows; row++)
+    mapping_matrix_multiply_channel_in_short(matrix, input, input_rows,
+      output + row, row, MAPPING_MATRIX_STRIDE(output_rows), frame_size);
+#else
+  int stride, i, j;
+  VARDECL(float, coefs);
+  VARDECL(float, block);
+  ALLOC_STACK;
+
+  celt_assert(input_rows <= matrix->cols && output_rows <= matrix->rows);
+
+  stride = MAPPING_MATRIX_STRIDE(output_rows);
+  ALLOC(coefs, input_rows*stride, float);
+  ALLOC(block, MIX_BLOCK*input_rows, float);
+  mix_coefs(matrix, output_rows, input_rows, 1, coefs);
+  for (i = 0; i < frame_size; i += MIX_BLOCK)
+  {
+    int n = IMIN(MIX_BLOCK, frame_size - i);
+    /* The int16 products are exact in float before rounding, so the sums
+       come out as the per-channel version's int to float accumulation */
+    for (j = 0; j < n*input_rows; j++)
+      block[j] = input[i*input_rows + j];
+    mapping_matrix_mix(coefs, stride, input_rows, block, input_rows,
+      1/(32768.f*32768.f), output + i*stride, n, arch);
+  }
+  RESTORE_STACK;
+#endif
+}
+
+void mapping_matrix_multiply_frame_out_short(
+    const MappingMatrix *matrix,
+    const opus_val16 *input,
+    int input_rows,
+    opus_int16 *output,
+    int output_rows,
+    int frame_size,
+    int arch)
+{
+#if defined(FIXED_POINT)
+  int col;
+
+  (void)arch;
+  OPUS_CLEAR(output, frame_size*output_rows);
+  for (col = 0; col < input_rows; col++)
+    mapping_matrix_multiply_channel_out_short(matrix, input + col, col,
+      input_rows, output, output_rows, frame_size);
+#else
+  opus_int16* matrix_data;
+  int stride, i, j, row, col;
+  VARDECL(opus_int32, coefs);
+  VARDECL(opus_int16, block_in);
+  VARDECL(opus_int32, block);
+  ALLOC_STACK;
+
+  celt_assert(input_rows <= matrix->cols && output_rows <= matrix->rows);
+
+  matrix_data = mapping_matrix_get_data(matrix);
+  stride = MAPPING_MATRIX_STRIDE(output_rows);
+  ALLOC(coefs, input_rows*stride, opus_int32);
+  ALLOC(block_in, MIX_BLOCK*input_rows, opus_int16);
+  ALLOC(block, MIX_BLOCK*stride, opus_int32);
+  for (col = 0; col < input_rows; col++)
+  {
+    for (row = 0; row < output_rows; row++)
+      coefs[col*stride + row] = matrix_data[MATRIX_INDEX(matrix->rows, row, col)];
+    for (; row < stride; row++)
+      coefs[col*stride + row] = 0;
+  }
+  for (i = 0; i < frame_size; i += MIX_BLOCK)
+  {
+    int n = IMIN(MIX_BLOCK, frame_size - i);
+    for (j = 0; j < n*input_rows; j++)
+      block_in[j] = FLOAT2INT16(input[i*input_rows + j]);
+    mapping_matrix_mix_int(coefs, stride, input_rows, block_in, input_rows,
+      block, n, arch);
+    /* The per-channel version wraps as it accumulates into int16, the
+       truncated sum wraps the same way */
+    for (j = 0; j < n; j++)
+    {
+      for (row = 0; row < output_rows; row++)
+        output[(i + j)*output_rows + row] = (opus_int16)block[j*stride + row];
+    }
+  }
+  RESTORE_STACK;
+#endif
+}
+
 const MappingMatrix mapping_matrix_foa_mixing = { 6, 6, 0 };
 const opus_int16 mapping_matrix_foa_mixing_data[36] = {
      16384,      0, -16384,  23170,      0,      0,  16384,  23170,
@@ -103,6 +103,92 @@ void mapping_matrix_multiply_channel_out_short(
     int frame_size
 );
 
+/* Whole-frame versions of the above: one pass over the frame computes every
+ * output channel. The mixing side writes all output_rows channels of each
+ * sample with a stride of MAPPING_MATRIX_STRIDE(output_rows), for the
+ * multistream encoder to pick its channels from. The demixing side reads
+ * input_rows interleaved channels and overwrites output. The results are
+ * bit-exact with the per-channel functions.
+ */
+#define MAPPING_MATRIX_STRIDE(rows) (((rows) + 7) & ~7)
+
+/* The multistream layer codes every stream a whole frame at a time, so the
+ * projection states keep room for one whole frame of all channels (120 ms at
+ * 48 kHz) rather than putting it on the stack.
+ */
+#define MAPPING_MATRIX_MAX_FRAME_SIZE 5760
+
+#ifndef DISABLE_FLOAT_API
+void mapping_matrix_multiply_frame_in_float(
+    const MappingMatrix *matrix,
+    const float *input,
+    int input_rows,
+    opus_val16 *output,
+    int output_rows,
+    int frame_size,
+    int arch
+);
+
+void mapping_matrix_multiply_frame_out_float(
+    const MappingMatrix *matrix,
+    const opus_val16 *input,
+    int input_rows,
+    float *output,
+    int output_rows,
+    int frame_size,
+    int arch
+);
+#endif /* DISABLE_FLOAT_API */
+
+void mapping_matrix_multiply_frame_in_short(
+    const MappingMatrix *matrix,
+    const opus_int16 *input,
+    int input_rows,
+    opus_val16 *output,
+    int output_rows,
+    int frame_size,
+    int arch
+);
+
+void mapping_matrix_multiply_frame_out_short(
+    const MappingMatrix *matrix,
+    const opus_val16 *input,
+    int input_rows,
+    opus_int16 *output,
+    int output_rows,
+    int frame_size,
+    int arch
+);
+
+/* The kernels under them. coefs holds cols columns of stride rows each
+ * (stride a multiple of 8, padded with zeros). For every sample i and
+ * every row below stride:
+ *   mix:     output[i*stride + row] = scale * sum(coefs[col*stride + row]
+ *                                                * input[i*input_stride + col])
+ *   mix_int: output[i*stride + row] = sum((coefs[col*stride + row]
+ *                                          * input[i*input_stride + col]
+ *                                          + 16384) >> 15)
+ * summing the columns in order.
+ */
+void mapping_matrix_mix_c(const float *coefs, int stride, int cols,
+    const float *input, int input_stride, float scale, float *output,
+    int frame_size);
+
+void mapping_matrix_mix_int_c(const opus_int32 *coefs, int stride, int cols,
+    const opus_int16 *input, int input_stride, opus_int32 *output,
+    int frame_size);
+
+#if defined(OPUS_X86_MAY_HAVE_SSE4_1) || defined(OPUS_X86_MAY_HAVE_AVX2)
+#include "x86/mapping_matrix_x86.h"
+#endif
+
+#ifndef OVERRIDE_MAPPING_MATRIX_MIX
+#define mapping_matrix_mix(coefs, stride, cols, input, input_stride, scale, output, frame_size, arch) \
+   ((void)(arch), mapping_matrix_mix_c(coefs, stride, cols, input, input_stride, scale, output, frame_size))
+#define mapping_matrix_mix_int(coefs, stride, cols, input, input_stride, output, frame_size, arch) \
+   ((void)(arch), mapping_matrix_mix_int_c(coefs, stride, cols, input, input_stride, output, frame_size))
+#endif
+
 /* Pre-computed mixing and demixing matrices for 1st to 3rd-order ambisonics.
  *   foa: first-order ambisonics
  *   soa: second-order ambisonics
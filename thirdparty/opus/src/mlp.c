@@ -67,7 +67,7 @@ static void gemm_accum(float *out, const opus_int8 *weights, int rows, int cols,
    }
 }
 
-void analysis_compute_dense(const AnalysisDenseLayer *layer, float *output, const float *input)
+void analysis_compute_dense_c(const AnalysisDenseLayer *layer, float *output, const float *input)
 {
    int i;
    int N, M;
@@ -89,7 +89,7 @@ void analysis_compute_dense(const AnalysisDenseLayer *layer, float *output, cons
    }
 }
 
-void analysis_compute_gru(const AnalysisGRULayer *gru, float *state, const float *input)
+void analysis_compute_gru_c(const AnalysisGRULayer *gru, float *state, const float *input)
 {
    int i;
    int N, M;
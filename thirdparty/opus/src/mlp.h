@@ -53,8 +53,19 @@ extern const AnalysisDenseLayer layer0;
 extern const AnalysisGRULayer layer1;
 extern const AnalysisDenseLayer layer2;
 
-void analysis_compute_dense(const AnalysisDenseLayer *layer, float *output, const float *input);
+void analysis_compute_dense_c(const AnalysisDenseLayer *layer, float *output, const float *input);
 
-void analysis_compute_gru(const AnalysisGRULayer *gru, float *state, const float *input);
+void analysis_compute_gru_c(const AnalysisGRULayer *gru, float *state, const float *input);
+
+#if defined(OPUS_X86_MAY_HAVE_SSE4_1) || defined(OPUS_X86_MAY_HAVE_AVX2)
+#include "x86/mlp_x86.h"
+#endif
+
+#ifndef OVERRIDE_ANALYSIS_MLP
+#define analysis_compute_dense(layer, output, input, arch) \
+   ((void)(arch), analysis_compute_dense_c(layer, output, input))
+#define analysis_compute_gru(gru, state, input, arch) \
+   ((void)(arch), analysis_compute_gru_c(gru, state, input))
+#endif
 
 #endif /* MLP_H_ */
@@ -74,6 +74,11 @@ struct OpusDecoder {
 #ifdef ENABLE_DEEP_PLC
     LPCNetPLCState lpcnet;
 #endif
+#ifdef OPUS_SCRATCH_ARENA
+   int          scratch_offset;
+   opus_int32   scratch_size;
+   opus_int32   scratch_peak;
+#endif
 
    /* Everything beyond this point gets cleared on a reset */
 #define OPUS_DECODER_RESET_START stream_channels
@@ -117,14 +122,19 @@ int opus_decoder_get_size(int channels)
 {
    int silkDecSizeBytes, celtDecSizeBytes;
    int ret;
-   if (channels<1 || channels > 2)
+   int size;
+   if (channels<1 || channels > 2 || !OPUS_CHANNELS_SUPPORTED(channels))
       return 0;
    ret = silk_Get_Decoder_Size( &silkDecSizeBytes );
    if(ret)
       return 0;
    silkDecSizeBytes = align(silkDecSizeBytes);
    celtDecSizeBytes = celt_decoder_get_size(channels);
-   return align(sizeof(OpusDecoder))+silkDecSizeBytes+celtDecSizeBytes;
+   size = align(sizeof(OpusDecoder))+silkDecSizeBytes+celtDecSizeBytes;
+#ifdef OPUS_SCRATCH_ARENA
+   size += OPUS_SCRATCH_ALLOC_SIZE(OPUS_DECODER_SCRATCH_SIZE(channels));
+#endif
+   return size;
 }
 
 int opus_decoder_init(OpusDecoder *st, opus_int32 Fs, int channels)
@@ -134,7 +144,8 @@ int opus_decoder_init(OpusDecoder *st, opus_int32 Fs, int channels)
    int ret, silkDecSizeBytes;
 
    if ((Fs!=48000&&Fs!=24000&&Fs!=16000&&Fs!=12000&&Fs!=8000)
-    || (channels!=1&&channels!=2))
+    || (channels!=1&&channels!=2)
+    || !OPUS_FS_SUPPORTED(Fs) || !OPUS_CHANNELS_SUPPORTED(channels))
       return OPUS_BAD_ARG;
 
    OPUS_CLEAR((char*)st, opus_decoder_get_size(channels));
@@ -146,14 +157,18 @@ int opus_decoder_init(OpusDecoder *st, opus_int32 Fs, int channels)
    silkDecSizeBytes = align(silkDecSizeBytes);
    st->silk_dec_offset = align(sizeof(OpusDecoder));
    st->celt_dec_offset = st->silk_dec_offset+silkDecSizeBytes;
+#ifdef OPUS_SCRATCH_ARENA
+   st->scratch_offset = st->celt_dec_offset+celt_decoder_get_size(channels);
+   st->scratch_size = OPUS_DECODER_SCRATCH_SIZE(channels);
+#endif
    silk_dec = (char*)st+st->silk_dec_offset;
    celt_dec = (CELTDecoder*)((char*)st+st->celt_dec_offset);
    st->stream_channels = st->channels = channels;
    st->complexity = 0;
 
    st->Fs = Fs;
-   st->DecControl.API_sampleRate = st->Fs;
-   st->DecControl.nChannelsAPI      = st->channels;
+   st->DecControl.API_sampleRate = OPUS_API_FS(st->Fs);
+   st->DecControl.nChannelsAPI      = OPUS_API_CHANNELS(st->channels);
 
    /* Reset decoder */
    ret = silk_InitDecoder( silk_dec );
@@ -270,7 +285,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
 
    silk_dec = (char*)st+st->silk_dec_offset;
    celt_dec = (CELTDecoder*)((char*)st+st->celt_dec_offset);
-   F20 = st->Fs/50;
+   F20 = OPUS_API_FS(st->Fs)/50;
    F10 = F20>>1;
    F5 = F10>>1;
    F2_5 = F5>>1;
@@ -280,7 +295,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
       return OPUS_BUFFER_TOO_SMALL;
    }
    /* Limit frame_size to avoid excessive stack allocations. */
-   frame_size = IMIN(frame_size, st->Fs/25*3);
+   frame_size = IMIN(frame_size, OPUS_API_FS(st->Fs)/25*3);
    /* Payloads of 1 (2 including ToC) or 0 trigger the PLC/DTX */
    if (len<=1)
    {
@@ -303,7 +318,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
       if (mode == 0)
       {
          /* If we haven't got any packet yet, all we can do is return zeros */
-         for (i=0;i<audiosize*st->channels;i++)
+         for (i=0;i<audiosize*OPUS_API_CHANNELS(st->channels);i++)
             pcm[i] = 0;
          RESTORE_STACK;
          return audiosize;
@@ -320,7 +335,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
                RESTORE_STACK;
                return ret;
             }
-            pcm += ret*st->channels;
+            pcm += ret*OPUS_API_CHANNELS(st->channels);
             audiosize -= ret;
          } while (audiosize > 0);
          RESTORE_STACK;
@@ -352,9 +367,9 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
       transition = 1;
       /* Decide where to allocate the stack memory for pcm_transition */
       if (mode == MODE_CELT_ONLY)
-         pcm_transition_celt_size = F5*st->channels;
+         pcm_transition_celt_size = F5*OPUS_API_CHANNELS(st->channels);
       else
-         pcm_transition_silk_size = F5*st->channels;
+         pcm_transition_silk_size = F5*OPUS_API_CHANNELS(st->channels);
    }
    ALLOC(pcm_transition_celt, pcm_transition_celt_size, opus_val16);
    if (transition && mode == MODE_CELT_ONLY)
@@ -372,7 +387,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
    }
 
    /* Don't allocate any memory when in CELT-only mode */
-   pcm_silk_size = (mode != MODE_CELT_ONLY && !celt_accum) ? IMAX(F10, frame_size)*st->channels : ALLOC_NONE;
+   pcm_silk_size = (mode != MODE_CELT_ONLY && !celt_accum) ? IMAX(F10, frame_size)*OPUS_API_CHANNELS(st->channels) : ALLOC_NONE;
    ALLOC(pcm_silk, pcm_silk_size, opus_int16);
 
    /* SILK processing */
@@ -391,7 +406,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
          silk_ResetDecoder( silk_dec );
 
       /* The SILK PLC cannot produce frames of less than 10 ms */
-      st->DecControl.payloadSize_ms = IMAX(10, 1000 * audiosize / st->Fs);
+      st->DecControl.payloadSize_ms = IMAX(10, 1000 * audiosize / OPUS_API_FS(st->Fs));
 
       if (data != NULL)
       {
@@ -438,14 +453,14 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
            if (lost_flag) {
               /* PLC failure should not be fatal */
               silk_frame_size = frame_size;
-              for (i=0;i<frame_size*st->channels;i++)
+              for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
                  pcm_ptr[i] = 0;
            } else {
              RESTORE_STACK;
              return OPUS_INTERNAL_ERROR;
            }
         }
-        pcm_ptr += silk_frame_size * st->channels;
+        pcm_ptr += silk_frame_size * OPUS_API_CHANNELS(st->channels);
         decoded_samples += silk_frame_size;
       } while( decoded_samples < frame_size );
    }
@@ -526,7 +541,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
    MUST_SUCCEED(celt_decoder_ctl(celt_dec, CELT_SET_CHANNELS(st->stream_channels)));
 
    /* Only allocation memory for redundancy if/when needed */
-   redundant_audio_size = redundancy ? F5*st->channels : ALLOC_NONE;
+   redundant_audio_size = redundancy ? F5*OPUS_API_CHANNELS(st->channels) : ALLOC_NONE;
    ALLOC(redundant_audio, redundant_audio_size, opus_val16);
 
    /* 5 ms redundant frame for CELT->SILK*/
@@ -563,7 +578,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
       unsigned char silence[2] = {0xFF, 0xFF};
       if (!celt_accum)
       {
-         for (i=0;i<frame_size*st->channels;i++)
+         for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
             pcm[i] = 0;
       }
       /* For hybrid -> SILK transitions, we let the CELT MDCT
@@ -578,10 +593,10 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
    if (mode != MODE_CELT_ONLY && !celt_accum)
    {
 #ifdef FIXED_POINT
-      for (i=0;i<frame_size*st->channels;i++)
+      for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
          pcm[i] = SAT16(ADD32(pcm[i], pcm_silk[i]));
 #else
-      for (i=0;i<frame_size*st->channels;i++)
+      for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
          pcm[i] = pcm[i] + (opus_val16)((1.f/32768.f)*pcm_silk[i]);
 #endif
    }
@@ -600,31 +615,31 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
 
       celt_decode_with_ec(celt_dec, data+len, redundancy_bytes, redundant_audio, F5, NULL, 0);
       MUST_SUCCEED(celt_decoder_ctl(celt_dec, OPUS_GET_FINAL_RANGE(&redundant_rng)));
-      smooth_fade(pcm+st->channels*(frame_size-F2_5), redundant_audio+st->channels*F2_5,
-                  pcm+st->channels*(frame_size-F2_5), F2_5, st->channels, window, st->Fs);
+      smooth_fade(pcm+OPUS_API_CHANNELS(st->channels)*(frame_size-F2_5), redundant_audio+OPUS_API_CHANNELS(st->channels)*F2_5,
+                  pcm+OPUS_API_CHANNELS(st->channels)*(frame_size-F2_5), F2_5, OPUS_API_CHANNELS(st->channels), window, OPUS_API_FS(st->Fs));
    }
    /* 5ms redundant frame for CELT->SILK; ignore if the previous frame did not
       use CELT (the first redundancy frame in a transition from SILK may have
       been lost) */
    if (redundancy && celt_to_silk && (st->prev_mode != MODE_SILK_ONLY || st->prev_redundancy))
    {
-      for (c=0;c<st->channels;c++)
+      for (c=0;c<OPUS_API_CHANNELS(st->channels);c++)
       {
          for (i=0;i<F2_5;i++)
-            pcm[st->channels*i+c] = redundant_audio[st->channels*i+c];
+            pcm[OPUS_API_CHANNELS(st->channels)*i+c] = redundant_audio[OPUS_API_CHANNELS(st->channels)*i+c];
       }
-      smooth_fade(redundant_audio+st->channels*F2_5, pcm+st->channels*F2_5,
-                  pcm+st->channels*F2_5, F2_5, st->channels, window, st->Fs);
+      smooth_fade(redundant_audio+OPUS_API_CHANNELS(st->channels)*F2_5, pcm+OPUS_API_CHANNELS(st->channels)*F2_5,
+                  pcm+OPUS_API_CHANNELS(st->channels)*F2_5, F2_5, OPUS_API_CHANNELS(st->channels), window, OPUS_API_FS(st->Fs));
    }
    if (transition)
    {
       if (audiosize >= F5)
       {
-         for (i=0;i<st->channels*F2_5;i++)
+         for (i=0;i<OPUS_API_CHANNELS(st->channels)*F2_5;i++)
             pcm[i] = pcm_transition[i];
-         smooth_fade(pcm_transition+st->channels*F2_5, pcm+st->channels*F2_5,
-                     pcm+st->channels*F2_5, F2_5,
-                     st->channels, window, st->Fs);
+         smooth_fade(pcm_transition+OPUS_API_CHANNELS(st->channels)*F2_5, pcm+OPUS_API_CHANNELS(st->channels)*F2_5,
+                     pcm+OPUS_API_CHANNELS(st->channels)*F2_5, F2_5,
+                     OPUS_API_CHANNELS(st->channels), window, OPUS_API_FS(st->Fs));
       } else {
          /* Not enough time to do a clean transition, but we do it anyway
             This will not preserve amplitude perfectly and may introduce
@@ -633,7 +648,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
             transition it pretty silly in the first place */
          smooth_fade(pcm_transition, pcm,
                      pcm, F2_5,
-                     st->channels, window, st->Fs);
+                     OPUS_API_CHANNELS(st->channels), window, OPUS_API_FS(st->Fs));
       }
    }
 
@@ -641,7 +656,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
    {
       opus_val32 gain;
       gain = celt_exp2(MULT16_16_P15(QCONST16(6.48814081e-4f, 25), st->decode_gain));
-      for (i=0;i<frame_size*st->channels;i++)
+      for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
       {
          opus_val32 x;
          x = MULT16_32_P16(pcm[i],gain);
@@ -659,7 +674,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
 
    if (celt_ret>=0)
    {
-      if (OPUS_CHECK_ARRAY(pcm, audiosize*st->channels))
+      if (OPUS_CHECK_ARRAY(pcm, audiosize*OPUS_API_CHANNELS(st->channels)))
          OPUS_PRINT_INT(audiosize);
    }
 
@@ -668,7 +683,7 @@ static int opus_decode_frame(OpusDecoder *st, const unsigned char *data,
 
 }
 
-int opus_decode_native(OpusDecoder *st, const unsigned char *data,
+static int opus_decode_native_impl(OpusDecoder *st, const unsigned char *data,
       opus_int32 len, opus_val16 *pcm, int frame_size, int decode_fec,
       int self_delimited, opus_int32 *packet_offset, int soft_clip, const OpusDRED *dred, opus_int32 dred_offset)
 {
@@ -682,7 +697,7 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
    if (decode_fec<0 || decode_fec>1)
       return OPUS_BAD_ARG;
    /* For FEC/PLC, frame_size has to be to have a multiple of 2.5 ms */
-   if ((decode_fec || len==0 || data==NULL) && frame_size%(st->Fs/400)!=0)
+   if ((decode_fec || len==0 || data==NULL) && frame_size%(OPUS_API_FS(st->Fs)/400)!=0)
       return OPUS_BAD_ARG;
 #ifdef ENABLE_DRED
    if (dred != NULL && dred->process_stage == 2) {
@@ -691,7 +706,7 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
       int needed_feature_frames;
       int init_frames;
       lpcnet_plc_fec_clear(&st->lpcnet);
-      F10 = st->Fs/100;
+      F10 = OPUS_API_FS(st->Fs)/100;
       /* if blend==0, the last PLC call was "update" and we need to feed two extra 10-ms frames. */
       init_frames = (st->lpcnet.blend == 0) ? 2 : 0;
       features_per_frame = IMAX(1, frame_size/F10);
@@ -718,13 +733,13 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
       int pcm_count=0;
       do {
          int ret;
-         ret = opus_decode_frame(st, NULL, 0, pcm+pcm_count*st->channels, frame_size-pcm_count, 0);
+         ret = opus_decode_frame(st, NULL, 0, pcm+pcm_count*OPUS_API_CHANNELS(st->channels), frame_size-pcm_count, 0);
          if (ret<0)
             return ret;
          pcm_count += ret;
       } while (pcm_count < frame_size);
       celt_assert(pcm_count == frame_size);
-      if (OPUS_CHECK_ARRAY(pcm, pcm_count*st->channels))
+      if (OPUS_CHECK_ARRAY(pcm, pcm_count*OPUS_API_CHANNELS(st->channels)))
          OPUS_PRINT_INT(pcm_count);
       st->last_packet_duration = pcm_count;
       return pcm_count;
@@ -733,7 +748,7 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
 
    packet_mode = opus_packet_get_mode(data);
    packet_bandwidth = opus_packet_get_bandwidth(data);
-   packet_frame_size = opus_packet_get_samples_per_frame(data, st->Fs);
+   packet_frame_size = opus_packet_get_samples_per_frame(data, OPUS_API_FS(st->Fs));
    packet_stream_channels = opus_packet_get_nb_channels(data);
 
    count = opus_packet_parse_impl(data, len, self_delimited, &toc, NULL,
@@ -767,12 +782,12 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
       st->bandwidth = packet_bandwidth;
       st->frame_size = packet_frame_size;
       st->stream_channels = packet_stream_channels;
-      ret = opus_decode_frame(st, data, size[0], pcm+st->channels*(frame_size-packet_frame_size),
+      ret = opus_decode_frame(st, data, size[0], pcm+OPUS_API_CHANNELS(st->channels)*(frame_size-packet_frame_size),
             packet_frame_size, 1);
       if (ret<0)
          return ret;
       else {
-         if (OPUS_CHECK_ARRAY(pcm, frame_size*st->channels))
+         if (OPUS_CHECK_ARRAY(pcm, frame_size*OPUS_API_CHANNELS(st->channels)))
             OPUS_PRINT_INT(frame_size);
          st->last_packet_duration = frame_size;
          return frame_size;
@@ -792,7 +807,7 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
    for (i=0;i<count;i++)
    {
       int ret;
-      ret = opus_decode_frame(st, data, size[i], pcm+nb_samples*st->channels, frame_size-nb_samples, 0);
+      ret = opus_decode_frame(st, data, size[i], pcm+nb_samples*OPUS_API_CHANNELS(st->channels), frame_size-nb_samples, 0);
       if (ret<0)
          return ret;
       celt_assert(ret==packet_frame_size);
@@ -800,17 +815,35 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data,
       nb_samples += ret;
    }
    st->last_packet_duration = nb_samples;
-   if (OPUS_CHECK_ARRAY(pcm, nb_samples*st->channels))
+   if (OPUS_CHECK_ARRAY(pcm, nb_samples*OPUS_API_CHANNELS(st->channels)))
       OPUS_PRINT_INT(nb_samples);
 #ifndef FIXED_POINT
    if (soft_clip)
-      opus_pcm_soft_clip(pcm, nb_samples, st->channels, st->softclip_mem);
+      opus_pcm_soft_clip(pcm, nb_samples, OPUS_API_CHANNELS(st->channels), st->softclip_mem);
    else
       st->softclip_mem[0]=st->softclip_mem[1]=0;
 #endif
    return nb_samples;
 }
 
+int opus_decode_native(OpusDecoder *st, const unsigned char *data,
+      opus_int32 len, opus_val16 *pcm, int frame_size, int decode_fec,
+      int self_delimited, opus_int32 *packet_offset, int soft_clip, const OpusDRED *dred, opus_int32 dred_offset)
+{
+#ifdef OPUS_SCRATCH_ARENA
+   OpusScratch scratch, *prev;
+   int ret;
+   prev = opus_scratch_enter(&scratch, (char*)st+st->scratch_offset, st->scratch_size, st->scratch_peak);
+   ret = opus_decode_native_impl(st, data, len, pcm, frame_size, decode_fec, self_delimited,
+         packet_offset, soft_clip, dred, dred_offset);
+   st->scratch_peak = opus_scratch_leave(prev);
+   return ret;
+#else
+   return opus_decode_native_impl(st, data, len, pcm, frame_size, decode_fec, self_delimited,
+         packet_offset, soft_clip, dred, dred_offset);
+#endif
+}
+
 #ifdef FIXED_POINT
 
 int opus_decode(OpusDecoder *st, const unsigned char *data,
@@ -844,12 +877,12 @@ int opus_decode_float(OpusDecoder *st, const unsigned char *data,
          return OPUS_INVALID_PACKET;
    }
    celt_assert(st->channels == 1 || st->channels == 2);
-   ALLOC(out, frame_size*st->channels, opus_int16);
+   ALLOC(out, frame_size*OPUS_API_CHANNELS(st->channels), opus_int16);
 
    ret = opus_decode_native(st, data, len, out, frame_size, decode_fec, 0, NULL, 0, NULL, 0);
    if (ret > 0)
    {
-      for (i=0;i<ret*st->channels;i++)
+      for (i=0;i<ret*OPUS_API_CHANNELS(st->channels);i++)
          pcm[i] = (1.f/32768.f)*(out[i]);
    }
    RESTORE_STACK;
@@ -882,12 +915,12 @@ int opus_decode(OpusDecoder *st, const unsigned char *data,
          return OPUS_INVALID_PACKET;
    }
    celt_assert(st->channels == 1 || st->channels == 2);
-   ALLOC(out, frame_size*st->channels, float);
+   ALLOC(out, frame_size*OPUS_API_CHANNELS(st->channels), float);
 
    ret = opus_decode_native(st, data, len, out, frame_size, decode_fec, 0, NULL, 1, NULL, 0);
    if (ret > 0)
    {
-      for (i=0;i<ret*st->channels;i++)
+      for (i=0;i<ret*OPUS_API_CHANNELS(st->channels);i++)
          pcm[i] = FLOAT2INT16(out[i]);
    }
    RESTORE_STACK;
@@ -960,6 +993,20 @@ int opus_decoder_ctl(OpusDecoder *st, int request, ...)
       *value = st->rangeFinal;
    }
    break;
+   case OPUS_GET_SCRATCH_PEAK_REQUEST:
+   {
+      opus_int32 *value = va_arg(ap, opus_int32*);
+      if (!value)
+      {
+         goto bad_arg;
+      }
+#ifdef OPUS_SCRATCH_ARENA
+      *value = st->scratch_peak;
+#else
+      ret = OPUS_UNIMPLEMENTED;
+#endif
+   }
+   break;
    case OPUS_RESET_STATE:
    {
       OPUS_CLEAR((char*)&st->OPUS_DECODER_RESET_START,
@@ -968,8 +1015,8 @@ int opus_decoder_ctl(OpusDecoder *st, int request, ...)
 
       celt_decoder_ctl(celt_dec, OPUS_RESET_STATE);
       silk_ResetDecoder( silk_dec );
-      st->stream_channels = st->channels;
-      st->frame_size = st->Fs/400;
+      st->stream_channels = OPUS_API_CHANNELS(st->channels);
+      st->frame_size = OPUS_API_FS(st->Fs)/400;
 #ifdef ENABLE_DEEP_PLC
       lpcnet_plc_reset( &st->lpcnet );
 #endif
@@ -982,7 +1029,7 @@ int opus_decoder_ctl(OpusDecoder *st, int request, ...)
       {
          goto bad_arg;
       }
-      *value = st->Fs;
+      *value = OPUS_API_FS(st->Fs);
    }
    break;
    case OPUS_GET_PITCH_REQUEST:
@@ -1472,12 +1519,12 @@ int opus_decoder_dred_decode(OpusDecoder *st, const OpusDRED *dred, opus_int32 d
    }
 
    celt_assert(st->channels == 1 || st->channels == 2);
-   ALLOC(out, frame_size*st->channels, float);
+   ALLOC(out, frame_size*OPUS_API_CHANNELS(st->channels), float);
 
    ret = opus_decode_native(st, NULL, 0, out, frame_size, 0, 0, NULL, 1, dred, dred_offset);
    if (ret > 0)
    {
-      for (i=0;i<ret*st->channels;i++)
+      for (i=0;i<ret*OPUS_API_CHANNELS(st->channels);i++)
          pcm[i] = FLOAT2INT16(out[i]);
    }
    RESTORE_STACK;
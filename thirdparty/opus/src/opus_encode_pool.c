@@ -0,0 +1,217 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "opus_multistream.h"
+#include "opus_private.h"
+#include "os_support.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#define OPUS_ENCODE_POOL_MAX_THREADS 254
+
+/* Everything below the lock belongs to whoever holds it. A job is handed out
+   one task index at a time, the caller of opus_encode_pool_run() takes its
+   share like any worker and sleeps once none are left to start. */
+struct OpusEncodePool {
+   int threads;
+#ifdef _WIN32
+   SRWLOCK lock;
+   CONDITION_VARIABLE work;
+   CONDITION_VARIABLE done;
+   HANDLE handles[OPUS_ENCODE_POOL_MAX_THREADS];
+#else
+   pthread_mutex_t lock;
+   pthread_cond_t work;
+   pthread_cond_t done;
+   pthread_t handles[OPUS_ENCODE_POOL_MAX_THREADS];
+#endif
+   opus_pool_task task;
+   void *arg;
+   int count;
+   int next;
+   int pending;
+   int stop;
+};
+
+#ifdef _WIN32
+static void pool_lock(OpusEncodePool *pool) { AcquireSRWLockExclusive(&pool->lock); }
+static void pool_unlock(OpusEncodePool *pool) { ReleaseSRWLockExclusive(&pool->lock); }
+static void pool_wait(OpusEncodePool *pool, CONDITION_VARIABLE *cond)
+{
+   SleepConditionVariableSRW(cond, &pool->lock, INFINITE, 0);
+}
+static void pool_wake_all(CONDITION_VARIABLE *cond) { WakeAllConditionVariable(cond); }
+static void pool_wake(CONDITION_VARIABLE *cond) { WakeConditionVariable(cond); }
+#else
+static void pool_lock(OpusEncodePool *pool) { pthread_mutex_lock(&pool->lock); }
+static void pool_unlock(OpusEncodePool *pool) { pthread_mutex_unlock(&pool->lock); }
+static void pool_wait(OpusEncodePool *pool, pthread_cond_t *cond) { pthread_cond_wait(cond, &pool->lock); }
+static void pool_wake_all(pthread_cond_t *cond) { pthread_cond_broadcast(cond); }
+static void pool_wake(pthread_cond_t *cond) { pthread_cond_signal(cond); }
+#endif
+
+/* Runs tasks of the current job until none are left to start, with the lock
+   held on entry and on return */
+static void pool_work(OpusEncodePool *pool)
+{
+   while (pool->next < pool->count)
+   {
+      int i = pool->next++;
+      pool_unlock(pool);
+      pool->task(pool->arg, i);
+      pool_lock(pool);
+      if (--pool->pending == 0)
+         pool_wake(&pool->done);
+   }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI pool_main(LPVOID arg)
+#else
+static void *pool_main(void *arg)
+#endif
+{
+   OpusEncodePool *pool = (OpusEncodePool *)arg;
+   pool_lock(pool);
+   while (!pool->stop)
+   {
+      pool_work(pool);
+      if (!pool->stop)
+         pool_wait(pool, &pool->work);
+   }
+   pool_unlock(pool);
+#ifdef _WIN32
+   return 0;
+#else
+   return NULL;
+#endif
+}
+
+static void pool_join(OpusEncodePool *pool, int started)
+{
+   int i;
+   pool_lock(pool);
+   pool->stop = 1;
+   pool_wake_all(&pool->work);
+   pool_unlock(pool);
+   for (i=0;i<started;i++)
+   {
+#ifdef _WIN32
+      WaitForSingleObject(pool->handles[i], INFINITE);
+      CloseHandle(pool->handles[i]);
+#else
+      pthread_join(pool->handles[i], NULL);
+#endif
+   }
+#ifndef _WIN32
+   pthread_cond_destroy(&pool->done);
+   pthread_cond_destroy(&pool->work);
+   pthread_mutex_destroy(&pool->lock);
+#endif
+}
+
+OpusEncodePool *opus_encode_pool_create(int threads, int *error)
+{
+   OpusEncodePool *pool;
+   int i;
+   if (threads < 1 || threads > OPUS_ENCODE_POOL_MAX_THREADS)
+   {
+      if (error)
+         *error = OPUS_BAD_ARG;
+      return NULL;
+   }
+   pool = (OpusEncodePool *)opus_alloc(sizeof(OpusEncodePool));
+   if (pool == NULL)
+   {
+      if (error)
+         *error = OPUS_ALLOC_FAIL;
+      return NULL;
+   }
+   OPUS_CLEAR(pool, 1);
+   pool->threads = threads;
+#ifdef _WIN32
+   InitializeSRWLock(&pool->lock);
+   InitializeConditionVariable(&pool->work);
+   InitializeConditionVariable(&pool->done);
+#else
+   pthread_mutex_init(&pool->lock, NULL);
+   pthread_cond_init(&pool->work, NULL);
+   pthread_cond_init(&pool->done, NULL);
+#endif
+   for (i=0;i<threads;i++)
+   {
+#ifdef _WIN32
+      pool->handles[i] = CreateThread(NULL, 0, pool_main, pool, 0, NULL);
+      if (pool->handles[i] == NULL)
+#else
+      if (pthread_create(&pool->handles[i], NULL, pool_main, pool) != 0)
+#endif
+      {
+         pool_join(pool, i);
+         opus_free(pool);
+         if (error)
+            *error = OPUS_INTERNAL_ERROR;
+         return NULL;
+      }
+   }
+   if (error)
+      *error = OPUS_OK;
+   return pool;
+}
+
+void opus_encode_pool_destroy(OpusEncodePool *pool)
+{
+   pool_join(pool, pool->threads);
+   opus_free(pool);
+}
+
+int opus_encode_pool_threads(const OpusEncodePool *pool)
+{
+   return pool->threads;
+}
+
+void opus_encode_pool_run(OpusEncodePool *pool, opus_pool_task task, void *arg, int count)
+{
+   pool_lock(pool);
+   pool->task = task;
+   pool->arg = arg;
+   pool->count = count;
+   pool->next = 0;
+   pool->pending = count;
+   pool_wake_all(&pool->work);
+   pool_work(pool);
+   while (pool->pending > 0)
+      pool_wait(pool, &pool->done);
+   pool_unlock(pool);
+}
@@ -58,6 +58,13 @@
 #ifdef ENABLE_OSCE_TRAINING_DATA
 #include <stdio.h>
 #endif
+#ifndef DISABLE_FLOAT_API
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif
 
 #define MAX_ENCODER_BUFFER 480
 
@@ -101,6 +108,13 @@ struct OpusEncoder {
     int          fec_config;
 #ifndef DISABLE_FLOAT_API
     TonalityAnalysisState analysis;
+    /* Set while a helper thread runs the analysis one frame ahead */
+    OpusAnalysisAhead *analysis_ahead;
+#endif
+#ifdef OPUS_SCRATCH_ARENA
+    int          scratch_offset;
+    opus_int32   scratch_size;
+    opus_int32   scratch_peak;
 #endif
 
 #define OPUS_ENCODER_RESET_START stream_channels
@@ -189,14 +203,19 @@ int opus_encoder_get_size(int channels)
 {
     int silkEncSizeBytes, celtEncSizeBytes;
     int ret;
-    if (channels<1 || channels > 2)
+    int size;
+    if (channels<1 || channels > 2 || !OPUS_CHANNELS_SUPPORTED(channels))
         return 0;
     ret = silk_Get_Encoder_Size( &silkEncSizeBytes );
     if (ret)
         return 0;
     silkEncSizeBytes = align(silkEncSizeBytes);
     celtEncSizeBytes = celt_encoder_get_size(channels);
-    return align(sizeof(OpusEncoder))+silkEncSizeBytes+celtEncSizeBytes;
+    size = align(sizeof(OpusEncoder))+silkEncSizeBytes+celtEncSizeBytes;
+#ifdef OPUS_SCRATCH_ARENA
+    size += OPUS_SCRATCH_ALLOC_SIZE(OPUS_ENCODER_SCRATCH_SIZE(channels));
+#endif
+    return size;
 }
 
 int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int application)
@@ -208,7 +227,8 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
 
    if((Fs!=48000&&Fs!=24000&&Fs!=16000&&Fs!=12000&&Fs!=8000)||(channels!=1&&channels!=2)||
         (application != OPUS_APPLICATION_VOIP && application != OPUS_APPLICATION_AUDIO
-        && application != OPUS_APPLICATION_RESTRICTED_LOWDELAY))
+        && application != OPUS_APPLICATION_RESTRICTED_LOWDELAY)
+        || !OPUS_FS_SUPPORTED(Fs) || !OPUS_CHANNELS_SUPPORTED(channels))
         return OPUS_BAD_ARG;
 
     OPUS_CLEAR((char*)st, opus_encoder_get_size(channels));
@@ -219,6 +239,10 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
     silkEncSizeBytes = align(silkEncSizeBytes);
     st->silk_enc_offset = align(sizeof(OpusEncoder));
     st->celt_enc_offset = st->silk_enc_offset+silkEncSizeBytes;
+#ifdef OPUS_SCRATCH_ARENA
+    st->scratch_offset = st->celt_enc_offset+celt_encoder_get_size(channels);
+    st->scratch_size = OPUS_ENCODER_SCRATCH_SIZE(channels);
+#endif
     silk_enc = (char*)st+st->silk_enc_offset;
     celt_enc = (CELTEncoder*)((char*)st+st->celt_enc_offset);
 
@@ -234,7 +258,7 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
     /* default SILK parameters */
     st->silk_mode.nChannelsAPI              = channels;
     st->silk_mode.nChannelsInternal         = channels;
-    st->silk_mode.API_sampleRate            = st->Fs;
+    st->silk_mode.API_sampleRate            = OPUS_API_FS(st->Fs);
     st->silk_mode.maxInternalSampleRate     = 16000;
     st->silk_mode.minInternalSampleRate     = 8000;
     st->silk_mode.desiredInternalSampleRate = 16000;
@@ -273,13 +297,13 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
     st->force_channels = OPUS_AUTO;
     st->user_forced_mode = OPUS_AUTO;
     st->voice_ratio = -1;
-    st->encoder_buffer = st->Fs/100;
+    st->encoder_buffer = OPUS_API_FS(st->Fs)/100;
     st->lsb_depth = 24;
     st->variable_duration = OPUS_FRAMESIZE_ARG;
 
     /* Delay compensation of 4 ms (2.5 ms for SILK's extra look-ahead
        + 1.5 ms for SILK resamplers and stereo prediction) */
-    st->delay_compensation = st->Fs/250;
+    st->delay_compensation = OPUS_API_FS(st->Fs)/250;
 
     st->hybrid_stereo_width_Q14 = 1 << 14;
     st->prev_HB_gain = Q15ONE;
@@ -289,7 +313,7 @@ int opus_encoder_init(OpusEncoder* st, opus_int32 Fs, int channels, int applicat
     st->bandwidth = OPUS_BANDWIDTH_FULLBAND;
 
 #ifndef DISABLE_FLOAT_API
-    tonality_analysis_init(&st->analysis, st->Fs);
+    tonality_analysis_init(&st->analysis, OPUS_API_FS(st->Fs));
     st->analysis.application = st->application;
 #endif
 
@@ -611,20 +635,20 @@ static opus_int32 compute_dred_bitrate(OpusEncoder *st, opus_int32 bitrate_bps,
       bitrate_offset = 12000;
    }
    /* Account for the fact that longer packets require less redundancy. */
-   dred_frac = dred_frac/(dred_frac + (1-dred_frac)*(frame_size*50.f)/st->Fs);
+   dred_frac = dred_frac/(dred_frac + (1-dred_frac)*(frame_size*50.f)/OPUS_API_FS(st->Fs));
    /* Approximate fit based on a few experiments. Could probably be improved. */
    q0 = IMIN(15, IMAX(4, 51 - 3*EC_ILOG(IMAX(1, bitrate_bps-bitrate_offset))));
    dQ = bitrate_bps-bitrate_offset > 36000 ? 3 : 5;
    qmax = 15;
    target_dred_bitrate = IMAX(0, (int)(dred_frac*(bitrate_bps-bitrate_offset)));
    if (st->dred_duration > 0) {
-      opus_int32 target_bits = target_dred_bitrate*frame_size/st->Fs;
+      opus_int32 target_bits = target_dred_bitrate*frame_size/OPUS_API_FS(st->Fs);
       max_dred_bits = estimate_dred_bitrate(q0, dQ, qmax, st->dred_duration, target_bits, &target_chunks);
    } else {
       max_dred_bits = 0;
       target_chunks=0;
    }
-   dred_bitrate = IMIN(target_dred_bitrate, max_dred_bits*st->Fs/frame_size);
+   dred_bitrate = IMIN(target_dred_bitrate, max_dred_bits*OPUS_API_FS(st->Fs)/frame_size);
    /* If we can't afford enough bits, don't bother with DRED at all. */
    if (target_chunks < 2)
       dred_bitrate = 0;
@@ -638,11 +662,11 @@ static opus_int32 compute_dred_bitrate(OpusEncoder *st, opus_int32 bitrate_bps,
 
 static opus_int32 user_bitrate_to_bitrate(OpusEncoder *st, int frame_size, int max_data_bytes)
 {
-  if(!frame_size)frame_size=st->Fs/400;
+  if(!frame_size)frame_size=OPUS_API_FS(st->Fs)/400;
   if (st->user_bitrate_bps==OPUS_AUTO)
-    return 60*st->Fs/frame_size + st->Fs*st->channels;
+    return 60*OPUS_API_FS(st->Fs)/frame_size + OPUS_API_FS(st->Fs)*OPUS_API_CHANNELS(st->channels);
   else if (st->user_bitrate_bps==OPUS_BITRATE_MAX)
-    return max_data_bytes*8*st->Fs/frame_size;
+    return max_data_bytes*8*OPUS_API_FS(st->Fs)/frame_size;
   else
     return st->user_bitrate_bps;
 }
@@ -726,6 +750,235 @@ opus_int32 frame_size_select(opus_int32 frame_size, int variable_duration, opus_
    return new_size;
 }
 
+#ifndef DISABLE_FLOAT_API
+/* The helper thread and the encoder hand the lookahead analysis state back
+   and forth through two frame counters. The helper analyzes frame n once the
+   encoder has taken frame n-1 (consumed==n), the encoder takes frame n once
+   the helper is done with it (submitted==n+1). Everything else in the struct
+   belongs to whichever side the counters say it does. A side that finds the
+   other behind spins for a short while, then sleeps on changed, which every
+   counter update is signaled on under lock. */
+struct OpusAnalysisAhead {
+   OpusEncoder *st;
+   const CELTMode *celt_mode;
+   int channels;
+   opus_int32 Fs;
+#ifdef _WIN32
+   SRWLOCK lock;
+   CONDITION_VARIABLE changed;
+#else
+   pthread_mutex_t lock;
+   pthread_cond_t changed;
+#endif
+   /* Written by the helper before it bumps submitted */
+   opus_uint32 submitted;
+   int skipped;
+   /* Written by the encoder before it bumps consumed */
+   opus_uint32 consumed;
+   int enabled;
+   int lsb_depth;
+   int variable_duration;
+   /* Encoder only: OPUS_RESET_STATE was called since the last frame */
+   int stale;
+   TonalityAnalysisState analysis;
+};
+
+#define ANALYSIS_AHEAD_SPINS 1024
+
+#ifdef _MSC_VER
+static opus_uint32 ahead_load(const opus_uint32 *counter)
+{
+   return (opus_uint32)InterlockedCompareExchange((volatile LONG *)counter, 0, 0);
+}
+static void ahead_store(opus_uint32 *counter, opus_uint32 value)
+{
+   InterlockedExchange((volatile LONG *)counter, (LONG)value);
+}
+#else
+static opus_uint32 ahead_load(const opus_uint32 *counter) { return __atomic_load_n(counter, __ATOMIC_ACQUIRE); }
+static void ahead_store(opus_uint32 *counter, opus_uint32 value) { __atomic_store_n(counter, value, __ATOMIC_RELEASE); }
+#endif
+
+#ifdef _WIN32
+static void ahead_pause(void) { YieldProcessor(); }
+static void ahead_lock(OpusAnalysisAhead *ahead) { AcquireSRWLockExclusive(&ahead->lock); }
+static void ahead_unlock(OpusAnalysisAhead *ahead) { ReleaseSRWLockExclusive(&ahead->lock); }
+static void ahead_sleep(OpusAnalysisAhead *ahead) { SleepConditionVariableSRW(&ahead->changed, &ahead->lock, INFINITE, 0); }
+static void ahead_wake(OpusAnalysisAhead *ahead) { WakeAllConditionVariable(&ahead->changed); }
+#else
+static void ahead_pause(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+   __builtin_ia32_pause();
+#endif
+}
+static void ahead_lock(OpusAnalysisAhead *ahead) { pthread_mutex_lock(&ahead->lock); }
+static void ahead_unlock(OpusAnalysisAhead *ahead) { pthread_mutex_unlock(&ahead->lock); }
+static void ahead_sleep(OpusAnalysisAhead *ahead) { pthread_cond_wait(&ahead->changed, &ahead->lock); }
+static void ahead_wake(OpusAnalysisAhead *ahead) { pthread_cond_broadcast(&ahead->changed); }
+#endif
+
+/* The other side is normally a frame's analysis away at most, so spin first
+   and only sleep when it is later than that (or never comes) */
+static void analysis_ahead_wait(OpusAnalysisAhead *ahead, const opus_uint32 *counter, opus_uint32 value)
+{
+   int spins;
+   for (spins=0;spins<ANALYSIS_AHEAD_SPINS;spins++)
+   {
+      if (ahead_load(counter) == value)
+         return;
+      ahead_pause();
+   }
+   ahead_lock(ahead);
+   while (ahead_load(counter) != value)
+      ahead_sleep(ahead);
+   ahead_unlock(ahead);
+}
+
+/* Taking the lock orders the update after any waiter's last check */
+static void analysis_ahead_set(OpusAnalysisAhead *ahead, opus_uint32 *counter, opus_uint32 value)
+{
+   ahead_store(counter, value);
+   ahead_lock(ahead);
+   ahead_wake(ahead);
+   ahead_unlock(ahead);
+}
+
+OpusAnalysisAhead *opus_analysis_ahead_create(OpusEncoder *st, int *error)
+{
+   OpusAnalysisAhead *ahead;
+   CELTEncoder *celt_enc;
+   if (st->analysis_ahead != NULL)
+   {
+      if (error)
+         *error = OPUS_BAD_ARG;
+      return NULL;
+   }
+   ahead = (OpusAnalysisAhead *)opus_alloc(sizeof(OpusAnalysisAhead));
+   if (ahead == NULL)
+   {
+      if (error)
+         *error = OPUS_ALLOC_FAIL;
+      return NULL;
+   }
+   OPUS_CLEAR(ahead, 1);
+#ifdef _WIN32
+   InitializeSRWLock(&ahead->lock);
+   InitializeConditionVariable(&ahead->changed);
+#else
+   pthread_mutex_init(&ahead->lock, NULL);
+   pthread_cond_init(&ahead->changed, NULL);
+#endif
+   celt_enc = (CELTEncoder*)((char*)st+st->celt_enc_offset);
+   celt_encoder_ctl(celt_enc, CELT_GET_MODE(&ahead->celt_mode));
+   ahead->st = st;
+   ahead->channels = OPUS_API_CHANNELS(st->channels);
+   ahead->Fs = OPUS_API_FS(st->Fs);
+   ahead->enabled = 1;
+#ifdef FIXED_POINT
+   ahead->lsb_depth = IMIN(16, st->lsb_depth);
+#else
+   ahead->lsb_depth = IMIN(24, st->lsb_depth);
+#endif
+   ahead->variable_duration = st->variable_duration;
+   OPUS_COPY(&ahead->analysis, &st->analysis, 1);
+   st->analysis_ahead = ahead;
+   if (error)
+      *error = OPUS_OK;
+   return ahead;
+}
+
+int opus_analysis_ahead_float(OpusAnalysisAhead *ahead, const float *pcm, int analysis_frame_size)
+{
+   int frame_size;
+   opus_uint32 n;
+   n = ahead->submitted;
+   analysis_ahead_wait(ahead, &ahead->consumed, n);
+   frame_size = frame_size_select(analysis_frame_size, ahead->variable_duration, ahead->Fs);
+   if (frame_size <= 0)
+      return OPUS_BAD_ARG;
+   if (ahead->enabled)
+   {
+      tonality_analysis_feed(&ahead->analysis, ahead->celt_mode, pcm, analysis_frame_size, frame_size,
+            0, -2, ahead->channels, ahead->Fs, ahead->lsb_depth, downmix_float);
+      ahead->skipped = 0;
+   } else {
+      ahead->skipped = 1;
+   }
+   analysis_ahead_set(ahead, &ahead->submitted, n+1);
+   return OPUS_OK;
+}
+
+void opus_analysis_ahead_destroy(OpusAnalysisAhead *ahead)
+{
+   OpusEncoder *st;
+   int read_pos, read_subframe;
+   st = ahead->st;
+   read_pos = st->analysis.read_pos;
+   read_subframe = st->analysis.read_subframe;
+   OPUS_COPY(&st->analysis, &ahead->analysis, 1);
+   st->analysis.read_pos = read_pos;
+   st->analysis.read_subframe = read_subframe;
+   st->analysis_ahead = NULL;
+#ifndef _WIN32
+   pthread_cond_destroy(&ahead->changed);
+   pthread_mutex_destroy(&ahead->lock);
+#endif
+   opus_free(ahead);
+}
+
+/* Encoder side of a frame with the analysis enabled: wait for the helper,
+   then move what it wrote into st->analysis, which the encoder keeps reading
+   (and rewinding) exactly as if it had run the analysis itself. */
+static void analysis_ahead_take(OpusEncoder *st, const void *analysis_pcm, int analysis_frame_size,
+      int frame_size, int lsb_depth, AnalysisInfo *analysis_info)
+{
+   OpusAnalysisAhead *ahead;
+   TonalityAnalysisState *tonal;
+   ahead = st->analysis_ahead;
+   tonal = &ahead->analysis;
+   analysis_ahead_wait(ahead, &ahead->submitted, ahead->consumed+1);
+   if (ahead->stale)
+   {
+      if (tonal->initialized)
+         tonality_analysis_reset(tonal);
+   }
+   /* The helper skipped this frame (the analysis was off for the previous
+      one) or analyzed it against state the caller has since reset */
+   if (ahead->skipped || ahead->stale)
+      tonality_analysis_feed(tonal, ahead->celt_mode, analysis_pcm, analysis_frame_size, frame_size,
+            0, -2, OPUS_API_CHANNELS(st->channels), OPUS_API_FS(st->Fs), lsb_depth, downmix_float);
+   ahead->stale = 0;
+   OPUS_COPY(st->analysis.info, tonal->info, DETECT_SIZE);
+   st->analysis.write_pos = tonal->write_pos;
+   st->analysis.count = tonal->count;
+   st->analysis.initialized = tonal->initialized;
+   tonality_get_info(&st->analysis, analysis_info, frame_size);
+   ahead->enabled = 1;
+   ahead->lsb_depth = lsb_depth;
+   ahead->variable_duration = st->variable_duration;
+   analysis_ahead_set(ahead, &ahead->consumed, ahead->consumed+1);
+}
+
+/* Encoder side of a frame with the analysis disabled: the helper may already
+   have analyzed it, so drop that along with the rest of the state, as the
+   non-pipelined encoder does, and tell the helper to skip the next frame. */
+static void analysis_ahead_skip(OpusEncoder *st)
+{
+   OpusAnalysisAhead *ahead;
+   ahead = st->analysis_ahead;
+   analysis_ahead_wait(ahead, &ahead->submitted, ahead->consumed+1);
+   if (ahead->analysis.initialized)
+      tonality_analysis_reset(&ahead->analysis);
+   if (st->analysis.initialized)
+      tonality_analysis_reset(&st->analysis);
+   ahead->stale = 0;
+   ahead->enabled = 0;
+   ahead->variable_duration = st->variable_duration;
+   analysis_ahead_set(ahead, &ahead->consumed, ahead->consumed+1);
+}
+#endif
+
 opus_val16 compute_stereo_width(const opus_val16 *pcm, int frame_size, opus_int32 Fs, StereoWidthState *mem)
 {
    opus_val32 xx, xy, yy;
@@ -1054,7 +1307,19 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
                 int redundancy, int celt_to_silk, int prefill,
                 opus_int32 equiv_rate, int to_celt);
 
-opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
+#ifndef DISABLE_FLOAT_API
+/* Whether this frame gets the tonality analysis */
+static int analysis_enabled(const OpusEncoder *st)
+{
+#ifdef FIXED_POINT
+   return st->silk_mode.complexity >= 10 && OPUS_API_FS(st->Fs)>=16000;
+#else
+   return st->silk_mode.complexity >= 7 && OPUS_API_FS(st->Fs)>=16000;
+#endif
+}
+#endif
+
+static opus_int32 opus_encode_native_impl(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
                 unsigned char *data, opus_int32 out_data_bytes, int lsb_depth,
                 const void *analysis_pcm, opus_int32 analysis_size, int c1, int c2,
                 int analysis_channels, downmix_func downmix, int float_api)
@@ -1095,9 +1360,26 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
        RESTORE_STACK;
        return OPUS_BAD_ARG;
     }
+#ifdef OPUS_FIXED_FRAME_SIZE
+    /* Past here the compiler knows the frame size too */
+    if (frame_size != OPUS_FIXED_FRAME_SIZE)
+    {
+       RESTORE_STACK;
+       return OPUS_BAD_ARG;
+    }
+#endif
+#ifndef DISABLE_FLOAT_API
+    /* The helper thread only sees the float input of a single encoder */
+    if (st->analysis_ahead != NULL && (downmix != downmix_float || c1 != 0 || c2 != -2
+          || analysis_channels != OPUS_API_CHANNELS(st->channels)))
+    {
+       RESTORE_STACK;
+       return OPUS_BAD_ARG;
+    }
+#endif
 
     /* Cannot encode 100 ms in 1 byte */
-    if (max_data_bytes==1 && st->Fs==(frame_size*10))
+    if (max_data_bytes==1 && OPUS_API_FS(st->Fs)==(frame_size*10))
     {
       RESTORE_STACK;
       return OPUS_BUFFER_TOO_SMALL;
@@ -1111,23 +1393,24 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     celt_encoder_ctl(celt_enc, CELT_GET_MODE(&celt_mode));
 #ifndef DISABLE_FLOAT_API
     analysis_info.valid = 0;
-#ifdef FIXED_POINT
-    if (st->silk_mode.complexity >= 10 && st->Fs>=16000)
-#else
-    if (st->silk_mode.complexity >= 7 && st->Fs>=16000)
-#endif
+    if (analysis_enabled(st))
     {
-       is_silence = is_digital_silence(pcm, frame_size, st->channels, lsb_depth);
+       is_silence = is_digital_silence(pcm, frame_size, OPUS_API_CHANNELS(st->channels), lsb_depth);
        analysis_read_pos_bak = st->analysis.read_pos;
        analysis_read_subframe_bak = st->analysis.read_subframe;
-       run_analysis(&st->analysis, celt_mode, analysis_pcm, analysis_size, frame_size,
-             c1, c2, analysis_channels, st->Fs,
-             lsb_depth, downmix, &analysis_info);
+       if (st->analysis_ahead != NULL)
+          analysis_ahead_take(st, analysis_pcm, analysis_size, frame_size, lsb_depth, &analysis_info);
+       else
+          run_analysis(&st->analysis, celt_mode, analysis_pcm, analysis_size, frame_size,
+                c1, c2, analysis_channels, OPUS_API_FS(st->Fs),
+                lsb_depth, downmix, &analysis_info);
 
        /* Track the peak signal energy */
        if (!is_silence && analysis_info.activity_probability > DTX_ACTIVITY_THRESHOLD)
           st->peak_signal_energy = MAX32(MULT16_32_Q15(QCONST16(0.999f, 15), st->peak_signal_energy),
-                compute_frame_energy(pcm, frame_size, st->channels, st->arch));
+                compute_frame_energy(pcm, frame_size, OPUS_API_CHANNELS(st->channels), st->arch));
+    } else if (st->analysis_ahead != NULL) {
+       analysis_ahead_skip(st);
     } else if (st->analysis.initialized) {
        tonality_analysis_reset(&st->analysis);
     }
@@ -1178,17 +1461,17 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     st->voice_ratio = -1;
 #endif
 
-    if (st->channels==2 && st->force_channels!=1)
-       stereo_width = compute_stereo_width(pcm, frame_size, st->Fs, &st->width_mem);
+    if (OPUS_API_CHANNELS(st->channels)==2 && st->force_channels!=1)
+       stereo_width = compute_stereo_width(pcm, frame_size, OPUS_API_FS(st->Fs), &st->width_mem);
     else
        stereo_width = 0;
     st->bitrate_bps = user_bitrate_to_bitrate(st, frame_size, max_data_bytes);
 
-    frame_rate = st->Fs/frame_size;
+    frame_rate = OPUS_API_FS(st->Fs)/frame_size;
     if (!st->use_vbr)
     {
        /* Multiply by 12 to make sure the division is exact. */
-       int frame_rate12 = 12*st->Fs/frame_size;
+       int frame_rate12 = 12*OPUS_API_FS(st->Fs)/frame_size;
        /* We need to make sure that "int" values always fit in 16 bits. */
        cbr_bytes = IMIN( (12*st->bitrate_bps/8 + frame_rate12/2)/frame_rate12, max_data_bytes);
        st->bitrate_bps = cbr_bytes*(opus_int32)frame_rate12*8/12;
@@ -1246,7 +1529,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
        else if (tocmode==MODE_HYBRID&&bw<=OPUS_BANDWIDTH_SUPERWIDEBAND)
           bw=OPUS_BANDWIDTH_SUPERWIDEBAND;
 
-       data[0] = gen_toc(tocmode, frame_rate, bw, st->stream_channels);
+       data[0] = gen_toc(tocmode, frame_rate, bw, OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
        data[0] |= packet_code;
 
        ret = packet_code <= 1 ? 1 : 2;
@@ -1270,7 +1553,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     max_rate = frame_rate*max_data_bytes*8;
 
     /* Equivalent 20-ms rate for mode/channel/bandwidth decisions */
-    equiv_rate = compute_equiv_rate(st->bitrate_bps, st->channels, st->Fs/frame_size,
+    equiv_rate = compute_equiv_rate(st->bitrate_bps, OPUS_API_CHANNELS(st->channels), OPUS_API_FS(st->Fs)/frame_size,
           st->use_vbr, 0, st->silk_mode.complexity, st->silk_mode.packetLossPercentage);
 
     if (st->signal_type == OPUS_SIGNAL_VOICE)
@@ -1288,7 +1571,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     else
        voice_est = 48;
 
-    if (st->force_channels!=OPUS_AUTO && st->channels == 2)
+    if (st->force_channels!=OPUS_AUTO && OPUS_API_CHANNELS(st->channels) == 2)
     {
         st->stream_channels = st->force_channels;
     } else {
@@ -1296,26 +1579,26 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
         (void)stereo_music_threshold;
         (void)stereo_voice_threshold;
        /* Random mono/stereo decision */
-       if (st->channels == 2 && (rand()&0x1F)==0)
-          st->stream_channels = 3-st->stream_channels;
+       if (OPUS_API_CHANNELS(st->channels) == 2 && (rand()&0x1F)==0)
+          st->stream_channels = 3-OPUS_ENC_STREAM_CHANNELS(st->stream_channels);
 #else
        /* Rate-dependent mono-stereo decision */
-       if (st->channels == 2)
+       if (OPUS_API_CHANNELS(st->channels) == 2)
        {
           opus_int32 stereo_threshold;
           stereo_threshold = stereo_music_threshold + ((voice_est*voice_est*(stereo_voice_threshold-stereo_music_threshold))>>14);
-          if (st->stream_channels == 2)
+          if (OPUS_ENC_STREAM_CHANNELS(st->stream_channels) == 2)
              stereo_threshold -= 1000;
           else
              stereo_threshold += 1000;
           st->stream_channels = (equiv_rate > stereo_threshold) ? 2 : 1;
        } else {
-          st->stream_channels = st->channels;
+          st->stream_channels = OPUS_API_CHANNELS(st->channels);
        }
 #endif
     }
     /* Update equivalent rate for channels decision. */
-    equiv_rate = compute_equiv_rate(st->bitrate_bps, st->stream_channels, st->Fs/frame_size,
+    equiv_rate = compute_equiv_rate(st->bitrate_bps, OPUS_ENC_STREAM_CHANNELS(st->stream_channels), OPUS_API_FS(st->Fs)/frame_size,
           st->use_vbr, 0, st->silk_mode.complexity, st->silk_mode.packetLossPercentage);
 
     /* Allow SILK DTX if DTX is enabled but the generalized DTX cannot be used,
@@ -1383,14 +1666,14 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
 #endif
 
        /* If max_data_bytes represents less than 6 kb/s, switch to CELT-only mode */
-       if (max_data_bytes < (frame_rate > 50 ? 9000 : 6000)*frame_size / (st->Fs * 8))
+       if (max_data_bytes < (frame_rate > 50 ? 9000 : 6000)*frame_size / (OPUS_API_FS(st->Fs) * 8))
           st->mode = MODE_CELT_ONLY;
     } else {
        st->mode = st->user_forced_mode;
     }
 
     /* Override the chosen mode to make sure we meet the requested frame size */
-    if (st->mode != MODE_CELT_ONLY && frame_size < st->Fs/100)
+    if (st->mode != MODE_CELT_ONLY && frame_size < OPUS_API_FS(st->Fs)/100)
        st->mode = MODE_CELT_ONLY;
     if (st->lfe)
        st->mode = MODE_CELT_ONLY;
@@ -1404,7 +1687,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
         if (!celt_to_silk)
         {
             /* Switch to SILK/hybrid if frame size is 10 ms or more*/
-            if (frame_size >= st->Fs/100)
+            if (frame_size >= OPUS_API_FS(st->Fs)/100)
             {
                 st->mode = st->prev_mode;
                 to_celt = 1;
@@ -1416,7 +1699,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
 
     /* When encoding multiframes, we can ask for a switch to CELT only in the last frame. This switch
      * is processed above as the requested mode shouldn't interrupt stereo->mono transition. */
-    if (st->stream_channels == 1 && st->prev_channels ==2 && st->silk_mode.toMono==0
+    if (OPUS_ENC_STREAM_CHANNELS(st->stream_channels) == 1 && st->prev_channels ==2 && st->silk_mode.toMono==0
           && st->mode != MODE_CELT_ONLY && st->prev_mode != MODE_CELT_ONLY)
     {
        /* Delay stereo->mono transition by two frames so that SILK can do a smooth downmix */
@@ -1427,7 +1710,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     }
 
     /* Update equivalent rate with mode decision. */
-    equiv_rate = compute_equiv_rate(st->bitrate_bps, st->stream_channels, st->Fs/frame_size,
+    equiv_rate = compute_equiv_rate(st->bitrate_bps, OPUS_ENC_STREAM_CHANNELS(st->stream_channels), OPUS_API_FS(st->Fs)/frame_size,
           st->use_vbr, st->mode, st->silk_mode.complexity, st->silk_mode.packetLossPercentage);
 
     if (st->mode != MODE_CELT_ONLY && st->prev_mode == MODE_CELT_ONLY)
@@ -1444,7 +1727,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
         opus_int32 bandwidth_thresholds[8];
         int bandwidth = OPUS_BANDWIDTH_FULLBAND;
 
-        if (st->channels==2 && st->force_channels!=1)
+        if (OPUS_API_CHANNELS(st->channels)==2 && st->force_channels!=1)
         {
            voice_bandwidth_thresholds = stereo_voice_bandwidth_thresholds;
            music_bandwidth_thresholds = stereo_music_bandwidth_thresholds;
@@ -1497,13 +1780,13 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
 
     /* Prevents Opus from wasting bits on frequencies that are above
        the Nyquist rate of the input signal */
-    if (st->Fs <= 24000 && st->bandwidth > OPUS_BANDWIDTH_SUPERWIDEBAND)
+    if (OPUS_API_FS(st->Fs) <= 24000 && st->bandwidth > OPUS_BANDWIDTH_SUPERWIDEBAND)
         st->bandwidth = OPUS_BANDWIDTH_SUPERWIDEBAND;
-    if (st->Fs <= 16000 && st->bandwidth > OPUS_BANDWIDTH_WIDEBAND)
+    if (OPUS_API_FS(st->Fs) <= 16000 && st->bandwidth > OPUS_BANDWIDTH_WIDEBAND)
         st->bandwidth = OPUS_BANDWIDTH_WIDEBAND;
-    if (st->Fs <= 12000 && st->bandwidth > OPUS_BANDWIDTH_MEDIUMBAND)
+    if (OPUS_API_FS(st->Fs) <= 12000 && st->bandwidth > OPUS_BANDWIDTH_MEDIUMBAND)
         st->bandwidth = OPUS_BANDWIDTH_MEDIUMBAND;
-    if (st->Fs <= 8000 && st->bandwidth > OPUS_BANDWIDTH_NARROWBAND)
+    if (OPUS_API_FS(st->Fs) <= 8000 && st->bandwidth > OPUS_BANDWIDTH_NARROWBAND)
         st->bandwidth = OPUS_BANDWIDTH_NARROWBAND;
 #ifndef DISABLE_FLOAT_API
     /* Use detected bandwidth to reduce the encoded bandwidth. */
@@ -1514,13 +1797,13 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
           gets it wrong when we could have coded a high bandwidth transparently.
           When operating in SILK/hybrid mode, we don't go below wideband to avoid
           more complicated switches that require redundancy. */
-       if (equiv_rate <= 18000*st->stream_channels && st->mode == MODE_CELT_ONLY)
+       if (equiv_rate <= 18000*OPUS_ENC_STREAM_CHANNELS(st->stream_channels) && st->mode == MODE_CELT_ONLY)
           min_detected_bandwidth = OPUS_BANDWIDTH_NARROWBAND;
-       else if (equiv_rate <= 24000*st->stream_channels && st->mode == MODE_CELT_ONLY)
+       else if (equiv_rate <= 24000*OPUS_ENC_STREAM_CHANNELS(st->stream_channels) && st->mode == MODE_CELT_ONLY)
           min_detected_bandwidth = OPUS_BANDWIDTH_MEDIUMBAND;
-       else if (equiv_rate <= 30000*st->stream_channels)
+       else if (equiv_rate <= 30000*OPUS_ENC_STREAM_CHANNELS(st->stream_channels))
           min_detected_bandwidth = OPUS_BANDWIDTH_WIDEBAND;
-       else if (equiv_rate <= 44000*st->stream_channels)
+       else if (equiv_rate <= 44000*OPUS_ENC_STREAM_CHANNELS(st->stream_channels))
           min_detected_bandwidth = OPUS_BANDWIDTH_SUPERWIDEBAND;
        else
           min_detected_bandwidth = OPUS_BANDWIDTH_FULLBAND;
@@ -1549,7 +1832,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
         st->mode = MODE_SILK_ONLY;
 
     /* Can't support higher than >60 ms frames, and >20 ms when in Hybrid or CELT-only modes */
-    if ((frame_size > st->Fs/50 && (st->mode != MODE_SILK_ONLY)) || frame_size > 3*st->Fs/50)
+    if ((frame_size > OPUS_API_FS(st->Fs)/50 && (st->mode != MODE_SILK_ONLY)) || frame_size > 3*OPUS_API_FS(st->Fs)/50)
     {
        int enc_frame_size;
        int nb_frames;
@@ -1565,15 +1848,15 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
 
        if (st->mode == MODE_SILK_ONLY)
        {
-         if (frame_size == 2*st->Fs/25)  /* 80 ms -> 2x 40 ms */
-           enc_frame_size = st->Fs/25;
-         else if (frame_size == 3*st->Fs/25)  /* 120 ms -> 2x 60 ms */
-           enc_frame_size = 3*st->Fs/50;
+         if (frame_size == 2*OPUS_API_FS(st->Fs)/25)  /* 80 ms -> 2x 40 ms */
+           enc_frame_size = OPUS_API_FS(st->Fs)/25;
+         else if (frame_size == 3*OPUS_API_FS(st->Fs)/25)  /* 120 ms -> 2x 60 ms */
+           enc_frame_size = 3*OPUS_API_FS(st->Fs)/50;
          else                            /* 100 ms -> 5x 20 ms */
-           enc_frame_size = st->Fs/50;
+           enc_frame_size = OPUS_API_FS(st->Fs)/50;
        }
        else
-         enc_frame_size = st->Fs/50;
+         enc_frame_size = OPUS_API_FS(st->Fs)/50;
 
        nb_frames = frame_size/enc_frame_size;
 
@@ -1610,7 +1893,7 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
        if (bak_to_mono)
           st->force_channels = 1;
        else
-          st->prev_channels = st->stream_channels;
+          st->prev_channels = OPUS_ENC_STREAM_CHANNELS(st->stream_channels);
 
        for (i=0;i<nb_frames;i++)
        {
@@ -1628,21 +1911,21 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
           frame_to_celt = to_celt && i==nb_frames-1;
           frame_redundancy = redundancy && (frame_to_celt || (!to_celt && i==0));
 
-          curr_max = IMIN(3*st->bitrate_bps/(3*8*st->Fs/enc_frame_size), max_len_sum/nb_frames);
+          curr_max = IMIN(3*st->bitrate_bps/(3*8*OPUS_API_FS(st->Fs)/enc_frame_size), max_len_sum/nb_frames);
 #ifdef ENABLE_DRED
-          curr_max = IMIN(curr_max, (max_len_sum-3*dred_bitrate_bps/(3*8*st->Fs/frame_size))/nb_frames);
-          if (first_frame) curr_max += 3*dred_bitrate_bps/(3*8*st->Fs/frame_size);
+          curr_max = IMIN(curr_max, (max_len_sum-3*dred_bitrate_bps/(3*8*OPUS_API_FS(st->Fs)/frame_size))/nb_frames);
+          if (first_frame) curr_max += 3*dred_bitrate_bps/(3*8*OPUS_API_FS(st->Fs)/frame_size);
 #endif
           curr_max = IMIN(max_len_sum-tot_size, curr_max);
 #ifndef DISABLE_FLOAT_API
           if (analysis_read_pos_bak != -1) {
-            is_silence = is_digital_silence(pcm, frame_size, st->channels, lsb_depth);
+            is_silence = is_digital_silence(pcm, frame_size, OPUS_API_CHANNELS(st->channels), lsb_depth);
             /* Get analysis for current frame. */
             tonality_get_info(&st->analysis, &analysis_info, enc_frame_size);
           }
 #endif
 
-          tmp_len = opus_encode_frame_native(st, pcm+i*(st->channels*enc_frame_size), enc_frame_size, curr_data, curr_max, float_api, first_frame,
+          tmp_len = opus_encode_frame_native(st, pcm+i*(OPUS_API_CHANNELS(st->channels)*enc_frame_size), enc_frame_size, curr_data, curr_max, float_api, first_frame,
 #ifdef ENABLE_DRED
           dred_bitrate_bps,
 #endif
@@ -1695,6 +1978,25 @@ opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_
     }
 }
 
+opus_int32 opus_encode_native(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
+                unsigned char *data, opus_int32 out_data_bytes, int lsb_depth,
+                const void *analysis_pcm, opus_int32 analysis_size, int c1, int c2,
+                int analysis_channels, downmix_func downmix, int float_api)
+{
+#ifdef OPUS_SCRATCH_ARENA
+    OpusScratch scratch, *prev;
+    opus_int32 ret;
+    prev = opus_scratch_enter(&scratch, (char*)st+st->scratch_offset, st->scratch_size, st->scratch_peak);
+    ret = opus_encode_native_impl(st, pcm, frame_size, data, out_data_bytes, lsb_depth,
+          analysis_pcm, analysis_size, c1, c2, analysis_channels, downmix, float_api);
+    st->scratch_peak = opus_scratch_leave(prev);
+    return ret;
+#else
+    return opus_encode_native_impl(st, pcm, frame_size, data, out_data_bytes, lsb_depth,
+          analysis_pcm, analysis_size, c1, c2, analysis_channels, downmix, float_api);
+#endif
+}
+
 static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pcm, int frame_size,
                 unsigned char *data, opus_int32 max_data_bytes,
                 int float_api, int first_frame,
@@ -1743,7 +2045,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
        delay_compensation = st->delay_compensation;
     total_buffer = delay_compensation;
 
-    frame_rate = st->Fs/frame_size;
+    frame_rate = OPUS_API_FS(st->Fs)/frame_size;
 
 #ifndef DISABLE_FLOAT_API
     if (is_silence)
@@ -1755,7 +2057,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
        if (!activity)
        {
            /* Mark as active if this noise frame is sufficiently loud */
-           opus_val32 noise_energy = compute_frame_energy(pcm, frame_size, st->channels, st->arch);
+           opus_val32 noise_energy = compute_frame_energy(pcm, frame_size, OPUS_API_CHANNELS(st->channels), st->arch);
            activity = st->peak_signal_energy < (PSEUDO_SNR_THRESHOLD * noise_energy);
        }
     }
@@ -1778,20 +2080,20 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
 
     if (redundancy)
     {
-       redundancy_bytes = compute_redundancy_bytes(max_data_bytes, st->bitrate_bps, frame_rate, st->stream_channels);
+       redundancy_bytes = compute_redundancy_bytes(max_data_bytes, st->bitrate_bps, frame_rate, OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
        if (redundancy_bytes == 0)
           redundancy = 0;
     }
 
-    /* printf("%d %d %d %d\n", st->bitrate_bps, st->stream_channels, st->mode, curr_bandwidth); */
-    bytes_target = IMIN(max_data_bytes-redundancy_bytes, st->bitrate_bps * frame_size / (st->Fs * 8)) - 1;
+    /* printf("%d %d %d %d\n", st->bitrate_bps, OPUS_ENC_STREAM_CHANNELS(st->stream_channels), st->mode, curr_bandwidth); */
+    bytes_target = IMIN(max_data_bytes-redundancy_bytes, st->bitrate_bps * frame_size / (OPUS_API_FS(st->Fs) * 8)) - 1;
 
     data += 1;
 
     ec_enc_init(&enc, data, max_data_bytes-1);
 
-    ALLOC(pcm_buf, (total_buffer+frame_size)*st->channels, opus_val16);
-    OPUS_COPY(pcm_buf, &st->delay_buffer[(st->encoder_buffer-total_buffer)*st->channels], total_buffer*st->channels);
+    ALLOC(pcm_buf, (total_buffer+frame_size)*OPUS_API_CHANNELS(st->channels), opus_val16);
+    OPUS_COPY(pcm_buf, &st->delay_buffer[(st->encoder_buffer-total_buffer)*OPUS_API_CHANNELS(st->channels)], total_buffer*OPUS_API_CHANNELS(st->channels));
 
     if (st->mode == MODE_CELT_ONLY)
        hp_freq_smth1 = silk_LSHIFT( silk_lin2log( VARIABLE_HP_MIN_CUTOFF_HZ ), 8 );
@@ -1806,7 +2108,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
 
     if (st->application == OPUS_APPLICATION_VOIP)
     {
-       hp_cutoff(pcm, cutoff_Hz, &pcm_buf[total_buffer*st->channels], st->hp_mem, frame_size, st->channels, st->Fs, st->arch);
+       hp_cutoff(pcm, cutoff_Hz, &pcm_buf[total_buffer*OPUS_API_CHANNELS(st->channels)], st->hp_mem, frame_size, OPUS_API_CHANNELS(st->channels), OPUS_API_FS(st->Fs), st->arch);
 
 #ifdef ENABLE_OSCE_TRAINING_DATA
        /* write out high pass filtered clean signal*/
@@ -1827,18 +2129,18 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
        }
 #endif
     } else {
-       dc_reject(pcm, 3, &pcm_buf[total_buffer*st->channels], st->hp_mem, frame_size, st->channels, st->Fs);
+       dc_reject(pcm, 3, &pcm_buf[total_buffer*OPUS_API_CHANNELS(st->channels)], st->hp_mem, frame_size, OPUS_API_CHANNELS(st->channels), OPUS_API_FS(st->Fs));
     }
 #ifndef FIXED_POINT
     if (float_api)
     {
        opus_val32 sum;
-       sum = celt_inner_prod(&pcm_buf[total_buffer*st->channels], &pcm_buf[total_buffer*st->channels], frame_size*st->channels, st->arch);
+       sum = celt_inner_prod(&pcm_buf[total_buffer*OPUS_API_CHANNELS(st->channels)], &pcm_buf[total_buffer*OPUS_API_CHANNELS(st->channels)], frame_size*OPUS_API_CHANNELS(st->channels), st->arch);
        /* This should filter out both NaNs and ridiculous signals that could
           cause NaNs further down. */
        if (!(sum < 1e9f) || celt_isnan(sum))
        {
-          OPUS_CLEAR(&pcm_buf[total_buffer*st->channels], frame_size*st->channels);
+          OPUS_CLEAR(&pcm_buf[total_buffer*OPUS_API_CHANNELS(st->channels)], frame_size*OPUS_API_CHANNELS(st->channels));
           st->hp_mem[0] = st->hp_mem[1] = st->hp_mem[2] = st->hp_mem[3] = 0;
        }
     }
@@ -1850,8 +2152,8 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
     if ( st->dred_duration > 0 && st->dred_encoder.loaded ) {
         int frame_size_400Hz;
         /* DRED Encoder */
-        dred_compute_latents( &st->dred_encoder, &pcm_buf[total_buffer*st->channels], frame_size, total_buffer, st->arch );
-        frame_size_400Hz = frame_size*400/st->Fs;
+        dred_compute_latents( &st->dred_encoder, &pcm_buf[total_buffer*OPUS_API_CHANNELS(st->channels)], frame_size, total_buffer, st->arch );
+        frame_size_400Hz = frame_size*400/OPUS_API_FS(st->Fs);
         OPUS_MOVE(&st->activity_mem[frame_size_400Hz], st->activity_mem, 4*DRED_MAX_FRAMES-frame_size_400Hz);
         for (i=0;i<frame_size_400Hz;i++)
            st->activity_mem[i] = activity;
@@ -1870,7 +2172,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
        const opus_int16 *pcm_silk;
 #else
        VARDECL(opus_int16, pcm_silk);
-       ALLOC(pcm_silk, st->channels*frame_size, opus_int16);
+       ALLOC(pcm_silk, OPUS_API_CHANNELS(st->channels)*frame_size, opus_int16);
 #endif
 
         /* Distribute bits between SILK and CELT */
@@ -1878,8 +2180,8 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         if( st->mode == MODE_HYBRID ) {
             /* Base rate for SILK */
             st->silk_mode.bitRate = compute_silk_rate_for_hybrid(total_bitRate,
-                  curr_bandwidth, st->Fs == 50 * frame_size, st->use_vbr, st->silk_mode.LBRR_coded,
-                  st->stream_channels);
+                  curr_bandwidth, OPUS_API_FS(st->Fs) == 50 * frame_size, st->use_vbr, st->silk_mode.LBRR_coded,
+                  OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
             if (!st->energy_masking)
             {
                /* Increasingly attenuate high band when it gets allocated fewer bits */
@@ -1909,7 +2211,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
               end = 15;
               srate = 12000;
            }
-           for (c=0;c<st->channels;c++)
+           for (c=0;c<OPUS_API_CHANNELS(st->channels);c++)
            {
               for(i=0;i<end;i++)
               {
@@ -1922,7 +2224,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
               }
            }
            /* Conservative rate reduction, we cut the masking in half */
-           masking_depth = mask_sum / end*st->channels;
+           masking_depth = mask_sum / end*OPUS_API_CHANNELS(st->channels);
            masking_depth += QCONST16(.2f, DB_SHIFT);
            rate_offset = (opus_int32)PSHR32(MULT16_16(srate, masking_depth), DB_SHIFT);
            rate_offset = MAX32(rate_offset, -2*st->silk_mode.bitRate/3);
@@ -1933,9 +2235,9 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
               st->silk_mode.bitRate += rate_offset;
         }
 
-        st->silk_mode.payloadSize_ms = 1000 * frame_size / st->Fs;
-        st->silk_mode.nChannelsAPI = st->channels;
-        st->silk_mode.nChannelsInternal = st->stream_channels;
+        st->silk_mode.payloadSize_ms = 1000 * frame_size / OPUS_API_FS(st->Fs);
+        st->silk_mode.nChannelsAPI = OPUS_API_CHANNELS(st->channels);
+        st->silk_mode.nChannelsInternal = OPUS_ENC_STREAM_CHANNELS(st->stream_channels);
         if (curr_bandwidth == OPUS_BANDWIDTH_NARROWBAND) {
             st->silk_mode.desiredInternalSampleRate = 8000;
         } else if (curr_bandwidth == OPUS_BANDWIDTH_MEDIUMBAND) {
@@ -1994,7 +2296,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
 #endif
            {
               /* Allow SILK to steal up to 25% of the remaining bits */
-              opus_int16 other_bits = IMAX(0, st->silk_mode.maxBits - st->silk_mode.bitRate * frame_size / st->Fs);
+              opus_int16 other_bits = IMAX(0, st->silk_mode.maxBits - st->silk_mode.bitRate * frame_size / OPUS_API_FS(st->Fs));
               st->silk_mode.maxBits = IMAX(0, st->silk_mode.maxBits - other_bits*3/4);
               st->silk_mode.useCBR = 0;
            }
@@ -2003,10 +2305,10 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
            if (st->mode == MODE_HYBRID)
            {
               /* Compute SILK bitrate corresponding to the max total bits available */
-              opus_int32 maxBitRate = compute_silk_rate_for_hybrid(st->silk_mode.maxBits*st->Fs / frame_size,
-                    curr_bandwidth, st->Fs == 50 * frame_size, st->use_vbr, st->silk_mode.LBRR_coded,
-                    st->stream_channels);
-              st->silk_mode.maxBits = maxBitRate * frame_size / st->Fs;
+              opus_int32 maxBitRate = compute_silk_rate_for_hybrid(st->silk_mode.maxBits*OPUS_API_FS(st->Fs) / frame_size,
+                    curr_bandwidth, OPUS_API_FS(st->Fs) == 50 * frame_size, st->use_vbr, st->silk_mode.LBRR_coded,
+                    OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
+              st->silk_mode.maxBits = maxBitRate * frame_size / OPUS_API_FS(st->Fs);
            }
         }
 
@@ -2020,14 +2322,14 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
                overwrite st->delay_buffer because the only thing that uses it before it gets
                rewritten is tmp_prefill[] and even then only the part after the ramp really
                gets used (rather than sent to the encoder and discarded) */
-            prefill_offset = st->channels*(st->encoder_buffer-st->delay_compensation-st->Fs/400);
+            prefill_offset = OPUS_API_CHANNELS(st->channels)*(st->encoder_buffer-st->delay_compensation-OPUS_API_FS(st->Fs)/400);
             gain_fade(st->delay_buffer+prefill_offset, st->delay_buffer+prefill_offset,
-                  0, Q15ONE, celt_mode->overlap, st->Fs/400, st->channels, celt_mode->window, st->Fs);
+                  0, Q15ONE, celt_mode->overlap, OPUS_API_FS(st->Fs)/400, OPUS_API_CHANNELS(st->channels), celt_mode->window, OPUS_API_FS(st->Fs));
             OPUS_CLEAR(st->delay_buffer, prefill_offset);
 #ifdef FIXED_POINT
             pcm_silk = st->delay_buffer;
 #else
-            for (i=0;i<st->encoder_buffer*st->channels;i++)
+            for (i=0;i<st->encoder_buffer*OPUS_API_CHANNELS(st->channels);i++)
                 pcm_silk[i] = FLOAT2INT16(st->delay_buffer[i]);
 #endif
             silk_Encode( silk_enc, &st->silk_mode, pcm_silk, st->encoder_buffer, NULL, &zero, prefill, activity );
@@ -2036,10 +2338,10 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         }
 
 #ifdef FIXED_POINT
-        pcm_silk = pcm_buf+total_buffer*st->channels;
+        pcm_silk = pcm_buf+total_buffer*OPUS_API_CHANNELS(st->channels);
 #else
-        for (i=0;i<frame_size*st->channels;i++)
-            pcm_silk[i] = FLOAT2INT16(pcm_buf[total_buffer*st->channels + i]);
+        for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
+            pcm_silk[i] = FLOAT2INT16(pcm_buf[total_buffer*OPUS_API_CHANNELS(st->channels) + i]);
 #endif
         ret = silk_Encode( silk_enc, &st->silk_mode, pcm_silk, frame_size, &enc, &nBytes, 0, activity );
         if( ret ) {
@@ -2067,7 +2369,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         if (nBytes==0)
         {
            st->rangeFinal = 0;
-           data[-1] = gen_toc(st->mode, st->Fs/frame_size, curr_bandwidth, st->stream_channels);
+           data[-1] = gen_toc(st->mode, OPUS_API_FS(st->Fs)/frame_size, curr_bandwidth, OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
            RESTORE_STACK;
            return 1;
         }
@@ -2075,7 +2377,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         /* FIXME: How do we allocate the redundancy for CBR? */
         if (st->silk_mode.opusCanSwitch)
         {
-           redundancy_bytes = compute_redundancy_bytes(max_data_bytes, st->bitrate_bps, frame_rate, st->stream_channels);
+           redundancy_bytes = compute_redundancy_bytes(max_data_bytes, st->bitrate_bps, frame_rate, OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
            redundancy = (redundancy_bytes != 0);
            celt_to_silk = 0;
            st->silk_bw_switch = 1;
@@ -2103,7 +2405,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
                 break;
         }
         celt_encoder_ctl(celt_enc, CELT_SET_END_BAND(endband));
-        celt_encoder_ctl(celt_enc, CELT_SET_CHANNELS(st->stream_channels));
+        celt_encoder_ctl(celt_enc, CELT_SET_CHANNELS(OPUS_ENC_STREAM_CHANNELS(st->stream_channels)));
     }
     celt_encoder_ctl(celt_enc, OPUS_SET_BITRATE(OPUS_BITRATE_MAX));
     if (st->mode != MODE_SILK_ONLY)
@@ -2115,29 +2417,29 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         celt_encoder_ctl(celt_enc, CELT_SET_PREDICTION(celt_pred));
     }
 
-    ALLOC(tmp_prefill, st->channels*st->Fs/400, opus_val16);
+    ALLOC(tmp_prefill, OPUS_API_CHANNELS(st->channels)*OPUS_API_FS(st->Fs)/400, opus_val16);
     if (st->mode != MODE_SILK_ONLY && st->mode != st->prev_mode && st->prev_mode > 0)
     {
-       OPUS_COPY(tmp_prefill, &st->delay_buffer[(st->encoder_buffer-total_buffer-st->Fs/400)*st->channels], st->channels*st->Fs/400);
+       OPUS_COPY(tmp_prefill, &st->delay_buffer[(st->encoder_buffer-total_buffer-OPUS_API_FS(st->Fs)/400)*OPUS_API_CHANNELS(st->channels)], OPUS_API_CHANNELS(st->channels)*OPUS_API_FS(st->Fs)/400);
     }
 
-    if (st->channels*(st->encoder_buffer-(frame_size+total_buffer)) > 0)
+    if (OPUS_API_CHANNELS(st->channels)*(st->encoder_buffer-(frame_size+total_buffer)) > 0)
     {
-       OPUS_MOVE(st->delay_buffer, &st->delay_buffer[st->channels*frame_size], st->channels*(st->encoder_buffer-frame_size-total_buffer));
-       OPUS_COPY(&st->delay_buffer[st->channels*(st->encoder_buffer-frame_size-total_buffer)],
+       OPUS_MOVE(st->delay_buffer, &st->delay_buffer[OPUS_API_CHANNELS(st->channels)*frame_size], OPUS_API_CHANNELS(st->channels)*(st->encoder_buffer-frame_size-total_buffer));
+       OPUS_COPY(&st->delay_buffer[OPUS_API_CHANNELS(st->channels)*(st->encoder_buffer-frame_size-total_buffer)],
              &pcm_buf[0],
-             (frame_size+total_buffer)*st->channels);
+             (frame_size+total_buffer)*OPUS_API_CHANNELS(st->channels));
     } else {
-       OPUS_COPY(st->delay_buffer, &pcm_buf[(frame_size+total_buffer-st->encoder_buffer)*st->channels], st->encoder_buffer*st->channels);
+       OPUS_COPY(st->delay_buffer, &pcm_buf[(frame_size+total_buffer-st->encoder_buffer)*OPUS_API_CHANNELS(st->channels)], st->encoder_buffer*OPUS_API_CHANNELS(st->channels));
     }
     /* gain_fade() and stereo_fade() need to be after the buffer copying
        because we don't want any of this to affect the SILK part */
     if( st->prev_HB_gain < Q15ONE || HB_gain < Q15ONE ) {
        gain_fade(pcm_buf, pcm_buf,
-             st->prev_HB_gain, HB_gain, celt_mode->overlap, frame_size, st->channels, celt_mode->window, st->Fs);
+             st->prev_HB_gain, HB_gain, celt_mode->overlap, frame_size, OPUS_API_CHANNELS(st->channels), celt_mode->window, OPUS_API_FS(st->Fs));
     }
     st->prev_HB_gain = HB_gain;
-    if (st->mode != MODE_HYBRID || st->stream_channels==1)
+    if (st->mode != MODE_HYBRID || OPUS_ENC_STREAM_CHANNELS(st->stream_channels)==1)
     {
        if (equiv_rate > 32000)
           st->silk_mode.stereoWidth_Q14 = 16384;
@@ -2146,7 +2448,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
        else
           st->silk_mode.stereoWidth_Q14 = 16384 - 2048*(opus_int32)(32000-equiv_rate)/(equiv_rate-14000);
     }
-    if( !st->energy_masking && st->channels == 2 ) {
+    if( !st->energy_masking && OPUS_API_CHANNELS(st->channels) == 2 ) {
         /* Apply stereo width reduction (at low bitrates) */
         if( st->hybrid_stereo_width_Q14 < (1 << 14) || st->silk_mode.stereoWidth_Q14 < (1 << 14) ) {
             opus_val16 g1, g2;
@@ -2160,7 +2462,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
             g2 *= (1.f/16384);
 #endif
             stereo_fade(pcm_buf, pcm_buf, g1, g2, celt_mode->overlap,
-                  frame_size, st->channels, celt_mode->window, st->Fs);
+                  frame_size, OPUS_API_CHANNELS(st->channels), celt_mode->window, OPUS_API_FS(st->Fs));
             st->hybrid_stereo_width_Q14 = st->silk_mode.stereoWidth_Q14;
         }
     }
@@ -2242,7 +2544,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         celt_encoder_ctl(celt_enc, CELT_SET_START_BAND(0));
         celt_encoder_ctl(celt_enc, OPUS_SET_VBR(0));
         celt_encoder_ctl(celt_enc, OPUS_SET_BITRATE(OPUS_BITRATE_MAX));
-        err = celt_encode_with_ec(celt_enc, pcm_buf, st->Fs/200, data+nb_compr_bytes, redundancy_bytes, NULL);
+        err = celt_encode_with_ec(celt_enc, pcm_buf, OPUS_API_FS(st->Fs)/200, data+nb_compr_bytes, redundancy_bytes, NULL);
         if (err < 0)
         {
            RESTORE_STACK;
@@ -2290,7 +2592,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
            celt_encoder_ctl(celt_enc, OPUS_RESET_STATE);
 
            /* Prefilling */
-           celt_encode_with_ec(celt_enc, tmp_prefill, st->Fs/400, dummy, 2, NULL);
+           celt_encode_with_ec(celt_enc, tmp_prefill, OPUS_API_FS(st->Fs)/400, dummy, 2, NULL);
            celt_encoder_ctl(celt_enc, CELT_SET_PREDICTION(0));
         }
         /* If false, we already busted the budget and we'll end up with a "PLC frame" */
@@ -2317,8 +2619,8 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         int err;
         unsigned char dummy[2];
         int N2, N4;
-        N2 = st->Fs/200;
-        N4 = st->Fs/400;
+        N2 = OPUS_API_FS(st->Fs)/200;
+        N4 = OPUS_API_FS(st->Fs)/400;
 
         celt_encoder_ctl(celt_enc, OPUS_RESET_STATE);
         celt_encoder_ctl(celt_enc, CELT_SET_START_BAND(0));
@@ -2333,9 +2635,9 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
            ec_enc_shrink(&enc, nb_compr_bytes);
         }
         /* NOTE: We could speed this up slightly (at the expense of code size) by just adding a function that prefills the buffer */
-        celt_encode_with_ec(celt_enc, pcm_buf+st->channels*(frame_size-N2-N4), N4, dummy, 2, NULL);
+        celt_encode_with_ec(celt_enc, pcm_buf+OPUS_API_CHANNELS(st->channels)*(frame_size-N2-N4), N4, dummy, 2, NULL);
 
-        err = celt_encode_with_ec(celt_enc, pcm_buf+st->channels*(frame_size-N2), N2, data+nb_compr_bytes, redundancy_bytes, NULL);
+        err = celt_encode_with_ec(celt_enc, pcm_buf+OPUS_API_CHANNELS(st->channels)*(frame_size-N2), N2, data+nb_compr_bytes, redundancy_bytes, NULL);
         if (err < 0)
         {
            RESTORE_STACK;
@@ -2348,7 +2650,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
 
     /* Signalling the mode in the first byte */
     data--;
-    data[0] = gen_toc(st->mode, st->Fs/frame_size, curr_bandwidth, st->stream_channels);
+    data[0] = gen_toc(st->mode, OPUS_API_FS(st->Fs)/frame_size, curr_bandwidth, OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
 
     st->rangeFinal = enc.rng ^ redundant_rng;
 
@@ -2356,7 +2658,7 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
         st->prev_mode = MODE_CELT_ONLY;
     else
         st->prev_mode = st->mode;
-    st->prev_channels = st->stream_channels;
+    st->prev_channels = OPUS_ENC_STREAM_CHANNELS(st->stream_channels);
     st->prev_framesize = frame_size;
 
     st->first = 0;
@@ -2365,10 +2667,10 @@ static opus_int32 opus_encode_frame_native(OpusEncoder *st, const opus_val16 *pc
 #ifndef DISABLE_FLOAT_API
     if (st->use_dtx && (analysis_info->valid || is_silence))
     {
-       if (decide_dtx_mode(activity, &st->nb_no_activity_ms_Q1, 2*1000*frame_size/st->Fs))
+       if (decide_dtx_mode(activity, &st->nb_no_activity_ms_Q1, 2*1000*frame_size/OPUS_API_FS(st->Fs)))
        {
           st->rangeFinal = 0;
-          data[0] = gen_toc(st->mode, st->Fs/frame_size, curr_bandwidth, st->stream_channels);
+          data[0] = gen_toc(st->mode, OPUS_API_FS(st->Fs)/frame_size, curr_bandwidth, OPUS_ENC_STREAM_CHANNELS(st->stream_channels));
           RESTORE_STACK;
           return 1;
        }
@@ -2469,18 +2771,18 @@ opus_int32 opus_encode_float(OpusEncoder *st, const float *pcm, int analysis_fra
    VARDECL(opus_int16, in);
    ALLOC_STACK;
 
-   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, st->Fs);
+   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, OPUS_API_FS(st->Fs));
    if (frame_size <= 0)
    {
       RESTORE_STACK;
       return OPUS_BAD_ARG;
    }
-   ALLOC(in, frame_size*st->channels, opus_int16);
+   ALLOC(in, frame_size*OPUS_API_CHANNELS(st->channels), opus_int16);
 
-   for (i=0;i<frame_size*st->channels;i++)
+   for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
       in[i] = FLOAT2INT16(pcm[i]);
    ret = opus_encode_native(st, in, frame_size, data, max_data_bytes, 16,
-                            pcm, analysis_frame_size, 0, -2, st->channels, downmix_float, 1);
+                            pcm, analysis_frame_size, 0, -2, OPUS_API_CHANNELS(st->channels), downmix_float, 1);
    RESTORE_STACK;
    return ret;
 }
@@ -2490,9 +2792,9 @@ opus_int32 opus_encode(OpusEncoder *st, const opus_int16 *pcm, int analysis_fram
                 unsigned char *data, opus_int32 out_data_bytes)
 {
    int frame_size;
-   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, st->Fs);
+   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, OPUS_API_FS(st->Fs));
    return opus_encode_native(st, pcm, frame_size, data, out_data_bytes, 16,
-                             pcm, analysis_frame_size, 0, -2, st->channels, downmix_int, 0);
+                             pcm, analysis_frame_size, 0, -2, OPUS_API_CHANNELS(st->channels), downmix_int, 0);
 }
 
 #else
@@ -2504,18 +2806,18 @@ opus_int32 opus_encode(OpusEncoder *st, const opus_int16 *pcm, int analysis_fram
    VARDECL(float, in);
    ALLOC_STACK;
 
-   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, st->Fs);
+   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, OPUS_API_FS(st->Fs));
    if (frame_size <= 0)
    {
       RESTORE_STACK;
       return OPUS_BAD_ARG;
    }
-   ALLOC(in, frame_size*st->channels, float);
+   ALLOC(in, frame_size*OPUS_API_CHANNELS(st->channels), float);
 
-   for (i=0;i<frame_size*st->channels;i++)
+   for (i=0;i<frame_size*OPUS_API_CHANNELS(st->channels);i++)
       in[i] = (1.0f/32768)*pcm[i];
    ret = opus_encode_native(st, in, frame_size, data, max_data_bytes, 16,
-                            pcm, analysis_frame_size, 0, -2, st->channels, downmix_int, 0);
+                            pcm, analysis_frame_size, 0, -2, OPUS_API_CHANNELS(st->channels), downmix_int, 0);
    RESTORE_STACK;
    return ret;
 }
@@ -2523,12 +2825,63 @@ opus_int32 opus_encode_float(OpusEncoder *st, const float *pcm, int analysis_fra
                       unsigned char *data, opus_int32 out_data_bytes)
 {
    int frame_size;
-   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, st->Fs);
+   frame_size = frame_size_select(analysis_frame_size, st->variable_duration, OPUS_API_FS(st->Fs));
    return opus_encode_native(st, pcm, frame_size, data, out_data_bytes, 24,
-                             pcm, analysis_frame_size, 0, -2, st->channels, downmix_float, 1);
+                             pcm, analysis_frame_size, 0, -2, OPUS_API_CHANNELS(st->channels), downmix_float, 1);
 }
 #endif
 
+#ifndef DISABLE_FLOAT_API
+/* Whether opus_encode_float() on st feeds the analysis before anything can
+   fail */
+static int analysis_fed(const OpusEncoder *st, int frame_size, opus_int32 max_data_bytes)
+{
+   return analysis_enabled(st) && st->analysis_ahead == NULL && frame_size > 0 && max_data_bytes > 0
+         && !(max_data_bytes==1 && OPUS_API_FS(st->Fs)==frame_size*10);
+}
+
+int opus_encode_float_tiers(OpusEncoder *const *st, const float *pcm, int count,
+      int analysis_frame_size, unsigned char *const *data, opus_int32 max_data_bytes, opus_int32 *ret)
+{
+   int i;
+   int frame_size;
+   VARDECL(int, shared);
+   ALLOC_STACK;
+
+   if (count < 1)
+   {
+      RESTORE_STACK;
+      return OPUS_BAD_ARG;
+   }
+   ALLOC(shared, count, int);
+   frame_size = frame_size_select(analysis_frame_size, st[0]->variable_duration, st[0]->Fs);
+   shared[0] = analysis_fed(st[0], frame_size, max_data_bytes);
+   /* A tier whose analysis would read the same input from the same state
+      ends up where the first encoder's does, compare before that moves on */
+   for (i=1;i<count;i++)
+   {
+      shared[i] = shared[0] && analysis_fed(st[i], frame_size, max_data_bytes)
+            && st[i]->Fs == st[0]->Fs && st[i]->channels == st[0]->channels
+            && IMIN(24, st[i]->lsb_depth) == IMIN(24, st[0]->lsb_depth)
+            && frame_size_select(analysis_frame_size, st[i]->variable_duration, st[i]->Fs) == frame_size
+            && tonality_analysis_matches(&st[i]->analysis, &st[0]->analysis);
+   }
+   ret[0] = opus_encode_float(st[0], pcm, analysis_frame_size, data[0], max_data_bytes);
+   for (i=1;i<count;i++)
+   {
+      if (shared[i])
+      {
+         tonality_analysis_copy(&st[i]->analysis, &st[0]->analysis);
+         ret[i] = opus_encode_native(st[i], pcm, frame_size, data[i], max_data_bytes, 24,
+               pcm, analysis_frame_size, 0, -2, st[i]->channels, downmix_analyzed, 1);
+      } else {
+         ret[i] = opus_encode_float(st[i], pcm, analysis_frame_size, data[i], max_data_bytes);
+      }
+   }
+   RESTORE_STACK;
+   return OPUS_OK;
+}
+#endif
 
 int opus_encoder_ctl(OpusEncoder *st, int request, ...)
 {
@@ -2578,8 +2931,8 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
                     goto bad_arg;
                 else if (value <= 500)
                     value = 500;
-                else if (value > (opus_int32)300000*st->channels)
-                    value = (opus_int32)300000*st->channels;
+                else if (value > (opus_int32)300000*OPUS_API_CHANNELS(st->channels))
+                    value = (opus_int32)300000*OPUS_API_CHANNELS(st->channels);
             }
             st->user_bitrate_bps = value;
         }
@@ -2839,7 +3192,7 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
             {
                goto bad_arg;
             }
-            *value = st->Fs/400;
+            *value = OPUS_API_FS(st->Fs)/400;
             if (st->application != OPUS_APPLICATION_RESTRICTED_LOWDELAY)
                 *value += st->delay_compensation;
         }
@@ -2851,7 +3204,7 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
             {
                goto bad_arg;
             }
-            *value = st->Fs;
+            *value = OPUS_API_FS(st->Fs);
         }
         break;
         case OPUS_GET_FINAL_RANGE_REQUEST:
@@ -2975,6 +3328,8 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
            silk_enc = (char*)st+st->silk_enc_offset;
 #ifndef DISABLE_FLOAT_API
            tonality_analysis_reset(&st->analysis);
+           if (st->analysis_ahead != NULL)
+              st->analysis_ahead->stale = 1;
 #endif
 
            start = (char*)&st->OPUS_ENCODER_RESET_START;
@@ -2986,7 +3341,7 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
            /* Initialize DRED Encoder */
            dred_encoder_reset( &st->dred_encoder );
 #endif
-           st->stream_channels = st->channels;
+           st->stream_channels = OPUS_API_CHANNELS(st->channels);
            st->hybrid_stereo_width_Q14 = 1 << 14;
            st->prev_HB_gain = Q15ONE;
            st->first = 1;
@@ -3019,6 +3374,20 @@ int opus_encoder_ctl(OpusEncoder *st, int request, ...)
             ret = celt_encoder_ctl(celt_enc, OPUS_SET_ENERGY_MASK(value));
         }
         break;
+        case OPUS_GET_SCRATCH_PEAK_REQUEST:
+        {
+            opus_int32 *value = va_arg(ap, opus_int32*);
+            if (!value)
+            {
+                goto bad_arg;
+            }
+#ifdef OPUS_SCRATCH_ARENA
+            *value = st->scratch_peak;
+#else
+            ret = OPUS_UNIMPLEMENTED;
+#endif
+        }
+        break;
         case OPUS_GET_IN_DTX_REQUEST:
         {
             opus_int32 *value = va_arg(ap, opus_int32*);
@@ -3083,6 +3452,28 @@ bad_arg:
     return OPUS_BAD_ARG;
 }
 
+int opus_encoder_copy(OpusEncoder *dst, const OpusEncoder *src)
+{
+   if (dst->channels != src->channels)
+      return OPUS_BAD_ARG;
+#ifndef DISABLE_FLOAT_API
+   /* The helper thread owns part of the analysis and points back at its
+      encoder */
+   if (src->analysis_ahead != NULL || dst->analysis_ahead != NULL)
+      return OPUS_BAD_ARG;
+#endif
+   if (dst == src)
+      return OPUS_OK;
+   /* Everything is at fixed offsets from st, the scratch arena is last and
+      holds nothing between calls */
+#ifdef OPUS_SCRATCH_ARENA
+   OPUS_COPY((char*)dst, (const char*)src, src->scratch_offset);
+#else
+   OPUS_COPY((char*)dst, (const char*)src, opus_encoder_get_size(src->channels));
+#endif
+   return OPUS_OK;
+}
+
 void opus_encoder_destroy(OpusEncoder *st)
 {
     opus_free(st);
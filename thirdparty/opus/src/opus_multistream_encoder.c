@@ -456,6 +456,7 @@ static int opus_multistream_encoder_init_impl(
    st->bitrate_bps = OPUS_AUTO;
    st->application = application;
    st->variable_duration = OPUS_FRAMESIZE_ARG;
+   st->pool = NULL;
    for (i=0;i<st->layout.nb_channels;i++)
       st->layout.mapping[i] = mapping[i];
    if (!validate_layout(&st->layout))
@@ -799,6 +800,188 @@ static opus_int32 rate_allocation(
 
 /* Max size in case the encoder decides to return six frames (6 x 20 ms = 120 ms) */
 #define MS_FRAME_TMP (6*1275+12)
+
+static OpusEncoder *ms_get_encoder(OpusMSEncoder *st, int s)
+{
+   char *ptr;
+   int coupled;
+   ptr = (char*)st + align(sizeof(OpusMSEncoder));
+   coupled = IMIN(s, st->layout.nb_coupled_streams);
+   ptr += coupled*align(opus_encoder_get_size(2));
+   ptr += (s-coupled)*align(opus_encoder_get_size(1));
+   return (OpusEncoder*)ptr;
+}
+
+/* Copies the channels of stream s to buf (interleaved if coupled) and points
+   its encoder at their surround masking in bandLogE */
+static void ms_stream_input(OpusMSEncoder *st, int s, OpusEncoder *enc, opus_copy_channel_in_func copy_channel_in,
+      const void *pcm, int frame_size, void *user_data, opus_val16 *buf, const opus_val16 *bandSMR,
+      opus_val16 *bandLogE, int *c1, int *c2)
+{
+   if (s < st->layout.nb_coupled_streams)
+   {
+      int i;
+      int left, right;
+      left = get_left_channel(&st->layout, s, -1);
+      right = get_right_channel(&st->layout, s, -1);
+      (*copy_channel_in)(buf, 2,
+         pcm, st->layout.nb_channels, left, frame_size, user_data);
+      (*copy_channel_in)(buf+1, 2,
+         pcm, st->layout.nb_channels, right, frame_size, user_data);
+      if (st->mapping_type == MAPPING_TYPE_SURROUND)
+      {
+         for (i=0;i<21;i++)
+         {
+            bandLogE[i] = bandSMR[21*left+i];
+            bandLogE[21+i] = bandSMR[21*right+i];
+         }
+      }
+      *c1 = left;
+      *c2 = right;
+   } else {
+      int i;
+      int chan = get_mono_channel(&st->layout, s, -1);
+      (*copy_channel_in)(buf, 1,
+         pcm, st->layout.nb_channels, chan, frame_size, user_data);
+      if (st->mapping_type == MAPPING_TYPE_SURROUND)
+      {
+         for (i=0;i<21;i++)
+            bandLogE[i] = bandSMR[21*chan+i];
+      }
+      *c1 = chan;
+      *c2 = -1;
+   }
+   if (st->mapping_type == MAPPING_TYPE_SURROUND)
+      opus_encoder_ctl(enc, OPUS_SET_ENERGY_MASK(bandLogE));
+}
+
+/* Most bytes stream s may take, tot_size bytes into the packet */
+static int ms_stream_budget(const OpusMSEncoder *st, int s, opus_int32 max_data_bytes, int tot_size,
+      int frame_size, opus_int32 Fs)
+{
+   int curr_max;
+   /* number of bytes left (+Toc) */
+   curr_max = max_data_bytes - tot_size;
+   /* Reserve one byte for the last stream and two for the others */
+   curr_max -= IMAX(0,2*(st->layout.nb_streams-s-1)-1);
+   /* For 100 ms, reserve an extra byte per stream for the ToC */
+   if (Fs/frame_size == 10)
+     curr_max -= st->layout.nb_streams-s-1;
+   curr_max = IMIN(curr_max,MS_FRAME_TMP);
+   /* Repacketizer will add one or two bytes for self-delimited frames */
+   if (s != st->layout.nb_streams-1) curr_max -=  curr_max>253 ? 2 : 1;
+   return curr_max;
+}
+
+/* Whether each stream's encode sees the same budget however large the packets
+   of the streams before it are. The encoder never uses more than 1276 bytes
+   of a frame of up to 20 ms, past that its budget makes no difference. */
+static int ms_budgets_fixed(const OpusMSEncoder *st, opus_int32 max_data_bytes, int frame_size, opus_int32 Fs)
+{
+   int s;
+   int single = frame_size <= Fs/50;
+   /* Largest packet a stream adds, with its self-delimiting length */
+   int largest = (single ? 1276 : MS_FRAME_TMP) + 2;
+   for (s=0;s<st->layout.nb_streams;s++)
+   {
+      int lowest = ms_stream_budget(st, s, max_data_bytes, s*largest, frame_size, Fs);
+      int highest = ms_stream_budget(st, s, max_data_bytes, 0, frame_size, Fs);
+      if (single ? IMIN(1276, lowest) != IMIN(1276, highest) : lowest != highest)
+         return 0;
+   }
+   return 1;
+}
+
+/* Budgets for streams encoded at once, fixed before any of them is. Where no
+   stream's budget depends on the packets before it (ms_budgets_fixed) these
+   are the serial ones and the packet is the same as the serial encode's.
+   Otherwise every stream gets the smallest packet it can make and the rest,
+   less the self-delimiting lengths, is shared out in proportion to the
+   streams' bitrates; a stream only codes differently from the serial encode
+   where its share is smaller than the bytes it would have taken. Returns 0
+   when max_data_bytes is too small to share out. */
+static int ms_parallel_budgets(const OpusMSEncoder *st, const opus_int32 *bitrates, opus_int32 rate_sum,
+      opus_int32 max_data_bytes, int frame_size, opus_int32 Fs, opus_int32 *budgets)
+{
+   int s;
+   int nb_streams;
+   int smallest;
+   opus_int32 left;
+   nb_streams = st->layout.nb_streams;
+   if (ms_budgets_fixed(st, max_data_bytes, frame_size, Fs))
+   {
+      for (s=0;s<nb_streams;s++)
+         budgets[s] = ms_stream_budget(st, s, max_data_bytes, 0, frame_size, Fs);
+      return 1;
+   }
+   /* A ToC byte, and a frame count byte for 100 ms */
+   smallest = Fs/frame_size == 10 ? 2 : 1;
+   left = max_data_bytes - smallest*nb_streams - 2*(nb_streams-1);
+   if (left < 0 || rate_sum <= 0)
+      return 0;
+   for (s=0;s<nb_streams;s++)
+   {
+      opus_int32 share = (opus_int32)((opus_int64)left*bitrates[s]/rate_sum);
+      budgets[s] = IMIN(smallest + share, MS_FRAME_TMP);
+   }
+   return 1;
+}
+
+/* Appends the len bytes of stream s to data, self-delimited but for the last
+   stream. We need to use the repacketizer to add the self-delimiting lengths
+   while taking into account the fact that the encoder can now return more
+   than one frame at a time (e.g. 60 ms CELT-only) */
+static int ms_append_stream(const OpusMSEncoder *st, int s, int vbr, const unsigned char *packet, int len,
+      unsigned char *data, opus_int32 max_data_bytes)
+{
+   OpusRepacketizer rp;
+   int ret;
+   opus_repacketizer_init(&rp);
+   ret = opus_repacketizer_cat(&rp, packet, len);
+   /* If the opus_repacketizer_cat() fails, then something's seriously wrong
+      with the encoder. */
+   if (ret != OPUS_OK)
+      return OPUS_INTERNAL_ERROR;
+   return opus_repacketizer_out_range_impl(&rp, 0, opus_repacketizer_get_nb_frames(&rp),
+         data, max_data_bytes, s != st->layout.nb_streams-1, !vbr && s == st->layout.nb_streams-1, NULL, 0);
+}
+
+/* The streams of one batch, encoded on the threads of a pool */
+typedef struct {
+   OpusMSEncoder *st;
+   opus_copy_channel_in_func copy_channel_in;
+   const void *pcm;
+   int analysis_frame_size;
+   int frame_size;
+   int lsb_depth;
+   downmix_func downmix;
+   int float_api;
+   void *user_data;
+   const opus_val16 *bandSMR;
+   int first;                 /* stream of task 0 */
+   /* per task */
+   opus_val16 *buf;           /* 2*frame_size */
+   unsigned char *packets;    /* MS_FRAME_TMP */
+   opus_val16 *bandLogE;      /* 42 */
+   opus_int32 *curr_max;
+   opus_int32 *len;
+} MSEncodeJob;
+
+static void ms_encode_stream(void *arg, int i)
+{
+   MSEncodeJob *job;
+   OpusEncoder *enc;
+   opus_val16 *buf;
+   int c1, c2;
+   job = (MSEncodeJob*)arg;
+   enc = ms_get_encoder(job->st, job->first+i);
+   buf = job->buf+i*2*job->frame_size;
+   ms_stream_input(job->st, job->first+i, enc, job->copy_channel_in, job->pcm, job->frame_size,
+         job->user_data, buf, job->bandSMR, job->bandLogE+i*42, &c1, &c2);
+   job->len[i] = opus_encode_native(enc, buf, job->frame_size, job->packets+i*MS_FRAME_TMP,
+         job->curr_max[i], job->lsb_depth, job->pcm, job->analysis_frame_size, c1, c2,
+         job->st->layout.nb_channels, job->downmix, job->float_api);
+}
 int opus_multistream_encode_native
 (
     OpusMSEncoder *st,
@@ -821,8 +1004,14 @@ int opus_multistream_encode_native
    int tot_size;
    VARDECL(opus_val16, buf);
    VARDECL(opus_val16, bandSMR);
+   VARDECL(opus_val16, job_buf);
+   VARDECL(unsigned char, job_packets);
+   VARDECL(opus_val16, job_bandLogE);
+   VARDECL(opus_int32, job_curr_max);
+   VARDECL(opus_int32, job_len);
+   opus_int32 budgets[255];
+   int first_serial;
    unsigned char tmp_data[MS_FRAME_TMP];
-   OpusRepacketizer rp;
    opus_int32 vbr;
    const CELTMode *celt_mode;
    opus_int32 bitrates[256];
@@ -922,66 +1111,85 @@ int opus_multistream_encode_native
       }
    }
 
-   ptr = (char*)st + align(sizeof(OpusMSEncoder));
-   /* Counting ToC */
-   tot_size = 0;
-   for (s=0;s<st->layout.nb_streams;s++)
+   /* With a pool the streams are encoded at once on fixed budgets. In CBR
+      mode the last stream pads the packet out to its size with what the
+      others left, so it is encoded after them by the serial loop below. */
+   first_serial = 0;
+   if (st->pool != NULL && (vbr ? st->layout.nb_streams > 1 : st->layout.nb_streams > 2)
+         && ms_parallel_budgets(st, bitrates, rate_sum, max_data_bytes, frame_size, Fs, budgets))
    {
-      OpusEncoder *enc;
-      int len;
-      int curr_max;
-      int c1, c2;
-      int ret;
-
-      opus_repacketizer_init(&rp);
-      enc = (OpusEncoder*)ptr;
-      if (s < st->layout.nb_coupled_streams)
+      /* Batches of twice as many streams as there are threads to encode them,
+         which keeps the buffers on the stack bounded without leaving the
+         threads idle between every round. The packet is put together in
+         stream order after each batch. */
+      MSEncodeJob job;
+      int batch;
+      int pooled;
+      pooled = vbr ? st->layout.nb_streams : st->layout.nb_streams-1;
+      batch = IMIN(2*(opus_encode_pool_threads(st->pool)+1), pooled);
+      ALLOC(job_buf, batch*2*frame_size, opus_val16);
+      ALLOC(job_packets, batch*MS_FRAME_TMP, unsigned char);
+      ALLOC(job_bandLogE, batch*42, opus_val16);
+      ALLOC(job_curr_max, batch, opus_int32);
+      ALLOC(job_len, batch, opus_int32);
+      job.buf = job_buf;
+      job.packets = job_packets;
+      job.bandLogE = job_bandLogE;
+      job.curr_max = job_curr_max;
+      job.len = job_len;
+      job.st = st;
+      job.copy_channel_in = copy_channel_in;
+      job.pcm = pcm;
+      job.analysis_frame_size = analysis_frame_size;
+      job.frame_size = frame_size;
+      job.lsb_depth = lsb_depth;
+      job.downmix = downmix;
+      job.float_api = float_api;
+      job.user_data = user_data;
+      job.bandSMR = bandSMR;
+      tot_size = 0;
+      for (job.first=0;job.first<pooled;job.first+=batch)
       {
          int i;
-         int left, right;
-         left = get_left_channel(&st->layout, s, -1);
-         right = get_right_channel(&st->layout, s, -1);
-         (*copy_channel_in)(buf, 2,
-            pcm, st->layout.nb_channels, left, frame_size, user_data);
-         (*copy_channel_in)(buf+1, 2,
-            pcm, st->layout.nb_channels, right, frame_size, user_data);
-         ptr += align(coupled_size);
-         if (st->mapping_type == MAPPING_TYPE_SURROUND)
+         int count = IMIN(batch, pooled-job.first);
+         for (i=0;i<count;i++)
+            job.curr_max[i] = budgets[job.first+i];
+         opus_encode_pool_run(st->pool, ms_encode_stream, &job, count);
+         for (i=0;i<count;i++)
          {
-            for (i=0;i<21;i++)
+            int len;
+            s = job.first+i;
+            if (job.len[i]<0)
             {
-               bandLogE[i] = bandSMR[21*left+i];
-               bandLogE[21+i] = bandSMR[21*right+i];
+               RESTORE_STACK;
+               return job.len[i];
             }
+            len = ms_append_stream(st, s, vbr, job.packets+i*MS_FRAME_TMP, job.len[i], data, max_data_bytes-tot_size);
+            if (len<0)
+            {
+               RESTORE_STACK;
+               return len;
+            }
+            data += len;
+            tot_size += len;
          }
-         c1 = left;
-         c2 = right;
-      } else {
-         int i;
-         int chan = get_mono_channel(&st->layout, s, -1);
-         (*copy_channel_in)(buf, 1,
-            pcm, st->layout.nb_channels, chan, frame_size, user_data);
-         ptr += align(mono_size);
-         if (st->mapping_type == MAPPING_TYPE_SURROUND)
-         {
-            for (i=0;i<21;i++)
-               bandLogE[i] = bandSMR[21*chan+i];
-         }
-         c1 = chan;
-         c2 = -1;
       }
-      if (st->mapping_type == MAPPING_TYPE_SURROUND)
-         opus_encoder_ctl(enc, OPUS_SET_ENERGY_MASK(bandLogE));
-      /* number of bytes left (+Toc) */
-      curr_max = max_data_bytes - tot_size;
-      /* Reserve one byte for the last stream and two for the others */
-      curr_max -= IMAX(0,2*(st->layout.nb_streams-s-1)-1);
-      /* For 100 ms, reserve an extra byte per stream for the ToC */
-      if (Fs/frame_size == 10)
-        curr_max -= st->layout.nb_streams-s-1;
-      curr_max = IMIN(curr_max,MS_FRAME_TMP);
-      /* Repacketizer will add one or two bytes for self-delimited frames */
-      if (s != st->layout.nb_streams-1) curr_max -=  curr_max>253 ? 2 : 1;
+      first_serial = pooled;
+   } else {
+      /* Counting ToC */
+      tot_size = 0;
+   }
+
+   for (s=first_serial;s<st->layout.nb_streams;s++)
+   {
+      OpusEncoder *enc;
+      int len;
+      int curr_max;
+      int c1, c2;
+
+      enc = ms_get_encoder(st, s);
+      ms_stream_input(st, s, enc, copy_channel_in, pcm, frame_size, user_data, buf, bandSMR, bandLogE, &c1, &c2);
+      curr_max = ms_stream_budget(st, s, max_data_bytes, tot_size, frame_size, Fs);
       if (!vbr && s == st->layout.nb_streams-1)
          opus_encoder_ctl(enc, OPUS_SET_BITRATE(curr_max*(8*Fs/frame_size)));
       len = opus_encode_native(enc, buf, frame_size, tmp_data, curr_max, lsb_depth,
@@ -991,19 +1199,12 @@ int opus_multistream_encode_native
          RESTORE_STACK;
          return len;
       }
-      /* We need to use the repacketizer to add the self-delimiting lengths
-         while taking into account the fact that the encoder can now return
-         more than one frame at a time (e.g. 60 ms CELT-only) */
-      ret = opus_repacketizer_cat(&rp, tmp_data, len);
-      /* If the opus_repacketizer_cat() fails, then something's seriously wrong
-         with the encoder. */
-      if (ret != OPUS_OK)
+      len = ms_append_stream(st, s, vbr, tmp_data, len, data, max_data_bytes-tot_size);
+      if (len<0)
       {
          RESTORE_STACK;
-         return OPUS_INTERNAL_ERROR;
+         return len;
       }
-      len = opus_repacketizer_out_range_impl(&rp, 0, opus_repacketizer_get_nb_frames(&rp),
-            data, max_data_bytes-tot_size, s != st->layout.nb_streams-1, !vbr && s == st->layout.nb_streams-1, NULL, 0);
       data += len;
       tot_size += len;
    }
@@ -1282,6 +1483,11 @@ int opus_multistream_encoder_ctl_va_list(OpusMSEncoder *st, int request,
        *value = st->variable_duration;
    }
    break;
+   case OPUS_MULTISTREAM_SET_ENCODE_POOL_REQUEST:
+   {
+       st->pool = va_arg(ap, OpusEncodePool*);
+   }
+   break;
    case OPUS_RESET_STATE:
    {
       int s;
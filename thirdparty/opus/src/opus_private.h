@@ -46,12 +46,7 @@ struct OpusRepacketizer {
    opus_int32 padding_len[48];
 };
 
-typedef struct {
-   int id;
-   int frame;
-   const unsigned char *data;
-   opus_int32 len;
-} opus_extension_data;
+typedef OpusExtensionData opus_extension_data;
 
 typedef struct ChannelLayout {
    int nb_channels;
@@ -74,6 +69,7 @@ struct OpusMSEncoder {
    int variable_duration;
    MappingType mapping_type;
    opus_int32 bitrate_bps;
+   struct OpusEncodePool *pool;
    /* Encoder states go here */
    /* then opus_val32 window_mem[channels*120]; */
    /* then opus_val32 preemph_mem[channels]; */
@@ -89,6 +85,12 @@ int opus_multistream_encoder_ctl_va_list(struct OpusMSEncoder *st, int request,
 int opus_multistream_decoder_ctl_va_list(struct OpusMSDecoder *st, int request,
   va_list ap);
 
+/* Runs task(arg, i) for every i in [0, count) on the pool's threads and the
+   calling one, returns once all of them are done */
+typedef void (*opus_pool_task)(void *arg, int i);
+void opus_encode_pool_run(struct OpusEncodePool *pool, opus_pool_task task, void *arg, int count);
+int opus_encode_pool_threads(const struct OpusEncodePool *pool);
+
 int validate_layout(const ChannelLayout *layout);
 int get_left_channel(const ChannelLayout *layout, int stream_id, int prev);
 int get_right_channel(const ChannelLayout *layout, int stream_id, int prev);
@@ -159,6 +161,16 @@ int opus_decode_native(OpusDecoder *st, const unsigned char *data, opus_int32 le
       opus_val16 *pcm, int frame_size, int decode_fec, int self_delimited,
       opus_int32 *packet_offset, int soft_clip, const OpusDRED *dred, opus_int32 dred_offset);
 
+#ifdef OPUS_SCRATCH_ARENA
+/* Scratch arena sizes, enough for the worst single call across frame sizes,
+   complexities and modes (see OPUS_GET_SCRATCH_PEAK). Anything beyond them
+   still works, it just spills onto the caller's stack. */
+#define OPUS_ENCODER_SCRATCH_SIZE(channels) (16384+24576*(channels))
+#define OPUS_DECODER_SCRATCH_SIZE(channels) (12288+4096*(channels))
+/* What a state allocates for its arena, including the slack to align it */
+#define OPUS_SCRATCH_ALLOC_SIZE(size) ((size)+OPUS_SCRATCH_ALIGN-1)
+#endif
+
 /* Make sure everything is properly aligned. */
 static OPUS_INLINE int align(int i)
 {
@@ -212,10 +224,6 @@ int opus_multistream_decode_native(
   void *user_data
 );
 
-opus_int32 opus_packet_extensions_parse(const unsigned char *data, opus_int32 len, opus_extension_data *extensions, opus_int32 *nb_extensions);
-
-opus_int32 opus_packet_extensions_generate(unsigned char *data, opus_int32 len, const opus_extension_data  *extensions, opus_int32 nb_extensions, int pad);
-
 opus_int32 opus_packet_extensions_count(const unsigned char *data, opus_int32 len);
 
 opus_int32 opus_packet_pad_impl(unsigned char *data, opus_int32 len, opus_int32 new_len, int pad, const opus_extension_data  *extensions, int nb_extensions);
@@ -30,6 +30,7 @@
 #endif
 
 #include "mathops.h"
+#include "cpu_support.h"
 #include "os_support.h"
 #include "opus_private.h"
 #include "opus_defines.h"
@@ -41,11 +42,14 @@
 struct OpusProjectionDecoder
 {
   opus_int32 demixing_matrix_size_in_bytes;
+  int arch;
+  opus_int32 decoded_offset; /* of the decoded frame, after the decoder states */
   /* Encoder states go here */
 };
 
-#if !defined(DISABLE_FLOAT_API)
-static void opus_projection_copy_channel_out_float(
+/* The decoded channels are gathered into one frame and demixed together once
+   every stream is decoded */
+static void opus_projection_copy_channel_out(
   void *dst,
   int dst_stride,
   int dst_channel,
@@ -54,39 +58,20 @@ static void opus_projection_copy_channel_out_float(
   int frame_size,
   void *user_data)
 {
-  float *float_dst;
-  const MappingMatrix *matrix;
-  float_dst = (float *)dst;
-  matrix = (const MappingMatrix *)user_data;
-
-  if (dst_channel == 0)
-    OPUS_CLEAR(float_dst, frame_size * dst_stride);
-
-  if (src != NULL)
-    mapping_matrix_multiply_channel_out_float(matrix, src, dst_channel,
-      src_stride, float_dst, dst_stride, frame_size);
-}
-#endif
-
-static void opus_projection_copy_channel_out_short(
-  void *dst,
-  int dst_stride,
-  int dst_channel,
-  const opus_val16 *src,
-  int src_stride,
-  int frame_size,
-  void *user_data)
-{
-  opus_int16 *short_dst;
-  const MappingMatrix *matrix;
-  short_dst = (opus_int16 *)dst;
-  matrix = (const MappingMatrix *)user_data;
-  if (dst_channel == 0)
-    OPUS_CLEAR(short_dst, frame_size * dst_stride);
-
+  opus_val16 *decoded;
+  int i;
+  (void)user_data;
+  decoded = (opus_val16 *)dst;
   if (src != NULL)
-    mapping_matrix_multiply_channel_out_short(matrix, src, dst_channel,
-      src_stride, short_dst, dst_stride, frame_size);
+  {
+    for (i = 0; i < frame_size; i++)
+      decoded[i*dst_stride + dst_channel] = src[i*src_stride];
+  }
+  else
+  {
+    for (i = 0; i < frame_size; i++)
+      decoded[i*dst_stride + dst_channel] = 0;
+  }
 }
 
 static MappingMatrix *get_dec_demixing_matrix(OpusProjectionDecoder *st)
@@ -119,7 +104,8 @@ opus_int32 opus_projection_decoder_get_size(int channels, int streams,
   if (!decoder_size)
     return 0;
 
-  return align(sizeof(OpusProjectionDecoder)) + matrix_size + decoder_size;
+  return align(sizeof(OpusProjectionDecoder)) + matrix_size + align(decoder_size) +
+    MAPPING_MATRIX_MAX_FRAME_SIZE*channels*sizeof(opus_val16);
 }
 
 int opus_projection_decoder_init(OpusProjectionDecoder *st, opus_int32 Fs,
@@ -162,6 +148,10 @@ int opus_projection_decoder_init(OpusProjectionDecoder *st, opus_int32 Fs,
 
   mapping_matrix_init(get_dec_demixing_matrix(st), channels, nb_input_streams, 0,
     buf, demixing_matrix_size);
+  st->arch = opus_select_arch();
+  st->decoded_offset = align(sizeof(OpusProjectionDecoder) +
+    st->demixing_matrix_size_in_bytes +
+    opus_multistream_decoder_get_size(streams, coupled_streams));
 
   /* Set trivial mapping so each input channel pairs with a matrix column. */
   for (i = 0; i < channels; i++)
@@ -209,23 +199,58 @@ OpusProjectionDecoder *opus_projection_decoder_create(
   return st;
 }
 
+static int opus_projection_decode_native(OpusProjectionDecoder *st,
+  const unsigned char *data, opus_int32 len, void *pcm, int frame_size,
+  int decode_fec, int soft_clip, int float_out)
+{
+  OpusMSDecoder *ms_decoder;
+  opus_int32 Fs;
+  int channels;
+  int ret;
+  opus_val16 *decoded;
+
+  ms_decoder = get_multistream_decoder(st);
+  if (frame_size <= 0)
+    return OPUS_BAD_ARG;
+  channels = ms_decoder->layout.nb_channels;
+  opus_multistream_decoder_ctl(ms_decoder, OPUS_GET_SAMPLE_RATE(&Fs));
+  /* The multistream decoder never returns more than this */
+  frame_size = IMIN(frame_size, Fs/25*3);
+  celt_assert(frame_size <= MAPPING_MATRIX_MAX_FRAME_SIZE);
+  /* void* cast avoids clang -Wcast-align warning */
+  decoded = (opus_val16*)(void*)((char*)st + st->decoded_offset);
+  ret = opus_multistream_decode_native(ms_decoder, data, len, decoded,
+    opus_projection_copy_channel_out, frame_size, decode_fec, soft_clip,
+    NULL);
+  if (ret > 0)
+  {
+#ifndef DISABLE_FLOAT_API
+    if (float_out)
+      mapping_matrix_multiply_frame_out_float(get_dec_demixing_matrix(st),
+        decoded, channels, (float*)pcm, channels, ret, st->arch);
+    else
+#endif
+      mapping_matrix_multiply_frame_out_short(get_dec_demixing_matrix(st),
+        decoded, channels, (opus_int16*)pcm, channels, ret, st->arch);
+  }
+  return ret;
+}
+
 #ifdef FIXED_POINT
 int opus_projection_decode(OpusProjectionDecoder *st, const unsigned char *data,
                            opus_int32 len, opus_int16 *pcm, int frame_size,
                            int decode_fec)
 {
-  return opus_multistream_decode_native(get_multistream_decoder(st), data, len,
-    pcm, opus_projection_copy_channel_out_short, frame_size, decode_fec, 0,
-    get_dec_demixing_matrix(st));
+  return opus_projection_decode_native(st, data, len, pcm, frame_size,
+    decode_fec, 0, 0);
 }
 #else
 int opus_projection_decode(OpusProjectionDecoder *st, const unsigned char *data,
                            opus_int32 len, opus_int16 *pcm, int frame_size,
                            int decode_fec)
 {
-  return opus_multistream_decode_native(get_multistream_decoder(st), data, len,
-    pcm, opus_projection_copy_channel_out_short, frame_size, decode_fec, 1,
-    get_dec_demixing_matrix(st));
+  return opus_projection_decode_native(st, data, len, pcm, frame_size,
+    decode_fec, 1, 0);
 }
 #endif
 
@@ -233,9 +258,8 @@ int opus_projection_decode(OpusProjectionDecoder *st, const unsigned char *data,
 int opus_projection_decode_float(OpusProjectionDecoder *st, const unsigned char *data,
                                  opus_int32 len, float *pcm, int frame_size, int decode_fec)
 {
-  return opus_multistream_decode_native(get_multistream_decoder(st), data, len,
-    pcm, opus_projection_copy_channel_out_float, frame_size, decode_fec, 0,
-    get_dec_demixing_matrix(st));
+  return opus_projection_decode_native(st, data, len, pcm, frame_size,
+    decode_fec, 0, 1);
 }
 #endif
 
@@ -42,11 +42,14 @@ struct OpusProjectionEncoder
 {
   opus_int32 mixing_matrix_size_in_bytes;
   opus_int32 demixing_matrix_size_in_bytes;
+  opus_int32 mixed_offset; /* of the mixed frame, after the encoder states */
   /* Encoder states go here */
 };
 
-#if !defined(DISABLE_FLOAT_API)
-static void opus_projection_copy_channel_in_float(
+/* The whole frame is mixed before the multistream encoder pulls its
+   channels, user_data is the mixed frame with every channel padded to the
+   kernels' stride */
+static void opus_projection_copy_channel_in(
   opus_val16 *dst,
   int dst_stride,
   const void *src,
@@ -56,23 +59,14 @@ static void opus_projection_copy_channel_in_float(
   void *user_data
 )
 {
-  mapping_matrix_multiply_channel_in_float((const MappingMatrix*)user_data,
-    (const float*)src, src_stride, dst, src_channel, dst_stride, frame_size);
-}
-#endif
-
-static void opus_projection_copy_channel_in_short(
-  opus_val16 *dst,
-  int dst_stride,
-  const void *src,
-  int src_stride,
-  int src_channel,
-  int frame_size,
-  void *user_data
-)
-{
-  mapping_matrix_multiply_channel_in_short((const MappingMatrix*)user_data,
-    (const opus_int16*)src, src_stride, dst, src_channel, dst_stride, frame_size);
+  const opus_val16 *mixed;
+  int stride;
+  int i;
+  (void)src;
+  mixed = (const opus_val16*)user_data;
+  stride = MAPPING_MATRIX_STRIDE(src_stride);
+  for (i = 0; i < frame_size; i++)
+    dst[i*dst_stride] = mixed[i*stride + src_channel];
 }
 
 static int get_order_plus_one_from_channels(int channels, int *order_plus_one)
@@ -210,7 +204,8 @@ opus_int32 opus_projection_ambisonics_encoder_get_size(int channels,
     return 0;
 
   return align(sizeof(OpusProjectionEncoder)) +
-    mixing_matrix_size + demixing_matrix_size + encoder_size;
+    mixing_matrix_size + demixing_matrix_size + align(encoder_size) +
+    MAPPING_MATRIX_MAX_FRAME_SIZE*MAPPING_MATRIX_STRIDE(channels)*sizeof(opus_val16);
 }
 
 int opus_projection_ambisonics_encoder_init(OpusProjectionEncoder *st, opus_int32 Fs,
@@ -340,6 +335,10 @@ int opus_projection_ambisonics_encoder_init(OpusProjectionEncoder *st, opus_int3
   for (i = 0; i < channels; i++)
     mapping[i] = i;
 
+  st->mixed_offset = align(sizeof(OpusProjectionEncoder) +
+    st->mixing_matrix_size_in_bytes + st->demixing_matrix_size_in_bytes +
+    opus_multistream_encoder_get_size(*streams, *coupled_streams));
+
   /* Initialize multistream encoder with provided settings. */
   ms_encoder = get_multistream_encoder(st);
   ret = opus_multistream_encoder_init(ms_encoder, Fs, channels, *streams,
@@ -383,13 +382,50 @@ OpusProjectionEncoder *opus_projection_ambisonics_encoder_create(
   return st;
 }
 
+static int opus_projection_encode_native(OpusProjectionEncoder *st,
+  const void *pcm, int frame_size, unsigned char *data,
+  opus_int32 max_data_bytes, int lsb_depth, downmix_func downmix,
+  int float_api)
+{
+  OpusMSEncoder *ms_encoder;
+  MappingMatrix *mixing_matrix;
+  opus_int32 Fs;
+  int channels;
+  int mix_size;
+  int ret;
+  opus_val16 *mixed;
+
+  ms_encoder = get_multistream_encoder(st);
+  mixing_matrix = get_mixing_matrix(st);
+  channels = ms_encoder->layout.nb_channels;
+  opus_multistream_encoder_ctl(ms_encoder, OPUS_GET_SAMPLE_RATE(&Fs));
+  mix_size = frame_size_select(frame_size, ms_encoder->variable_duration, Fs);
+  if (mix_size <= 0)
+    return OPUS_BAD_ARG;
+  celt_assert(mix_size <= MAPPING_MATRIX_MAX_FRAME_SIZE);
+  /* void* cast avoids clang -Wcast-align warning */
+  mixed = (opus_val16*)(void*)((char*)st + st->mixed_offset);
+#ifndef DISABLE_FLOAT_API
+  if (float_api)
+    mapping_matrix_multiply_frame_in_float(mixing_matrix, (const float*)pcm,
+      channels, mixed, channels, mix_size, ms_encoder->arch);
+  else
+#endif
+    mapping_matrix_multiply_frame_in_short(mixing_matrix,
+      (const opus_int16*)pcm, channels, mixed, channels, mix_size,
+      ms_encoder->arch);
+  ret = opus_multistream_encode_native(ms_encoder,
+    opus_projection_copy_channel_in, pcm, frame_size, data, max_data_bytes,
+    lsb_depth, downmix, float_api, mixed);
+  return ret;
+}
+
 int opus_projection_encode(OpusProjectionEncoder *st, const opus_int16 *pcm,
                            int frame_size, unsigned char *data,
                            opus_int32 max_data_bytes)
 {
-  return opus_multistream_encode_native(get_multistream_encoder(st),
-    opus_projection_copy_channel_in_short, pcm, frame_size, data,
-    max_data_bytes, 16, downmix_int, 0, get_mixing_matrix(st));
+  return opus_projection_encode_native(st, pcm, frame_size, data,
+    max_data_bytes, 16, downmix_int, 0);
 }
 
 #ifndef DISABLE_FLOAT_API
@@ -398,18 +434,16 @@ int opus_projection_encode_float(OpusProjectionEncoder *st, const float *pcm,
                                  int frame_size, unsigned char *data,
                                  opus_int32 max_data_bytes)
 {
-  return opus_multistream_encode_native(get_multistream_encoder(st),
-    opus_projection_copy_channel_in_float, pcm, frame_size, data,
-    max_data_bytes, 16, downmix_float, 1, get_mixing_matrix(st));
+  return opus_projection_encode_native(st, pcm, frame_size, data,
+    max_data_bytes, 16, downmix_float, 1);
 }
 #else
 int opus_projection_encode_float(OpusProjectionEncoder *st, const float *pcm,
                                  int frame_size, unsigned char *data,
                                  opus_int32 max_data_bytes)
 {
-  return opus_multistream_encode_native(get_multistream_encoder(st),
-    opus_projection_copy_channel_in_float, pcm, frame_size, data,
-    max_data_bytes, 24, downmix_float, 1, get_mixing_matrix(st));
+  return opus_projection_encode_native(st, pcm, frame_size, data,
+    max_data_bytes, 24, downmix_float, 1);
 }
 #endif
 #endif
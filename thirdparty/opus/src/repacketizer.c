@@ -140,7 +140,7 @@ opus_int32 opus_repacketizer_out_range_impl(OpusRepacketizer *rp, int begin, int
 
    /* figure out total number of extensions */
    total_ext_count = nb_extensions;
-   for (i=begin;i<end;i++)
+   for (i=0;i<end;i++)
    {
       int n = opus_packet_extensions_count(rp->paddings[i], rp->padding_len[i]);
       if (n > 0) total_ext_count += n;
@@ -152,10 +152,12 @@ opus_int32 opus_repacketizer_out_range_impl(OpusRepacketizer *rp, int begin, int
       all_extensions[ext_count] = extensions[ext_count];
    }
 
-   /* incorporate any extensions from the repacketizer padding */
-   for (i=begin;i<end;i++)
+   /* incorporate any extensions from the repacketizer padding. A packet's
+      padding sits with its first frame and numbers frames from there, so a
+      packet that started before begin can still have extensions in range. */
+   for (i=0;i<end;i++)
    {
-      int j;
+      int j, kept=0;
       opus_int32 frame_ext_count;
       frame_ext_count = total_ext_count - ext_count;
       int ret = opus_packet_extensions_parse(rp->paddings[i], rp->padding_len[i],
@@ -165,12 +167,18 @@ opus_int32 opus_repacketizer_out_range_impl(OpusRepacketizer *rp, int begin, int
          RESTORE_STACK;
          return OPUS_INTERNAL_ERROR;
       }
-      /* renumber the extension frame numbers */
+      /* keep the ones on frames in [begin, end) and renumber them */
       for (j=0;j<frame_ext_count;j++)
       {
-         all_extensions[ext_count+j].frame += i-begin;
+         int frame = all_extensions[ext_count+j].frame + i;
+         if (frame >= begin && frame < end)
+         {
+            all_extensions[ext_count+kept] = all_extensions[ext_count+j];
+            all_extensions[ext_count+kept].frame = frame-begin;
+            kept++;
+         }
       }
-      ext_count += frame_ext_count;
+      ext_count += kept;
    }
 
    ptr = data;
@@ -363,6 +371,22 @@ int opus_packet_pad(unsigned char *data, opus_int32 len, opus_int32 new_len)
       return ret;
 }
 
+opus_int32 opus_packet_add_extensions(unsigned char *data, opus_int32 len, opus_int32 maxlen, const OpusExtensionData *extensions, int nb_extensions)
+{
+   opus_int32 ret;
+   ALLOC_STACK;
+   if (len < 1)
+      ret = OPUS_BAD_ARG;
+   else if (nb_extensions == 0)
+      ret = len;
+   else if (maxlen <= len)
+      ret = OPUS_BUFFER_TOO_SMALL;
+   else
+      ret = opus_packet_pad_impl(data, len, maxlen, 0, extensions, nb_extensions);
+   RESTORE_STACK;
+   return ret;
+}
+
 opus_int32 opus_packet_unpad(unsigned char *data, opus_int32 len)
 {
    OpusRepacketizer rp;
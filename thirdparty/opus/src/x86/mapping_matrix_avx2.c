@@ -0,0 +1,134 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "celt/x86/x86cpu.h"
+#include "arch.h"
+#include "mapping_matrix.h"
+
+#if defined(OPUS_X86_MAY_HAVE_AVX2)
+
+/* Eight rows (one vector) by four samples per block, so each column of
+   coefficients is loaded once for four samples. Every output still sums
+   its columns in order. With contraction off (this file is built with
+   -mfma) the result is bit-exact with the C version. */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+void mapping_matrix_mix_avx2(const float *coefs, int stride, int cols,
+      const float *input, int input_stride, float scale, float *output, int frame_size)
+{
+   int i, row, col;
+   const __m256 vscale = _mm256_set1_ps(scale);
+   for (i=0;i<frame_size-3;i+=4)
+   {
+      const float *x = input + i*input_stride;
+      float *y = output + i*stride;
+      for (row=0;row<stride;row+=8)
+      {
+         __m256 acc0 = _mm256_setzero_ps();
+         __m256 acc1 = _mm256_setzero_ps();
+         __m256 acc2 = _mm256_setzero_ps();
+         __m256 acc3 = _mm256_setzero_ps();
+         for (col=0;col<cols;col++)
+         {
+            __m256 c = _mm256_loadu_ps(coefs + col*stride + row);
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(c, _mm256_broadcast_ss(x + col)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(c, _mm256_broadcast_ss(x + input_stride + col)));
+            acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(c, _mm256_broadcast_ss(x + 2*input_stride + col)));
+            acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(c, _mm256_broadcast_ss(x + 3*input_stride + col)));
+         }
+         _mm256_storeu_ps(y + row, _mm256_mul_ps(vscale, acc0));
+         _mm256_storeu_ps(y + stride + row, _mm256_mul_ps(vscale, acc1));
+         _mm256_storeu_ps(y + 2*stride + row, _mm256_mul_ps(vscale, acc2));
+         _mm256_storeu_ps(y + 3*stride + row, _mm256_mul_ps(vscale, acc3));
+      }
+   }
+   for (;i<frame_size;i++)
+   {
+      const float *x = input + i*input_stride;
+      float *y = output + i*stride;
+      for (row=0;row<stride;row+=8)
+      {
+         __m256 acc = _mm256_setzero_ps();
+         for (col=0;col<cols;col++)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(coefs + col*stride + row),
+                  _mm256_broadcast_ss(x + col)));
+         _mm256_storeu_ps(y + row, _mm256_mul_ps(vscale, acc));
+      }
+   }
+}
+
+static OPUS_INLINE __m256i mix_term8(__m256i c, __m256i x)
+{
+   return _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(c, x), _mm256_set1_epi32(16384)), 15);
+}
+
+void mapping_matrix_mix_int_avx2(const opus_int32 *coefs, int stride, int cols,
+      const opus_int16 *input, int input_stride, opus_int32 *output, int frame_size)
+{
+   int i, row, col;
+   for (i=0;i<frame_size-1;i+=2)
+   {
+      const opus_int16 *x = input + i*input_stride;
+      opus_int32 *y = output + i*stride;
+      for (row=0;row<stride;row+=8)
+      {
+         __m256i acc0 = _mm256_setzero_si256();
+         __m256i acc1 = _mm256_setzero_si256();
+         for (col=0;col<cols;col++)
+         {
+            __m256i c = _mm256_loadu_si256((const __m256i*)(coefs + col*stride + row));
+            acc0 = _mm256_add_epi32(acc0, mix_term8(c, _mm256_set1_epi32(x[col])));
+            acc1 = _mm256_add_epi32(acc1, mix_term8(c, _mm256_set1_epi32(x[input_stride + col])));
+         }
+         _mm256_storeu_si256((__m256i*)(y + row), acc0);
+         _mm256_storeu_si256((__m256i*)(y + stride + row), acc1);
+      }
+   }
+   for (;i<frame_size;i++)
+   {
+      const opus_int16 *x = input + i*input_stride;
+      opus_int32 *y = output + i*stride;
+      for (row=0;row<stride;row+=8)
+      {
+         __m256i acc = _mm256_setzero_si256();
+         for (col=0;col<cols;col++)
+            acc = _mm256_add_epi32(acc, mix_term8(_mm256_loadu_si256((const __m256i*)(coefs + col*stride + row)),
+                  _mm256_set1_epi32(x[col])));
+         _mm256_storeu_si256((__m256i*)(y + row), acc);
+      }
+   }
+}
+
+#endif
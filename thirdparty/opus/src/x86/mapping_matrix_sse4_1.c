@@ -0,0 +1,123 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <smmintrin.h>
+#include "celt/x86/x86cpu.h"
+#include "arch.h"
+#include "mapping_matrix.h"
+
+#if defined(OPUS_X86_MAY_HAVE_SSE4_1)
+
+/* Eight rows (two vectors) by four samples per block, so each column of
+   coefficients is loaded once for four samples. Every output still sums
+   its columns in order, so the result is bit-exact with the C version. */
+void mapping_matrix_mix_sse4_1(const float *coefs, int stride, int cols,
+      const float *input, int input_stride, float scale, float *output, int frame_size)
+{
+   int i, row, col;
+   const __m128 vscale = _mm_set1_ps(scale);
+   for (i=0;i<frame_size-3;i+=4)
+   {
+      const float *x = input + i*input_stride;
+      float *y = output + i*stride;
+      for (row=0;row<stride;row+=8)
+      {
+         __m128 acc[8];
+         int k;
+         for (k=0;k<8;k++)
+            acc[k] = _mm_setzero_ps();
+         for (col=0;col<cols;col++)
+         {
+            __m128 c0 = _mm_loadu_ps(coefs + col*stride + row);
+            __m128 c1 = _mm_loadu_ps(coefs + col*stride + row + 4);
+            for (k=0;k<4;k++)
+            {
+               __m128 xk = _mm_set1_ps(x[k*input_stride + col]);
+               acc[2*k] = _mm_add_ps(acc[2*k], _mm_mul_ps(c0, xk));
+               acc[2*k+1] = _mm_add_ps(acc[2*k+1], _mm_mul_ps(c1, xk));
+            }
+         }
+         for (k=0;k<4;k++)
+         {
+            _mm_storeu_ps(y + k*stride + row, _mm_mul_ps(vscale, acc[2*k]));
+            _mm_storeu_ps(y + k*stride + row + 4, _mm_mul_ps(vscale, acc[2*k+1]));
+         }
+      }
+   }
+   for (;i<frame_size;i++)
+   {
+      const float *x = input + i*input_stride;
+      float *y = output + i*stride;
+      for (row=0;row<stride;row+=8)
+      {
+         __m128 acc0 = _mm_setzero_ps();
+         __m128 acc1 = _mm_setzero_ps();
+         for (col=0;col<cols;col++)
+         {
+            __m128 xc = _mm_set1_ps(x[col]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(coefs + col*stride + row), xc));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(coefs + col*stride + row + 4), xc));
+         }
+         _mm_storeu_ps(y + row, _mm_mul_ps(vscale, acc0));
+         _mm_storeu_ps(y + row + 4, _mm_mul_ps(vscale, acc1));
+      }
+   }
+}
+
+static OPUS_INLINE __m128i mix_term4(__m128i c, __m128i x)
+{
+   return _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(c, x), _mm_set1_epi32(16384)), 15);
+}
+
+void mapping_matrix_mix_int_sse4_1(const opus_int32 *coefs, int stride, int cols,
+      const opus_int16 *input, int input_stride, opus_int32 *output, int frame_size)
+{
+   int i, row, col;
+   for (i=0;i<frame_size;i++)
+   {
+      const opus_int16 *x = input + i*input_stride;
+      opus_int32 *y = output + i*stride;
+      for (row=0;row<stride;row+=8)
+      {
+         __m128i acc0 = _mm_setzero_si128();
+         __m128i acc1 = _mm_setzero_si128();
+         for (col=0;col<cols;col++)
+         {
+            __m128i xc = _mm_set1_epi32(x[col]);
+            acc0 = _mm_add_epi32(acc0, mix_term4(_mm_loadu_si128((const __m128i*)(coefs + col*stride + row)), xc));
+            acc1 = _mm_add_epi32(acc1, mix_term4(_mm_loadu_si128((const __m128i*)(coefs + col*stride + row + 4)), xc));
+         }
+         _mm_storeu_si128((__m128i*)(y + row), acc0);
+         _mm_storeu_si128((__m128i*)(y + row + 4), acc1);
+      }
+   }
+}
+
+#endif
@@ -0,0 +1,77 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef MAPPING_MATRIX_X86_H
+#define MAPPING_MATRIX_X86_H
+
+#include "cpu_support.h"
+
+#if defined(OPUS_X86_MAY_HAVE_SSE4_1)
+void mapping_matrix_mix_sse4_1(const float *coefs, int stride, int cols,
+      const float *input, int input_stride, float scale, float *output, int frame_size);
+void mapping_matrix_mix_int_sse4_1(const opus_int32 *coefs, int stride, int cols,
+      const opus_int16 *input, int input_stride, opus_int32 *output, int frame_size);
+#endif
+
+#if defined(OPUS_X86_MAY_HAVE_AVX2)
+void mapping_matrix_mix_avx2(const float *coefs, int stride, int cols,
+      const float *input, int input_stride, float scale, float *output, int frame_size);
+void mapping_matrix_mix_int_avx2(const opus_int32 *coefs, int stride, int cols,
+      const opus_int16 *input, int input_stride, opus_int32 *output, int frame_size);
+#endif
+
+#if defined(OPUS_X86_PRESUME_AVX2)
+
+#define OVERRIDE_MAPPING_MATRIX_MIX
+#define mapping_matrix_mix(coefs, stride, cols, input, input_stride, scale, output, frame_size, arch) \
+   ((void)(arch), mapping_matrix_mix_avx2(coefs, stride, cols, input, input_stride, scale, output, frame_size))
+#define mapping_matrix_mix_int(coefs, stride, cols, input, input_stride, output, frame_size, arch) \
+   ((void)(arch), mapping_matrix_mix_int_avx2(coefs, stride, cols, input, input_stride, output, frame_size))
+
+#elif defined(OPUS_X86_PRESUME_SSE4_1) && !(defined(OPUS_HAVE_RTCD) && defined(OPUS_X86_MAY_HAVE_AVX2))
+
+#define OVERRIDE_MAPPING_MATRIX_MIX
+#define mapping_matrix_mix(coefs, stride, cols, input, input_stride, scale, output, frame_size, arch) \
+   ((void)(arch), mapping_matrix_mix_sse4_1(coefs, stride, cols, input, input_stride, scale, output, frame_size))
+#define mapping_matrix_mix_int(coefs, stride, cols, input, input_stride, output, frame_size, arch) \
+   ((void)(arch), mapping_matrix_mix_int_sse4_1(coefs, stride, cols, input, input_stride, output, frame_size))
+
+#elif defined(OPUS_HAVE_RTCD)
+
+#define OVERRIDE_MAPPING_MATRIX_MIX
+extern void (*const MAPPING_MATRIX_MIX_IMPL[OPUS_ARCHMASK + 1])(const float *coefs, int stride, int cols,
+      const float *input, int input_stride, float scale, float *output, int frame_size);
+#define mapping_matrix_mix(coefs, stride, cols, input, input_stride, scale, output, frame_size, arch) \
+   ((*MAPPING_MATRIX_MIX_IMPL[(arch) & OPUS_ARCHMASK])(coefs, stride, cols, input, input_stride, scale, output, frame_size))
+
+extern void (*const MAPPING_MATRIX_MIX_INT_IMPL[OPUS_ARCHMASK + 1])(const opus_int32 *coefs, int stride, int cols,
+      const opus_int16 *input, int input_stride, opus_int32 *output, int frame_size);
+#define mapping_matrix_mix_int(coefs, stride, cols, input, input_stride, output, frame_size, arch) \
+   ((*MAPPING_MATRIX_MIX_INT_IMPL[(arch) & OPUS_ARCHMASK])(coefs, stride, cols, input, input_stride, output, frame_size))
+
+#endif
+
+#endif
@@ -0,0 +1,185 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <immintrin.h>
+#include "celt/x86/x86cpu.h"
+#include "os_support.h"
+#include "mlp.h"
+
+#if defined(OPUS_X86_MAY_HAVE_AVX2)
+
+/* The classifier is small (25->32 dense, 32->24 GRU, 24->2 dense), so rather
+   than an int8 dot product across the inputs this runs eight neurons per
+   vector: the weights of one input for consecutive neurons are contiguous,
+   and each neuron still sums its inputs in the same order as the C version.
+   With contraction off (this file is built with -mfma) the output is
+   bit-exact with it. */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+static OPUS_INLINE __m256 tansig_approx8(__m256 x)
+{
+   const __m256 N0 = _mm256_set1_ps(952.52801514f);
+   const __m256 N1 = _mm256_set1_ps(96.39235687f);
+   const __m256 N2 = _mm256_set1_ps(0.60863042f);
+   const __m256 D0 = _mm256_set1_ps(952.72399902f);
+   const __m256 D1 = _mm256_set1_ps(413.36801147f);
+   const __m256 D2 = _mm256_set1_ps(11.88600922f);
+   __m256 X2, num, den;
+   X2 = _mm256_mul_ps(x, x);
+   num = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(N2, X2), N1), X2), N0);
+   den = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(D2, X2), D1), X2), D0);
+   num = _mm256_div_ps(_mm256_mul_ps(num, x), den);
+   return _mm256_max_ps(_mm256_set1_ps(-1.f), _mm256_min_ps(_mm256_set1_ps(1.f), num));
+}
+
+static OPUS_INLINE __m256 sigmoid_approx8(__m256 x)
+{
+   const __m256 half = _mm256_set1_ps(.5f);
+   return _mm256_add_ps(half, _mm256_mul_ps(half, tansig_approx8(_mm256_mul_ps(half, x))));
+}
+
+/* Applies WEIGHTS_SCALE and the activation in place, a partial last vector
+   goes through a zero padded copy */
+static void activation_avx2(float *x, int N, int sigmoid)
+{
+   int i;
+   const __m256 scale = _mm256_set1_ps(WEIGHTS_SCALE);
+   for (i=0;i<N;i+=8)
+   {
+      float tmp[8] = {0};
+      float *p;
+      __m256 v;
+      p = x+i;
+      if (N-i < 8)
+      {
+         OPUS_COPY(tmp, x+i, N-i);
+         p = tmp;
+      }
+      v = _mm256_mul_ps(_mm256_loadu_ps(p), scale);
+      v = sigmoid ? sigmoid_approx8(v) : tansig_approx8(v);
+      _mm256_storeu_ps(p, v);
+      if (p == tmp)
+         OPUS_COPY(x+i, tmp, N-i);
+   }
+}
+
+static OPUS_INLINE __m256 load_weights8(const opus_int8 *w)
+{
+   return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(const void *)w)));
+}
+
+static void gemm_accum_avx2(float *out, const opus_int8 *weights, int rows, int cols, int col_stride, const float *x)
+{
+   int i, j;
+   /* Two independent vectors per pass to hide the add latency */
+   for (i=0;i<rows-15;i+=16)
+   {
+      __m256 acc0 = _mm256_loadu_ps(out+i);
+      __m256 acc1 = _mm256_loadu_ps(out+i+8);
+      for (j=0;j<cols;j++)
+      {
+         __m256 xj = _mm256_broadcast_ss(&x[j]);
+         acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(load_weights8(&weights[j*col_stride + i]), xj));
+         acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(load_weights8(&weights[j*col_stride + i + 8]), xj));
+      }
+      _mm256_storeu_ps(out+i, acc0);
+      _mm256_storeu_ps(out+i+8, acc1);
+   }
+   for (;i<rows-7;i+=8)
+   {
+      __m256 acc = _mm256_loadu_ps(out+i);
+      for (j=0;j<cols;j++)
+         acc = _mm256_add_ps(acc, _mm256_mul_ps(load_weights8(&weights[j*col_stride + i]), _mm256_broadcast_ss(&x[j])));
+      _mm256_storeu_ps(out+i, acc);
+   }
+   for (;i<rows;i++)
+   {
+      for (j=0;j<cols;j++)
+         out[i] += weights[j*col_stride + i]*x[j];
+   }
+}
+
+void analysis_compute_dense_avx2(const AnalysisDenseLayer *layer, float *output, const float *input)
+{
+   int i;
+   int N, M;
+   int stride;
+   M = layer->nb_inputs;
+   N = layer->nb_neurons;
+   stride = N;
+   for (i=0;i<N;i++)
+      output[i] = layer->bias[i];
+   gemm_accum_avx2(output, layer->input_weights, N, M, stride, input);
+   activation_avx2(output, N, layer->sigmoid);
+}
+
+void analysis_compute_gru_avx2(const AnalysisGRULayer *gru, float *state, const float *input)
+{
+   int i;
+   int N, M;
+   int stride;
+   float tmp[MAX_NEURONS];
+   float z[MAX_NEURONS];
+   float r[MAX_NEURONS];
+   float h[MAX_NEURONS];
+   M = gru->nb_inputs;
+   N = gru->nb_neurons;
+   stride = 3*N;
+   /* Compute update gate. */
+   for (i=0;i<N;i++)
+      z[i] = gru->bias[i];
+   gemm_accum_avx2(z, gru->input_weights, N, M, stride, input);
+   gemm_accum_avx2(z, gru->recurrent_weights, N, N, stride, state);
+   activation_avx2(z, N, 1);
+
+   /* Compute reset gate. */
+   for (i=0;i<N;i++)
+      r[i] = gru->bias[N + i];
+   gemm_accum_avx2(r, &gru->input_weights[N], N, M, stride, input);
+   gemm_accum_avx2(r, &gru->recurrent_weights[N], N, N, stride, state);
+   activation_avx2(r, N, 1);
+
+   /* Compute output. */
+   for (i=0;i<N;i++)
+      h[i] = gru->bias[2*N + i];
+   for (i=0;i<N;i++)
+      tmp[i] = state[i] * r[i];
+   gemm_accum_avx2(h, &gru->input_weights[2*N], N, M, stride, input);
+   gemm_accum_avx2(h, &gru->recurrent_weights[2*N], N, N, stride, tmp);
+   activation_avx2(h, N, 0);
+   for (i=0;i<N;i++)
+      state[i] = z[i]*state[i] + (1-z[i])*h[i];
+}
+
+#endif
@@ -0,0 +1,177 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <smmintrin.h>
+#include "celt/x86/x86cpu.h"
+#include "os_support.h"
+#include "mlp.h"
+
+#if defined(OPUS_X86_MAY_HAVE_SSE4_1)
+
+/* Same layout as the AVX2 version, four neurons per vector. Each neuron sums
+   its inputs in the same order as the C version, so the output is bit-exact
+   with it. */
+
+static OPUS_INLINE __m128 tansig_approx4(__m128 x)
+{
+   const __m128 N0 = _mm_set1_ps(952.52801514f);
+   const __m128 N1 = _mm_set1_ps(96.39235687f);
+   const __m128 N2 = _mm_set1_ps(0.60863042f);
+   const __m128 D0 = _mm_set1_ps(952.72399902f);
+   const __m128 D1 = _mm_set1_ps(413.36801147f);
+   const __m128 D2 = _mm_set1_ps(11.88600922f);
+   __m128 X2, num, den;
+   X2 = _mm_mul_ps(x, x);
+   num = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(N2, X2), N1), X2), N0);
+   den = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(D2, X2), D1), X2), D0);
+   num = _mm_div_ps(_mm_mul_ps(num, x), den);
+   return _mm_max_ps(_mm_set1_ps(-1.f), _mm_min_ps(_mm_set1_ps(1.f), num));
+}
+
+static OPUS_INLINE __m128 sigmoid_approx4(__m128 x)
+{
+   const __m128 half = _mm_set1_ps(.5f);
+   return _mm_add_ps(half, _mm_mul_ps(half, tansig_approx4(_mm_mul_ps(half, x))));
+}
+
+/* Applies WEIGHTS_SCALE and the activation in place, a partial last vector
+   goes through a zero padded copy */
+static void activation_sse4_1(float *x, int N, int sigmoid)
+{
+   int i;
+   const __m128 scale = _mm_set1_ps(WEIGHTS_SCALE);
+   for (i=0;i<N;i+=4)
+   {
+      float tmp[4] = {0};
+      float *p;
+      __m128 v;
+      p = x+i;
+      if (N-i < 4)
+      {
+         OPUS_COPY(tmp, x+i, N-i);
+         p = tmp;
+      }
+      v = _mm_mul_ps(_mm_loadu_ps(p), scale);
+      v = sigmoid ? sigmoid_approx4(v) : tansig_approx4(v);
+      _mm_storeu_ps(p, v);
+      if (p == tmp)
+         OPUS_COPY(x+i, tmp, N-i);
+   }
+}
+
+static OPUS_INLINE __m128 load_weights4(const opus_int8 *w)
+{
+   return _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_loadu_si32(w)));
+}
+
+static void gemm_accum_sse4_1(float *out, const opus_int8 *weights, int rows, int cols, int col_stride, const float *x)
+{
+   int i, j;
+   /* Two independent vectors per pass to hide the add latency */
+   for (i=0;i<rows-7;i+=8)
+   {
+      __m128 acc0 = _mm_loadu_ps(out+i);
+      __m128 acc1 = _mm_loadu_ps(out+i+4);
+      for (j=0;j<cols;j++)
+      {
+         __m128 xj = _mm_set1_ps(x[j]);
+         acc0 = _mm_add_ps(acc0, _mm_mul_ps(load_weights4(&weights[j*col_stride + i]), xj));
+         acc1 = _mm_add_ps(acc1, _mm_mul_ps(load_weights4(&weights[j*col_stride + i + 4]), xj));
+      }
+      _mm_storeu_ps(out+i, acc0);
+      _mm_storeu_ps(out+i+4, acc1);
+   }
+   for (;i<rows-3;i+=4)
+   {
+      __m128 acc = _mm_loadu_ps(out+i);
+      for (j=0;j<cols;j++)
+         acc = _mm_add_ps(acc, _mm_mul_ps(load_weights4(&weights[j*col_stride + i]), _mm_set1_ps(x[j])));
+      _mm_storeu_ps(out+i, acc);
+   }
+   for (;i<rows;i++)
+   {
+      for (j=0;j<cols;j++)
+         out[i] += weights[j*col_stride + i]*x[j];
+   }
+}
+
+void analysis_compute_dense_sse4_1(const AnalysisDenseLayer *layer, float *output, const float *input)
+{
+   int i;
+   int N, M;
+   int stride;
+   M = layer->nb_inputs;
+   N = layer->nb_neurons;
+   stride = N;
+   for (i=0;i<N;i++)
+      output[i] = layer->bias[i];
+   gemm_accum_sse4_1(output, layer->input_weights, N, M, stride, input);
+   activation_sse4_1(output, N, layer->sigmoid);
+}
+
+void analysis_compute_gru_sse4_1(const AnalysisGRULayer *gru, float *state, const float *input)
+{
+   int i;
+   int N, M;
+   int stride;
+   float tmp[MAX_NEURONS];
+   float z[MAX_NEURONS];
+   float r[MAX_NEURONS];
+   float h[MAX_NEURONS];
+   M = gru->nb_inputs;
+   N = gru->nb_neurons;
+   stride = 3*N;
+   /* Compute update gate. */
+   for (i=0;i<N;i++)
+      z[i] = gru->bias[i];
+   gemm_accum_sse4_1(z, gru->input_weights, N, M, stride, input);
+   gemm_accum_sse4_1(z, gru->recurrent_weights, N, N, stride, state);
+   activation_sse4_1(z, N, 1);
+
+   /* Compute reset gate. */
+   for (i=0;i<N;i++)
+      r[i] = gru->bias[N + i];
+   gemm_accum_sse4_1(r, &gru->input_weights[N], N, M, stride, input);
+   gemm_accum_sse4_1(r, &gru->recurrent_weights[N], N, N, stride, state);
+   activation_sse4_1(r, N, 1);
+
+   /* Compute output. */
+   for (i=0;i<N;i++)
+      h[i] = gru->bias[2*N + i];
+   for (i=0;i<N;i++)
+      tmp[i] = state[i] * r[i];
+   gemm_accum_sse4_1(h, &gru->input_weights[2*N], N, M, stride, input);
+   gemm_accum_sse4_1(h, &gru->recurrent_weights[2*N], N, N, stride, tmp);
+   activation_sse4_1(h, N, 0);
+   for (i=0;i<N;i++)
+      state[i] = z[i]*state[i] + (1-z[i])*h[i];
+}
+
+#endif
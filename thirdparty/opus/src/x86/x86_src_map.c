@@ -0,0 +1,111 @@
+/* Copyright (c) 2026 tty-vc contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "celt/x86/x86cpu.h"
+#include "arch.h"
+#include "mlp.h"
+#include "mapping_matrix.h"
+
+#if defined(OPUS_HAVE_RTCD) && !defined(OPUS_X86_PRESUME_AVX2) && \
+ ((defined(OPUS_X86_MAY_HAVE_SSE4_1) && !defined(OPUS_X86_PRESUME_SSE4_1)) || \
+  defined(OPUS_X86_MAY_HAVE_AVX2))
+
+void (*const ANALYSIS_COMPUTE_DENSE_IMPL[OPUS_ARCHMASK + 1])(
+      const AnalysisDenseLayer *layer,
+      float *output,
+      const float *input
+) = {
+  analysis_compute_dense_c,                /* non-sse */
+  analysis_compute_dense_c,
+  analysis_compute_dense_c,
+  MAY_HAVE_SSE4_1(analysis_compute_dense), /* sse4.1  */
+  MAY_HAVE_AVX2(analysis_compute_dense),   /* avx  */
+  MAY_HAVE_AVX2(analysis_compute_dense),   /* avx512  */
+  MAY_HAVE_AVX2(analysis_compute_dense)    /* avx512 vnni */
+};
+
+void (*const ANALYSIS_COMPUTE_GRU_IMPL[OPUS_ARCHMASK + 1])(
+      const AnalysisGRULayer *gru,
+      float *state,
+      const float *input
+) = {
+  analysis_compute_gru_c,                  /* non-sse */
+  analysis_compute_gru_c,
+  analysis_compute_gru_c,
+  MAY_HAVE_SSE4_1(analysis_compute_gru),   /* sse4.1  */
+  MAY_HAVE_AVX2(analysis_compute_gru),     /* avx  */
+  MAY_HAVE_AVX2(analysis_compute_gru),     /* avx512  */
+  MAY_HAVE_AVX2(analysis_compute_gru)      /* avx512 vnni */
+};
+
+#endif
+
+#if defined(OPUS_HAVE_RTCD) && !defined(OPUS_X86_PRESUME_AVX2) && \
+ ((defined(OPUS_X86_MAY_HAVE_SSE4_1) && !defined(OPUS_X86_PRESUME_SSE4_1)) || \
+  defined(OPUS_X86_MAY_HAVE_AVX2))
+
+void (*const MAPPING_MATRIX_MIX_IMPL[OPUS_ARCHMASK + 1])(
+      const float *coefs,
+      int stride,
+      int cols,
+      const float *input,
+      int input_stride,
+      float scale,
+      float *output,
+      int frame_size
+) = {
+  mapping_matrix_mix_c,                    /* non-sse */
+  mapping_matrix_mix_c,
+  mapping_matrix_mix_c,
+  MAY_HAVE_SSE4_1(mapping_matrix_mix),     /* sse4.1  */
+  MAY_HAVE_AVX2(mapping_matrix_mix),       /* avx  */
+  MAY_HAVE_AVX2(mapping_matrix_mix),       /* avx512  */
+  MAY_HAVE_AVX2(mapping_matrix_mix)        /* avx512 vnni */
+};
+
+void (*const MAPPING_MATRIX_MIX_INT_IMPL[OPUS_ARCHMASK + 1])(
+      const opus_int32 *coefs,
+      int stride,
+      int cols,
+      const opus_int16 *input,
+      int input_stride,
+      opus_int32 *output,
+      int frame_size
+) = {
+  mapping_matrix_mix_int_c,                /* non-sse */
+  mapping_matrix_mix_int_c,
+  mapping_matrix_mix_int_c,
+  MAY_HAVE_SSE4_1(mapping_matrix_mix_int), /* sse4.1  */
+  MAY_HAVE_AVX2(mapping_matrix_mix_int),   /* avx  */
+  MAY_HAVE_AVX2(mapping_matrix_mix_int),   /* avx512  */
+  MAY_HAVE_AVX2(mapping_matrix_mix_int)    /* avx512 vnni */
+};
+
+#endif